@@ -26,6 +26,9 @@
 #include "Conditional.h"
 #include "Reset.h"
 #include "QuantumGates.h"
+#include "CompiledCircuit.h"
+#include "GateFusion.h"
+#include "../Utils/PackedBits.h"
 
 namespace Circuits {
 
@@ -42,6 +45,7 @@ namespace Circuits {
 	template<typename Time = Types::time_type> class Circuit : public IOperation<Time> {
 	public:
 		using ExecuteResults = std::unordered_map<std::vector<bool>, size_t>; /**< The results of the execution of the circuit. */
+		using PackedExecuteResults = Utils::PackedBitsCounts; /**< The results of the execution of the circuit, with packed keys, cheaper to fill shot by shot. */
 		using BitMapping = std::unordered_map<Types::qubit_t, Types::qubit_t>; /**< The (qu)bit mapping for remapping. */
 
 		using Operation = IOperation<Time>; /**< The operation type. */
@@ -337,6 +341,19 @@ namespace Circuits {
 				results[res.first] += res.second;
 		}
 
+		/**
+		 * @brief Accumulate packed results of a circuit execution to already existing results.
+		 *
+		 * Accumulates packed results of a circuit execution to already existing results, unpacking the keys.
+		 * @param results The existing results to accumulate to.
+		 * @param newResults The new packed results to add to the existing results.
+		 */
+		static void AccumulateResults(ExecuteResults& results, const PackedExecuteResults& newResults)
+		{
+			for (const auto& res : newResults)
+				results[res.first.ToVector()] += res.second;
+		}
+
 		/**
 		 * @brief Accumulate the results of a circuit execution to already existing results with remapping.
 		 * 
@@ -760,9 +777,23 @@ namespace Circuits {
 					operations.insert(operations.begin(), std::make_shared<Reset<Time>>(Types::qubits_vector{ q }, delay));
 		}
 
+		/**
+		 * @brief Fuse the gates
+		 *
+		 * Merges runs of gates acting on at most maxQubits qubits into a single gate.
+		 * With maxQubits 1 only single qubit gates are fused, into U gates, otherwise the result might contain fused (dense matrix) gates,
+		 * which only statevector simulators can execute.
+		 * @param maxQubits The maximum number of qubits of a fused gate.
+		 * @sa GateFusion
+		 */
+		void Fuse(size_t maxQubits = 2)
+		{
+			operations = GateFusion<Time>::Fuse(operations, maxQubits);
+		}
+
 		/**
 		 * @brief Circuit optimization
-		 * 
+		 *
 		 * Optimizes the circuit.
 		 * See qisikit aer for 'transpilling' when the circuit is flushed for some ideas.
 		 */
@@ -1655,6 +1686,10 @@ namespace Circuits {
 			std::vector<bool> executedOps;
 			executedOps.reserve(operations.size());
 
+			// the operations that can be executed are collected, then executed in one go in compiled form
+			OperationsVector opsToExecute;
+			opsToExecute.reserve(operations.size());
+
 			std::unordered_set<Types::qubit_t> measuredQubits;
 			std::unordered_set<Types::qubit_t> affectedQubits;
 
@@ -1680,9 +1715,8 @@ namespace Circuits {
 							break;
 						}
 
-					if (executed) {
-						if (sim) op->Execute(sim, state);
-					}
+					if (executed)
+						opsToExecute.push_back(op);
 					else
 						measuredQubits.insert(qubits.begin(), qubits.end());
 				}
@@ -1714,7 +1748,7 @@ namespace Circuits {
 
 					if (canExecute)
 					{
-						if (sim) op->Execute(sim, state);
+						opsToExecute.push_back(op);
 						executed = true;
 					}
 					else
@@ -1732,11 +1766,49 @@ namespace Circuits {
 					executedOps.emplace_back(executed);
 			}
 
+			if (sim) CompiledCircuit<Time>(opsToExecute).Execute(sim, state);
+
 			//if (sim) sim->Flush();
 
 			return executedOps;
 		}
 
+		/**
+		 * @brief Compile the circuit.
+		 *
+		 * Compiles the circuit to a flat form, cheaper to execute many times.
+		 * The compiled circuit is not affected by later changes to the circuit.
+		 * @return The compiled circuit.
+		 * @sa CompiledCircuit
+		 */
+		CompiledCircuit<Time> Compile() const
+		{
+			return CompiledCircuit<Time>(operations);
+		}
+
+		/**
+		 * @brief Compile the operations not executed by ExecuteNonMeasurements.
+		 *
+		 * Executing the result is the same as calling ExecuteMeasurements with the same executed operations vector, except that the classical state is not reset.
+		 * @param executedOps The executed operations vector, as returned by ExecuteNonMeasurements.
+		 * @return The compiled operations.
+		 * @sa CompiledCircuit
+		 * @sa ExecuteNonMeasurements
+		 */
+		CompiledCircuit<Time> CompileMeasurements(const std::vector<bool>& executedOps) const
+		{
+			CompiledCircuit<Time> compiled;
+
+			const size_t dif = operations.size() - executedOps.size();
+			compiled.Reserve(executedOps.size());
+
+			for (size_t i = dif; i < operations.size(); ++i)
+				if (!executedOps[i - dif])
+					compiled.AddOperation(operations[i]);
+
+			return compiled;
+		}
+
 		/**
 		 * @brief Execute the measurement operations from the circuit on the given simulator.
 		 *
@@ -0,0 +1,299 @@
+/**
+ * @file CompiledCircuit.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A compiled (flattened) form of a list of operations, for fast repeated execution.
+ *
+ * The operations are stored as a struct of arrays: opcodes, qubits, parameters and classical bits indices.
+ * Executing it is a single loop with a switch over the opcodes, calling the simulator directly,
+ * instead of a virtual Execute call through a shared pointer for each operation.
+ */
+
+#pragma once
+
+#ifndef _COMPILED_CIRCUIT_H_
+#define _COMPILED_CIRCUIT_H_
+
+#include <vector>
+#include <cstdint>
+
+#include "Operations.h"
+#include "QuantumGates.h"
+#include "Measurements.h"
+
+namespace Circuits {
+
+	/**
+	 * @enum CompiledOpcode
+	 * @brief The opcodes of a compiled circuit.
+	 *
+	 * The gates opcodes have the same values as the corresponding QuantumGateType.
+	 */
+	enum class CompiledOpcode : uint8_t {
+		kP = 0,
+		kX,
+		kY,
+		kZ,
+		kH,
+		kS,
+		kSdg,
+		kT,
+		kTdg,
+		kSx,
+		kSxDag,
+		kK,
+		kRx,
+		kRy,
+		kRz,
+		kU,
+		kSwap,
+		kCX,
+		kCY,
+		kCZ,
+		kCP,
+		kCRx,
+		kCRy,
+		kCRz,
+		kCH,
+		kCSx,
+		kCSxDag,
+		kCU,
+		kCSwap,
+		kCCX,
+		kMeasurement, /**< a measurement, the argument is the index of the measurement */
+		kOperation /**< any other operation, executed through the operation object, the argument is its index */
+	};
+
+	static_assert(static_cast<int>(CompiledOpcode::kCCX) == static_cast<int>(QuantumGateType::kCCXGateType), "The compiled gates opcodes must match the quantum gates types");
+
+	/**
+	 * @class CompiledCircuit
+	 * @brief A flattened form of a list of operations.
+	 *
+	 * Built once from the operations, then executed many times (for example once for each shot).
+	 * Gates and measurements are compiled to opcodes, everything else (conditional operations, random generators, resets, fused gates...)
+	 * is kept as an operation object and executed through it.
+	 * It does not keep any reference to the operations it was compiled from, except for the ones that are not compiled.
+	 * @tparam Time The type of the execution delay.
+	 * @sa Circuit
+	 */
+	template<typename Time = Types::time_type> class CompiledCircuit {
+	public:
+		using OperationPtr = std::shared_ptr<IOperation<Time>>; /**< The shared pointer to the operation type. */
+
+		constexpr static size_t MaxQubits = 3; /**< The maximum number of qubits of a gate, the qubits array has this stride */
+
+		/**
+		 * @brief Construct an empty compiled circuit.
+		 */
+		CompiledCircuit() = default;
+
+		/**
+		 * @brief Construct a compiled circuit from a list of operations.
+		 *
+		 * @param ops The operations to compile.
+		 */
+		explicit CompiledCircuit(const std::vector<OperationPtr>& ops)
+		{
+			Reserve(ops.size());
+
+			for (const auto& op : ops)
+				AddOperation(op);
+		}
+
+		/**
+		 * @brief Reserve memory for a number of operations.
+		 *
+		 * @param nrOps The number of operations.
+		 */
+		void Reserve(size_t nrOps)
+		{
+			opcodes.reserve(nrOps);
+			qubits.reserve(MaxQubits * nrOps);
+			args.reserve(nrOps);
+		}
+
+		/**
+		 * @brief Compile an operation and add it at the end.
+		 *
+		 * @param op The operation to add.
+		 */
+		void AddOperation(const OperationPtr& op)
+		{
+			if (!op) return;
+
+			switch (op->GetType())
+			{
+			case OperationType::kNoOp:
+				break;
+
+			case OperationType::kGate:
+			{
+				const auto gate = std::static_pointer_cast<IQuantumGate<Time>>(op);
+
+				// the fused gates are expensive anyway, they go through the operation object
+				if (gate->GetGateType() == QuantumGateType::kFusedGateType)
+				{
+					AddUncompiled(op);
+					break;
+				}
+
+				const auto gateParams = gate->GetParams();
+
+				opcodes.push_back(static_cast<CompiledOpcode>(gate->GetGateType()));
+				for (unsigned int q = 0; q < MaxQubits; ++q)
+					qubits.push_back(q < gate->GetNumQubits() ? gate->GetQubit(q) : 0);
+				args.push_back(static_cast<uint32_t>(params.size()));
+				params.insert(params.end(), gateParams.begin(), gateParams.end());
+			}
+			break;
+
+			case OperationType::kMeasurement:
+			{
+				const auto measurement = std::static_pointer_cast<MeasurementOperation<Time>>(op);
+				const auto& bits = measurement->GetBitsIndices();
+
+				opcodes.push_back(CompiledOpcode::kMeasurement);
+				qubits.insert(qubits.end(), MaxQubits, 0);
+				args.push_back(static_cast<uint32_t>(measurementsQubits.size()));
+				measurementsQubits.push_back(measurement->GetQubits());
+				measurementsCbitsStart.push_back(cbits.size());
+				cbits.insert(cbits.end(), bits.begin(), bits.end());
+			}
+			break;
+
+			default:
+				AddUncompiled(op);
+				break;
+			}
+		}
+
+		/**
+		 * @brief Execute the compiled operations on the given simulator.
+		 *
+		 * Unlike Circuit::Execute, the classical state is not reset before execution.
+		 * @param sim The simulator to execute on.
+		 * @param state The classical state containing the classical bits.
+		 * @sa ISimulator
+		 * @sa OperationState
+		 */
+		void Execute(const std::shared_ptr<Simulators::ISimulator>& sim, OperationState& state) const
+		{
+			if (!sim) return;
+
+			Simulators::ISimulator& s = *sim;
+
+			const size_t nrOps = opcodes.size();
+			for (size_t i = 0; i < nrOps; ++i)
+			{
+				const Types::qubit_t* q = qubits.data() + MaxQubits * i;
+				const double* p = opcodes[i] < CompiledOpcode::kMeasurement ? params.data() + args[i] : nullptr;
+
+				switch (opcodes[i])
+				{
+				case CompiledOpcode::kP: s.ApplyP(q[0], p[0]); break;
+				case CompiledOpcode::kX: s.ApplyX(q[0]); break;
+				case CompiledOpcode::kY: s.ApplyY(q[0]); break;
+				case CompiledOpcode::kZ: s.ApplyZ(q[0]); break;
+				case CompiledOpcode::kH: s.ApplyH(q[0]); break;
+				case CompiledOpcode::kS: s.ApplyS(q[0]); break;
+				case CompiledOpcode::kSdg: s.ApplySDG(q[0]); break;
+				case CompiledOpcode::kT: s.ApplyT(q[0]); break;
+				case CompiledOpcode::kTdg: s.ApplyTDG(q[0]); break;
+				case CompiledOpcode::kSx: s.ApplySx(q[0]); break;
+				case CompiledOpcode::kSxDag: s.ApplySxDAG(q[0]); break;
+				case CompiledOpcode::kK: s.ApplyK(q[0]); break;
+				case CompiledOpcode::kRx: s.ApplyRx(q[0], p[0]); break;
+				case CompiledOpcode::kRy: s.ApplyRy(q[0], p[0]); break;
+				case CompiledOpcode::kRz: s.ApplyRz(q[0], p[0]); break;
+				case CompiledOpcode::kU: s.ApplyU(q[0], p[0], p[1], p[2], p[3]); break;
+				case CompiledOpcode::kSwap: s.ApplySwap(q[0], q[1]); break;
+				case CompiledOpcode::kCX: s.ApplyCX(q[0], q[1]); break;
+				case CompiledOpcode::kCY: s.ApplyCY(q[0], q[1]); break;
+				case CompiledOpcode::kCZ: s.ApplyCZ(q[0], q[1]); break;
+				case CompiledOpcode::kCP: s.ApplyCP(q[0], q[1], p[0]); break;
+				case CompiledOpcode::kCRx: s.ApplyCRx(q[0], q[1], p[0]); break;
+				case CompiledOpcode::kCRy: s.ApplyCRy(q[0], q[1], p[0]); break;
+				case CompiledOpcode::kCRz: s.ApplyCRz(q[0], q[1], p[0]); break;
+				case CompiledOpcode::kCH: s.ApplyCH(q[0], q[1]); break;
+				case CompiledOpcode::kCSx: s.ApplyCSx(q[0], q[1]); break;
+				case CompiledOpcode::kCSxDag: s.ApplyCSxDAG(q[0], q[1]); break;
+				case CompiledOpcode::kCU: s.ApplyCU(q[0], q[1], p[0], p[1], p[2], p[3]); break;
+				case CompiledOpcode::kCSwap: s.ApplyCSwap(q[0], q[1], q[2]); break;
+				case CompiledOpcode::kCCX: s.ApplyCCX(q[0], q[1], q[2]); break;
+
+				case CompiledOpcode::kMeasurement:
+				{
+					const auto& measQubits = measurementsQubits[args[i]];
+					if (measQubits.empty()) break;
+
+					size_t res = s.Measure(measQubits);
+
+					const size_t* bits = cbits.data() + measurementsCbitsStart[args[i]];
+					for (size_t b = 0; b < measQubits.size(); ++b)
+					{
+						state.SetBit(bits[b], (res & 1) != 0);
+						res >>= 1;
+					}
+				}
+				break;
+
+				case CompiledOpcode::kOperation:
+					operations[args[i]]->Execute(sim, state);
+					break;
+				}
+			}
+		}
+
+		/**
+		 * @brief Get the number of compiled operations.
+		 *
+		 * The no-ops are dropped at compilation, so this might be less than the number of operations it was compiled from.
+		 * @return The number of operations.
+		 */
+		size_t size() const
+		{
+			return opcodes.size();
+		}
+
+		/**
+		 * @brief Check if there are no compiled operations.
+		 *
+		 * @return True if there is nothing to execute, false otherwise.
+		 */
+		bool empty() const
+		{
+			return opcodes.empty();
+		}
+
+	private:
+		/**
+		 * @brief Add an operation that is executed through the operation object.
+		 *
+		 * @param op The operation to add.
+		 */
+		void AddUncompiled(const OperationPtr& op)
+		{
+			opcodes.push_back(CompiledOpcode::kOperation);
+			qubits.insert(qubits.end(), MaxQubits, 0);
+			args.push_back(static_cast<uint32_t>(operations.size()));
+			operations.push_back(op);
+		}
+
+		std::vector<CompiledOpcode> opcodes; /**< The opcodes, one for each operation */
+		std::vector<Types::qubit_t> qubits; /**< The qubits, MaxQubits for each operation, the unused ones are zero */
+		std::vector<uint32_t> args; /**< For each operation, the index of the first parameter for gates, the index of the measurement or of the operation otherwise */
+		std::vector<double> params; /**< The gates parameters */
+
+		std::vector<Types::qubits_vector> measurementsQubits; /**< The measured qubits, for each measurement */
+		std::vector<size_t> measurementsCbitsStart; /**< The index in cbits of the first classical bit, for each measurement */
+		std::vector<size_t> cbits; /**< The classical bits indices where the measurement results go */
+
+		std::vector<OperationPtr> operations; /**< The operations that are not compiled */
+	};
+
+}
+
+#endif // _COMPILED_CIRCUIT_H_
@@ -0,0 +1,561 @@
+/**
+ * @file GateFusion.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Gate fusion: merges runs of gates acting on a few qubits into a single gate.
+ *
+ * Runs of single qubit gates become a single U gate, supported by all the simulators except the stabilizer one.
+ * With more than one qubit allowed, single qubit gates are absorbed in the neighbouring two qubits gates (or larger blocks, up to 5 qubits),
+ * the result being a gate given by a dense matrix, to be applied by statevector simulators.
+ */
+
+#pragma once
+
+#ifndef _GATE_FUSION_H_
+#define _GATE_FUSION_H_
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Operations.h"
+#include "QuantumGates.h"
+
+namespace Circuits {
+
+	/**
+	 * @class GateFusion
+	 * @brief Gate fusion pass.
+	 *
+	 * Goes once over the operations, keeping open blocks of gates, each acting on a set of qubits.
+	 * A gate is added to the blocks that act on its qubits (merging them) if the result doesn't exceed the maximum number of qubits,
+	 * otherwise those blocks are closed and a new block is started with the gate.
+	 * Any other operation (measurement, reset, conditional gate...) closes the blocks that act on its qubits.
+	 * The gates in a block act only on the qubits of the block and all the operations emitted meanwhile act on other qubits,
+	 * so emitting the block when it's closed does not change the result of the circuit.
+	 *
+	 * The matrices use the same convention as ISimulator::ApplyMatrix: row major, the first qubit being the least significant bit of the indices.
+	 * @tparam Time The type of the execution delay.
+	 * @sa FusedGate
+	 */
+	template<typename Time = Types::time_type> class GateFusion {
+	public:
+		using OperationPtr = std::shared_ptr<IOperation<Time>>; /**< The shared pointer to the operation type. */
+		using Matrix = std::vector<std::complex<double>>; /**< A dense matrix, row major. */
+
+		constexpr static size_t MaxFusedQubits = 5; /**< The maximum number of qubits of a fused gate */
+
+		/**
+		 * @brief Fuse the gates.
+		 *
+		 * @param ops The operations to fuse.
+		 * @param maxQubits The maximum number of qubits of a fused gate, 1 means only single qubit gates are fused (into U gates).
+		 * @return The operations, with the fused gates.
+		 */
+		static std::vector<OperationPtr> Fuse(const std::vector<OperationPtr>& ops, size_t maxQubits = 2)
+		{
+			maxQubits = std::clamp<size_t>(maxQubits, 1, MaxFusedQubits);
+
+			std::vector<OperationPtr> result;
+			result.reserve(ops.size());
+
+			std::vector<Block> blocks;
+			std::unordered_map<Types::qubit_t, size_t> openBlocks; // the open block acting on each qubit
+
+			auto closeBlock = [&](size_t b)
+			{
+				for (const auto q : blocks[b].qubits)
+					openBlocks.erase(q);
+
+				Emit(blocks[b], result);
+				blocks[b] = Block(); // free the memory, it's not needed anymore
+			};
+
+			for (const auto& op : ops)
+			{
+				const auto type = op->GetType();
+				if (type == OperationType::kNoOp) continue;
+
+				const auto qubits = op->AffectedQubits();
+
+				Matrix gateMatrix;
+				if (type != OperationType::kGate || qubits.size() > maxQubits || !GetGateMatrix(std::static_pointer_cast<IQuantumGate<Time>>(op), gateMatrix))
+				{
+					for (const auto q : qubits)
+					{
+						const auto it = openBlocks.find(q);
+						if (it != openBlocks.end())
+							closeBlock(it->second);
+					}
+
+					result.push_back(op);
+					continue;
+				}
+
+				// the open blocks acting on the gate qubits, in creation order
+				std::vector<size_t> touched;
+				size_t nrFreeQubits = 0;
+				for (const auto q : qubits)
+				{
+					const auto it = openBlocks.find(q);
+					if (it == openBlocks.end())
+						++nrFreeQubits;
+					else if (std::find(touched.begin(), touched.end(), it->second) == touched.end())
+						touched.push_back(it->second);
+				}
+				std::sort(touched.begin(), touched.end());
+
+				size_t nrQubits = nrFreeQubits;
+				for (const auto b : touched)
+					nrQubits += blocks[b].qubits.size();
+
+				Block block;
+				if (nrQubits <= maxQubits)
+				{
+					// merge the blocks, the gates in different blocks act on different qubits, so they commute
+					for (const auto b : touched)
+					{
+						block = Merge(block, blocks[b]);
+						for (const auto q : blocks[b].qubits)
+							openBlocks.erase(q);
+						blocks[b] = Block();
+					}
+				}
+				else
+				{
+					for (const auto b : touched)
+						closeBlock(b);
+				}
+
+				AddGate(block, op, qubits, gateMatrix);
+
+				for (const auto q : block.qubits)
+					openBlocks[q] = blocks.size();
+				blocks.emplace_back(std::move(block));
+			}
+
+			// the remaining blocks act on different qubits, emit them in creation order
+			for (size_t b = 0; b < blocks.size(); ++b)
+				if (!blocks[b].qubits.empty())
+					Emit(blocks[b], result);
+
+			return result;
+		}
+
+		/**
+		 * @brief Get the matrix of a gate.
+		 *
+		 * @param gate The gate.
+		 * @param matrix The matrix of the gate, 2^n x 2^n, n being the number of qubits of the gate, in the order of the gate qubits.
+		 * @return True if the matrix is known, false otherwise.
+		 */
+		static bool GetGateMatrix(const std::shared_ptr<IQuantumGate<Time>>& gate, Matrix& matrix)
+		{
+			const auto gateType = gate->GetGateType();
+			const auto params = gate->GetParams();
+
+			if (gateType == QuantumGateType::kFusedGateType)
+			{
+				matrix = std::static_pointer_cast<FusedGate<Time>>(gate)->GetMatrix();
+				return true;
+			}
+
+			std::complex<double> u[4];
+			if (gate->GetNumQubits() == 1)
+			{
+				if (!GetSingleQubitMatrix(gateType, params, u)) return false;
+
+				matrix.assign(u, u + 4);
+				return true;
+			}
+
+			switch (gateType)
+			{
+			case QuantumGateType::kSwapGateType:
+				matrix = Identity(4);
+				std::swap(matrix[1 * 4 + 1], matrix[1 * 4 + 2]);
+				std::swap(matrix[2 * 4 + 2], matrix[2 * 4 + 1]);
+				return true;
+
+			case QuantumGateType::kCCXGateType:
+				// controls on the first two qubits, the target is the third
+				matrix = Identity(8);
+				std::swap(matrix[3 * 8 + 3], matrix[3 * 8 + 7]);
+				std::swap(matrix[7 * 8 + 7], matrix[7 * 8 + 3]);
+				return true;
+
+			case QuantumGateType::kCSwapGateType:
+				// the control on the first qubit, swaps the other two
+				matrix = Identity(8);
+				std::swap(matrix[3 * 8 + 3], matrix[3 * 8 + 5]);
+				std::swap(matrix[5 * 8 + 5], matrix[5 * 8 + 3]);
+				return true;
+
+			default:
+				break;
+			}
+
+			// the rest are controlled single qubit gates, the control is the first qubit
+			QuantumGateType targetType;
+			switch (gateType)
+			{
+			case QuantumGateType::kCXGateType: targetType = QuantumGateType::kXGateType; break;
+			case QuantumGateType::kCYGateType: targetType = QuantumGateType::kYGateType; break;
+			case QuantumGateType::kCZGateType: targetType = QuantumGateType::kZGateType; break;
+			case QuantumGateType::kCPGateType: targetType = QuantumGateType::kPhaseGateType; break;
+			case QuantumGateType::kCRxGateType: targetType = QuantumGateType::kRxGateType; break;
+			case QuantumGateType::kCRyGateType: targetType = QuantumGateType::kRyGateType; break;
+			case QuantumGateType::kCRzGateType: targetType = QuantumGateType::kRzGateType; break;
+			case QuantumGateType::kCHGateType: targetType = QuantumGateType::kHadamardGateType; break;
+			case QuantumGateType::kCSxGateType: targetType = QuantumGateType::kSxGateType; break;
+			case QuantumGateType::kCSxDagGateType: targetType = QuantumGateType::kSxDagGateType; break;
+			case QuantumGateType::kCUGateType: targetType = QuantumGateType::kUGateType; break;
+			default:
+				return false;
+			}
+
+			if (!GetSingleQubitMatrix(targetType, params, u)) return false;
+
+			matrix = Identity(4);
+			matrix[1 * 4 + 1] = u[0];
+			matrix[1 * 4 + 3] = u[1];
+			matrix[3 * 4 + 1] = u[2];
+			matrix[3 * 4 + 3] = u[3];
+
+			return true;
+		}
+
+	private:
+		/**
+		 * @brief A block of gates being fused.
+		 */
+		struct Block {
+			Types::qubits_vector qubits; /**< The qubits of the block, empty if the block was emitted or merged */
+			Matrix matrix; /**< The matrix of the block */
+			OperationPtr firstGate; /**< The first gate, emitted as it is if it's the only one */
+			size_t nrGates = 0; /**< The number of gates in the block */
+			Time delay = 0; /**< The sum of the gates delays */
+		};
+
+		/**
+		 * @brief Get the matrix of a single qubit gate.
+		 *
+		 * @param gateType The gate type.
+		 * @param params The gate parameters.
+		 * @param u The matrix, row major.
+		 * @return True if the matrix is known, false otherwise.
+		 */
+		static bool GetSingleQubitMatrix(QuantumGateType gateType, const std::vector<double>& params, std::complex<double> u[4])
+		{
+			using namespace std::complex_literals;
+			static const double invSqrt2 = 1. / std::sqrt(2.);
+
+			switch (gateType)
+			{
+			case QuantumGateType::kPhaseGateType:
+				u[0] = 1.; u[1] = 0.; u[2] = 0.; u[3] = std::polar(1., params[0]);
+				break;
+			case QuantumGateType::kXGateType:
+				u[0] = 0.; u[1] = 1.; u[2] = 1.; u[3] = 0.;
+				break;
+			case QuantumGateType::kYGateType:
+				u[0] = 0.; u[1] = -1i; u[2] = 1i; u[3] = 0.;
+				break;
+			case QuantumGateType::kZGateType:
+				u[0] = 1.; u[1] = 0.; u[2] = 0.; u[3] = -1.;
+				break;
+			case QuantumGateType::kHadamardGateType:
+				u[0] = invSqrt2; u[1] = invSqrt2; u[2] = invSqrt2; u[3] = -invSqrt2;
+				break;
+			case QuantumGateType::kSGateType:
+				u[0] = 1.; u[1] = 0.; u[2] = 0.; u[3] = 1i;
+				break;
+			case QuantumGateType::kSdgGateType:
+				u[0] = 1.; u[1] = 0.; u[2] = 0.; u[3] = -1i;
+				break;
+			case QuantumGateType::kTGateType:
+				u[0] = 1.; u[1] = 0.; u[2] = 0.; u[3] = std::polar(1., M_PI_4);
+				break;
+			case QuantumGateType::kTdgGateType:
+				u[0] = 1.; u[1] = 0.; u[2] = 0.; u[3] = std::polar(1., -M_PI_4);
+				break;
+			case QuantumGateType::kSxGateType:
+				u[0] = 0.5 + 0.5i; u[1] = 0.5 - 0.5i; u[2] = 0.5 - 0.5i; u[3] = 0.5 + 0.5i;
+				break;
+			case QuantumGateType::kSxDagGateType:
+				u[0] = 0.5 - 0.5i; u[1] = 0.5 + 0.5i; u[2] = 0.5 + 0.5i; u[3] = 0.5 - 0.5i;
+				break;
+			case QuantumGateType::kKGateType:
+				u[0] = invSqrt2; u[1] = -1i * invSqrt2; u[2] = 1i * invSqrt2; u[3] = -invSqrt2;
+				break;
+			case QuantumGateType::kRxGateType:
+			{
+				const double c = std::cos(0.5 * params[0]);
+				const double s = std::sin(0.5 * params[0]);
+				u[0] = c; u[1] = -1i * s; u[2] = -1i * s; u[3] = c;
+			}
+			break;
+			case QuantumGateType::kRyGateType:
+			{
+				const double c = std::cos(0.5 * params[0]);
+				const double s = std::sin(0.5 * params[0]);
+				u[0] = c; u[1] = -s; u[2] = s; u[3] = c;
+			}
+			break;
+			case QuantumGateType::kRzGateType:
+				u[0] = std::polar(1., -0.5 * params[0]); u[1] = 0.; u[2] = 0.; u[3] = std::polar(1., 0.5 * params[0]);
+				break;
+			case QuantumGateType::kUGateType:
+			{
+				const double c = std::cos(0.5 * params[0]);
+				const double s = std::sin(0.5 * params[0]);
+				const double phi = params[1];
+				const double lambda = params[2];
+				const double gamma = params[3];
+
+				u[0] = std::polar(c, gamma);
+				u[1] = -std::polar(s, lambda + gamma);
+				u[2] = std::polar(s, phi + gamma);
+				u[3] = std::polar(c, phi + lambda + gamma);
+			}
+			break;
+			default:
+				return false;
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Get the identity matrix.
+		 *
+		 * @param dim The dimension of the matrix.
+		 * @return The identity matrix.
+		 */
+		static Matrix Identity(size_t dim)
+		{
+			Matrix m(dim * dim, 0.);
+			for (size_t i = 0; i < dim; ++i)
+				m[i * dim + i] = 1.;
+
+			return m;
+		}
+
+		/**
+		 * @brief Merge two blocks acting on different qubits.
+		 *
+		 * The qubits of the second block come after the ones of the first block, the matrix is the tensor product.
+		 * @param first The first block.
+		 * @param second The second block.
+		 * @return The merged block.
+		 */
+		static Block Merge(const Block& first, const Block& second)
+		{
+			if (first.qubits.empty()) return second;
+
+			Block block;
+			block.qubits = first.qubits;
+			block.qubits.insert(block.qubits.end(), second.qubits.begin(), second.qubits.end());
+			block.firstGate = first.firstGate;
+			block.nrGates = first.nrGates + second.nrGates;
+			block.delay = first.delay + second.delay;
+			block.matrix = Kron(second.matrix, 1ULL << second.qubits.size(), first.matrix, 1ULL << first.qubits.size());
+
+			return block;
+		}
+
+		/**
+		 * @brief The tensor product of two matrices.
+		 *
+		 * @param high The matrix acting on the high bits of the indices.
+		 * @param dimHigh The dimension of the high matrix.
+		 * @param low The matrix acting on the low bits of the indices.
+		 * @param dimLow The dimension of the low matrix.
+		 * @return The tensor product.
+		 */
+		static Matrix Kron(const Matrix& high, size_t dimHigh, const Matrix& low, size_t dimLow)
+		{
+			const size_t dim = dimHigh * dimLow;
+			Matrix m(dim * dim);
+
+			for (size_t rh = 0; rh < dimHigh; ++rh)
+				for (size_t ch = 0; ch < dimHigh; ++ch)
+				{
+					const std::complex<double> h = high[rh * dimHigh + ch];
+					for (size_t rl = 0; rl < dimLow; ++rl)
+						for (size_t cl = 0; cl < dimLow; ++cl)
+							m[(rh * dimLow + rl) * dim + ch * dimLow + cl] = h * low[rl * dimLow + cl];
+				}
+
+			return m;
+		}
+
+		/**
+		 * @brief Add a gate to a block.
+		 *
+		 * The block is extended with the gate qubits that it does not contain yet, then the gate matrix is multiplied (from the left) with the block matrix.
+		 * @param block The block, empty for starting a new one.
+		 * @param gate The gate.
+		 * @param gateQubits The gate qubits.
+		 * @param gateMatrix The gate matrix.
+		 */
+		static void AddGate(Block& block, const OperationPtr& gate, const Types::qubits_vector& gateQubits, const Matrix& gateMatrix)
+		{
+			if (block.qubits.empty())
+			{
+				block.qubits = gateQubits;
+				block.matrix = gateMatrix;
+				block.firstGate = gate;
+				block.nrGates = 1;
+				block.delay = gate->GetDelay();
+
+				return;
+			}
+
+			for (const auto q : gateQubits)
+				if (std::find(block.qubits.begin(), block.qubits.end(), q) == block.qubits.end())
+				{
+					block.matrix = Kron(Identity(2), 2, block.matrix, 1ULL << block.qubits.size());
+					block.qubits.push_back(q);
+				}
+
+			const size_t dim = 1ULL << block.qubits.size();
+			const size_t gateDim = 1ULL << gateQubits.size();
+
+			// the positions of the gate qubits in the block qubits
+			std::vector<size_t> positions(gateQubits.size());
+			size_t gateMask = 0;
+			for (size_t i = 0; i < gateQubits.size(); ++i)
+			{
+				positions[i] = std::find(block.qubits.begin(), block.qubits.end(), gateQubits[i]) - block.qubits.begin();
+				gateMask |= 1ULL << positions[i];
+			}
+
+			auto gateIndex = [&](size_t index)
+			{
+				size_t g = 0;
+				for (size_t i = 0; i < positions.size(); ++i)
+					g |= ((index >> positions[i]) & 1ULL) << i;
+				return g;
+			};
+
+			// the gate matrix extended to the block qubits: <r|G|c> is nonzero only if r and c have the same bits outside the gate qubits
+			Matrix result(dim * dim, 0.);
+			for (size_t r = 0; r < dim; ++r)
+			{
+				const size_t gr = gateIndex(r);
+				for (size_t c = 0; c < dim; ++c)
+				{
+					if ((r & ~gateMask) != (c & ~gateMask)) continue;
+
+					const std::complex<double> g = gateMatrix[gr * gateDim + gateIndex(c)];
+					if (g == 0.) continue;
+
+					for (size_t k = 0; k < dim; ++k)
+						result[r * dim + k] += g * block.matrix[c * dim + k];
+				}
+			}
+
+			block.matrix.swap(result);
+			++block.nrGates;
+			block.delay += gate->GetDelay();
+		}
+
+		/**
+		 * @brief Checks if a matrix is the identity, up to a global phase.
+		 *
+		 * @param m The matrix.
+		 * @param dim The dimension of the matrix.
+		 * @return True if the matrix is the identity up to a global phase, false otherwise.
+		 */
+		static bool IsIdentity(const Matrix& m, size_t dim)
+		{
+			constexpr double eps = 1e-12;
+
+			const std::complex<double> phase = m[0];
+			if (std::abs(std::abs(phase) - 1.) > eps) return false;
+
+			for (size_t r = 0; r < dim; ++r)
+				for (size_t c = 0; c < dim; ++c)
+					if (std::abs(m[r * dim + c] - (r == c ? phase : 0.)) > eps)
+						return false;
+
+			return true;
+		}
+
+		/**
+		 * @brief Emit the gate for a block.
+		 *
+		 * A block with a single gate is emitted as it is, a single qubit block as a U gate, the others as fused gates.
+		 * Blocks that amount to the identity are dropped.
+		 * @param block The block.
+		 * @param result The operations to add the gate to.
+		 */
+		static void Emit(const Block& block, std::vector<OperationPtr>& result)
+		{
+			if (block.nrGates == 1)
+			{
+				result.push_back(block.firstGate);
+				return;
+			}
+
+			const size_t dim = 1ULL << block.qubits.size();
+			if (IsIdentity(block.matrix, dim)) return;
+
+			if (block.qubits.size() == 1)
+				result.push_back(MakeUGate(block.qubits[0], block.matrix, block.delay));
+			else
+				result.push_back(std::make_shared<FusedGate<Time>>(block.qubits, block.matrix, block.delay));
+		}
+
+		/**
+		 * @brief Make a U gate from a single qubit unitary matrix.
+		 *
+		 * U(theta, phi, lambda, gamma) = e^(i gamma) [[cos(theta/2), -e^(i lambda) sin(theta/2)], [e^(i phi) sin(theta/2), e^(i (phi + lambda)) cos(theta/2)]]
+		 * @param qubit The qubit.
+		 * @param m The matrix, row major.
+		 * @param delay The gate delay.
+		 * @return The U gate.
+		 */
+		static OperationPtr MakeUGate(Types::qubit_t qubit, const Matrix& m, Time delay)
+		{
+			constexpr double eps = 1e-14;
+
+			const double c = std::abs(m[0]);
+			const double s = std::abs(m[2]);
+			const double theta = 2. * std::atan2(s, c);
+
+			double phi = 0.;
+			double lambda = 0.;
+			double gamma;
+
+			if (s < eps) // diagonal
+			{
+				gamma = std::arg(m[0]);
+				lambda = std::arg(m[3]) - gamma;
+			}
+			else if (c < eps) // anti-diagonal, only phi + lambda is determined together with gamma, pick lambda = 0
+			{
+				gamma = std::arg(-m[1]);
+				phi = std::arg(m[2]) - gamma;
+			}
+			else
+			{
+				gamma = std::arg(m[0]);
+				phi = std::arg(m[2]) - gamma;
+				lambda = std::arg(-m[1]) - gamma;
+			}
+
+			return std::make_shared<UGate<Time>>(qubit, theta, phi, lambda, gamma, delay);
+		}
+	};
+
+}
+
+#endif // _GATE_FUSION_H_
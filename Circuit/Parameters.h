@@ -0,0 +1,121 @@
+/**
+ * @file Parameters.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Binding circuit parameters to gate parameters.
+ *
+ * A parametrized circuit is a circuit together with a list of bindings, each one saying which gate parameter takes the value of which circuit parameter.
+ * The gates are found once, then binding a set of values to the circuit only changes the parameters of those gates.
+ */
+
+#pragma once
+
+#ifndef _CIRCUIT_PARAMETERS_H_
+#define _CIRCUIT_PARAMETERS_H_
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "Conditional.h"
+
+namespace Circuits {
+
+	/**
+	 * @struct ParameterBinding
+	 * @brief A gate parameter bound to a circuit parameter.
+	 */
+	struct ParameterBinding {
+		size_t operationIndex = 0; /**< The index of the operation in the circuit, a gate or a conditional gate */
+		size_t paramIndex = 0; /**< The position of the parameter in the gate parameters */
+		size_t parameter = 0; /**< The index of the circuit parameter */
+	};
+
+	/**
+	 * @class ParametersBinder
+	 * @brief Sets the gate parameters of a circuit from the values of the circuit parameters.
+	 *
+	 * The gates are found by the operation indices when constructed, so the circuit operations must be in the order the bindings refer to at that time.
+	 * The gates are then kept, the operations can be reordered afterwards (for example by moving the measurements).
+	 *
+	 * @tparam Time The time type used for operation timing.
+	 * @sa ParameterBinding
+	 */
+	template<typename Time = Types::time_type> class ParametersBinder {
+	public:
+		/**
+		 * @brief Construct the binder, finding the bound gates in the operations.
+		 *
+		 * @param ops The operations of the circuit.
+		 * @param bindings The bindings.
+		 * @throws std::invalid_argument If a binding refers to an operation that does not exist or is not a gate or a conditional gate.
+		 */
+		ParametersBinder(const std::vector<std::shared_ptr<IOperation<Time>>>& ops, const std::vector<ParameterBinding>& bindings)
+			: bindings(bindings)
+		{
+			gates.reserve(bindings.size());
+
+			for (size_t i = 0; i < bindings.size(); ++i)
+			{
+				const size_t opIndex = bindings[i].operationIndex;
+				if (opIndex >= ops.size() || !ops[opIndex])
+					throw std::invalid_argument("ParametersBinder: binding " + std::to_string(i) + " refers to operation " + std::to_string(opIndex) + ", which does not exist.");
+
+				auto op = ops[opIndex];
+				if (op->GetType() == OperationType::kConditionalGate)
+					op = std::static_pointer_cast<IConditionalOperation<Time>>(op)->GetOperation();
+
+				if (!op || op->GetType() != OperationType::kGate)
+					throw std::invalid_argument("ParametersBinder: binding " + std::to_string(i) + " refers to operation " + std::to_string(opIndex) + ", which is not a gate.");
+
+				gates.emplace_back(std::static_pointer_cast<IQuantumGate<Time>>(op));
+			}
+		}
+
+		/**
+		 * @brief Get the number of circuit parameters the bindings refer to.
+		 *
+		 * @param bindings The bindings.
+		 * @return The number of circuit parameters, one more than the largest index.
+		 */
+		static size_t GetNumParameters(const std::vector<ParameterBinding>& bindings)
+		{
+			size_t nrParams = 0;
+			for (const auto& binding : bindings)
+				nrParams = std::max(nrParams, binding.parameter + 1);
+
+			return nrParams;
+		}
+
+		/**
+		 * @brief Set the gate parameters from the values of the circuit parameters.
+		 *
+		 * @param values The values of the circuit parameters, at least GetNumParameters of them.
+		 */
+		void Bind(const double* values) const
+		{
+			for (size_t i = 0; i < bindings.size(); ++i)
+			{
+				const auto& gate = gates[i];
+
+				auto gateParams = gate->GetParams();
+				if (bindings[i].paramIndex < gateParams.size())
+				{
+					gateParams[bindings[i].paramIndex] = values[bindings[i].parameter];
+					gate->SetParams(gateParams);
+				}
+			}
+		}
+
+	private:
+		std::vector<ParameterBinding> bindings; /**< The bindings */
+		std::vector<std::shared_ptr<IQuantumGate<Time>>> gates; /**< The bound gates, one for each binding */
+	};
+
+}
+
+#endif // _CIRCUIT_PARAMETERS_H_
@@ -7,6 +7,7 @@
  * The quantum gates interfaces and implementations.
  * 
  * There are one qubit, two qubits and three qubits gates interfaces, along with implementations for specific gates.
+ * There is also a gate given by a dense matrix, the result of gate fusion.
  * The QuantumGateType enum is used to identify the type of gate.
  */
 
@@ -15,6 +16,8 @@
 #ifndef _QUANTUM_GATES_H_
 #define _QUANTUM_GATES_H_
 
+#include <complex>
+
 #include "Operations.h"
 
 namespace Circuits {
@@ -53,7 +56,8 @@ namespace Circuits {
 		kCSxDagGateType,
 		kCUGateType,
 		kCSwapGateType,
-		kCCXGateType
+		kCCXGateType,
+		kFusedGateType
 	};
 
 	/**
@@ -90,6 +94,15 @@ namespace Circuits {
 		 * @return A vector with the parameters of the gate, empty if there are no parameters.
 		 */
 		virtual std::vector<double> GetParams() const { return {}; }
+
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate, in the order returned by GetParams.
+		 * Missing values leave the corresponding parameters unchanged, the extra ones are ignored.
+		 * @param params The new parameters of the gate.
+		 */
+		virtual void SetParams(const std::vector<double>& params) {}
 	};
 
 	/**
@@ -503,6 +516,17 @@ namespace Circuits {
 		 */
 		std::vector<double> GetParams() const override { return { lambda }; }
 
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate.
+		 * @param params The new parameters of the gate.
+		 */
+		void SetParams(const std::vector<double>& params) override
+		{
+			if (!params.empty()) lambda = params[0];
+		}
+
 		/**
 		 * @brief Checks if the operation is a Clifford one.
 		 *
@@ -1320,6 +1344,17 @@ namespace Circuits {
 		 */
 		std::vector<double> GetParams() const override { return { theta }; }
 
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate.
+		 * @param params The new parameters of the gate.
+		 */
+		void SetParams(const std::vector<double>& params) override
+		{
+			if (!params.empty()) theta = params[0];
+		}
+
 	private:
 		double theta; /**< The theta angle for the rotation gate. */
 	};
@@ -1637,6 +1672,20 @@ namespace Circuits {
 		 */
 		std::vector<double> GetParams() const override { return { theta, phi, lambda, gamma }; }
 
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate.
+		 * @param params The new parameters of the gate.
+		 */
+		void SetParams(const std::vector<double>& params) override
+		{
+			if (params.size() > 0) theta = params[0];
+			if (params.size() > 1) phi = params[1];
+			if (params.size() > 2) lambda = params[2];
+			if (params.size() > 3) gamma = params[3];
+		}
+
 		/**
 		 * @brief Checks if the operation is a Clifford one.
 		 *
@@ -2031,6 +2080,17 @@ namespace Circuits {
 		 */
 		std::vector<double> GetParams() const override { return { lambda }; }
 
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate.
+		 * @param params The new parameters of the gate.
+		 */
+		void SetParams(const std::vector<double>& params) override
+		{
+			if (!params.empty()) lambda = params[0];
+		}
+
 	private:
 		double lambda; /**< The lambda parameter for the controlled phase gate. */
 	};
@@ -2083,6 +2143,17 @@ namespace Circuits {
 		 */
 		std::vector<double> GetParams() const override { return { theta }; }
 
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate.
+		 * @param params The new parameters of the gate.
+		 */
+		void SetParams(const std::vector<double>& params) override
+		{
+			if (!params.empty()) theta = params[0];
+		}
+
 	private:
 		double theta; /**< The theta angle for the controlled rotation gate. */
 	};
@@ -2578,6 +2649,20 @@ namespace Circuits {
 		 */
 		std::vector<double> GetParams() const override { return { theta, phi, lambda, gamma }; }
 
+		/**
+		 * @brief Set the gate parameters.
+		 *
+		 * Sets the parameters of the gate.
+		 * @param params The new parameters of the gate.
+		 */
+		void SetParams(const std::vector<double>& params) override
+		{
+			if (params.size() > 0) theta = params[0];
+			if (params.size() > 1) phi = params[1];
+			if (params.size() > 2) lambda = params[2];
+			if (params.size() > 3) gamma = params[3];
+		}
+
 	private:
 		double theta;  /**< The theta parameter for the controlled U gate. */
 		double phi;    /**< The phi parameter for the controlled U gate. */
@@ -2709,6 +2794,152 @@ namespace Circuits {
 			return std::make_shared<CSwapGate<Time>>(ThreeQubitsGate<Time>::GetQubit(0), ThreeQubitsGate<Time>::GetQubit(1), ThreeQubitsGate<Time>::GetQubit(2), IOperation<Time>::GetDelay());
 		}
 	};
+
+	//**********************************************************************************************
+	// Fused gates
+	//**********************************************************************************************
+
+	/**
+	 * @class FusedGate
+	 * @brief A gate given by a dense matrix.
+	 *
+	 * The result of fusing several gates acting on a few qubits into a single one.
+	 * The matrix is 2^n x 2^n, in row major order, with the first qubit corresponding to the least significant bit of the row and column indices.
+	 * Applied with ISimulator::ApplyMatrix, so only simulators supporting dense matrices can execute it.
+	 * @tparam Time The type of the execution delay.
+	 * @sa IQuantumGate
+	 * @sa GateFusion
+	 */
+	template<typename Time = Types::time_type> class FusedGate : public IQuantumGate<Time> {
+	public:
+		/**
+		 * @brief FusedGate constructor.
+		 *
+		 * Constructs the fused gate object. If specified, the delay is the time the quantum gate takes to execute.
+		 * @param qubits The qubits the quantum gate is applied to.
+		 * @param matrix The matrix of the gate, 2^n x 2^n in row major order, n being the number of qubits.
+		 * @param delay The time the quantum gate takes to execute.
+		 * @sa IQuantumGate
+		 */
+		FusedGate(const Types::qubits_vector& qubits = {}, const std::vector<std::complex<double>>& matrix = {}, Time delay = 0)
+			: IQuantumGate<Time>(delay), qubits(qubits), matrix(matrix) {}
+
+		/**
+		 * @brief Execute the quantum gate.
+		 *
+		 * Executes the quantum gate on the given simulator with the given classical state.
+		 * @param sim The simulator to execute the quantum gate on.
+		 * @param state The classical state to execute the quantum gate with.
+		 * @sa ISimulator
+		 * @sa ClassicalState
+		 */
+		void Execute(const std::shared_ptr<Simulators::ISimulator>& sim, OperationState& state) const override
+		{
+			sim->ApplyMatrix(qubits, matrix);
+		}
+
+		/**
+		 * @brief Get the type of the quantum gate.
+		 *
+		 * Returns the type of the quantum gate.
+		 * @return The type of the quantum gate.
+		 * @sa QuantumGateType
+		 */
+		QuantumGateType GetGateType() const override
+		{
+			return QuantumGateType::kFusedGateType;
+		}
+
+		/**
+		 * @brief Get the number of qubits the quantum gate is applied to.
+		 *
+		 * @return The number of qubits the quantum gate is applied to.
+		 */
+		unsigned int GetNumQubits() const override { return static_cast<unsigned int>(qubits.size()); }
+
+		/**
+		 * @brief Set the qubit the quantum gate is applied to.
+		 *
+		 * @param q The qubit the quantum gate is applied to.
+		 * @param index The index of the qubit to set.
+		 */
+		void SetQubit(Types::qubit_t q, unsigned long index = 0) override
+		{
+			if (index < qubits.size()) qubits[index] = q;
+		}
+
+		/**
+		 * @brief Get the qubit the quantum gate is applied to.
+		 *
+		 * If the index is out of range, it will return UINT_MAX.
+		 * @param index The index of the qubit to get.
+		 * @return The qubit the quantum gate is applied to.
+		 */
+		Types::qubit_t GetQubit(unsigned int index = 0) const override
+		{
+			if (index < qubits.size()) return qubits[index];
+
+			return UINT_MAX;
+		}
+
+		/**
+		 * @brief Get the qubits the quantum gate is applied to.
+		 *
+		 * @return The qubits the quantum gate is applied to.
+		 */
+		Types::qubits_vector AffectedQubits() const override
+		{
+			return qubits;
+		}
+
+		/**
+		 * @brief Get the matrix of the gate.
+		 *
+		 * @return The matrix, 2^n x 2^n in row major order.
+		 */
+		const std::vector<std::complex<double>>& GetMatrix() const
+		{
+			return matrix;
+		}
+
+		/**
+		 * @brief Get a shared pointer to a clone of this object.
+		 *
+		 * Returns a shared pointer to a copy of this object.
+		 * @return A shared pointer to this object.
+		 */
+		std::shared_ptr<IOperation<Time>> Clone() const override
+		{
+			return std::make_shared<FusedGate<Time>>(qubits, matrix, IOperation<Time>::GetDelay());
+		}
+
+		/**
+		 * @brief Get a shared pointer to a remapped operation.
+		 *
+		 * Returns a shared pointer to a copy of the operation with qubits and classical bits changed according to the provided maps.
+		 *
+		 * @param qubitsMap The map of qubits to remap.
+		 * @param bitsMap The map of classical bits to remap.
+		 * @return A shared pointer to the remapped object.
+		 */
+		std::shared_ptr<IOperation<Time>> Remap(const std::unordered_map<Types::qubit_t, Types::qubit_t>& qubitsMap, const std::unordered_map<Types::qubit_t, Types::qubit_t>& bitsMap = {}) const override
+		{
+			auto newGate = std::make_shared<FusedGate<Time>>(qubits, matrix, IOperation<Time>::GetDelay());
+
+			for (size_t i = 0; i < qubits.size(); ++i)
+			{
+				const auto qubitit = qubitsMap.find(qubits[i]);
+				if (qubitit != qubitsMap.end())
+					newGate->SetQubit(qubitit->second, i);
+			}
+
+			return newGate;
+		}
+
+	private:
+		Types::qubits_vector qubits; /**< The qubits the quantum gate is applied to. */
+		std::vector<std::complex<double>> matrix; /**< The matrix of the gate, row major. */
+	};
 }
 
 #endif // !_QUANTUM_GATES_H_
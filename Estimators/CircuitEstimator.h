@@ -0,0 +1,542 @@
+/**
+ * @file CircuitEstimator.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * An estimator of the execution time and memory of a circuit, for the simulation methods.
+ *
+ * The estimations are obtained from the complexity of the simulation algorithms, without executing the circuit.
+ * For the tensor network the contraction order is searched with a dry run, using only the shapes of the tensors.
+ */
+
+#pragma once
+
+#ifndef __CIRCUIT_ESTIMATOR_H_
+#define __CIRCUIT_ESTIMATOR_H_
+
+#include "EstimatorInterface.h"
+#include "../Circuit/Circuit.h"
+
+#include "../TensorNetworks/TensorNetwork.h"
+#include "../TensorNetworks/GreedyContractor.h"
+
+#include <cmath>
+#include <numeric>
+
+namespace Estimators {
+
+	/**
+	 * @class CircuitEstimator
+	 * @brief Estimates the execution time and memory of a circuit.
+	 *
+	 * The estimations are obtained from the complexity of the simulation algorithms:
+	 * - statevector: each gate touches all the amplitudes, for the composite simulator only the ones of the qubits group of the gate;
+	 * - matrix product state: a bond dimension growth model, the bonds crossed by a two qubits gate are doubled, up to the limits;
+	 * - stabilizer: each gate touches a tableau column, each measurement the whole tableau;
+	 * - tensor network: the predicted number of operations of the contraction, obtained with a dry run of the greedy contractor.
+	 *
+	 * The times are in seconds, but they are meant to be compared with each other, not to be precise.
+	 *
+	 * @tparam Time The time type used for operation timing.
+	 */
+	template<typename Time = Types::time_type> class CircuitEstimator : public EstimatorInterface {
+	public:
+		constexpr static double OperationsPerSecond = 1E9; /**< The number of complex multiply-adds per second for a thread, roughly */
+		constexpr static size_t MultithreadingQubits = 14; /**< Below this number of qubits the statevector is simulated on a single thread */
+
+		CircuitEstimator() = delete;
+
+		/**
+		 * @brief Constructor.
+		 *
+		 * @param circuit The circuit.
+		 * @param nrQubits The number of qubits.
+		 * @param shots The number of shots.
+		 * @param maxBondDim The maximum bond dimension for the matrix product state, 0 for no limit.
+		 * @param nrThreads The number of threads, used for the multithreaded simulators and for executing shots in parallel.
+		 */
+		CircuitEstimator(const std::shared_ptr<Circuits::Circuit<Time>>& circuit, size_t nrQubits, size_t shots, size_t maxBondDim = 0, size_t nrThreads = 1)
+			: nrQubits(std::max<size_t>(nrQubits, 1)), shots(std::max<size_t>(shots, 1)), maxBondDim(maxBondDim), nrThreads(std::max<size_t>(nrThreads, 1))
+		{
+			opsAfterMeasurements = circuit->HasOpsAfterMeasurements();
+
+			for (const auto& op : circuit->GetOperations())
+			{
+				const auto type = op->GetType();
+
+				if (type == Circuits::OperationType::kGate || type == Circuits::OperationType::kConditionalGate)
+				{
+					auto qubits = op->AffectedQubits();
+					if (!qubits.empty()) gates.emplace_back(std::move(qubits));
+				}
+				else if (type == Circuits::OperationType::kMeasurement || type == Circuits::OperationType::kConditionalMeasurement || type == Circuits::OperationType::kReset)
+				{
+					const auto qubits = op->AffectedQubits();
+					measurements += qubits.size();
+					measuredQubits.insert(qubits.begin(), qubits.end());
+				}
+			}
+		}
+
+		/**
+		 * @brief Estimate the time to execute the circuit for all the shots.
+		 *
+		 * @param type The simulator type.
+		 * @param method The simulation method.
+		 * @return The estimated time in seconds, infinity if the method is not supported.
+		 */
+		double EstimateTime(Simulators::SimulatorType type, Simulators::SimulationType method) const override
+		{
+			double operations = std::numeric_limits<double>::infinity();
+
+			switch (method)
+			{
+			case Simulators::SimulationType::kStatevector:
+				operations = IsComposite(type) ? CompositeStatevectorOperations(false) : StatevectorOperations(false);
+				break;
+			case Simulators::SimulationType::kMatrixProductState:
+				operations = MPSOperations(false);
+				break;
+			case Simulators::SimulationType::kStabilizer:
+				operations = StabilizerOperations(false);
+				break;
+			case Simulators::SimulationType::kTensorNetwork:
+				operations = TensorNetworkOperations(false);
+				break;
+			default:
+				break;
+			}
+
+			return operations * TypeFactor(type) / OperationsPerSecond;
+		}
+
+		/**
+		 * @brief Estimate the time to compute the expectation values of the Pauli strings.
+		 *
+		 * @param type The simulator type.
+		 * @param method The simulation method.
+		 * @param paulis The Pauli strings.
+		 * @return The estimated time in seconds, infinity if the method is not supported.
+		 */
+		double EstimateExpectationValuesTime(Simulators::SimulatorType type, Simulators::SimulationType method, const std::vector<std::string>& paulis) override
+		{
+			nrPaulis = paulis.size();
+
+			double operations = std::numeric_limits<double>::infinity();
+
+			switch (method)
+			{
+			case Simulators::SimulationType::kStatevector:
+				operations = IsComposite(type) ? CompositeStatevectorOperations(true) : StatevectorOperations(true);
+				break;
+			case Simulators::SimulationType::kMatrixProductState:
+				operations = MPSOperations(true);
+				break;
+			case Simulators::SimulationType::kStabilizer:
+				operations = StabilizerOperations(true);
+				break;
+			case Simulators::SimulationType::kTensorNetwork:
+				operations = TensorNetworkOperations(true);
+				break;
+			default:
+				break;
+			}
+
+			return operations * TypeFactor(type) / OperationsPerSecond;
+		}
+
+		/**
+		 * @brief Estimate the peak memory needed to execute the circuit.
+		 *
+		 * Includes the simulators for the shots executed in parallel, if the circuit has operations after measurements.
+		 *
+		 * @param type The simulator type.
+		 * @param method The simulation method.
+		 * @return The estimated memory in bytes, infinity if the method is not supported.
+		 */
+		double EstimateMemory(Simulators::SimulatorType type, Simulators::SimulationType method) const
+		{
+			double memory = std::numeric_limits<double>::infinity();
+
+			switch (method)
+			{
+			case Simulators::SimulationType::kStatevector:
+				memory = IsComposite(type) ? CompositeStatevectorMemory() : std::ldexp(AmplitudeSize, static_cast<int>(nrQubits));
+				break;
+			case Simulators::SimulationType::kMatrixProductState:
+				memory = MPSMemory();
+				break;
+			case Simulators::SimulationType::kStabilizer:
+				// the tableau, 2n rows with 2n + 1 bits
+				memory = 2. * nrQubits * (2. * nrQubits + 1) / 8.;
+				break;
+			case Simulators::SimulationType::kTensorNetwork:
+				memory = TensorNetworkMemory();
+				break;
+			default:
+				break;
+			}
+
+			return opsAfterMeasurements ? memory * ParallelShots() : memory;
+		}
+
+	private:
+		constexpr static double AmplitudeSize = 16.; /**< The size of a complex amplitude, in bytes */
+
+		static bool IsComposite(Simulators::SimulatorType type)
+		{
+#ifndef NO_QISKIT_AER
+			if (type == Simulators::SimulatorType::kCompositeQiskitAer) return true;
+#endif
+			return type == Simulators::SimulatorType::kCompositeQCSim;
+		}
+
+		/**
+		 * @brief A factor for the speed of the implementations of the simulators.
+		 *
+		 * @param type The simulator type.
+		 * @return The factor the number of operations is multiplied with, lower is faster.
+		 */
+		double TypeFactor(Simulators::SimulatorType type) const
+		{
+#ifdef __linux__
+			// the gpu has a lot more throughput, but the transfers make it worth only for large states
+			if (type == Simulators::SimulatorType::kGpuSim)
+				return nrQubits >= 20 ? 0.1 : 2.;
+#endif
+			return 1.;
+		}
+
+		size_t ParallelShots() const
+		{
+			return std::min(nrThreads, shots);
+		}
+
+		/**
+		 * @brief The number of repetitions of the circuit execution.
+		 *
+		 * If there are no operations after measurements, the circuit is executed once and the shots are sampled from the final state,
+		 * otherwise the shots are executed in parallel, each one executing the whole circuit.
+		 *
+		 * @param expectations True if computing expectation values, which need a single execution.
+		 * @return The number of sequential executions.
+		 */
+		double Repetitions(bool expectations) const
+		{
+			if (expectations || !opsAfterMeasurements) return 1.;
+
+			return std::ceil(static_cast<double>(shots) / ParallelShots());
+		}
+
+		double StatevectorThreads() const
+		{
+			// the shots executed in parallel take the threads
+			if (opsAfterMeasurements || nrQubits < MultithreadingQubits) return 1.;
+
+			return static_cast<double>(nrThreads);
+		}
+
+		double StatevectorOperations(bool expectations) const
+		{
+			const double amplitudes = std::ldexp(1., static_cast<int>(nrQubits));
+
+			double operations = 0;
+			for (const auto& qubits : gates)
+				operations += amplitudes * std::ldexp(1., static_cast<int>(qubits.size()));
+
+			// each measurement goes over the whole state
+			operations += amplitudes * measurements;
+			operations *= Repetitions(expectations);
+
+			if (expectations)
+				operations += 2. * amplitudes * nrPaulis;
+			else if (!opsAfterMeasurements)
+				operations += amplitudes + static_cast<double>(shots) * nrQubits; // the sampling
+
+			return operations / StatevectorThreads();
+		}
+
+		/**
+		 * @brief The number of operations for the composite statevector.
+		 *
+		 * The qubits start in separate groups, joined by the gates acting on several groups.
+		 * A gate touches only the amplitudes of its group.
+		 */
+		double CompositeStatevectorOperations(bool expectations) const
+		{
+			std::vector<size_t> parents(nrQubits);
+			std::vector<size_t> sizes(nrQubits, 1);
+			std::iota(parents.begin(), parents.end(), 0);
+
+			double operations = 0;
+			for (const auto& qubits : gates)
+			{
+				size_t root = Find(parents, qubits[0]);
+				for (size_t i = 1; i < qubits.size(); ++i)
+				{
+					const size_t other = Find(parents, qubits[i]);
+					if (other == root) continue;
+
+					// joining the groups needs a tensor product of the states
+					sizes[root] += sizes[other];
+					parents[other] = root;
+					operations += std::ldexp(1., static_cast<int>(sizes[root]));
+				}
+
+				operations += std::ldexp(1., static_cast<int>(sizes[root] + qubits.size()));
+			}
+
+			operations += measurements * std::ldexp(1., static_cast<int>(*std::max_element(sizes.begin(), sizes.end())));
+			operations *= Repetitions(expectations);
+
+			if (expectations)
+				operations += 2. * CompositeStatevectorMemory() / AmplitudeSize * nrPaulis;
+			else if (!opsAfterMeasurements)
+				operations += CompositeStatevectorMemory() / AmplitudeSize + static_cast<double>(shots) * nrQubits;
+
+			return operations;
+		}
+
+		double CompositeStatevectorMemory() const
+		{
+			std::vector<size_t> parents(nrQubits);
+			std::iota(parents.begin(), parents.end(), 0);
+
+			for (const auto& qubits : gates)
+				for (size_t i = 1; i < qubits.size(); ++i)
+					parents[Find(parents, qubits[i])] = Find(parents, qubits[0]);
+
+			std::vector<size_t> sizes(nrQubits, 0);
+			for (size_t q = 0; q < nrQubits; ++q)
+				++sizes[Find(parents, q)];
+
+			double memory = 0;
+			for (const auto size : sizes)
+				if (size) memory += std::ldexp(AmplitudeSize, static_cast<int>(size));
+
+			return memory;
+		}
+
+		static size_t Find(std::vector<size_t>& parents, size_t q)
+		{
+			while (parents[q] != q)
+			{
+				parents[q] = parents[parents[q]];
+				q = parents[q];
+			}
+
+			return q;
+		}
+
+		/**
+		 * @brief Simulate the growth of the bond dimensions of the matrix product state.
+		 *
+		 * A two qubits gate doubles the dimensions of the bonds between its qubits (the qubits that are not adjacent are swapped next to each other),
+		 * limited by the maximum bond dimension and by the dimension of the smaller side of the bond.
+		 *
+		 * @param operations Set to the number of operations for applying the gates.
+		 * @return The final bond dimensions.
+		 */
+		std::vector<double> MPSBondDimensions(double& operations) const
+		{
+			std::vector<double> bonds(nrQubits > 1 ? nrQubits - 1 : 0, 1.);
+
+			operations = 0;
+			for (const auto& qubits : gates)
+			{
+				const auto [minIt, maxIt] = std::minmax_element(qubits.begin(), qubits.end());
+				const size_t first = *minIt;
+				const size_t last = *maxIt;
+
+				if (first == last)
+				{
+					const double left = first > 0 ? bonds[first - 1] : 1.;
+					const double right = first < bonds.size() ? bonds[first] : 1.;
+					operations += 4. * left * right;
+					continue;
+				}
+
+				for (size_t b = first; b < last; ++b)
+				{
+					const int side = static_cast<int>(std::min(b + 1, nrQubits - b - 1));
+					double limit = std::ldexp(1., std::min(side, 512));
+					if (maxBondDim) limit = std::min(limit, static_cast<double>(maxBondDim));
+
+					bonds[b] = std::min(2. * bonds[b], limit);
+
+					// the singular value decomposition of the two sites, done twice for the swaps there and back
+					const double svd = 8. * bonds[b] * bonds[b] * bonds[b];
+					operations += last - first > 1 ? 2. * svd : svd;
+				}
+			}
+
+			return bonds;
+		}
+
+		double MPSOperations(bool expectations) const
+		{
+			double operations = 0;
+			const auto bonds = MPSBondDimensions(operations);
+
+			// a sample goes along the chain with a vector, a measurement or an expectation value contracts the matrices
+			double sample = 0;
+			double chain = 0;
+			for (size_t q = 0; q < nrQubits; ++q)
+			{
+				const double left = q > 0 ? bonds[q - 1] : 1.;
+				const double right = q < bonds.size() ? bonds[q] : 1.;
+				sample += 4. * left * right;
+				chain += 4. * left * right * std::max(left, right);
+			}
+
+			operations += measurements * chain;
+			operations *= Repetitions(expectations);
+
+			if (expectations)
+				operations += chain * nrPaulis;
+			else if (!opsAfterMeasurements)
+				operations += static_cast<double>(shots) * sample;
+
+			return operations;
+		}
+
+		double MPSMemory() const
+		{
+			double operations = 0;
+			const auto bonds = MPSBondDimensions(operations);
+
+			double memory = 0;
+			for (size_t q = 0; q < nrQubits; ++q)
+			{
+				const double left = q > 0 ? bonds[q - 1] : 1.;
+				const double right = q < bonds.size() ? bonds[q] : 1.;
+				memory += 2. * left * right * AmplitudeSize;
+			}
+
+			return memory;
+		}
+
+		double StabilizerOperations(bool expectations) const
+		{
+			const double n = static_cast<double>(nrQubits);
+
+			// a gate updates a column of the tableau, a measurement might need row operations on the whole tableau
+			double operations = gates.size() * 2. * n + measurements * 2. * n * n;
+			operations *= Repetitions(expectations);
+
+			if (expectations)
+				operations += 2. * n * n * nrPaulis;
+			else if (!opsAfterMeasurements)
+				operations += static_cast<double>(shots) * measuredQubits.size() * 2. * n * n;
+
+			// the tableau is made of bits, operated on in words
+			return operations / 64.;
+		}
+
+		/**
+		 * @brief Plan the contraction of the tensor network of the circuit.
+		 *
+		 * The network is built with the same topology as the circuit, the values of the gates do not matter for the plan.
+		 * The plan is for the largest qubits group, the one that dominates the cost.
+		 * The plan is computed once, when needed.
+		 */
+		void PlanTensorNetwork() const
+		{
+			if (tensorNetworkPlanned) return;
+			tensorNetworkPlanned = true;
+
+			TensorNetworks::TensorNetwork network(nrQubits);
+			const auto contractor = std::make_shared<TensorNetworks::GreedyContractor>();
+			contractor->SetCachePlans(false);
+			network.SetContractor(contractor);
+
+			std::vector<size_t> parents(nrQubits);
+			std::vector<size_t> sizes(nrQubits, 1);
+			std::iota(parents.begin(), parents.end(), 0);
+
+			for (const auto& qubits : gates)
+			{
+				if (qubits.size() == 1)
+					network.AddGate(oneQubitGate, qubits[0]);
+				else
+				{
+					// the gates on more than two qubits are decomposed in two qubits gates
+					for (size_t i = 0; i < qubits.size(); ++i)
+						for (size_t j = i + 1; j < qubits.size(); ++j)
+							network.AddGate(twoQubitsGate, qubits[i], qubits[j]);
+				}
+
+				for (size_t i = 1; i < qubits.size(); ++i)
+				{
+					const size_t root = Find(parents, qubits[0]);
+					const size_t other = Find(parents, qubits[i]);
+					if (root == other) continue;
+
+					parents[other] = root;
+					sizes[root] += sizes[other];
+				}
+			}
+
+			size_t qubit = 0;
+			for (size_t q = 0; q < nrQubits; ++q)
+				if (parents[q] == q && sizes[q] > sizes[Find(parents, qubit)])
+					qubit = q;
+
+			largestGroupSize = sizes[Find(parents, qubit)];
+
+			const auto plan = network.PlanProbability(static_cast<Types::qubit_t>(qubit));
+			if (plan)
+			{
+				contractionOperations = plan->GetFlops();
+				contractionMemory = plan->GetPeakMemory();
+			}
+		}
+
+		double TensorNetworkOperations(bool expectations) const
+		{
+			PlanTensorNetwork();
+
+			// an expectation value contracts a network like the one for a probability
+			if (expectations) return contractionOperations * nrPaulis;
+
+			const double measured = static_cast<double>(measuredQubits.empty() ? nrQubits : measuredQubits.size());
+
+			// a small group is sampled from its amplitudes, obtained with a single contraction, otherwise each qubit is measured for each shot
+			if (!opsAfterMeasurements && largestGroupSize <= TensorNetworks::TensorNetwork::MaxSingleLayerSamplingQubits)
+				return contractionOperations + std::ldexp(1., static_cast<int>(largestGroupSize)) + static_cast<double>(shots) * measured;
+
+			return Repetitions(false) * measured * contractionOperations;
+		}
+
+		double TensorNetworkMemory() const
+		{
+			PlanTensorNetwork();
+
+			return contractionMemory;
+		}
+
+		size_t nrQubits; /**< The number of qubits. */
+		size_t shots; /**< The number of shots. */
+		size_t maxBondDim; /**< The maximum bond dimension for the matrix product state, 0 for no limit. */
+		size_t nrThreads; /**< The number of threads. */
+		size_t nrPaulis = 0; /**< The number of Pauli strings, for the expectation values. */
+
+		bool opsAfterMeasurements = false; /**< True if the circuit has operations after measurements, so each shot executes the whole circuit. */
+		std::vector<Types::qubits_vector> gates; /**< The qubits of each gate. */
+		size_t measurements = 0; /**< The number of measured (or reset) qubits, counted for each measurement. */
+		std::unordered_set<Types::qubit_t> measuredQubits; /**< The measured qubits. */
+
+		// the plan of the tensor network is computed only when a tensor network estimation is needed
+		mutable bool tensorNetworkPlanned = false;
+		mutable double contractionOperations = std::numeric_limits<double>::infinity();
+		mutable double contractionMemory = std::numeric_limits<double>::infinity();
+		mutable size_t largestGroupSize = 0;
+
+		QC::Gates::HadamardGate<> oneQubitGate; /**< A gate used for the topology of the tensor network. */
+		QC::Gates::CNOTGate<> twoQubitsGate; /**< A gate used for the topology of the tensor network. */
+	};
+
+}
+
+#endif // !__CIRCUIT_ESTIMATOR_H_
@@ -0,0 +1,112 @@
+/**
+ * @file SimulatorsEstimator.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The built-in simulators estimator.
+ *
+ * Chooses the simulator with the lowest estimated execution time among the ones that fit in memory,
+ * using the circuit estimator, so no trial executions are needed.
+ */
+
+#pragma once
+
+#ifndef __SIMULATORS_ESTIMATOR_H_
+#define __SIMULATORS_ESTIMATOR_H_
+
+#include "SimulatorsEstimatorInterface.h"
+#include "CircuitEstimator.h"
+
+#include "../Simulators/Factory.h"
+
+namespace Estimators {
+
+	/**
+	 * @class SimulatorsEstimator
+	 * @brief The built-in simulators estimator.
+	 *
+	 * Estimates the time and memory needed by each of the simulators with a CircuitEstimator and chooses the fastest one that fits in memory.
+	 *
+	 * @tparam Time The time type used for operation timing.
+	 * @sa CircuitEstimator
+	 */
+	template<typename Time = Types::time_type> class SimulatorsEstimator : public SimulatorsEstimatorInterface<Time> {
+	public:
+		std::shared_ptr<Simulators::ISimulator> ChooseBestSimulator(const std::vector<std::pair<Simulators::SimulatorType, Simulators::SimulationType>>& simulatorTypes, const std::shared_ptr<Circuits::Circuit<Time>>& dcirc,
+			size_t& counts, size_t nrQubits, size_t nrCbits, size_t nrResultCbits,
+			Simulators::SimulatorType& simType, Simulators::SimulationType& method, std::vector<bool>& executed,
+			size_t maxBondDim, const std::string& singularValueThreshold, const std::string& mpsSample, const std::string& maxIntermediateSize,
+			size_t maxSimulators, const std::vector<std::string>* paulis,
+			bool multithreading = false, bool dontRunCircuitStart = false) const override
+		{
+			CircuitEstimator<Time> estimator(dcirc, nrQubits, counts, maxBondDim, maxSimulators);
+
+			bool found = false;
+			double bestTime = 0;
+
+			for (const auto& [type, kind] : simulatorTypes)
+			{
+				if (maxMemory && estimator.EstimateMemory(type, kind) > static_cast<double>(maxMemory))
+					continue;
+
+				const double time = paulis ? estimator.EstimateExpectationValuesTime(type, kind, *paulis) : estimator.EstimateTime(type, kind);
+				if (!std::isfinite(time)) continue;
+
+				if (!found || time < bestTime)
+				{
+					bestTime = time;
+					simType = type;
+					method = kind;
+					found = true;
+				}
+			}
+
+			if (!found) return nullptr;
+
+			std::shared_ptr<Simulators::ISimulator> sim = Simulators::SimulatorsFactory::CreateSimulator(simType, method);
+			if (!sim) return nullptr;
+
+			if (method == Simulators::SimulationType::kMatrixProductState)
+			{
+				if (maxBondDim) sim->Configure("matrix_product_state_max_bond_dimension", std::to_string(maxBondDim).c_str());
+				if (!singularValueThreshold.empty()) sim->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
+				if (!mpsSample.empty()) sim->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+			}
+			else if (method == Simulators::SimulationType::kTensorNetwork && !maxIntermediateSize.empty())
+				sim->Configure("tensor_network_max_intermediate_size", maxIntermediateSize.c_str());
+			sim->SetMultithreading(true);
+			if (!dontRunCircuitStart) SimulatorsEstimatorInterface<Time>::ExecuteUpToMeasurements(dcirc, nrQubits, nrCbits, nrResultCbits, sim, executed, multithreading);
+
+			return sim;
+		}
+
+		bool EstimatesTensorNetworks() const override
+		{
+			return true;
+		}
+
+		/**
+		 * @brief Set the memory available for the simulation.
+		 *
+		 * The simulators estimated to need more memory are not chosen.
+		 *
+		 * @param bytes The memory in bytes, 0 for no limit.
+		 */
+		void SetMaxMemory(size_t bytes = 0)
+		{
+			maxMemory = bytes;
+		}
+
+		size_t GetMaxMemory() const
+		{
+			return maxMemory;
+		}
+
+	private:
+		size_t maxMemory = 0; /**< The memory available for the simulation, in bytes, 0 for no limit. */
+	};
+
+}
+
+#endif // !__SIMULATORS_ESTIMATOR_H_
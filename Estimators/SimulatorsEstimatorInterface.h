@@ -33,10 +33,22 @@ namespace Estimators {
 		virtual std::shared_ptr<Simulators::ISimulator> ChooseBestSimulator(const std::vector<std::pair<Simulators::SimulatorType, Simulators::SimulationType>>& simulatorTypes, const std::shared_ptr<Circuits::Circuit<Time>>& dcirc, 
 			size_t& counts, size_t nrQubits, size_t nrCbits, size_t nrResultCbits, 
 			Simulators::SimulatorType& simType, Simulators::SimulationType& method, std::vector<bool>& executed, 
-			const std::string& maxBondDim, const std::string& singularValueThreshold, const std::string& mpsSample,
+			size_t maxBondDim, const std::string& singularValueThreshold, const std::string& mpsSample, const std::string& maxIntermediateSize,
 			size_t maxSimulators, const std::vector<std::string>* paulis,
 			bool multithreading = false, bool dontRunCircuitStart = false) const = 0;
 
+		/**
+		 * @brief Check if the estimator can estimate the tensor network simulation.
+		 *
+		 * If it can, the tensor network simulator is added to the simulators to choose from, otherwise only if it's the requested one.
+		 *
+		 * @return True if the tensor network simulation can be estimated, false otherwise.
+		 */
+		virtual bool EstimatesTensorNetworks() const
+		{
+			return false;
+		}
+
 
 		static void ExecuteUpToMeasurements(const std::shared_ptr<Circuits::Circuit<Time>>& dcirc, size_t nrQubits, size_t nrCbits, size_t nrResultCbits, const std::shared_ptr<Simulators::ISimulator>& sim, std::vector<bool>& executed, bool multithreading)
 		{
@@ -16,11 +16,14 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
 #include <boost/container_hash/hash.hpp>
 #include <unordered_set>
+#include <unordered_map>
 
 #include "../Simulators/Factory.h"
 #include "../Circuit/Circuit.h"
+#include "../Circuit/Parameters.h"
 #include "Controller.h"
 
 
@@ -39,6 +42,22 @@ namespace Network {
 		kNetqasmDESNetwork  /**< Fully connected network, hosts executing netqasm code with discrete events simulation */
 	};
 
+	/**
+	 * @struct PreparedHostCircuit
+	 * @brief A circuit mapped on a host, for executing it many times without mapping it again.
+	 *
+	 * @tparam Time The time type used for execution times.
+	 * @sa INetwork::PrepareCircuitOnHost
+	 * @sa INetwork::RepeatedExecutePrepared
+	 */
+	template<typename Time = Types::time_type> struct PreparedHostCircuit {
+		std::shared_ptr<Circuits::Circuit<Time>> circuit; /**< The circuit mapped on the host */
+		size_t hostId = 0; /**< The id of the host */
+		size_t nrQubits = 0; /**< The number of qubits used by the circuit */
+		size_t nrCbits = 0; /**< The number of classical bits used by the circuit */
+		std::unordered_map<Types::qubit_t, Types::qubit_t> reverseQubitsMap; /**< The map for converting back the results, empty if the circuit was not remapped */
+	};
+
 	/**
 	 * @class INetwork
 	 * @brief The network interface.
@@ -193,6 +212,84 @@ namespace Network {
 			return RepeatedExecuteOnHost(executeCircuit.circuit, hostId, executeCircuit.shots);
 		}
 
+		/**
+		 * @brief Prepare the circuit for repeated executions on the specified host.
+		 *
+		 * Does once the work RepeatedExecuteOnHost does with the circuit before executing it (optimizing and mapping it on the host),
+		 * so the circuit can then be executed many times with RepeatedExecutePrepared.
+		 * The operations of the prepared circuit are in the same order as the ones of the passed circuit if it's not optimized,
+		 * so the gates parameters can be changed in the prepared circuit between executions.
+		 * The default implementation does not map the circuit, it's mapped at each execution.
+		 *
+		 * @param circuit The circuit to prepare.
+		 * @param hostId The id of the host to execute the circuit on.
+		 * @param optimize If false, the circuit is not optimized even if the controller is set to optimize circuits.
+		 * @return The prepared circuit.
+		 * @sa RepeatedExecutePrepared
+		 */
+		virtual std::shared_ptr<PreparedHostCircuit<Time>> PrepareCircuitOnHost(const std::shared_ptr<Circuits::Circuit<Time>>& circuit, size_t hostId, bool optimize = true)
+		{
+			auto prepared = std::make_shared<PreparedHostCircuit<Time>>();
+			prepared->circuit = circuit;
+			prepared->hostId = hostId;
+
+			return prepared;
+		}
+
+		/**
+		 * @brief Execute a prepared circuit, repeatedly.
+		 *
+		 * Execute the circuit prepared with PrepareCircuitOnHost, repeating the execution 'shots' times.
+		 * The prepared circuit might be changed by the execution (for example the measurements could be moved), but it remains equivalent.
+		 *
+		 * @param prepared The prepared circuit.
+		 * @param shots The number of times to repeat the execution.
+		 * @return A map with the results of the execution, where the key is the state as a vector of bools and the value is the number of times it was measured.
+		 * @sa PrepareCircuitOnHost
+		 */
+		virtual ExecuteResults RepeatedExecutePrepared(const PreparedHostCircuit<Time>& prepared, size_t shots = 1000)
+		{
+			return RepeatedExecuteOnHost(prepared.circuit, prepared.hostId, shots);
+		}
+
+		/**
+		 * @brief Execute a parametrized circuit on the specified host, for each of the parameters points.
+		 *
+		 * The gates parameters given by the bindings are set from the values of each point, then the circuit is executed 'shots' times.
+		 * The passed circuit is not changed.
+		 * The default implementation executes the points one after another.
+		 *
+		 * @param circuit The parametrized circuit.
+		 * @param bindings The gates parameters bound to the circuit parameters, the operation indices refer to the passed circuit.
+		 * @param points The values of the circuit parameters, one vector for each point.
+		 * @param hostId The id of the host to execute the circuit on.
+		 * @param shots The number of times to repeat the execution for each point.
+		 * @return The results of the execution for each point, in the order of the points, empty if a point has too few values.
+		 * @sa Circuits::ParameterBinding
+		 */
+		virtual std::vector<ExecuteResults> RepeatedExecuteSweepOnHost(const std::shared_ptr<Circuits::Circuit<Time>>& circuit, const std::vector<Circuits::ParameterBinding>& bindings,
+			const std::vector<std::vector<double>>& points, size_t hostId, size_t shots = 1000)
+		{
+			if (!circuit) return {};
+
+			const size_t nrParams = Circuits::ParametersBinder<Time>::GetNumParameters(bindings);
+			for (const auto& point : points)
+				if (point.size() < nrParams) return {};
+
+			std::vector<ExecuteResults> results;
+			results.reserve(points.size());
+
+			for (const auto& point : points)
+			{
+				const auto pointCircuit = std::static_pointer_cast<Circuits::Circuit<Time>>(circuit->Clone());
+				Circuits::ParametersBinder<Time>(pointCircuit->GetOperations(), bindings).Bind(point.data());
+
+				results.emplace_back(RepeatedExecuteOnHost(pointCircuit, hostId, shots));
+			}
+
+			return results;
+		}
+
 
 		/**
 		 * @brief Schedule and execute circuits on the network.
@@ -674,6 +771,18 @@ namespace Network {
 		 */
 		virtual bool GetOptimizeSimulator() const = 0;
 
+		/**
+		 * @brief Set the flag for cancelling the executions.
+		 *
+		 * Once the flag is set, the shots not started yet are dropped and the execution returns early, with partial results.
+		 * The default implementation ignores it.
+		 *
+		 * @param flag The cancellation flag, nullptr if the executions cannot be cancelled.
+		 */
+		virtual void SetCancellationFlag(const std::shared_ptr<const std::atomic<bool>>& flag)
+		{
+		}
+
 
 		/**
 		 * @brief Get the last used simulator type.
@@ -12,26 +12,147 @@
 #ifndef  _NETWORK_JOB_H
 #define _NETWORK_JOB_H
 
+#include <atomic>
+
 #include "../Utils/ThreadsPool.h"
+#include "../Utils/WorkStealingThreadsPool.h"
+#include "../Utils/ShotsDispenser.h"
+#include "../Simulators/PauliFrameSimulator.h"
+#include "../Circuit/Parameters.h"
 #include "../Types.h"
 
 namespace Network {
 
+	/**
+	 * @class ParameterSweep
+	 * @brief The parameters points of a sweep, shared by the jobs executing it.
+	 *
+	 * The jobs take the points one by one until there are none left, each point's results are stored by the job that executed it.
+	 *
+	 * @tparam Time The time type used for operation timing.
+	 */
+	template<typename Time = Types::time_type> class ParameterSweep
+	{
+	public:
+		using PackedExecuteResults = typename Circuits::Circuit<Time>::PackedExecuteResults;
+
+		explicit ParameterSweep(const std::vector<std::vector<double>>& p)
+			: points(p), results(p.size())
+		{
+		}
+
+		size_t GetNumPoints() const
+		{
+			return points.size();
+		}
+
+		const std::vector<double>& GetPoint(size_t index) const
+		{
+			return points[index];
+		}
+
+		/**
+		 * @brief Take the next point to execute.
+		 *
+		 * @return The index of the point, GetNumPoints() or more if there are no points left.
+		 */
+		size_t TakePoint()
+		{
+			return nextPoint.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Take all the points not taken yet, without executing them.
+		 *
+		 * @return The number of points taken.
+		 */
+		size_t TakeRemaining()
+		{
+			const size_t taken = nextPoint.exchange(points.size(), std::memory_order_relaxed);
+
+			return taken < points.size() ? points.size() - taken : 0;
+		}
+
+		std::vector<PackedExecuteResults> results; // the results for each point, each one written only by the job that took the point
+
+	private:
+		const std::vector<std::vector<double>>& points; // owned by the caller, which waits for the jobs to finish
+		std::atomic<size_t> nextPoint{ 0 };
+	};
+
 	template<typename Time = Types::time_type> class ExecuteJob
 	{
 	public:
 		using ExecuteResults = typename Circuits::Circuit<Time>::ExecuteResults;
+		using PackedExecuteResults = typename Circuits::Circuit<Time>::PackedExecuteResults;
 
 		ExecuteJob() = delete;
 
-		explicit ExecuteJob(const std::shared_ptr<Circuits::Circuit<Time>>& c, ExecuteResults& r, size_t cnt, size_t nq, size_t nc, size_t ncr, Simulators::SimulatorType t, Simulators::SimulationType m, std::mutex& mut)
-			: dcirc(c), res(r), curCnt(cnt), nrQubits(nq), nrCbits(nc), nrResultCbits(ncr), simType(t), method(m), resultsMutex(mut)
+		explicit ExecuteJob(const std::shared_ptr<Circuits::Circuit<Time>>& c, size_t cnt, size_t nq, size_t nc, size_t ncr, Simulators::SimulatorType t, Simulators::SimulationType m)
+			: dcirc(c), curCnt(cnt), nrQubits(nq), nrCbits(nc), nrResultCbits(ncr), simType(t), method(m)
+		{
+		}
+
+		/**
+		 * @brief Construct a job that takes its shots from a dispenser shared with other jobs.
+		 *
+		 * The job executes batches of shots taken from the dispenser until there are no shots left, reusing the same simulator.
+		 */
+		explicit ExecuteJob(const std::shared_ptr<Circuits::Circuit<Time>>& c, const std::shared_ptr<Utils::ShotsDispenser>& d, size_t nq, size_t nc, size_t ncr, Simulators::SimulatorType t, Simulators::SimulationType m)
+			: dcirc(c), curCnt(0), nrQubits(nq), nrCbits(nc), nrResultCbits(ncr), simType(t), method(m), shotsDispenser(d)
 		{
 		}
 
+		/**
+		 * @brief Construct a job that executes the points of a parameter sweep, 'cnt' shots for each point.
+		 *
+		 * The job takes points from the sweep until there are none left, reusing the same simulator, reset before each point.
+		 * The binder must set the parameters of the gates in the job's circuit, which must not be shared with other jobs.
+		 */
+		explicit ExecuteJob(const std::shared_ptr<Circuits::Circuit<Time>>& c, const std::shared_ptr<ParameterSweep<Time>>& s, const std::shared_ptr<Circuits::ParametersBinder<Time>>& b, size_t cnt, size_t nq, size_t nc, size_t ncr, Simulators::SimulatorType t, Simulators::SimulationType m)
+			: dcirc(c), curCnt(cnt), nrQubits(nq), nrCbits(nc), nrResultCbits(ncr), simType(t), method(m), sweep(s), binder(b)
+		{
+		}
+
+		/**
+		 * @brief Execute the job on a threads pool thread.
+		 *
+		 * The other threads are busy with other jobs, so the simulator is not set to multithreading.
+		 */
 		void DoWork()
 		{
-			if (curCnt == 0) return;
+			DoWorkNoLock(false);
+		}
+
+		/**
+		 * @brief Execute the job.
+		 *
+		 * The shots are taken from the dispenser if there is one, otherwise all the job's shots are executed.
+		 * @param multithreading True if executing on the caller thread, the simulator being allowed to use all the threads.
+		 */
+		void DoWorkNoLock(bool multithreading = true)
+		{
+			if (sweep)
+			{
+				DoSweep(multithreading);
+				return;
+			}
+
+			if (curCnt == 0 && !shotsDispenser) return;
+
+			if (method == Simulators::SimulationType::kPauliFrame)
+			{
+				if (!PreparePauliFrames())
+				{
+					if (shotsDispenser) doneCnt += shotsDispenser->TakeAll();
+					return;
+				}
+
+				while (const size_t batchCnt = TakeShots(nullptr))
+					ExecutePauliFrames(batchCnt);
+
+				return;
+			}
 
 			Circuits::OperationState state;
 			state.AllocateBits(nrCbits);
@@ -41,15 +162,35 @@ namespace Network {
 			const bool specialOptimizationForStatevector = optimiseMultipleShots && method == Simulators::SimulationType::kStatevector && hasMeasurementsOnlyAtEnd;
 			const bool specialOptimizationForMPS = optimiseMultipleShots && method == Simulators::SimulationType::kMatrixProductState && hasMeasurementsOnlyAtEnd;
 
-			if (!optSim)
+			// a passed simulator has the start of the circuit already executed, unless it does not have the needed qubits
+			bool executeStart = false;
+			if (optSim)
+			{
+				if (multithreading) optSim->SetMultithreading(true);
+
+				if (optSim->GetNumberOfQubits() != nrQubits)
+				{
+					optSim->Clear();
+					executeStart = true;
+				}
+			}
+			else
 			{
 				optSim = Simulators::SimulatorsFactory::CreateSimulator(simType, method);
 				if (!optSim)
+				{
+					// drop the shots, otherwise the caller would wait for them forever
+					if (shotsDispenser) doneCnt += shotsDispenser->TakeAll();
 					return;
+				}
+
+				if (multithreading) optSim->SetMultithreading(true);
+				executeStart = true;
+			}
 
-				if (!maxBondDim.empty()) optSim->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
-				if (!singularValueThreshold.empty()) optSim->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
-				if (!mpsSample.empty()) optSim->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+			if (executeStart)
+			{
+				ConfigureSimulator(optSim);
 
 				optSim->AllocateQubits(nrQubits);
 				optSim->Initialize();
@@ -63,218 +204,246 @@ namespace Network {
 				}
 			}
 
-
 			std::shared_ptr<Circuits::MeasurementOperation<Time>> measurementsOp;
 
 			const std::vector<bool> executed = std::move(executedGates);
 
 			if (optimiseMultipleShots && hasMeasurementsOnlyAtEnd)
 			{
+#ifdef NO_QISKIT_AER
+				measurementsOp = dcirc->GetLastMeasurements(executed, false);
+#else
 				measurementsOp = dcirc->GetLastMeasurements(executed, optSim->GetType() == Simulators::SimulatorType::kQiskitAer);
+#endif
 
 				const auto& qbits = measurementsOp->GetQubits();
 				if (qbits.empty())
 				{
-					auto bits = state.GetAllBits();
-					bits.resize(nrResultCbits, false);
+					size_t cnt = 0;
+					while (const size_t batchCnt = TakeShots(nullptr))
+						cnt += batchCnt;
 
-					const std::lock_guard lock(resultsMutex);
-					res[bits] += curCnt;
+					res[Utils::PackedBits(state.GetAllBits(), nrResultCbits)] += cnt;
 
 					return;
 				}
 			}
 
-			ExecuteResults localRes;
-
 			if (optimiseMultipleShots && (specialOptimizationForStatevector || hasMeasurementsOnlyAtEnd))
 			{
 				const auto& qbits = measurementsOp->GetQubits();
 
-				const auto sampleres = optSim->SampleCounts(qbits, curCnt);
-
-				for (const auto& [mstate, cnt] : sampleres)
+				// the sampling cost does not vary much from shot to shot, so take the shots in large batches
+				while (const size_t batchCnt = TakeShots(nullptr))
 				{
-					measurementsOp->SetStateFromSample(mstate, state);
+					const auto sampleres = optSim->SampleCounts(qbits, batchCnt);
 
-					auto bits = state.GetAllBits();
-					bits.resize(nrResultCbits, false);
+					for (const auto& [mstate, cnt] : sampleres)
+					{
+						measurementsOp->SetStateFromSample(mstate, state);
 
-					localRes[bits] += cnt;
+						res[Utils::PackedBits(state.GetAllBits(), nrResultCbits)] += cnt;
 
-					state.Reset();
+						state.Reset();
+					}
 				}
 
-				const std::lock_guard lock(resultsMutex);
-				for (const auto& r : localRes)
-					res[r.first] += r.second;
-
 				return;
 			}
 
-			const auto curCnt1 = curCnt > 0 ? curCnt - 1 : 0;
-			for (size_t i = 0; i < curCnt; ++i)
+			// the operations executed at each shot are compiled once, the state is reset after each shot so the compiled form does not need to do it
+			const auto shotCircuit = optimiseMultipleShots ? dcirc->CompileMeasurements(executed) : dcirc->Compile();
+
+			Utils::ShotsBatchTuner tuner;
+			bool resetNeeded = false;
+			while (const size_t batchCnt = TakeShots(&tuner))
 			{
-				if (optimiseMultipleShots)
-				{
-					optSim->RestoreState();
-					dcirc->ExecuteMeasurements(optSim, state, executed);
-				}
-				else
+				const auto start = Utils::ShotsBatchTuner::Clock::now();
+
+				// the shots of a batch that are not executed because of a cancellation are counted as done, as the ones not taken
+				for (size_t i = 0; i < batchCnt && !IsCancelled(); ++i)
 				{
-					dcirc->Execute(optSim, state);
-					if (i < curCnt1) optSim->Reset();
-				}
+					if (optimiseMultipleShots)
+					{
+						optSim->RestoreState();
+						shotCircuit.Execute(optSim, state);
+					}
+					else
+					{
+						// reset before each shot except the first one, leaving the simulator state from the last shot
+						if (resetNeeded) optSim->Reset();
+						shotCircuit.Execute(optSim, state);
+						resetNeeded = true;
+					}
 
-				auto bits = state.GetAllBits();
-				bits.resize(nrResultCbits, false);
+					++res[Utils::PackedBits(state.GetAllBits(), nrResultCbits)];
 
-				++localRes[bits];
+					state.Reset();
+				}
 
-				state.Reset();
+				tuner.Update(batchCnt, start);
 			}
+		}
 
-			const std::lock_guard lock(resultsMutex);
-			for (const auto& r : localRes)
-				res[r.first] += r.second;
+		/**
+		 * @brief Configure a simulator created by the job.
+		 *
+		 * @param sim The simulator, not yet initialized.
+		 */
+		void ConfigureSimulator(const std::shared_ptr<Simulators::ISimulator>& sim) const
+		{
+			if (!maxBondDim.empty()) sim->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
+			if (!singularValueThreshold.empty()) sim->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
+			if (!mpsSample.empty()) sim->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+			if (!maxIntermediateSize.empty()) sim->Configure("tensor_network_max_intermediate_size", maxIntermediateSize.c_str());
 		}
 
-		void DoWorkNoLock()
+		static bool IsOptimisableForMultipleShots(Simulators::SimulatorType t, size_t curCnt)
 		{
-			if (curCnt == 0) return;
+			return curCnt > 1;
+		}
 
-			Circuits::OperationState state;
-			state.AllocateBits(nrCbits);
+		bool IsCancelled() const
+		{
+			return cancelled && cancelled->load(std::memory_order_relaxed);
+		}
 
-			const bool hasMeasurementsOnlyAtEnd = !dcirc->HasOpsAfterMeasurements();
-			const bool optimiseMultipleShots = optimiseMultipleShotsExecution;
-			const bool specialOptimizationForStatevector = optimiseMultipleShots && method == Simulators::SimulationType::kStatevector && hasMeasurementsOnlyAtEnd;
-			const bool specialOptimizationForMPS = optimiseMultipleShots && method == Simulators::SimulationType::kMatrixProductState && hasMeasurementsOnlyAtEnd;
+		size_t GetJobCount() const
+		{
+			// for a sweep, the number of points executed
+			return (shotsDispenser || sweep) ? doneCnt : curCnt;
+		}
 
-			if (optSim)
+		/**
+		 * @brief Execute the points of the parameter sweep.
+		 *
+		 * For each point taken, the parameters are bound, the circuit is fused if needed (the fused gates depend on the parameters)
+		 * and the shots are executed as a regular job would, on the simulator kept from the previous point.
+		 * @param multithreading True if executing on the caller thread, with a multithreaded simulator.
+		 */
+		void DoSweep(bool multithreading)
+		{
+			for (size_t point = sweep->TakePoint(); point < sweep->GetNumPoints(); point = sweep->TakePoint())
 			{
-				optSim->SetMultithreading(true);
-
-				if (optSim->GetNumberOfQubits() != nrQubits)
+				if (IsCancelled())
 				{
-					optSim->Clear();
+					// this point and the ones not taken yet are counted as done, with no results
+					doneCnt += sweep->TakeRemaining() + 1;
+					break;
+				}
 
-					if (!maxBondDim.empty()) optSim->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
-					if (!singularValueThreshold.empty()) optSim->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
-					if (!mpsSample.empty()) optSim->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+				binder->Bind(sweep->GetPoint(point).data());
 
-					optSim->AllocateQubits(nrQubits);
-					optSim->Initialize();
-				
-					if (optimiseMultipleShots)
-					{
-						executedGates = dcirc->ExecuteNonMeasurements(optSim, state);
-
-						if (!specialOptimizationForStatevector && !specialOptimizationForMPS)
-							optSim->SaveState();
-					}
+				auto circ = dcirc;
+				if (fusionMaxQubits)
+				{
+					circ = std::make_shared<Circuits::Circuit<Time>>(dcirc->GetOperations());
+					circ->Fuse(fusionMaxQubits);
 				}
-			}
-			else
-			{
-				optSim = Simulators::SimulatorsFactory::CreateSimulator(simType, method);
-				if (!optSim)
-					return;
 
-				optSim->SetMultithreading(true);
+				ExecuteJob<Time> pointJob(circ, curCnt, nrQubits, nrCbits, nrResultCbits, simType, method);
+				pointJob.optimiseMultipleShotsExecution = optimiseMultipleShotsExecution;
 
-				if (!maxBondDim.empty()) optSim->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
-				if (!singularValueThreshold.empty()) optSim->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
-				if (!mpsSample.empty()) optSim->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+				pointJob.maxBondDim = maxBondDim;
+				pointJob.mpsSample = mpsSample;
+				pointJob.maxIntermediateSize = maxIntermediateSize;
+				pointJob.singularValueThreshold = singularValueThreshold;
+				pointJob.cancelled = cancelled;
 
-				optSim->AllocateQubits(nrQubits);
-				optSim->Initialize();
-
-				if (optimiseMultipleShots)
+				if (optSim)
 				{
-					executedGates = dcirc->ExecuteNonMeasurements(optSim, state);
+					// the job expects the circuit start to be already executed on a passed simulator
+					optSim->Reset();
 
-					if (!specialOptimizationForStatevector && !specialOptimizationForMPS)
-						optSim->SaveState();
-				}
-			}
+					if (optimiseMultipleShotsExecution)
+					{
+						Circuits::OperationState state;
+						state.AllocateBits(nrCbits);
 
-			std::shared_ptr<Circuits::MeasurementOperation<Time>> measurementsOp;
+						pointJob.executedGates = circ->ExecuteNonMeasurements(optSim, state);
 
-			const std::vector<bool> executed = std::move(executedGates);
+						const bool sampled = (method == Simulators::SimulationType::kStatevector || method == Simulators::SimulationType::kMatrixProductState) && !circ->HasOpsAfterMeasurements();
+						if (!sampled)
+							optSim->SaveState();
+					}
 
-			if (optimiseMultipleShots && hasMeasurementsOnlyAtEnd)
-			{
-				measurementsOp = dcirc->GetLastMeasurements(executed, optSim->GetType() == Simulators::SimulatorType::kQiskitAer);
+					pointJob.optSim = optSim;
+				}
 
-				const auto& qbits = measurementsOp->GetQubits();
-				if (qbits.empty())
-				{
-					auto bits = state.GetAllBits();
-					bits.resize(nrResultCbits, false);
+				pointJob.DoWorkNoLock(multithreading);
 
-					res[bits] += curCnt;
+				optSim = pointJob.optSim;
+				sweep->results[point] = std::move(pointJob.res);
 
-					return;
-				}
+				++doneCnt;
 			}
+		}
 
-			if (optimiseMultipleShots && (specialOptimizationForStatevector || hasMeasurementsOnlyAtEnd))
+		/**
+		 * @brief Take the next batch of shots to execute.
+		 *
+		 * Without a dispenser, all the job's shots are returned at the first call.
+		 * @param tuner The batch size tuner, nullptr if the shots have about the same cost and can be taken in large batches.
+		 * @return The number of shots to execute, zero if there is nothing left.
+		 */
+		size_t TakeShots(const Utils::ShotsBatchTuner* tuner)
+		{
+			if (IsCancelled())
 			{
-				const auto& qbits = measurementsOp->GetQubits();
+				// the dropped shots are counted as done, otherwise the caller would wait for them forever
+				doneCnt += shotsDispenser ? shotsDispenser->TakeAll() : curCnt - doneCnt;
 
-				const auto sampleres = optSim->SampleCounts(qbits, curCnt);
-
-				for (const auto& [mstate, cnt] : sampleres)
-				{
-					measurementsOp->SetStateFromSample(mstate, state);
+				return 0;
+			}
 
-					auto bits = state.GetAllBits();
-					bits.resize(nrResultCbits, false);
+			size_t cnt;
+			if (shotsDispenser)
+				cnt = tuner ? shotsDispenser->Take(tuner->GetBatchSize()) : shotsDispenser->TakeShare();
+			else
+				cnt = curCnt - doneCnt;
 
-					res[bits] += cnt;
+			doneCnt += cnt;
 
-					state.Reset();
-				}
+			return cnt;
+		}
 
-				return;
-			}
+		/**
+		 * @brief Prepare the Pauli frames execution.
+		 *
+		 * The reference execution is done once, on a stabilizer simulator created for it, the shots are then executed as Pauli frames.
+		 * @return False if the simulator for the reference execution could not be created.
+		 */
+		bool PreparePauliFrames()
+		{
+			if (pauliFrames) return true;
 
-			const auto curCnt1 = curCnt > 0 ? curCnt - 1 : 0;
-			for (size_t i = 0; i < curCnt; ++i)
+			if (!optSim || optSim->GetSimulationType() != Simulators::SimulationType::kStabilizer || optSim->GetNumberOfQubits() != nrQubits)
 			{
-				if (optimiseMultipleShots)
-				{
-					optSim->RestoreState();
-					dcirc->ExecuteMeasurements(optSim, state, executed);
-				}
-				else
-				{
-					dcirc->Execute(optSim, state);
-					if (i < curCnt1) optSim->Reset(); // leave the simulator state for the last iteration
-				}
-
-				auto bits = state.GetAllBits();
-				bits.resize(nrResultCbits, false);
+				optSim = Simulators::SimulatorsFactory::CreateSimulator(simType, Simulators::SimulationType::kStabilizer);
+				if (!optSim) return false;
 
-				++res[bits];
-
-				state.Reset();
+				optSim->AllocateQubits(nrQubits);
+				optSim->Initialize();
 			}
-		}
+			else
+				optSim->Reset();
 
-		static bool IsOptimisableForMultipleShots(Simulators::SimulatorType t, size_t curCnt)
-		{
-			return curCnt > 1;
+			pauliFrames = std::make_unique<Simulators::PauliFrameSimulator<Time>>(dcirc, nrQubits, nrCbits);
+			pauliFrames->ExecuteReference(optSim);
+
+			return true;
 		}
 
-		size_t GetJobCount() const
+		void ExecutePauliFrames(size_t shots)
 		{
-			return curCnt;
+			pauliFrames->ExecuteShots(shots, [this](const std::vector<bool>& bits)
+				{
+					++res[Utils::PackedBits(bits, nrResultCbits)];
+				});
 		}
 
 		const std::shared_ptr<Circuits::Circuit<Time>> dcirc;
-		ExecuteResults& res;
+		PackedExecuteResults res; // the results of this job, merged by the caller after the job is finished, no locking needed
 		const size_t curCnt;
 		const size_t nrQubits;
 		const size_t nrCbits;
@@ -282,18 +451,39 @@ namespace Network {
 
 		const Simulators::SimulatorType simType;
 		const Simulators::SimulationType method;
-		std::mutex& resultsMutex;
 
 		bool optimiseMultipleShotsExecution = true;
 		std::shared_ptr<Simulators::ISimulator> optSim;
 		std::vector<bool> executedGates;
+		std::unique_ptr<Simulators::PauliFrameSimulator<Time>> pauliFrames; // for the Pauli frames method, holds the reference execution
+
+		// if set, the shots are taken in batches from it instead of executing curCnt shots
+		const std::shared_ptr<Utils::ShotsDispenser> shotsDispenser;
+		size_t doneCnt = 0;
+
+		// if set, the job executes the points of the sweep instead, curCnt shots for each
+		const std::shared_ptr<ParameterSweep<Time>> sweep;
+		const std::shared_ptr<Circuits::ParametersBinder<Time>> binder;
+		size_t fusionMaxQubits = 0; // if not zero, the circuit is fused for each point, since the fused gates depend on the parameters
+
+		// if set, the shots (or the sweep points) not started yet are dropped
+		std::shared_ptr<const std::atomic<bool>> cancelled;
 
 		// only fill them if passing null simulator
 		std::string maxBondDim;
 		std::string singularValueThreshold;
 		std::string mpsSample;
+		std::string maxIntermediateSize;
 	};
 
+	// the pool used for executing the shots jobs
+	// define USE_SINGLE_QUEUE_THREADS_POOL to go back to the pool with a single mutex protected queue
+#ifdef USE_SINGLE_QUEUE_THREADS_POOL
+	template<typename Time = Types::time_type> using ExecuteJobsPool = Utils::ThreadsPool<ExecuteJob<Time>>;
+#else
+	template<typename Time = Types::time_type> using ExecuteJobsPool = Utils::WorkStealingThreadsPool<ExecuteJob<Time>>;
+#endif
+
 }
 
 #endif // ! _NETWORK_JOB_H
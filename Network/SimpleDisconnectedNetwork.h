@@ -14,6 +14,9 @@
 #ifndef _SIMPLE_NETWORK_H_
 #define _SIMPLE_NETWORK_H_
 
+#include <cerrno>
+#include <cstdlib>
+
 #include "SimpleHost.h"
 #include "SimpleController.h"
 #include "QubitRegister.h"
@@ -124,7 +127,7 @@ namespace Network {
 			}
 
 			if (recreate && (!simulator || (simulator && (simType != simulator->GetType() || method != simulator->GetSimulationType() || simulator->GetNumberOfQubits() != numQubits))))
-				CreateSimulator(simType, method);
+				RecreateSimulator(simType, method);
 		}
 
 
@@ -168,7 +171,7 @@ namespace Network {
 			}
 
 			if (recreate && (!simulator || (simulator && (simType != simulator->GetType() || method != simulator->GetSimulationType() || simulator->GetNumberOfQubits() != numQubits))))
-				CreateSimulator(simType, method);
+				RecreateSimulator(simType, method);
 		}
 
 
@@ -224,31 +227,21 @@ namespace Network {
 					// convert the classical state results back to the expected order
 					const auto& qubitsMap = optimiser->GetQubitsMap();
 
-					for (size_t i = 0; i < paulis.size(); ++i)
+					std::vector<size_t> targets(MaxPauliStringSize(paulis));
+					for (size_t j = 0; j < targets.size(); ++j)
 					{
-						std::string translated(numOps, 'I');
-
-						for (size_t j = 0; j < paulis[i].size(); ++j)
-						{
-							const auto pos = qubitsMap.find(j);
-							if (pos != qubitsMap.end())
-								translated[pos->second] = paulis[i][j];
-							else
-								translated[j] = paulis[i][j];
-						}
-
-						expectations[i] = simulator->ExpectationValue(translated);
+						const auto pos = qubitsMap.find(j);
+						targets[j] = pos != qubitsMap.end() ? pos->second : j;
 					}
+
+					expectations = simulator->ExpectationValues(TranslatePauliStrings(paulis, targets, numOps));
 				}
 				else
-				{
-					for (size_t i = 0; i < paulis.size(); ++i)
-						expectations[i] = simulator->ExpectationValue(paulis[i]);
-				}
+					expectations = simulator->ExpectationValues(Utils::PauliString::Parse(paulis));
 			}
 
 			if (recreate && (!simulator || simType != simulator->GetType() || method != simulator->GetSimulationType() || simulator->GetNumberOfQubits() != numQubits))
-				CreateSimulator(simType, method);
+				RecreateSimulator(simType, method);
 
 			return expectations;
 		}
@@ -305,33 +298,21 @@ namespace Network {
 				// translate the pauli strings to the mapped order of qubits
 				const size_t numOps = simulator->GetNumberOfQubits();
 
-				// convert the pauli strings to the actual qubits order
-				for (size_t i = 0; i < paulis.size(); ++i)
+				// the actual qubit for each position in the pauli strings, the ones not mapped follow the mapped ones
+				std::vector<size_t> targets(MaxPauliStringSize(paulis));
+				size_t offset = offsetBase;
+				for (size_t j = 0; j < targets.size(); ++j)
 				{
-					std::string translated(std::max(numOps, paulis[i].size()), 'I');
-
-					size_t offset = offsetBase;
-
-					for (size_t j = 0; j < paulis[i].size(); ++j)
-					{
-						auto pos = qubitsMapOnHost.find(j);
-						if (pos != qubitsMapOnHost.end())
-							translated[pos->second] = paulis[i][j];
-						else
-						{
-							translated[offset] = paulis[i][j];
-							++offset;
-						}
-					}
-
-					//std::cout << "Translated pauli string: " << translated << std::endl;
-
-					expectations[i] = simulator->ExpectationValue(translated);
+					const auto pos = qubitsMapOnHost.find(j);
+					targets[j] = pos != qubitsMapOnHost.end() ? pos->second : offset++;
 				}
+
+				// all the strings at once, the simulator can share the work between them
+				expectations = simulator->ExpectationValues(TranslatePauliStrings(paulis, targets, numOps));
 			}
 
 			if (recreate && (!simulator || simType != simulator->GetType() || method != simulator->GetSimulationType() || simulator->GetNumberOfQubits() != numQubits))
-				CreateSimulator(simType, method);
+				RecreateSimulator(simType, method);
 
 			return expectations;
 		}
@@ -397,23 +378,29 @@ namespace Network {
 #endif
 			}
 
+			// many shots with mid-circuit measurements on the stabilizer simulator are executed as Pauli frames, relative to a single reference execution
+			if (GetOptimizeSimulator() && method == Simulators::SimulationType::kStabilizer && shots > 1 && distCirc->HasOpsAfterMeasurements() &&
+				Simulators::PauliFrameSimulator<Time>::IsSupported(*distCirc))
+				method = Simulators::SimulationType::kPauliFrame;
+
 			ExecuteResults res;
 			const size_t nrQubits = GetNumQubits() + GetNumNetworkEntangledQubits();
 			const size_t nrCbitsResults = GetNumClassicalBits();
 
-			maxBondDim = simulator->GetConfiguration("matrix_product_state_max_bond_dimension");
-			singularValueThreshold = simulator->GetConfiguration("matrix_product_state_truncation_threshold");
-			mpsSample = simulator->GetConfiguration("mps_sample_measure_algorithm");
+			ReadSimulatorConfiguration();
 
 			// do that only if the optimization for simulator is on and the estimator is available, ortherwise an 'optimal' simulator won't be created
-			if (optimizeSimulator && simulatorsEstimator)
+			if (ChoosesSimulator())
 			{
 				simulator->Clear();
 				GetState().Clear();
 			}
 
 			std::vector<bool> executed;
-			auto optSim = ChooseBestSimulator(distCirc, shots, nrQubits, nrQubits, nrCbitsResults, simType, method, executed);
+			// the circuit start is executed only after fusing the gates for the chosen simulator, so the executed flags match the fused circuit
+			auto optSim = ChooseBestSimulator(distCirc, shots, nrQubits, nrQubits, nrCbitsResults, simType, method, executed, false, true);
+			const auto dcirc = FuseForExecution(distCirc, simType, method);
+			if (optSim) Estimators::SimulatorsEstimatorInterface<Time>::ExecuteUpToMeasurements(dcirc, nrQubits, nrQubits, nrCbitsResults, optSim, executed, false);
 
 			lastSimulatorType = simType;
 			lastMethod = method;
@@ -430,59 +417,60 @@ namespace Network {
 
 			nrThreads = std::min(nrThreads, std::max<size_t>(shots, 1ULL));
 
-			std::mutex resultsMutex;
-
-			const auto dcirc = distCirc;
-
 			if (nrThreads > 1)
 			{
 				// since it's going to execute on multiple threads, free the memory from the network's simulator and state, it's going to use other ones, created in the threads
 				// if optimization already exists, it will be cloned in the threads, otherwise a new one will be created in the threads
-				if (!optimizeSimulator || !simulatorsEstimator) // otherwise it was already cleared
+				if (!ChoosesSimulator()) // otherwise it was already cleared
 				{
 					simulator->Clear();
 					GetState().Clear();
 				}
 
-				const size_t cntPerThread = std::max<size_t>(shots / nrThreads, 1ULL);
+				// the pool is shared between calls (and networks), the threads are kept alive, only this call's jobs are waited for
+				auto& threadsPool = ExecuteJobsPool<Time>::GetSharedPool(nrThreads);
+				const auto batch = std::make_shared<Utils::JobsBatch>(shots);
 
-				threadsPool.Resize(nrThreads);
-				threadsPool.SetFinishLimit(shots);
+				// one job (and simulator) per thread, the shots are taken in batches from the dispenser, sized from the measured time per shot
+				// this way the threads finish at about the same time even if the cost varies a lot from shot to shot (mid-circuit measurements)
+				const auto dispenser = std::make_shared<Utils::ShotsDispenser>(shots, nrThreads);
 
-				while (shots > 0)
+				std::vector<std::shared_ptr<ExecuteJob<Time>>> jobs(nrThreads);
+				for (auto& job : jobs)
 				{
-					const size_t curCnt = std::min(cntPerThread, shots);
-
-					shots -= curCnt;
-
-					auto job = std::make_shared<ExecuteJob<Time>>(dcirc, res, curCnt, nrQubits, nrQubits, nrCbitsResults, simType, method, resultsMutex);
+					job = std::make_shared<ExecuteJob<Time>>(dcirc, dispenser, nrQubits, nrQubits, nrCbitsResults, simType, method);
 					job->optimiseMultipleShotsExecution = GetOptimizeSimulator();
 
 					job->maxBondDim = maxBondDim;
 					job->mpsSample = mpsSample;
+					job->maxIntermediateSize = maxIntermediateSize;
 					job->singularValueThreshold = singularValueThreshold;
+					job->cancelled = cancelled;
 
 					if (optSim) {
 						job->optSim = optSim->Clone();
 						job->executedGates = executed;
 					}
 
-					threadsPool.AddRunJob(std::move(job));
+					threadsPool.AddRunJob(job, batch);
 				}
 
-				threadsPool.WaitForFinish();
-				threadsPool.Stop();
+				batch->WaitForFinish();
+
+				CollectJobsResults(jobs, res);
 			}
 			else
 			{
 				const size_t curCnt = shots;
 
-				auto job = std::make_shared<ExecuteJob<Time>>(dcirc, res, curCnt, nrQubits, nrQubits, nrCbitsResults, simType, method, resultsMutex);
+				auto job = std::make_shared<ExecuteJob<Time>>(dcirc, curCnt, nrQubits, nrQubits, nrCbitsResults, simType, method);
 				job->optimiseMultipleShotsExecution = GetOptimizeSimulator();
 
 				job->maxBondDim = maxBondDim;
 				job->mpsSample = mpsSample;
+				job->maxIntermediateSize = maxIntermediateSize;
 				job->singularValueThreshold = singularValueThreshold;
+				job->cancelled = cancelled;
 
 				if (optSim) {
 					optSim->SetMultithreading(true);
@@ -500,12 +488,13 @@ namespace Network {
 				}
 
 				job->DoWorkNoLock();
+				Circuits::Circuit<Time>::AccumulateResults(res, job->res);
 				if (!recreateIfNeeded)
 					simulator = job->optSim;
 			}
 
 			if (recreateIfNeeded)
-				CreateSimulator(saveSimType, saveMethod);
+				RecreateSimulator(saveSimType, saveMethod);
 
 			ConvertBackResults(res);
 
@@ -531,24 +520,71 @@ namespace Network {
 		{
 			if (!circuit || hostId >= GetNumHosts()) return {};
 
-			size_t nrQubits = 0;
-			size_t nrCbits = 0;
+			const auto prepared = PrepareCircuitOnHost(circuit, hostId);
+
+			return RepeatedExecutePrepared(*prepared, shots);
+		}
+
+		/**
+		 * @brief Prepare the circuit for repeated executions on the specified host.
+		 *
+		 * Optimizes the circuit (if the controller is set to do that and it's allowed by the parameter) and maps it on the host.
+		 * Without optimization the operations of the prepared circuit correspond one to one, in order, to the ones of the passed circuit.
+		 *
+		 * @param circuit The circuit to prepare.
+		 * @param hostId The id of the host to execute the circuit on.
+		 * @param optimize If false, the circuit is not optimized even if the controller is set to optimize circuits.
+		 * @return The prepared circuit, without a circuit if the passed one is null or the host does not exist.
+		 * @sa RepeatedExecutePrepared
+		 */
+		std::shared_ptr<PreparedHostCircuit<Time>> PrepareCircuitOnHost(const std::shared_ptr<Circuits::Circuit<Time>>& circuit, size_t hostId, bool optimize = true) override
+		{
+			auto prepared = std::make_shared<PreparedHostCircuit<Time>>();
+			prepared->hostId = hostId;
+
+			if (!circuit || hostId >= GetNumHosts()) return prepared;
+
+			const bool optimizeCircuit = optimize && GetController()->GetOptimizeCircuit();
 
 			std::shared_ptr<Circuits::Circuit<Time>> optCircuit;
-			if (GetController()->GetOptimizeCircuit()) {
+			if (optimizeCircuit) {
 				optCircuit = std::static_pointer_cast<Circuits::Circuit<Time>>(circuit->Clone());
 				optCircuit->Optimize();
 			}
-			const auto reverseQubitsMap = MapCircuitOnHost(GetController()->GetOptimizeCircuit() ? optCircuit : circuit, hostId, nrQubits, nrCbits, true);
-			if (nrCbits == 0) nrCbits = nrQubits;
+			prepared->reverseQubitsMap = MapCircuitOnHost(optimizeCircuit ? optCircuit : circuit, hostId, prepared->nrQubits, prepared->nrCbits, true);
+			if (prepared->nrCbits == 0) prepared->nrCbits = prepared->nrQubits;
+
+			prepared->circuit = distCirc;
+
+			return prepared;
+		}
+
+		/**
+		 * @brief Execute a prepared circuit, repeatedly.
+		 *
+		 * Execute the circuit prepared with PrepareCircuitOnHost, repeating the execution 'shots' times.
+		 * The measurements and resets of the prepared circuit are moved if needed by the simulator.
+		 *
+		 * @param prepared The prepared circuit.
+		 * @param shots The number of times to repeat the execution.
+		 * @return A map with the results of the execution, where the key is the state as a vector of bools and the value is the number of times it was measured.
+		 * @sa PrepareCircuitOnHost
+		 */
+		ExecuteResults RepeatedExecutePrepared(const PreparedHostCircuit<Time>& prepared, size_t shots = 1000) override
+		{
+			if (!prepared.circuit || prepared.hostId >= GetNumHosts()) return {};
+
+			distCirc = prepared.circuit;
+
+			const size_t nrQubits = prepared.nrQubits;
+			const size_t nrCbits = prepared.nrCbits;
+			const auto& reverseQubitsMap = prepared.reverseQubitsMap;
 
 			if (!simulator || distCirc->empty()) return {};
 
 			auto simType = simulator->GetType();
 
-			maxBondDim = simulator->GetConfiguration("matrix_product_state_max_bond_dimension");
-			singularValueThreshold = simulator->GetConfiguration("matrix_product_state_truncation_threshold");
-			mpsSample = simulator->GetConfiguration("mps_sample_measure_algorithm");
+			ReadSimulatorConfiguration();
 
 			if (distCirc->HasOpsAfterMeasurements() && (
 #ifndef NO_QISKIT_AER
@@ -578,6 +614,11 @@ namespace Network {
 #endif
 			}
 
+			// many shots with mid-circuit measurements on the stabilizer simulator are executed as Pauli frames, relative to a single reference execution
+			if (GetOptimizeSimulator() && method == Simulators::SimulationType::kStabilizer && shots > 1 && distCirc->HasOpsAfterMeasurements() &&
+				Simulators::PauliFrameSimulator<Time>::IsSupported(*distCirc))
+				method = Simulators::SimulationType::kPauliFrame;
+
 			ExecuteResults res;
 
 			// since it's going to execute on multiple threads, free the memory from the network's simulator and state, it's going to use other ones, created in the threads
@@ -585,7 +626,10 @@ namespace Network {
 			GetState().Clear();
 
 			std::vector<bool> executed;
-			auto optSim = ChooseBestSimulator(distCirc, shots, nrQubits, nrCbits, nrCbits, simType, method, executed);
+			// the circuit start is executed only after fusing the gates for the chosen simulator, so the executed flags match the fused circuit
+			auto optSim = ChooseBestSimulator(distCirc, shots, nrQubits, nrCbits, nrCbits, simType, method, executed, false, true);
+			const auto dcirc = FuseForExecution(distCirc, simType, method);
+			if (optSim) Estimators::SimulatorsEstimatorInterface<Time>::ExecuteUpToMeasurements(dcirc, nrQubits, nrCbits, nrCbits, optSim, executed, false);
 
 			lastSimulatorType = simType;
 			lastMethod = method;
@@ -604,52 +648,51 @@ namespace Network {
 
 			// WARNING: be sure to not put this above ChooseBestSimulator, as that one can change the shots value!
 
-			std::mutex resultsMutex;
-
-			const auto dcirc = distCirc;
-
 			if (nrThreads > 1)
 			{
-				// this rounds up, rounding down is better
-				//const size_t cntPerThread = static_cast<size_t>((shots - 1) / nrThreads + 1);
-				const size_t cntPerThread = std::max<size_t>(shots / nrThreads, 1ULL);
+				// the pool is shared between calls (and networks), the threads are kept alive, only this call's jobs are waited for
+				auto& threadsPool = ExecuteJobsPool<Time>::GetSharedPool(nrThreads);
+				const auto batch = std::make_shared<Utils::JobsBatch>(shots);
 
-				threadsPool.Resize(nrThreads);
-				threadsPool.SetFinishLimit(shots);
+				// one job (and simulator) per thread, the shots are taken in batches from the dispenser
+				const auto dispenser = std::make_shared<Utils::ShotsDispenser>(shots, nrThreads);
 
-				while (shots > 0)
+				std::vector<std::shared_ptr<ExecuteJob<Time>>> jobs(nrThreads);
+				for (auto& job : jobs)
 				{
-					const size_t curCnt = std::min(cntPerThread, shots);
-					shots -= curCnt;
-
-					auto job = std::make_shared<ExecuteJob<Time>>(dcirc, res, curCnt, nrQubits, nrCbits, nrCbits, simType, method, resultsMutex);
+					job = std::make_shared<ExecuteJob<Time>>(dcirc, dispenser, nrQubits, nrCbits, nrCbits, simType, method);
 					job->optimiseMultipleShotsExecution = GetOptimizeSimulator();
 
 					job->maxBondDim = maxBondDim;
 					job->mpsSample = mpsSample;
+					job->maxIntermediateSize = maxIntermediateSize;
 					job->singularValueThreshold = singularValueThreshold;
+					job->cancelled = cancelled;
 
 					if (optSim) {
 						job->optSim = optSim->Clone();
 						job->executedGates = executed;
 					}
 
-					threadsPool.AddRunJob(std::move(job));
+					threadsPool.AddRunJob(job, batch);
 				}
 
-				threadsPool.WaitForFinish();
-				threadsPool.Stop();
+				batch->WaitForFinish();
+
+				CollectJobsResults(jobs, res);
 			}
 			else
 			{
 				const size_t curCnt = shots;
 
-				auto job = std::make_shared<ExecuteJob<Time>>(dcirc, res, curCnt, nrQubits, nrCbits, nrCbits, simType, method, resultsMutex);
+				auto job = std::make_shared<ExecuteJob<Time>>(dcirc, curCnt, nrQubits, nrCbits, nrCbits, simType, method);
 				job->optimiseMultipleShotsExecution = GetOptimizeSimulator();
 
 				job->maxBondDim = maxBondDim;
 				job->mpsSample = mpsSample;
+				job->maxIntermediateSize = maxIntermediateSize;
 				job->singularValueThreshold = singularValueThreshold;
+				job->cancelled = cancelled;
 
 				if (optSim) {
 					optSim->SetMultithreading(true);
@@ -658,18 +701,146 @@ namespace Network {
 				}
 
 				job->DoWorkNoLock();
+				Circuits::Circuit<Time>::AccumulateResults(res, job->res);
 				if (!recreateIfNeeded)
 					simulator = job->optSim;
 			}
 
 			if (recreateIfNeeded)
-				CreateSimulator(saveSimType, saveMethod);
+				RecreateSimulator(saveSimType, saveMethod);
 
 			if (!reverseQubitsMap.empty()) ConvertBackResults(res, reverseQubitsMap);
 
 			return res;
 		}
 
+		/**
+		 * @brief Execute a parametrized circuit on the specified host, for each of the parameters points.
+		 *
+		 * The circuit is mapped on the host once, without optimizing it, then the points are spread over the execution threads.
+		 * Each thread has its own copy of the circuit and its own simulator, reset and reused for each point it takes.
+		 * The simulator type is chosen once for all points, the automatic switch to the stabilizer simulator is not done,
+		 * as whether the circuit is Clifford or not depends on the parameters values.
+		 *
+		 * @param circuit The parametrized circuit.
+		 * @param bindings The gates parameters bound to the circuit parameters, the operation indices refer to the passed circuit.
+		 * @param points The values of the circuit parameters, one vector for each point.
+		 * @param hostId The id of the host to execute the circuit on.
+		 * @param shots The number of times to repeat the execution for each point.
+		 * @return The results of the execution for each point, in the order of the points, empty if a point has too few values.
+		 * @sa Circuits::ParameterBinding
+		 */
+		std::vector<ExecuteResults> RepeatedExecuteSweepOnHost(const std::shared_ptr<Circuits::Circuit<Time>>& circuit, const std::vector<Circuits::ParameterBinding>& bindings,
+			const std::vector<std::vector<double>>& points, size_t hostId, size_t shots = 1000) override
+		{
+			if (!circuit || hostId >= GetNumHosts() || !simulator || points.empty()) return {};
+
+			const size_t nrParams = Circuits::ParametersBinder<Time>::GetNumParameters(bindings);
+			for (const auto& point : points)
+				if (point.size() < nrParams) return {};
+
+			// not optimized, so the operations still correspond to the bindings
+			const auto prepared = PrepareCircuitOnHost(circuit, hostId, false);
+			if (!prepared->circuit || prepared->circuit->empty()) return std::vector<ExecuteResults>(points.size());
+
+			const auto& templateCircuit = prepared->circuit;
+			const size_t nrQubits = prepared->nrQubits;
+			const size_t nrCbits = prepared->nrCbits;
+
+			auto simType = simulator->GetType();
+			auto method = simulator->GetSimulationType();
+			const auto saveSimType = simType;
+			const auto saveMethod = method;
+
+			ReadSimulatorConfiguration();
+
+			simulator->Clear();
+			GetState().Clear();
+
+			// only the simulator type is chosen here, the circuit is executed for each point by the jobs
+			{
+				const auto typeCircuit = std::static_pointer_cast<Circuits::Circuit<Time>>(templateCircuit->Clone());
+				Circuits::ParametersBinder<Time>(typeCircuit->GetOperations(), bindings).Bind(points.front().data());
+
+				size_t typeShots = shots;
+				std::vector<bool> executed;
+				ChooseBestSimulator(typeCircuit, typeShots, nrQubits, nrCbits, nrCbits, simType, method, executed, false, true);
+			}
+
+			lastSimulatorType = simType;
+			lastMethod = method;
+
+			const bool moveMeasurements = templateCircuit->HasOpsAfterMeasurements() && (
+#ifndef NO_QISKIT_AER
+				simType == Simulators::SimulatorType::kCompositeQiskitAer ||
+#endif
+				simType == Simulators::SimulatorType::kCompositeQCSim);
+
+			size_t nrThreads = GetMaxSimulators();
+#ifdef __linux__
+			if (simType == Simulators::SimulatorType::kGpuSim)
+				nrThreads = 1;
+#endif
+			nrThreads = std::max<size_t>(std::min(nrThreads, points.size()), 1ULL);
+
+			const auto sweep = std::make_shared<ParameterSweep<Time>>(points);
+
+			auto createJob = [&]()
+			{
+				// the binder finds the gates before the measurements are moved
+				const auto jobCircuit = std::static_pointer_cast<Circuits::Circuit<Time>>(templateCircuit->Clone());
+				const auto binder = std::make_shared<Circuits::ParametersBinder<Time>>(jobCircuit->GetOperations(), bindings);
+				if (moveMeasurements) jobCircuit->MoveMeasurementsAndResets();
+
+				auto job = std::make_shared<ExecuteJob<Time>>(jobCircuit, sweep, binder, shots, nrQubits, nrCbits, nrCbits, simType, method);
+				job->optimiseMultipleShotsExecution = GetOptimizeSimulator();
+				job->fusionMaxQubits = GetFusionMaxQubits(simType, method);
+
+				job->maxBondDim = maxBondDim;
+				job->mpsSample = mpsSample;
+				job->maxIntermediateSize = maxIntermediateSize;
+				job->singularValueThreshold = singularValueThreshold;
+				job->cancelled = cancelled;
+
+				return job;
+			};
+
+			if (nrThreads > 1)
+			{
+				auto& threadsPool = ExecuteJobsPool<Time>::GetSharedPool(nrThreads);
+				const auto batch = std::make_shared<Utils::JobsBatch>(points.size());
+
+				std::vector<std::shared_ptr<ExecuteJob<Time>>> jobs(nrThreads);
+				for (auto& job : jobs)
+				{
+					job = createJob();
+					threadsPool.AddRunJob(job, batch);
+				}
+
+				batch->WaitForFinish();
+			}
+			else
+			{
+				auto job = createJob();
+				job->DoWorkNoLock();
+
+				if (!recreateIfNeeded)
+					simulator = job->optSim;
+			}
+
+			if (recreateIfNeeded)
+				RecreateSimulator(saveSimType, saveMethod);
+
+			std::vector<ExecuteResults> results(points.size());
+			for (size_t i = 0; i < points.size(); ++i)
+			{
+				Circuits::Circuit<Time>::AccumulateResults(results[i], sweep->results[i]);
+				if (!prepared->reverseQubitsMap.empty()) ConvertBackResults(results[i], prepared->reverseQubitsMap);
+			}
+
+			return results;
+		}
+
 		/**
 		 * @brief Get the number of gates that span more than one host.
 		 *
@@ -736,20 +907,38 @@ namespace Network {
 			, Simulators::SimulationType simExecType = Simulators::SimulationType::kMatrixProductState, size_t nrQubits = 0
 		) override
 		{
-			classicalState.Clear();
-			classicalState.AllocateBits(GetNumClassicalBits() + GetNumNetworkEntangledQubits());
+			// the simulator was set explicitly, the estimator must not replace it
+			chooseSimulator = false;
 
-			simulator = Simulators::SimulatorsFactory::CreateSimulator(simType, simExecType);
+			RecreateSimulator(simType, simExecType, nrQubits);
+		}
 
-			if (simulator)
-			{
-				if (!maxBondDim.empty()) simulator->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
-				if (!singularValueThreshold.empty()) simulator->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
-				if (!mpsSample.empty()) simulator->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+		/**
+		 * @brief Set the simulators estimator.
+		 *
+		 * With an estimator set (and the simulator optimization allowed), the executions use the implementation estimated to be the fastest
+		 * for the configured simulation method, for example the qiskit aer statevector instead of the qcsim one.
+		 * If the optimization simulators set is not empty, the estimator chooses among the simulators in it instead.
+		 * Creating the simulator or configuring it (bond dimension, truncation, mps sampling, intermediate tensors size) afterwards turns off the choice,
+		 * setting the estimator again turns it back on.
+		 *
+		 * @param estimator The estimator, for example an Estimators::SimulatorsEstimator, nullptr to always use the configured simulator.
+		 * @sa Estimators::SimulatorsEstimator
+		 */
+		void SetSimulatorsEstimator(const std::shared_ptr<Estimators::SimulatorsEstimatorInterface<Time>>& estimator)
+		{
+			simulatorsEstimator = estimator;
+			chooseSimulator = static_cast<bool>(estimator);
+		}
 
-				simulator->AllocateQubits(nrQubits == 0 ? GetNumQubits() + GetNumNetworkEntangledQubits() : nrQubits);
-				simulator->Initialize();
-			}
+		/**
+		 * @brief Get the simulators estimator.
+		 *
+		 * @return The estimator set with SetSimulatorsEstimator(), nullptr if none was set.
+		 */
+		std::shared_ptr<Estimators::SimulatorsEstimatorInterface<Time>> GetSimulatorsEstimator() const
+		{
+			return simulatorsEstimator;
 		}
 
 		/**
@@ -764,14 +953,40 @@ namespace Network {
 		{
 			if (!key || !value) return;
 
+			// configuring the simulator explicitly turns off the simulator choice
 			if (std::string("matrix_product_state_max_bond_dimension") == key)
-				maxBondDim = value;
+			{
+				if (ParseSize(value, maxBondDimension))
+					maxBondDim = value;
+				chooseSimulator = false;
+			}
 			else if (std::string("matrix_product_state_truncation_threshold") == key)
+			{
 				singularValueThreshold = value;
+				chooseSimulator = false;
+			}
 			else if (std::string("mps_sample_measure_algorithm") == key)
+			{
 				mpsSample = value;
+				chooseSimulator = false;
+			}
+			else if (std::string("tensor_network_max_intermediate_size") == key)
+			{
+				maxIntermediateSize = value;
+				chooseSimulator = false;
+			}
+			else if (std::string("gate_fusion_max_qubits") == key)
+				ParseSize(value, fusionMaxQubits);
 			else if (std::string("max_simulators") == key)
-				maxSimulators = std::stoull(value);
+			{
+				size_t val;
+				if (ParseSize(value, val))
+				{
+					SetMaxSimulators(val);
+					// start the threads now, so they are already available for the first execution
+					if (maxSimulators > 1) ExecuteJobsPool<Time>::GetSharedPool(maxSimulators);
+				}
+			}
 
 			if (simulator)
 				simulator->Configure(key, value);
@@ -1532,6 +1747,18 @@ namespace Network {
 			optimizeSimulator = optimize;
 		}
 
+		/**
+		 * @brief Set the flag for cancelling the executions.
+		 *
+		 * The execution jobs check it before taking the next batch of shots (or the next point of a sweep).
+		 *
+		 * @param flag The cancellation flag, nullptr if the executions cannot be cancelled.
+		 */
+		void SetCancellationFlag(const std::shared_ptr<const std::atomic<bool>>& flag) override
+		{
+			cancelled = flag;
+		}
+
 
 		/**
 		 * @brief Returns the 'optimize' flag.
@@ -1637,29 +1864,106 @@ namespace Network {
 			const auto cloned = std::make_shared<SimpleDisconnectedNetwork<Time, Controller>>(qubits, cbits);
 
 			cloned->maxBondDim = maxBondDim;
+			cloned->maxBondDimension = maxBondDimension;
 			cloned->singularValueThreshold = singularValueThreshold;
 			cloned->mpsSample = mpsSample;
+			cloned->maxIntermediateSize = maxIntermediateSize;
+			cloned->fusionMaxQubits = fusionMaxQubits;
+			cloned->maxSimulators = maxSimulators;
 
 			//cloned->optimizeSimulator = optimizeSimulator;
 			//cloned->simulatorsForOptimizations = simulatorsForOptimizations;
+			cloned->simulatorsEstimator = simulatorsEstimator;
+			cloned->chooseSimulator = chooseSimulator;
 
 			if (GetSimulator())
-				cloned->CreateSimulator(GetSimulator()->GetType(), GetSimulator()->GetSimulationType());
+				cloned->RecreateSimulator(GetSimulator()->GetType(), GetSimulator()->GetSimulationType());
 
 			return cloned;
 		}
 
+		/**
+		 * @brief Fuses the gates of the circuit, for execution.
+		 *
+		 * Statevector simulators (except the gpu one) get dense gates on up to fusionMaxQubits qubits,
+		 * the matrix product state and tensor network simulators get only the single qubit gates fused, the stabilizer simulator gets nothing fused.
+		 * @param circ The circuit to execute.
+		 * @param simType The simulator type.
+		 * @param method The simulation method.
+		 * @return The circuit to execute, a copy if fused, otherwise the passed one.
+		 */
+		std::shared_ptr<Circuits::Circuit<Time>> FuseForExecution(const std::shared_ptr<Circuits::Circuit<Time>>& circ, Simulators::SimulatorType simType, Simulators::SimulationType method) const
+		{
+			const size_t maxQubits = GetFusionMaxQubits(simType, method);
+			if (maxQubits == 0)
+				return circ;
+
+			auto fused = std::make_shared<Circuits::Circuit<Time>>(circ->GetOperations());
+			fused->Fuse(maxQubits);
+
+			return fused;
+		}
+
+		/**
+		 * @brief Parses an unsigned integer configuration value.
+		 *
+		 * @param value The configuration value.
+		 * @param result The parsed value, not changed if the value is not a valid unsigned integer.
+		 * @return True if the value was parsed, false otherwise.
+		 */
+		static bool ParseSize(const char* value, size_t& result)
+		{
+			if (!value || *value < '0' || *value > '9') return false;
+
+			char* end = nullptr;
+			errno = 0;
+			const unsigned long long int val = std::strtoull(value, &end, 10);
+			if (errno == ERANGE || *end != 0) return false;
+
+			result = static_cast<size_t>(val);
+
+			return true;
+		}
+
+		/**
+		 * @brief Get the maximum number of qubits of the fused gates, for execution on the simulator.
+		 *
+		 * @param simType The simulator type.
+		 * @param method The simulation method.
+		 * @return The maximum number of qubits of the fused gates, zero if the gates are not to be fused.
+		 * @sa FuseForExecution
+		 */
+		size_t GetFusionMaxQubits(Simulators::SimulatorType simType, Simulators::SimulationType method) const
+		{
+			if (fusionMaxQubits == 0 || method == Simulators::SimulationType::kStabilizer || method == Simulators::SimulationType::kPauliFrame || method == Simulators::SimulationType::kOther)
+				return 0;
+
+#ifdef __linux__
+			if (simType == Simulators::SimulatorType::kGpuSim)
+				return 1;
+#endif
+
+			return method == Simulators::SimulationType::kStatevector ? fusionMaxQubits : 1;
+		}
+
 		std::shared_ptr<Simulators::ISimulator> ChooseBestSimulator(const std::shared_ptr<Circuits::Circuit<Time>>& dcirc, size_t& counts, size_t nrQubits, size_t nrCbits, size_t nrResultCbits, 
 			Simulators::SimulatorType& simType, Simulators::SimulationType& method, std::vector<bool>& executed, bool multithreading = false, bool dontRunCircuitStart = false) const override
 		{
-			if (!optimizeSimulator || !simulatorsEstimator)
+			// the Pauli frames jobs do the reference execution on their own stabilizer simulators
+			if (!ChoosesSimulator() || method == Simulators::SimulationType::kPauliFrame)
 				return nullptr;
 
 			// when multithreading is set to true it means it needs a multithreaded simulator
 
+			// without an explicit optimization set, only the implementations of the configured method are candidates
+			const auto IsCandidate = [this, method](Simulators::SimulatorType type, Simulators::SimulationType kind)
+			{
+				return OptimizationSimulatorExists(type, kind) && (!simulatorsForOptimizations.empty() || kind == method);
+			};
+
 			std::vector<std::pair<Simulators::SimulatorType, Simulators::SimulationType>> simulatorTypes;
 
-			const bool checkTensorNetwork = method == Simulators::SimulationType::kTensorNetwork;
+			const bool checkTensorNetwork = method == Simulators::SimulationType::kTensorNetwork || simulatorsEstimator->EstimatesTensorNetworks();
 
 			// the others are to be picked between statevector, composite, tensor networks and mps, for now at least
 			// for tensor networks in the future it's worth checking different contractors!!!!
@@ -1668,48 +1972,48 @@ namespace Network {
 			if (method == Simulators::SimulationType::kStabilizer)
 			{
 				// compare qcsim with qiskit aer if qiskit aer is available, let the best one win
-				if (OptimizationSimulatorExists(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStabilizer))
+				if (IsCandidate(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStabilizer))
 					simulatorTypes.emplace_back(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStabilizer);
 
 #ifndef NO_QISKIT_AER
 				// if the number of shots is too small, probably it's not worth it, it's going to be better to just execute them multithreading
-				if (OptimizationSimulatorExists(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kStabilizer))
+				if (IsCandidate(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kStabilizer))
 					simulatorTypes.emplace_back(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kStabilizer);
 #endif
 			}
 
-			if (OptimizationSimulatorExists(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStatevector))
+			if (IsCandidate(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStatevector))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStatevector);
 
-			if (OptimizationSimulatorExists(Simulators::SimulatorType::kCompositeQCSim, Simulators::SimulationType::kStatevector))
+			if (IsCandidate(Simulators::SimulatorType::kCompositeQCSim, Simulators::SimulationType::kStatevector))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kCompositeQCSim, Simulators::SimulationType::kStatevector);
 
-			if (checkTensorNetwork && OptimizationSimulatorExists(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kTensorNetwork))
+			if (checkTensorNetwork && IsCandidate(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kTensorNetwork))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kTensorNetwork);
 
-			if (OptimizationSimulatorExists(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kMatrixProductState) &&
-				(nrQubits <= 4 || !maxBondDim.empty()))
+			if (IsCandidate(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kMatrixProductState) &&
+				(method == Simulators::SimulationType::kMatrixProductState || nrQubits <= 4 || !maxBondDim.empty()))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kMatrixProductState);
 
 #ifndef NO_QISKIT_AER
 			// tensor networks are out of the picture for now for qiskit aer, since they are available with cuda library, and work only on linux (obviously when compiled properly and if there is the right hw an driver installed)
 
-			if (OptimizationSimulatorExists(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kStatevector))
+			if (IsCandidate(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kStatevector))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kStatevector);
 
-			if (OptimizationSimulatorExists(Simulators::SimulatorType::kCompositeQiskitAer, Simulators::SimulationType::kStatevector))
+			if (IsCandidate(Simulators::SimulatorType::kCompositeQiskitAer, Simulators::SimulationType::kStatevector))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kCompositeQiskitAer, Simulators::SimulationType::kStatevector);
 
-			if (OptimizationSimulatorExists(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kMatrixProductState) &&
-				(nrQubits <= 4 || !maxBondDim.empty()))
+			if (IsCandidate(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kMatrixProductState) &&
+				(method == Simulators::SimulationType::kMatrixProductState || nrQubits <= 4 || !maxBondDim.empty()))
 				simulatorTypes.emplace_back(Simulators::SimulatorType::kQiskitAer, Simulators::SimulationType::kMatrixProductState);
 #endif
 
 #ifdef __linux__
 			if (Simulators::SimulatorsFactory::IsGpuLibraryAvailable()) {
-				if (OptimizationSimulatorExists(Simulators::SimulatorType::kGpuSim, Simulators::SimulationType::kStatevector))
+				if (IsCandidate(Simulators::SimulatorType::kGpuSim, Simulators::SimulationType::kStatevector))
 					simulatorTypes.emplace_back(Simulators::SimulatorType::kGpuSim, Simulators::SimulationType::kStatevector);
-				if (OptimizationSimulatorExists(Simulators::SimulatorType::kGpuSim, Simulators::SimulationType::kMatrixProductState))
+				if (IsCandidate(Simulators::SimulatorType::kGpuSim, Simulators::SimulationType::kMatrixProductState))
 					simulatorTypes.emplace_back(Simulators::SimulatorType::kGpuSim, Simulators::SimulationType::kMatrixProductState);
 			}
 #endif
@@ -1729,6 +2033,8 @@ namespace Network {
 						if (!singularValueThreshold.empty()) sim->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
 						if (!mpsSample.empty()) sim->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
 					}
+					else if (method == Simulators::SimulationType::kTensorNetwork && !maxIntermediateSize.empty())
+						sim->Configure("tensor_network_max_intermediate_size", maxIntermediateSize.c_str());
 					sim->SetMultithreading(true);
 					if (!dontRunCircuitStart) Estimators::SimulatorsEstimatorInterface<Time>::ExecuteUpToMeasurements(dcirc, nrQubits, nrCbits, nrResultCbits, sim, executed, multithreading);
 
@@ -1737,13 +2043,114 @@ namespace Network {
 			}
 
 			return simulatorsEstimator->ChooseBestSimulator(simulatorTypes, dcirc, counts, nrQubits, nrCbits, nrResultCbits, simType, method, executed,
-				maxBondDim, singularValueThreshold, mpsSample,
+				maxBondDimension, singularValueThreshold, mpsSample, maxIntermediateSize,
 				GetMaxSimulators(), pauliStrings,
 				multithreading, dontRunCircuitStart);
 		}
 
 
 	protected:
+		/**
+		 * @brief Reads back the configuration of the simulator.
+		 *
+		 * The simulator might have been configured directly, the simulators created for the execution must get the same configuration.
+		 * The bond dimension is parsed only if it changed.
+		 */
+		void ReadSimulatorConfiguration()
+		{
+			if (auto val = simulator->GetConfiguration("matrix_product_state_max_bond_dimension"); val != maxBondDim)
+			{
+				maxBondDim = std::move(val);
+				maxBondDimension = 0;
+				ParseSize(maxBondDim.c_str(), maxBondDimension);
+			}
+			singularValueThreshold = simulator->GetConfiguration("matrix_product_state_truncation_threshold");
+			mpsSample = simulator->GetConfiguration("mps_sample_measure_algorithm");
+			// only the tensor network simulator knows about it, the others must not drop the configured value
+			if (const auto val = simulator->GetConfiguration("tensor_network_max_intermediate_size"); !val.empty()) maxIntermediateSize = val;
+		}
+
+		/**
+		 * @brief Checks if the estimator chooses the simulator for the executions.
+		 *
+		 * @return True if the simulator optimization is allowed, an estimator was set and no simulator was created or configured explicitly after that.
+		 */
+		bool ChoosesSimulator() const
+		{
+			return optimizeSimulator && chooseSimulator && simulatorsEstimator;
+		}
+
+		/**
+		 * @brief Creates the simulator, without changing the simulator choice.
+		 *
+		 * Used to restore the simulator after an execution.
+		 *
+		 * @param simType The type of the simulator to create.
+		 * @param simExecType The type of the simulation.
+		 * @param nrQubits The number of qubits to allocate for the simulator, 0 for the whole network.
+		 */
+		void RecreateSimulator(Simulators::SimulatorType simType, Simulators::SimulationType simExecType, size_t nrQubits = 0)
+		{
+			classicalState.Clear();
+			classicalState.AllocateBits(GetNumClassicalBits() + GetNumNetworkEntangledQubits());
+
+			simulator = Simulators::SimulatorsFactory::CreateSimulator(simType, simExecType);
+
+			if (simulator)
+			{
+				if (!maxBondDim.empty()) simulator->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
+				if (!singularValueThreshold.empty()) simulator->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
+				if (!mpsSample.empty()) simulator->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+				if (!maxIntermediateSize.empty()) simulator->Configure("tensor_network_max_intermediate_size", maxIntermediateSize.c_str());
+
+				simulator->AllocateQubits(nrQubits == 0 ? GetNumQubits() + GetNumNetworkEntangledQubits() : nrQubits);
+				simulator->Initialize();
+			}
+		}
+
+		/**
+		 * @brief Returns the size of the longest Pauli string.
+		 *
+		 * @param paulis The Pauli strings.
+		 * @return The size of the longest Pauli string.
+		 */
+		static size_t MaxPauliStringSize(const std::vector<std::string>& paulis)
+		{
+			size_t maxSize = 0;
+			for (const auto& pauli : paulis)
+				maxSize = std::max(maxSize, pauli.size());
+
+			return maxSize;
+		}
+
+		/**
+		 * @brief Parses the Pauli strings and moves their operators to the actual qubits.
+		 *
+		 * The strings are parsed once and only the operators that are not identities are moved.
+		 *
+		 * @param paulis The Pauli strings, in the order of the qubits of the circuit.
+		 * @param targets The actual qubit for each position in the strings.
+		 * @param nrQubits The number of qubits of the simulator.
+		 * @return The translated Pauli strings.
+		 */
+		static std::vector<Utils::PauliString> TranslatePauliStrings(const std::vector<std::string>& paulis, const std::vector<size_t>& targets, size_t nrQubits)
+		{
+			std::vector<Utils::PauliString> translated;
+			translated.reserve(paulis.size());
+
+			for (const auto& pauliString : paulis)
+			{
+				const Utils::PauliString pauli(pauliString);
+
+				translated.emplace_back(nrQubits);
+				auto& result = translated.back();
+
+				pauli.ForEachOperator([&result, &targets](size_t q, char op) { result.Set(targets[q], op); });
+			}
+
+			return translated;
+		}
+
 		/**
 		 * @brief Converts back the state from the optimized network distribution mapping
 		 *
@@ -1779,6 +2186,29 @@ namespace Network {
 			theClassicalState.Remap(qubitsMap);
 		}
 
+		/**
+		 * @brief Collects the results of the shots execution jobs.
+		 *
+		 * Merges the partial results of the jobs, still with packed keys, into the results of the largest one, then unpacks them.
+		 * This way the jobs don't need to lock anything while filling their results and the keys are unpacked only once.
+		 *
+		 * @param jobs The finished jobs.
+		 * @param res The results to add to.
+		 */
+		static void CollectJobsResults(std::vector<std::shared_ptr<ExecuteJob<Time>>>& jobs, ExecuteResults& res)
+		{
+			if (jobs.empty()) return;
+
+			const auto largest = std::max_element(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return a->res.size() < b->res.size(); });
+			auto merged = std::move((*largest)->res);
+
+			for (const auto& job : jobs)
+				if (job != *largest)
+					Utils::MergeCounts(merged, job->res);
+
+			Circuits::Circuit<Time>::AccumulateResults(res, merged);
+		}
+
 		/**
 		 * @brief Converts back the results from the optimized network distribution mapping
 		 *
@@ -1924,8 +2354,14 @@ namespace Network {
 		Simulators::SimulationType lastMethod = Simulators::SimulationType::kStatevector;	/**< The last simulation method used. */
 
 		std::string maxBondDim;
+		size_t maxBondDimension = 0; /**< The maximum bond dimension, parsed from maxBondDim, 0 for no limit. */
 		std::string singularValueThreshold;
 		std::string mpsSample;
+		std::string maxIntermediateSize; /**< The limit of the size of the intermediate tensors for the tensor network contraction, empty for no limit. */
+
+		size_t fusionMaxQubits = 0; /**< The maximum number of qubits of the fused gates, 0 (the default) disables gate fusion. */
+
+		std::shared_ptr<const std::atomic<bool>> cancelled; /**< The flag for cancelling the executions, not copied when cloning. */
 
 		size_t maxSimulators = QC::QubitRegisterCalculator<>::GetNumberOfThreads(); /**< The maximum number of simulators that can be used in the network. */
 
@@ -1939,10 +2375,10 @@ namespace Network {
 		// or simply a vector of hosts for a totally connected network (or where the communication details do not matter so much)
 		std::vector<std::shared_ptr<IHost<Time>>> hosts;   /**< The hosts in the network. */
 
-		std::unique_ptr<Estimators::SimulatorsEstimatorInterface<Time>> simulatorsEstimator;  /**< The simulators estimator. */
+		std::shared_ptr<Estimators::SimulatorsEstimatorInterface<Time>> simulatorsEstimator;  /**< The simulators estimator, shared with the clones. */
+		bool chooseSimulator = false;  /**< The flag to let the estimator choose the simulator, set with the estimator, cleared by an explicit simulator creation or configuration. */
 
 	private:
-		Utils::ThreadsPool<ExecuteJob<Time>> threadsPool;  /**< The threads pool for the execution of the circuits. */
 		bool recreateIfNeeded = true;               /**< The flag to recreate the simulator if needed. */
 		std::unordered_map<Types::qubit_t, Types::qubit_t> qubitsMapOnHost; /**< The map with the qubits mapping when executing on a host. Relevant only when computing expectation values. */
 		const std::vector<std::string>* pauliStrings = nullptr;  /**< Set to the vector of pauli strings if computing the expectation values. */
@@ -714,6 +714,31 @@ namespace Simulators {
 				NotifyObservers(qubits);
 			}
 
+			/**
+			 * @brief Applies a gate given by a dense matrix to the qubits
+			 *
+			 * Applies a gate given by its matrix to the specified qubits.
+			 * Not supported by the stabilizer simulator.
+			 * @param qubits The qubits the gate is applied to
+			 * @param matrix The matrix of the gate, row major, qubits[0] corresponding to the least significant bit of the indices
+			 */
+			void ApplyMatrix(const Types::qubits_vector& qubits, const std::vector<std::complex<double>>& matrix) override
+			{
+				if (GetSimulationType() == SimulationType::kStabilizer)
+					throw std::runtime_error("Gates given by matrices are not supported in stabilizer simulation");
+
+				const size_t dim = 1ULL << qubits.size();
+				cmatrix_t mat(dim, dim);
+				for (size_t r = 0; r < dim; ++r)
+					for (size_t c = 0; c < dim; ++c)
+						mat(r, c) = matrix[r * dim + c];
+
+				// qiskit aer uses the same convention, the first qubit is the least significant one
+				state->apply_unitary(qubits, mat);
+
+				NotifyObservers(qubits);
+			}
+
 			/**
 			 * @brief Applies a nop
 			 *
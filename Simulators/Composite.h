@@ -19,8 +19,10 @@
 #ifdef INCLUDED_BY_FACTORY
 
 #include "Individual.h"
+#include "../Utils/BitScatter.h"
 
 #include <vector>
+#include <random>
 
 namespace Simulators {
 
@@ -424,7 +426,6 @@ namespace Simulators {
 			 */
 			std::unordered_map<Types::qubit_t, Types::qubit_t> SampleCounts(const Types::qubits_vector& qubits, size_t shots = 1000) override
 			{
-				// TODO: improve it as for the qcsim statevector simulator case!
 				std::unordered_map<Types::qubit_t, Types::qubit_t> result;
 				DontNotify();
 
@@ -432,27 +433,7 @@ namespace Simulators {
 
 				if (shots > 1)
 				{
-					InitializeAlias();
-
-					for (size_t shot = 0; shot < shots; ++shot)
-					{
-						size_t measRaw = 0;
-						for (auto& [id, simulator] : simulators)
-							measRaw |= simulator->SampleFromAlias();
-						
-						size_t meas = 0;
-						size_t mask = 1ULL;
-						for (auto q : qubits)
-						{
-							const size_t qubitMask = 1ULL << q;
-							if ((measRaw & qubitMask) != 0)
-								meas |= mask;
-							mask <<= 1ULL;
-						}
-
-						++result[meas];
-					}
-
+					result = SampleCountsBatched(qubits, shots);
 					ClearAlias();
 				}
 				else
@@ -494,25 +475,64 @@ namespace Simulators {
 			 */
 			double ExpectationValue(const std::string& pauliString) override
 			{
-				std::unordered_map<size_t, std::string> pauliStrings;
+				if (pauliString.empty()) return 1.0;
+
+				return ExpectationValues(std::vector<Utils::PauliString>{ Utils::PauliString(pauliString) })[0];
+			}
 
-				for (size_t q = 0; q < pauliString.size(); ++q)
+			using ISimulator::ExpectationValues;
+
+			/**
+			 * @brief Returns the expected values of a batch of Pauli strings.
+			 *
+			 * Each string is split into the strings for the individual simulators, the expected value is the product of their expected values.
+			 * Each individual simulator gets a single batch with all the strings for it.
+			 *
+			 * @param paulis The Pauli strings to obtain the expected values for.
+			 * @return The expected values of the specified Pauli strings, in the same order.
+			 */
+			std::vector<double> ExpectationValues(const std::vector<Utils::PauliString>& paulis) override
+			{
+				std::vector<double> result(paulis.size(), 1.0);
+
+				// for each individual simulator, its strings and the indices of the strings they are part of
+				std::unordered_map<size_t, std::vector<Utils::PauliString>> localPaulis;
+				std::unordered_map<size_t, std::vector<size_t>> localIndices;
+
+				for (size_t i = 0; i < paulis.size(); ++i)
 				{
-					const char op = toupper(pauliString[q]);
-					if (op == 'I') continue;
+					std::unordered_map<size_t, Utils::PauliString> split;
+
+					paulis[i].ForEachOperator([this, &split, &result, i](size_t q, char op)
+						{
+							if (q >= qubitsMap.size())
+							{
+								// acts on |0>
+								if (op != 'Z') result[i] = 0.0;
+								return;
+							}
+
+							const size_t simId = qubitsMap[q];
+							split[simId].Set(simulators[simId]->GetQubitsMap().at(q), op);
+						});
 
-					const size_t simId = qubitsMap[q];
-					const size_t localQubit = simulators[simId]->GetQubitsMap().at(q);
+					if (result[i] == 0.0) continue;
 
-					if (pauliStrings[simId].size() <= localQubit)
-						pauliStrings[simId].resize(localQubit + 1, 'I');
-					
-					pauliStrings[simId][localQubit] = op;
+					for (auto& [simId, localPauli] : split)
+					{
+						localPaulis[simId].emplace_back(std::move(localPauli));
+						localIndices[simId].push_back(i);
+					}
 				}
 
-				double result = 1.0;
-				for (auto& [id, localPauliString] : pauliStrings)
-					result *= simulators[id]->ExpectationValue(localPauliString);
+				for (const auto& [simId, simPaulis] : localPaulis)
+				{
+					const auto values = simulators[simId]->ExpectationValues(simPaulis);
+					const auto& indices = localIndices[simId];
+
+					for (size_t j = 0; j < indices.size(); ++j)
+						result[indices[j]] *= values[j];
+				}
 
 				return result;
 			}
@@ -976,6 +996,25 @@ namespace Simulators {
 				NotifyObservers({ tgt_qubit, ctrl_qubit });
 			}
 
+			/**
+			 * @brief Applies a gate given by a dense matrix to the qubits
+			 *
+			 * Applies a gate given by its matrix to the specified qubits.
+			 * The simulators of the qubits are joined first, if needed.
+			 * @param qubits The qubits the gate is applied to
+			 * @param matrix The matrix of the gate, row major, qubits[0] corresponding to the least significant bit of the indices
+			 */
+			void ApplyMatrix(const Types::qubits_vector& qubits, const std::vector<std::complex<double>>& matrix) override
+			{
+				if (qubits.empty()) return;
+
+				for (size_t i = 1; i < qubits.size(); ++i)
+					JoinIfNeeded(qubits[0], qubits[i]);
+
+				GetSimulator(qubits[0])->ApplyMatrix(qubits, matrix);
+				NotifyObservers(qubits);
+			}
+
 			void ApplyNop()
 			{
 				GetSimulator(0)->ApplyNop();
@@ -1125,6 +1164,119 @@ namespace Simulators {
 			}
 
 		private:
+			/**
+			 * @brief Samples the measured qubits, for many shots.
+			 *
+			 * Only the simulators containing measured qubits are sampled, the others don't affect the results.
+			 * The shots are split between threads, each with its own random numbers generator, seeded from the simulator's one.
+			 * Each thread samples the simulators one after another for a block of shots, moving the sampled bits to their place in the results with precomputed tables.
+			 * If there are only a few measured qubits and enough shots to fill it, the counts are accumulated in a flat histogram instead of a hash map.
+			 * The state must be saved to the internal storage before calling this (for qiskit aer the amplitudes are there).
+			 *
+			 * @param qubits The qubits to measure.
+			 * @param shots The number of shots.
+			 * @return The counts of the outcomes, the first qubit result is the least significant bit.
+			 */
+			std::unordered_map<Types::qubit_t, Types::qubit_t> SampleCountsBatched(const Types::qubits_vector& qubits, size_t shots)
+			{
+				struct SampledSimulator
+				{
+					const Utils::Alias* alias;
+					Utils::BitScatter scatter;
+				};
+
+				std::vector<SampledSimulator> sampled;
+				for (auto& [id, simulator] : simulators)
+				{
+					std::vector<std::pair<size_t, size_t>> bitsMap;
+					for (size_t i = 0; i < qubits.size(); ++i)
+						if (qubitsMap.at(qubits[i]) == id)
+							bitsMap.emplace_back(simulator->GetQubitsMap().at(qubits[i]), i);
+
+					if (bitsMap.empty()) continue;
+
+					simulator->InitializeAlias();
+					sampled.push_back({ simulator->alias.get(), Utils::BitScatter(bitsMap) });
+				}
+
+				std::unordered_map<Types::qubit_t, Types::qubit_t> result;
+				if (sampled.empty())
+				{
+					result[0] = shots;
+					return result;
+				}
+
+				const int nrThreads = enableMultithreading && shots > ParallelSamplingLimit ? QC::QubitRegister<>::GetNumberOfThreads() : 1;
+				// a histogram is allocated and scanned for each thread, worth it only if the shots are not much fewer than its size
+				const bool useHistogram = qubits.size() <= HistogramMaxQubits && (shots / nrThreads) * HistogramShotsFactor >= (1ULL << qubits.size());
+				const size_t histogramSize = useHistogram ? 1ULL << qubits.size() : 0;
+
+				std::vector<uint64_t> seeds(nrThreads);
+				for (auto& seed : seeds)
+					seed = rng();
+
+				std::vector<std::vector<Types::qubit_t>> histograms(useHistogram ? nrThreads : 0);
+				std::vector<std::unordered_map<Types::qubit_t, Types::qubit_t>> partialResults(useHistogram ? 0 : nrThreads);
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static, 1) if (nrThreads > 1)
+				for (int t = 0; t < nrThreads; ++t)
+				{
+					std::mt19937_64 gen(seeds[t]);
+					std::uniform_real_distribution<double> uniformZeroOne(0., 1.);
+
+					if (useHistogram) histograms[t].resize(histogramSize, 0);
+
+					const size_t start = shots * t / nrThreads;
+					const size_t end = shots * (t + 1) / nrThreads;
+
+					std::vector<Types::qubit_t> meas(std::min(SamplingBlockSize, end - start));
+
+					for (size_t blockStart = start; blockStart < end; blockStart += SamplingBlockSize)
+					{
+						const size_t cnt = std::min(SamplingBlockSize, end - blockStart);
+						std::fill(meas.begin(), meas.begin() + cnt, 0);
+
+						for (const auto& sim : sampled)
+							for (size_t i = 0; i < cnt; ++i)
+								meas[i] |= sim.scatter.Scatter(sim.alias->Sample(1. - uniformZeroOne(gen))); // this excludes 0 as probability
+
+						if (useHistogram)
+						{
+							auto& histogram = histograms[t];
+							for (size_t i = 0; i < cnt; ++i)
+								++histogram[meas[i]];
+						}
+						else
+						{
+							auto& partial = partialResults[t];
+							for (size_t i = 0; i < cnt; ++i)
+								++partial[meas[i]];
+						}
+					}
+				}
+
+				if (useHistogram)
+				{
+					auto& histogram = histograms[0];
+					for (int t = 1; t < nrThreads; ++t)
+						for (size_t i = 0; i < histogramSize; ++i)
+							histogram[i] += histograms[t][i];
+
+					for (size_t i = 0; i < histogramSize; ++i)
+						if (histogram[i])
+							result[i] = histogram[i];
+				}
+				else
+				{
+					result.swap(partialResults[0]);
+					for (int t = 1; t < nrThreads; ++t)
+						for (const auto& [meas, cnt] : partialResults[t])
+							result[meas] += cnt;
+				}
+
+				return result;
+			}
+
 			void InitializeAlias()
 			{
 				for (auto& [id, simulator] : simulators)
@@ -1224,6 +1376,13 @@ namespace Simulators {
 			bool enableMultithreading = true;           /**< A flag to indicate if multithreading should be enabled. */
 
 			std::unique_ptr<ISimulator> savedState; /**< The saved state, if any. */
+
+			std::mt19937_64 rng{ std::random_device{}() }; /**< The generator for the seeds of the sampling threads */
+
+			constexpr static size_t ParallelSamplingLimit = 16384; /**< Below this number of shots, sampling is done on a single thread */
+			constexpr static size_t HistogramMaxQubits = 20; /**< Up to this number of measured qubits, the counts are accumulated in a flat histogram */
+			constexpr static size_t HistogramShotsFactor = 4; /**< The flat histogram is used only if the shots per thread times this factor reach the histogram size */
+			constexpr static size_t SamplingBlockSize = 1024; /**< The number of shots sampled in one go for each simulator */
 		};
 
 	}
@@ -81,7 +81,7 @@ namespace Simulators {
 			auto sim = std::make_shared<Private::QCSimSimulator>();
 			if (m == SimulationType::kMatrixProductState)
 				sim->Configure("method", "matrix_product_state");
-			else if (m == SimulationType::kStabilizer)
+			else if (m == SimulationType::kStabilizer || m == SimulationType::kPauliFrame)
 				sim->Configure("method", "stabilizer");
 			else if (m == SimulationType::kTensorNetwork)
 				sim->Configure("method", "tensor_network");
@@ -94,7 +94,7 @@ namespace Simulators {
 			auto sim = std::make_shared<Private::AerSimulator>();
 			if (m == SimulationType::kMatrixProductState)
 				sim->Configure("method", "matrix_product_state");
-			else if (m == SimulationType::kStabilizer)
+			else if (m == SimulationType::kStabilizer || m == SimulationType::kPauliFrame)
 				sim->Configure("method", "stabilizer");
 			else if (m == SimulationType::kTensorNetwork)
 				sim->Configure("method", "tensor_network");
@@ -139,7 +139,7 @@ namespace Simulators {
 			auto sim = std::make_unique<Private::QCSimSimulator>();
 			if (m == SimulationType::kMatrixProductState)
 				sim->Configure("method", "matrix_product_state");
-			else if (m == SimulationType::kStabilizer)
+			else if (m == SimulationType::kStabilizer || m == SimulationType::kPauliFrame)
 				sim->Configure("method", "stabilizer");
 			else if (m == SimulationType::kTensorNetwork)
 				sim->Configure("method", "tensor_network");
@@ -152,7 +152,7 @@ namespace Simulators {
 			auto sim = std::make_unique<Private::AerSimulator>();
 			if (m == SimulationType::kMatrixProductState)
 				sim->Configure("method", "matrix_product_state");
-			else if (m == SimulationType::kStabilizer)
+			else if (m == SimulationType::kStabilizer || m == SimulationType::kPauliFrame)
 				sim->Configure("method", "stabilizer");
 			else if (m == SimulationType::kTensorNetwork)
 				sim->Configure("method", "tensor_network");
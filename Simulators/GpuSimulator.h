@@ -590,6 +590,19 @@ namespace Simulators {
 				NotifyObservers({ tgt_qubit, ctrl_qubit });
 			}
 
+			/**
+			 * @brief Applies a gate given by a dense matrix to the qubits
+			 *
+			 * Applies a gate given by its matrix to the specified qubits.
+			 * Not supported by the gpu simulator, the gpu library has no kernel for it.
+			 * @param qubits The qubits the gate is applied to
+			 * @param matrix The matrix of the gate, row major, qubits[0] corresponding to the least significant bit of the indices
+			 */
+			void ApplyMatrix(const Types::qubits_vector& qubits, const std::vector<std::complex<double>>& matrix) override
+			{
+				throw std::runtime_error("GpuSimulator::ApplyMatrix: Gates given by matrices are not supported.");
+			}
+
 			/**
 			 * @brief Applies a nop
 			 *
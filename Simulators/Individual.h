@@ -16,6 +16,7 @@
 #include <unordered_map>
 #include "Factory.h"
 #include "../Utils/Alias.h"
+#include "../Utils/AmplitudeKernels.h"
 
 namespace Simulators {
 
@@ -77,10 +78,9 @@ namespace Simulators {
 			 */
 			inline void Join(size_t simId, const std::unique_ptr<IndividualSimulator>& other, std::vector<size_t>& qubitsMapToSim, bool enableMultithreading)
 			{
-				// 1. grab the state of both simulators (in the first phase, using Amplitude, but maybe something faster can be done)
+				// 1. grab the state of both simulators (the amplitudes buffers)
 				// 2. join the states by a tensor product
 				const size_t nrQubits1 = GetNumberOfQubits();
-				const size_t nrBasisStates1 = 1ULL << nrQubits1;
 				const size_t nrQubits2 = other->GetNumberOfQubits();
 				const size_t nrBasisStates2 = 1ULL << nrQubits2;
 
@@ -90,56 +90,30 @@ namespace Simulators {
 				SaveStateToInternalDestructive();
 				other->SaveStateToInternalDestructive();
 
+				// work directly on the amplitudes buffers, no virtual call per amplitude
+				const int nrThreads = enableMultithreading && nrBasisStates > OmpLimitJoin ? processor_count : 1;
+
+				// 3. set the state of the current simulator to the joined state
+				// the original qubits of this simulator get mapped as they are
+				// the other ones get shifted to the left by the number of qubits of this simulator
+				// so transfer mapping keeping this in mind
 				if (GetType() == SimulatorType::kQCSim)
 				{
-					if (enableMultithreading && nrBasisStates > OmpLimitJoin)
-						JoinOmpQcsim(nrQubits1, nrBasisStates1, nrBasisStates2, newNrQubits, nrBasisStates, other, enableMultithreading);
-					else
-					{
-						Eigen::VectorXcd newAmplitudes;
-						newAmplitudes.resize(nrBasisStates);
-
-						for (size_t state2 = 0; state2 < nrBasisStates2; ++state2)
-						{
-							const auto ampl2 = other->AmplitudeRaw(state2);
-							const size_t state2Mask = state2 << nrQubits1;
-							for (size_t state1 = 0; state1 < nrBasisStates1; ++state1)
-								newAmplitudes[state2Mask | state1] = AmplitudeRaw(state1) * ampl2;
-						}
-
-						// 3. set the state of the current simulator to the joined state
-						// the original qubits of this simulator get mapped as they are
-						// the other ones get shifted to the left by the number of qubits of this simulator
-						// so transfer mapping keeping this in mind
-
-						//simulator->SetMultithreading(enableMultithreading);
-						simulator->InitializeState(newNrQubits, newAmplitudes); // this will end up by swapping the data from newAmplitudes to the simulator, no allocation and copying is done
-					}
+					Eigen::VectorXcd newAmplitudes;
+					newAmplitudes.resize(nrBasisStates);
+
+					Utils::JoinAmplitudes(GetRawAmplitudes(), nrQubits1, other->GetRawAmplitudes(), nrBasisStates2, newAmplitudes.data(), nrThreads);
+
+					simulator->InitializeState(newNrQubits, newAmplitudes); // this will end up by swapping the data from newAmplitudes to the simulator, no allocation and copying is done
 				}
 #ifndef NO_QISKIT_AER
 				else
 				{
-					if (enableMultithreading && nrBasisStates > OmpLimitJoin)
-						JoinOmpAer(nrQubits1, nrBasisStates1, nrBasisStates2, newNrQubits, nrBasisStates, other, enableMultithreading);
-					else
-					{
-						AER::Vector<std::complex<double>> newAmplitudes(nrBasisStates, false); // the false here avoids data initialization, it will be set anyway
-
-						for (size_t state2 = 0; state2 < nrBasisStates2; ++state2)
-						{
-							const auto ampl2 = other->AmplitudeRaw(state2);
-							const size_t state2Mask = state2 << nrQubits1;
-							for (size_t state1 = 0; state1 < nrBasisStates1; ++state1)
-								newAmplitudes[state2Mask | state1] = AmplitudeRaw(state1) * ampl2;
-						}
-
-						// 3. set the state of the current simulator to the joined state
-						// the original qubits of this simulator get mapped as they are
-						// the other ones get shifted to the left by the number of qubits of this simulator
-						// so transfer mapping keeping this in mind
-						//simulator->SetMultithreading(enableMultithreading);
-						simulator->InitializeState(newNrQubits, newAmplitudes); // this will move the data from newAmplitudes to the simulator, no allocation and copying is done
-					}
+					AER::Vector<std::complex<double>> newAmplitudes(nrBasisStates, false); // the false here avoids data initialization, it will be set anyway
+
+					Utils::JoinAmplitudes(GetRawAmplitudes(), nrQubits1, other->GetRawAmplitudes(), nrBasisStates2, newAmplitudes.data(), nrThreads);
+
+					simulator->InitializeState(newNrQubits, newAmplitudes); // this will move the data from newAmplitudes to the simulator, no allocation and copying is done
 				}
 #endif
 
@@ -188,66 +162,27 @@ namespace Simulators {
 				
 				SaveStateToInternalDestructive();
 
+				// work directly on the amplitudes buffers, no virtual call per amplitude
+				const int nrThreads = enableMultithreading && nrBasisStates > OmpLimitSplit ? processor_count : 1;
+
+				// now the adjusted current simulator, without the removed qubit
 				if (GetType() == SimulatorType::kQCSim)
 				{
-					/*
-					if (nrBasisStates > OmpLimitSplit) // parallelization for assignment and some bit manipulations, I must do some benchmarks to see if it's worth it and find where the limit is
-						SplitOmpQcsim(localQubit, newNrQubits, nrBasisStates, qubitOutcome);
-					else
-					*/
-					{
-						// now the adjusted current simulator, without the removed qubit
-						Eigen::VectorXcd newAmplitudes;
-						newAmplitudes.resize(nrBasisStates);
-
-						// compute the new amplitudes
-
-						const size_t localQubitMask = 1ULL << localQubit;
-						const size_t maskLow = localQubitMask - 1ULL;
-						const size_t maskHigh = ~maskLow;
-						const size_t qubitMask = qubitOutcome ? localQubitMask : 0ULL;
-
-						for (size_t state = 0; state < nrBasisStates; ++state)
-						{
-							const size_t stateLow = state & maskLow;
-							const size_t stateHigh = (state & maskHigh) << 1ULL;
-
-							newAmplitudes[state] = AmplitudeRaw(stateLow | stateHigh | qubitMask);
-						}
-
-						//simulator->SetMultithreading(enableMultithreading);
-						simulator->InitializeState(newNrQubits, newAmplitudes); // this will end up by swapping the data from newAmplitudes to the simulator, no allocation and copying is done
-					}
+					Eigen::VectorXcd newAmplitudes;
+					newAmplitudes.resize(nrBasisStates);
+
+					Utils::SplitAmplitudes(GetRawAmplitudes(), newAmplitudes.data(), nrBasisStates, localQubit, qubitOutcome, nrThreads);
+
+					simulator->InitializeState(newNrQubits, newAmplitudes); // this will end up by swapping the data from newAmplitudes to the simulator, no allocation and copying is done
 				}
 #ifndef NO_QISKIT_AER
 				else
 				{
-					/*
-					if (nrBasisStates > OmpLimitSplit) // parallelization for assignment and some bit manipulations, I must do some benchmarks to see if it's worth it and find where the limit is
-						SplitOmpAer(localQubit, newNrQubits, nrBasisStates, qubitOutcome);
-					else
-					*/
-					{
-						// now the adjusted current simulator, without the removed qubit
-						AER::Vector<std::complex<double>> newAmplitudes(nrBasisStates, false); // the false here avoids data initialization, it will be set anyway
-
-						// compute the new amplitudes
-						const size_t localQubitMask = 1ULL << localQubit;
-						const size_t maskLow = localQubitMask - 1ULL;
-						const size_t maskHigh = ~maskLow;
-						const size_t qubitMask = qubitOutcome ? localQubitMask : 0ULL;
-
-						for (size_t state = 0; state < nrBasisStates; ++state)
-						{
-							const size_t stateLow = state & maskLow;
-							const size_t stateHigh = (state & maskHigh) << 1ULL;
-
-							newAmplitudes[state] = AmplitudeRaw(stateLow | stateHigh | qubitMask);
-						}
-
-						//simulator->SetMultithreading(enableMultithreading);
-						simulator->InitializeState(newNrQubits, newAmplitudes); // this will move the data from newAmplitudes to the simulator, no allocation and copying is done
-					}
+					AER::Vector<std::complex<double>> newAmplitudes(nrBasisStates, false); // the false here avoids data initialization, it will be set anyway
+
+					Utils::SplitAmplitudes(GetRawAmplitudes(), newAmplitudes.data(), nrBasisStates, localQubit, qubitOutcome, nrThreads);
+
+					simulator->InitializeState(newNrQubits, newAmplitudes); // this will move the data from newAmplitudes to the simulator, no allocation and copying is done
 				}
 #endif
 
@@ -697,6 +632,28 @@ namespace Simulators {
 				return simulator->ExpectationValue(pauliString);
 			}
 
+			/**
+			 * @brief Returns the expected values of a batch of Pauli strings.
+			 *
+			 * @param pauliStrings The Pauli strings to obtain the expected values for.
+			 * @return The expected values of the specified Pauli strings, in the same order.
+			 */
+			std::vector<double> ExpectationValues(const std::vector<std::string>& pauliStrings) override
+			{
+				return simulator->ExpectationValues(pauliStrings);
+			}
+
+			/**
+			 * @brief Returns the expected values of a batch of parsed Pauli strings.
+			 *
+			 * @param paulis The Pauli strings to obtain the expected values for.
+			 * @return The expected values of the specified Pauli strings, in the same order.
+			 */
+			std::vector<double> ExpectationValues(const std::vector<Utils::PauliString>& paulis) override
+			{
+				return simulator->ExpectationValues(paulis);
+			}
+
 			/**
 			 * @brief Returns the type of simulator.
 			 *
@@ -1098,6 +1055,22 @@ namespace Simulators {
 				simulator->ApplyCU(qubitsMap[ctrl_qubit], qubitsMap[tgt_qubit], theta, phi, lambda, gamma);
 			}
 
+			/**
+			 * @brief Applies a gate given by a dense matrix to the qubits
+			 *
+			 * Applies a gate given by its matrix to the specified qubits.
+			 * @param qubits The qubits the gate is applied to
+			 * @param matrix The matrix of the gate, row major, qubits[0] corresponding to the least significant bit of the indices
+			 */
+			void ApplyMatrix(const Types::qubits_vector& qubits, const std::vector<std::complex<double>>& matrix) override
+			{
+				Types::qubits_vector mappedQubits(qubits.size());
+				for (size_t i = 0; i < qubits.size(); ++i)
+					mappedQubits[i] = qubitsMap[qubits[i]];
+
+				simulator->ApplyMatrix(mappedQubits, matrix);
+			}
+
 			void ApplyNop() override
 			{
 				simulator->ApplyNop();
@@ -1141,7 +1114,11 @@ namespace Simulators {
 			 */
 			bool IsQcsim() const override
 			{
+#ifdef NO_QISKIT_AER
+				return false;
+#else
 				return GetType() == Simulators::SimulatorType::kQiskitAer;
+#endif
 			}
 
 			/**
@@ -1190,12 +1167,14 @@ namespace Simulators {
 					QCSimSimulator* qcsim = dynamic_cast<QCSimSimulator*>(simulator.get());
 					prob = 1. - qcsim->uniformZeroOne(qcsim->rng);
 				}
+#ifndef NO_QISKIT_AER
 				else
 				{
 					// qiskit aer - convert 'simulator' to qiskit aer simulator and access 'savedAmplitudes' (assumes destructive saving of the state)
 					AerSimulator* aer = dynamic_cast<AerSimulator*>(simulator.get());
 					prob = 1 - aer->uniformZeroOne(aer->rng);
 				}
+#endif
 
 				const size_t measRaw = alias->Sample(prob);
 
@@ -1211,15 +1190,17 @@ namespace Simulators {
 					// qcsim - convert 'simulator' to qcsim simulator and access 'state' (from there the statevector is accessible)
 					QCSimSimulator* qcsim = dynamic_cast<QCSimSimulator*>(simulator.get());
 
-					alias = std::unique_ptr<Utils::Alias>(new Utils::Alias(qcsim->state->getRegisterStorage()));
+					alias = std::unique_ptr<Utils::Alias>(new Utils::Alias(qcsim->state->getRegisterStorage(), processor_count));
 				}
+#ifndef NO_QISKIT_AER
 				else
 				{
 					// qiskit aer - convert 'simulator' to qiskit aer simulator and access 'savedAmplitudes' (assumes destructive saving of the state)
 					AerSimulator* aer = dynamic_cast<AerSimulator*>(simulator.get());
 
-					alias = std::unique_ptr<Utils::Alias>(new Utils::Alias(aer->savedAmplitudes));
+					alias = std::unique_ptr<Utils::Alias>(new Utils::Alias(aer->savedAmplitudes, processor_count));
 				}
+#endif
 			}
 
 			void ClearAlias()
@@ -1228,164 +1209,28 @@ namespace Simulators {
 			}
 
 			/**
-			 * @brief Join helper function for joining with open mp
-			 * 
-			 * Join helper function for joining with open mp, for the aer simulators
+			 * @brief Get the amplitudes buffer of the simulator.
 			 *
-			 * @param nrQubits1 The number of qubits of the first simulator.
-			 * @param nrBasisStates1 The number of basis states of the first simulator.
-			 * @param nrBasisStates2 The number of basis states of the second simulator.
-			 * @param newNrQubits The number of qubits of the joined simulator.
-			 * @param nrBasisStates The number of basis states of the joined simulator.
-			 * @param other The other simulator to join with.
-			 */
-#ifndef NO_QISKIT_AER
-			inline void JoinOmpAer(size_t nrQubits1, size_t nrBasisStates1, size_t nrBasisStates2, size_t newNrQubits, size_t nrBasisStates, const std::unique_ptr<IndividualSimulator>& other, bool enableMultithreading)
-			{
-				AER::Vector<std::complex<double>> newAmplitudes(nrBasisStates, false); // the false here avoids data initialization, it will be set anyway
-
-				/*
-				const size_t state1Mask = nrBasisStates1 - 1ULL;
-
-#pragma omp parallel for num_threads(processor_count) schedule(static, OmpLimitJoin / divSchedule)
-				for (long long int state = 0; state < static_cast<long long int>(nrBasisStates); ++state)
-					newAmplitudes[state] = AmplitudeRaw(state & state1Mask) * other->AmplitudeRaw(state >> nrQubits1);
-				*/
-
-				// TODO: check if this is better
-#pragma omp parallel for num_threads(processor_count)
-				for (long long int state2 = 0; state2 < static_cast<long long int>(nrBasisStates2); ++state2)
-				{
-					const auto ampl2 = other->AmplitudeRaw(state2);
-					const size_t state2Mask = state2 << nrQubits1;
-					for (size_t state1 = 0; state1 < nrBasisStates1; ++state1)
-						newAmplitudes[state2Mask | state1] = AmplitudeRaw(state1) * ampl2;
-				}
-				
-
-				// 3. set the state of the current simulator to the joined state
-				// the original qubits of this simulator get mapped as they are
-				// the other ones get shifted to the left by the number of qubits of this simulator
-				// so transfer mapping keeping this in mind
-				//simulator->SetMultithreading(enableMultithreading);
-				simulator->InitializeState(newNrQubits, newAmplitudes); // this will move the data from newAmplitudes to the simulator, no allocation and copying is done
-			}
-#endif
-
-			/**
-			 * @brief Split helper function for splitting with open mp
-			 *
-			 * Split helper function for splitting with open mp, for the aer simulators
-	         *
-			 * @param localQubit The qubit to split out.
-			 * @param newNrQubits The number of qubits of the new simulator.
-			 * @param nrBasisStates The number of basis states of the new simulator.
-			 * @param qubitOutcome The outcome of the qubit to split out.
-			 */
-			/*
-			inline void SplitOmpAer(size_t localQubit, size_t newNrQubits, size_t nrBasisStates, bool qubitOutcome = false)
-			{
-				// now the adjusted current simulator, without the removed qubit
-				AER::Vector<std::complex<double>> newAmplitudes(nrBasisStates, false); // the false here avoids data initialization, it will be set anyway
-
-				// compute the new amplitudes
-
-				const size_t localQubitMask = 1ULL << localQubit;
-				const size_t maskLow = localQubitMask - 1ULL;
-				const size_t maskHigh = ~maskLow;
-				const size_t qubitMask = qubitOutcome ? localQubitMask : 0ULL;
-
-#pragma omp parallel for num_threads(processor_count) schedule(static, OmpLimitSplit / divSchedule)
-				for (long long int state = 0; state < static_cast<long long int>(nrBasisStates); ++state)
-				{
-					const size_t stateLow = state & maskLow;
-					const size_t stateHigh = (state & maskHigh) << 1ULL;
-
-					newAmplitudes[state] = AmplitudeRaw(stateLow | stateHigh | qubitMask);
-				}
-
-				simulator->InitializeState(newNrQubits, newAmplitudes); // this will move the data from newAmplitudes to the simulator, no allocation and copying is done
-			}
-			*/
-
-			/**
-			 * @brief Join helper function for joining with open mp
-			 *
-			 * Join helper function for joining with open mp, for the qcsim simulators
+			 * Call SaveStateToInternalDestructive before, for qiskit aer the amplitudes are in the saved state.
 			 *
-			 * @param nrQubits1 The number of qubits of the first simulator.
-			 * @param nrBasisStates1 The number of basis states of the first simulator.
-			 * @param nrBasisStates2 The number of basis states of the second simulator.
-			 * @param newNrQubits The number of qubits of the joined simulator.
-			 * @param nrBasisStates The number of basis states of the joined simulator.
-			 * @param other The other simulator to join with.
-			 */
-			inline void JoinOmpQcsim(size_t nrQubits1, size_t nrBasisStates1, size_t nrBasisStates2, size_t newNrQubits, size_t nrBasisStates, const std::unique_ptr<IndividualSimulator>& other, bool enableMultithreading)
-			{
-				Eigen::VectorXcd newAmplitudes;
-				newAmplitudes.resize(nrBasisStates);
-				
-				/*
-				const size_t state1Mask = nrBasisStates1 - 1ULL;
-
-#pragma omp parallel for num_threads(processor_count) schedule(static, OmpLimitJoin / divSchedule)
-				for (long long int state = 0; state < static_cast<long long int>(nrBasisStates); ++state)
-					newAmplitudes[state] = AmplitudeRaw(state & state1Mask) * other->AmplitudeRaw(state >> nrQubits1);
-				*/
-
-				// TODO: check if this is better
-#pragma omp parallel for num_threads(processor_count)
-				for (long long int state2 = 0; state2 < static_cast<long long int>(nrBasisStates2); ++state2)
-				{
-					const auto ampl2 = other->AmplitudeRaw(state2);
-					const size_t state2Mask = state2 << nrQubits1;
-					for (size_t state1 = 0; state1 < nrBasisStates1; ++state1)
-						newAmplitudes[state2Mask | state1] = AmplitudeRaw(state1) * ampl2;
-				}
-
-				// 3. set the state of the current simulator to the joined state
-				// the original qubits of this simulator get mapped as they are
-				// the other ones get shifted to the left by the number of qubits of this simulator
-				// so transfer mapping keeping this in mind
-				//simulator->SetMultithreading(enableMultithreading);
-				simulator->InitializeState(newNrQubits, newAmplitudes); // this will end up by swapping the data from newAmplitudes to the simulator, no allocation and copying is done
-			}
-
-			/**
-			 * @brief Split helper function for splitting with open mp
-			 *
-			 * Split helper function for splitting with open mp, for the qcsim simulators
-			 *
-			 * @param localQubit The qubit to split out.
-			 * @param newNrQubits The number of qubits of the new simulator.
-			 * @param nrBasisStates The number of basis states of the new simulator.
-			 * @param qubitOutcome The outcome of the qubit to split out.
+			 * @return A pointer to the amplitudes.
 			 */
-			/*
-			inline void SplitOmpQcsim(size_t localQubit, size_t newNrQubits, size_t nrBasisStates, bool qubitOutcome = false)
+			const std::complex<double>* GetRawAmplitudes() const
 			{
-				// now the adjusted current simulator, without the removed qubit
-				Eigen::VectorXcd newAmplitudes;
-				newAmplitudes.resize(nrBasisStates);
-
-				// compute the new amplitudes
-				const size_t localQubitMask = 1ULL << localQubit;
-				const size_t maskLow = localQubitMask - 1ULL;
-				const size_t maskHigh = ~maskLow;
-				const size_t qubitMask = qubitOutcome ? localQubitMask : 0ULL;
-
-#pragma omp parallel for num_threads(processor_count) schedule(static, OmpLimitSplit / divSchedule)
-				for (long long int state = 0; state < static_cast<long long int>(nrBasisStates); ++state)
+#ifndef NO_QISKIT_AER
+				if (GetType() != SimulatorType::kQCSim)
 				{
-					const size_t stateLow = state & maskLow;
-					const size_t stateHigh = (state & maskHigh) << 1ULL;
+					// qiskit aer - convert 'simulator' to qiskit aer simulator and access 'savedAmplitudes' (assumes destructive saving of the state)
+					const AerSimulator* aer = dynamic_cast<const AerSimulator*>(simulator.get());
 
-					newAmplitudes[state] = AmplitudeRaw(stateLow | stateHigh | qubitMask);
+					return aer->savedAmplitudes.data();
 				}
+#endif
+				// qcsim - convert 'simulator' to qcsim simulator and access 'state' (from there the statevector is accessible)
+				const QCSimSimulator* qcsim = dynamic_cast<const QCSimSimulator*>(simulator.get());
 
-				simulator->InitializeState(newNrQubits, newAmplitudes); // this will end up by swapping the data from newAmplitudes to the simulator, no allocation and copying is done
+				return qcsim->state->getRegisterStorage().data();
 			}
-			*/
 
 			std::unordered_map<Types::qubit_t, Types::qubit_t> qubitsMap; /**< A map between qubits (as identified from outside) and the qubits from the actual simulator */
 			std::unique_ptr<ISimulator> simulator;        /**< The actual simulator to use */
@@ -1395,9 +1240,9 @@ namespace Simulators {
 
 			int processor_count = QC::QubitRegister<>::GetNumberOfThreads(); /**< The number of processors to use for parallelization */
 
-			//constexpr static int divSchedule = 4;
-			constexpr static size_t OmpLimitJoin = 4096 * 2;
-			//constexpr static size_t OmpLimitSplit = OmpLimitJoin * 16;
+			// the kernels are memory bound, below these sizes the threads startup costs more than it saves
+			constexpr static size_t OmpLimitJoin = 4096 * 16;
+			constexpr static size_t OmpLimitSplit = 4096 * 32;
 		};
 	
 	}
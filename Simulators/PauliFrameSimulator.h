@@ -0,0 +1,448 @@
+/**
+ * @file PauliFrameSimulator.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The Pauli frames simulator, for executing many shots of Clifford circuits with mid-circuit measurements, resets and conditional Pauli gates.
+ *
+ * The circuit is executed once on a stabilizer simulator, to obtain a reference execution.
+ * Each shot differs from the reference by a Pauli operator (the frame), which is propagated through the Clifford gates.
+ * The frames of 64 shots are packed in a word for each qubit, so a gate is a few word operations for 64 shots, with no tableau involved.
+ */
+
+#pragma once
+
+#ifndef _PAULI_FRAME_SIMULATOR_H_
+#define _PAULI_FRAME_SIMULATOR_H_
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+#include "../Circuit/Circuit.h"
+
+namespace Simulators {
+
+	/**
+	 * @class PauliFrameSimulator
+	 * @brief Executes many shots of a Clifford circuit by propagating Pauli frames relative to a reference execution.
+	 *
+	 * The frame of a shot is a Pauli operator, only the X and Z bits are needed, the sign does not matter.
+	 * The outcome of a measurement is the reference outcome flipped by the X bit of the frame.
+	 * The Z bits are randomized at the start and after measurements and resets, where the qubit is in a Z eigenstate and a Z does not change it.
+	 * This gives the random outcomes of the later measurements that do not commute with the previous ones, as in a stabilizer simulation.
+	 * A conditional Pauli gate is applied to the frames of the shots for which the condition is met differently than in the reference.
+	 *
+	 * The supported operations are the Clifford gates (except the conditional ones that are not Pauli gates), measurements and resets.
+	 *
+	 * @tparam Time The time type used for operation timing.
+	 * @sa IsSupported
+	 */
+	template<typename Time = Types::time_type> class PauliFrameSimulator
+	{
+	public:
+		constexpr static size_t BitsPerWord = 64; /**< The number of shots in a word */
+		constexpr static size_t MaxWordsPerBatch = 8; /**< The maximum number of words of shots propagated together, 512 shots */
+
+		/**
+		 * @brief Construct the simulator.
+		 *
+		 * The operations are translated to frame operations once, the circuit must be supported.
+		 *
+		 * @param circuit The circuit to execute.
+		 * @param nrQubits The number of qubits.
+		 * @param nrCbits The number of classical bits.
+		 * @sa IsSupported
+		 */
+		PauliFrameSimulator(const std::shared_ptr<Circuits::Circuit<Time>>& circuit, size_t nrQubits, size_t nrCbits)
+			: nrQubits(nrQubits), nrCbits(nrCbits), rng(std::random_device{}())
+		{
+			for (const auto& op : circuit->GetOperations())
+				steps.emplace_back(MakeStep(op));
+		}
+
+		/**
+		 * @brief Check if the circuit can be executed with Pauli frames.
+		 *
+		 * @param circuit The circuit to check.
+		 * @return True if all the operations are supported, false otherwise.
+		 */
+		static bool IsSupported(const Circuits::Circuit<Time>& circuit)
+		{
+			for (const auto& op : circuit.GetOperations())
+			{
+				switch (op->GetType())
+				{
+				case Circuits::OperationType::kGate:
+					if (!op->IsClifford() || GetStepType(op) == StepType::kUnsupported)
+						return false;
+					break;
+				case Circuits::OperationType::kConditionalGate:
+				{
+					const auto condOp = std::static_pointer_cast<Circuits::IConditionalOperation<Time>>(op);
+					if (!std::dynamic_pointer_cast<Circuits::EqualCondition>(condOp->GetCondition()) || !condOp->GetOperation())
+						return false;
+
+					const auto stepType = GetStepType(condOp->GetOperation());
+					if (stepType != StepType::kPauliX && stepType != StepType::kPauliY && stepType != StepType::kPauliZ)
+						return false;
+				}
+				break;
+				case Circuits::OperationType::kMeasurement:
+				case Circuits::OperationType::kReset:
+				case Circuits::OperationType::kNoOp:
+					break;
+				default:
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Seed the random numbers generator.
+		 *
+		 * @param seed The seed.
+		 */
+		void Seed(uint64_t seed)
+		{
+			rng.seed(seed);
+		}
+
+		/**
+		 * @brief Execute the reference shot.
+		 *
+		 * Executes the circuit once on the passed simulator, recording the measurement outcomes and the conditions that were met.
+		 *
+		 * @param sim The stabilizer simulator, with the qubits allocated and initialized.
+		 */
+		void ExecuteReference(const std::shared_ptr<ISimulator>& sim)
+		{
+			Circuits::OperationState state;
+			state.AllocateBits(nrCbits);
+
+			for (auto& step : steps)
+			{
+				if (step.type == StepType::kConditionalPauli)
+					step.referenceMet = step.condition->IsConditionMet(state);
+
+				step.op->Execute(sim, state);
+
+				if (step.type == StepType::kMeasure)
+					step.referenceBits = state.GetBits(step.bits);
+			}
+
+			hasReference = true;
+		}
+
+		bool HasReference() const
+		{
+			return hasReference;
+		}
+
+		/**
+		 * @brief Execute shots.
+		 *
+		 * The shots are executed in batches of up to 512, the frames of a batch being propagated together.
+		 *
+		 * @param shots The number of shots.
+		 * @param addShot Called with the classical bits of each shot.
+		 */
+		template<class F> void ExecuteShots(size_t shots, F&& addShot)
+		{
+			std::vector<bool> bits(nrCbits);
+
+			while (shots > 0)
+			{
+				const size_t nrWords = std::min(MaxWordsPerBatch, (shots + BitsPerWord - 1) / BitsPerWord);
+				const size_t batchShots = std::min(shots, nrWords * BitsPerWord);
+
+				ExecuteBatch(nrWords);
+
+				for (size_t shot = 0; shot < batchShots; ++shot)
+				{
+					const size_t word = shot / BitsPerWord;
+					const size_t bit = shot % BitsPerWord;
+
+					for (size_t b = 0; b < nrCbits; ++b)
+						bits[b] = (cbits[b * nrWords + word] >> bit) & 1;
+
+					addShot(bits);
+				}
+
+				shots -= batchShots;
+			}
+		}
+
+	private:
+		/**
+		 * @brief The frame operation for a circuit operation.
+		 */
+		enum class StepType {
+			kNone,              /**< nothing to do on frames, the Pauli gates, for example */
+			kHadamard,          /**< swaps X and Z */
+			kPhase,             /**< Z ^= X, for S, Sdg */
+			kSqrtX,             /**< X ^= Z, for Sx, SxDag, K */
+			kPauliX,            /**< a Pauli X, only relevant if conditional */
+			kPauliY,            /**< a Pauli Y, only relevant if conditional */
+			kPauliZ,            /**< a Pauli Z, only relevant if conditional */
+			kSwap,              /**< swaps the frames of two qubits */
+			kCX,                /**< controlled X */
+			kCY,                /**< controlled Y */
+			kCZ,                /**< controlled Z */
+			kMeasure,           /**< measurement */
+			kReset,             /**< reset */
+			kConditionalPauli,  /**< a conditional Pauli gate */
+			kUnsupported        /**< cannot be executed on frames */
+		};
+
+		/**
+		 * @brief A frame operation.
+		 */
+		struct Step {
+			StepType type = StepType::kNone; /**< The type */
+			StepType pauli = StepType::kNone; /**< The Pauli gate, for a conditional Pauli */
+			std::shared_ptr<Circuits::IOperation<Time>> op; /**< The circuit operation, for the reference execution */
+			Types::qubits_vector qubits; /**< The qubits */
+			std::vector<size_t> bits; /**< The classical bits, for a measurement */
+			std::vector<bool> referenceBits; /**< The outcomes of the measurement in the reference execution */
+			std::shared_ptr<Circuits::EqualCondition> condition; /**< The condition, for a conditional Pauli */
+			bool referenceMet = false; /**< True if the condition was met in the reference execution */
+		};
+
+		/**
+		 * @brief Get the frame operation type for a gate.
+		 *
+		 * @param op The gate.
+		 * @return The frame operation type.
+		 */
+		static StepType GetStepType(const std::shared_ptr<Circuits::IOperation<Time>>& op)
+		{
+			if (op->GetType() != Circuits::OperationType::kGate)
+				return StepType::kUnsupported;
+
+			const auto gate = std::dynamic_pointer_cast<Circuits::IQuantumGate<Time>>(op);
+			if (!gate) return StepType::kUnsupported;
+
+			switch (gate->GetGateType())
+			{
+			case Circuits::QuantumGateType::kXGateType:
+				return StepType::kPauliX;
+			case Circuits::QuantumGateType::kYGateType:
+				return StepType::kPauliY;
+			case Circuits::QuantumGateType::kZGateType:
+				return StepType::kPauliZ;
+			case Circuits::QuantumGateType::kHadamardGateType:
+				return StepType::kHadamard;
+			case Circuits::QuantumGateType::kPhaseGateType: // it's Clifford only for pi/2, that is, S
+			case Circuits::QuantumGateType::kSGateType:
+			case Circuits::QuantumGateType::kSdgGateType:
+				return StepType::kPhase;
+			case Circuits::QuantumGateType::kSxGateType:
+			case Circuits::QuantumGateType::kSxDagGateType:
+			case Circuits::QuantumGateType::kKGateType:
+				return StepType::kSqrtX;
+			case Circuits::QuantumGateType::kSwapGateType:
+				return StepType::kSwap;
+			case Circuits::QuantumGateType::kCXGateType:
+				return StepType::kCX;
+			case Circuits::QuantumGateType::kCYGateType:
+				return StepType::kCY;
+			case Circuits::QuantumGateType::kCZGateType:
+				return StepType::kCZ;
+			default:
+				break;
+			}
+
+			return StepType::kUnsupported;
+		}
+
+		/**
+		 * @brief Translate a circuit operation to a frame operation.
+		 *
+		 * @param op The circuit operation.
+		 * @return The frame operation.
+		 */
+		static Step MakeStep(const std::shared_ptr<Circuits::IOperation<Time>>& op)
+		{
+			Step step;
+			step.op = op;
+
+			switch (op->GetType())
+			{
+			case Circuits::OperationType::kGate:
+				step.type = GetStepType(op);
+				if (step.type == StepType::kPauliX || step.type == StepType::kPauliY || step.type == StepType::kPauliZ)
+					step.type = StepType::kNone;
+				step.qubits = op->AffectedQubits();
+				break;
+			case Circuits::OperationType::kConditionalGate:
+			{
+				const auto condOp = std::static_pointer_cast<Circuits::IConditionalOperation<Time>>(op);
+				step.type = StepType::kConditionalPauli;
+				step.pauli = GetStepType(condOp->GetOperation());
+				step.condition = std::dynamic_pointer_cast<Circuits::EqualCondition>(condOp->GetCondition());
+				step.qubits = condOp->GetOperation()->AffectedQubits();
+			}
+			break;
+			case Circuits::OperationType::kMeasurement:
+			{
+				const auto measOp = std::static_pointer_cast<Circuits::MeasurementOperation<Time>>(op);
+				step.type = StepType::kMeasure;
+				step.qubits = measOp->GetQubits();
+				step.bits = measOp->GetBitsIndices();
+			}
+			break;
+			case Circuits::OperationType::kReset:
+				step.type = StepType::kReset;
+				step.qubits = std::static_pointer_cast<Circuits::Reset<Time>>(op)->GetQubits();
+				break;
+			default:
+				step.type = StepType::kNone;
+				break;
+			}
+
+			return step;
+		}
+
+		/**
+		 * @brief Propagate the frames of a batch of shots through the circuit.
+		 *
+		 * @param nrWords The number of words of shots.
+		 */
+		void ExecuteBatch(size_t nrWords)
+		{
+			xFrames.assign(nrQubits * nrWords, 0);
+			zFrames.resize(nrQubits * nrWords);
+			cbits.assign(nrCbits * nrWords, 0);
+
+			// the initial state is a Z eigenstate
+			for (auto& word : zFrames)
+				word = rng();
+
+			for (const auto& step : steps)
+			{
+				switch (step.type)
+				{
+				case StepType::kHadamard:
+					for (size_t w = 0; w < nrWords; ++w)
+						std::swap(X(step.qubits[0], w, nrWords), Z(step.qubits[0], w, nrWords));
+					break;
+				case StepType::kPhase:
+					for (size_t w = 0; w < nrWords; ++w)
+						Z(step.qubits[0], w, nrWords) ^= X(step.qubits[0], w, nrWords);
+					break;
+				case StepType::kSqrtX:
+					for (size_t w = 0; w < nrWords; ++w)
+						X(step.qubits[0], w, nrWords) ^= Z(step.qubits[0], w, nrWords);
+					break;
+				case StepType::kSwap:
+					for (size_t w = 0; w < nrWords; ++w)
+					{
+						std::swap(X(step.qubits[0], w, nrWords), X(step.qubits[1], w, nrWords));
+						std::swap(Z(step.qubits[0], w, nrWords), Z(step.qubits[1], w, nrWords));
+					}
+					break;
+				case StepType::kCX:
+					for (size_t w = 0; w < nrWords; ++w)
+						ApplyCX(step.qubits[0], step.qubits[1], w, nrWords);
+					break;
+				case StepType::kCY:
+					// CY = S CX Sdg on the target, S and Sdg are the same on frames
+					for (size_t w = 0; w < nrWords; ++w)
+					{
+						Z(step.qubits[1], w, nrWords) ^= X(step.qubits[1], w, nrWords);
+						ApplyCX(step.qubits[0], step.qubits[1], w, nrWords);
+						Z(step.qubits[1], w, nrWords) ^= X(step.qubits[1], w, nrWords);
+					}
+					break;
+				case StepType::kCZ:
+					for (size_t w = 0; w < nrWords; ++w)
+					{
+						Z(step.qubits[0], w, nrWords) ^= X(step.qubits[1], w, nrWords);
+						Z(step.qubits[1], w, nrWords) ^= X(step.qubits[0], w, nrWords);
+					}
+					break;
+				case StepType::kMeasure:
+					for (size_t i = 0; i < step.qubits.size(); ++i)
+					{
+						const uint64_t reference = step.referenceBits[i] ? ~0ULL : 0ULL;
+						for (size_t w = 0; w < nrWords; ++w)
+						{
+							if (step.bits[i] < nrCbits)
+								cbits[step.bits[i] * nrWords + w] = X(step.qubits[i], w, nrWords) ^ reference;
+							Z(step.qubits[i], w, nrWords) ^= rng();
+						}
+					}
+					break;
+				case StepType::kReset:
+					for (const auto q : step.qubits)
+						for (size_t w = 0; w < nrWords; ++w)
+						{
+							X(q, w, nrWords) = 0;
+							Z(q, w, nrWords) = rng();
+						}
+					break;
+				case StepType::kConditionalPauli:
+				{
+					const auto& indices = step.condition->GetBitsIndices();
+					const auto& values = step.condition->GetAllBits();
+					const uint64_t reference = step.referenceMet ? ~0ULL : 0ULL;
+
+					for (size_t w = 0; w < nrWords; ++w)
+					{
+						uint64_t met = ~0ULL;
+						for (size_t i = 0; i < indices.size(); ++i)
+						{
+							const uint64_t bit = indices[i] < nrCbits ? cbits[indices[i] * nrWords + w] : 0ULL;
+							met &= (i < values.size() && values[i]) ? bit : ~bit;
+						}
+
+						const uint64_t flip = met ^ reference;
+						if (step.pauli != StepType::kPauliZ)
+							X(step.qubits[0], w, nrWords) ^= flip;
+						if (step.pauli != StepType::kPauliX)
+							Z(step.qubits[0], w, nrWords) ^= flip;
+					}
+				}
+				break;
+				default:
+					break;
+				}
+			}
+		}
+
+		void ApplyCX(Types::qubit_t control, Types::qubit_t target, size_t w, size_t nrWords)
+		{
+			X(target, w, nrWords) ^= X(control, w, nrWords);
+			Z(control, w, nrWords) ^= Z(target, w, nrWords);
+		}
+
+		uint64_t& X(Types::qubit_t q, size_t w, size_t nrWords)
+		{
+			return xFrames[q * nrWords + w];
+		}
+
+		uint64_t& Z(Types::qubit_t q, size_t w, size_t nrWords)
+		{
+			return zFrames[q * nrWords + w];
+		}
+
+		size_t nrQubits; /**< The number of qubits */
+		size_t nrCbits; /**< The number of classical bits */
+		std::vector<Step> steps; /**< The frame operations, one for each circuit operation */
+		bool hasReference = false; /**< True if the reference execution was done */
+
+		std::vector<uint64_t> xFrames; /**< The X bits of the frames, the words for a qubit are consecutive */
+		std::vector<uint64_t> zFrames; /**< The Z bits of the frames, the words for a qubit are consecutive */
+		std::vector<uint64_t> cbits; /**< The classical bits of the shots, the words for a bit are consecutive */
+
+		std::mt19937_64 rng; /**< The random numbers generator */
+	};
+
+}
+
+#endif // _PAULI_FRAME_SIMULATOR_H_
@@ -17,6 +17,7 @@
 #ifdef INCLUDED_BY_FACTORY
 
 #include "QCSimState.h"
+#include "../Utils/AmplitudeKernels.h"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -739,6 +740,31 @@ namespace Simulators {
 				NotifyObservers({ tgt_qubit, ctrl_qubit });
 			}
 
+			/**
+			 * @brief Applies a gate given by a dense matrix to the qubits
+			 *
+			 * Applies a gate given by its matrix to the specified qubits.
+			 * Supported only by the statevector simulator.
+			 * @param qubits The qubits the gate is applied to
+			 * @param matrix The matrix of the gate, row major, qubits[0] corresponding to the least significant bit of the indices
+			 */
+			void ApplyMatrix(const Types::qubits_vector& qubits, const std::vector<std::complex<double>>& matrix) override
+			{
+				if (GetSimulationType() != SimulationType::kStatevector)
+					throw std::runtime_error("QCSimSimulator::ApplyMatrix: Only the statevector simulator supports gates given by matrices.");
+
+				// the result goes into a buffer that is then set as the register storage, so the register knows its amplitudes changed
+				const auto& amplitudes = state->getRegisterStorage();
+				if (matrixBuffer.size() != amplitudes.size())
+					matrixBuffer.resize(amplitudes.size());
+
+				const int nrThreads = enableMultithreading && nrQubits >= OmpLimitMatrixQubits ? QC::QubitRegister<>::GetNumberOfThreads() : 1;
+
+				Utils::ApplyMatrixToAmplitudes(amplitudes.data(), matrixBuffer.data(), nrQubits, qubits, matrix.data(), nrThreads);
+				state->setRegisterStorageFastNoNormalize(matrixBuffer);
+				NotifyObservers(qubits);
+			}
+
 			/**
 			 * @brief Applies a nop
 			 *
@@ -774,6 +800,7 @@ namespace Simulators {
 				
 				cloned->enableMultithreading = enableMultithreading;
 				cloned->useMPSMeasureNoCollapse = useMPSMeasureNoCollapse;
+				cloned->maxIntermediateSize = maxIntermediateSize;
 
 				if (state)
 					cloned->state = state->Clone();
@@ -789,7 +816,7 @@ namespace Simulators {
 				}
 
 				if (cliffordSimulator)
-					cloned->cliffordSimulator = cliffordSimulator->Clone();
+					cloned->cliffordSimulator = std::make_unique<QCSimStabilizerSimulator>(*cliffordSimulator);
 
 				if (tensorNetwork)
 					cloned->tensorNetwork = tensorNetwork->Clone();
@@ -829,6 +856,9 @@ namespace Simulators {
 			QC::Gates::ToffoliGate<> ccxgate;
 			QC::Gates::FredkinGate<> cswapgate;
 			QC::Gates::ControlledUGate<> cugate;
+
+			constexpr static size_t OmpLimitMatrixQubits = 14; /**< Below this number of qubits the dense matrices are applied on a single thread */
+			Eigen::VectorXcd matrixBuffer; /**< The destination of the dense matrices applied to the statevector, kept between gates to avoid allocations */
 		};
 
 	}
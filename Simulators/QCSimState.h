@@ -18,6 +18,7 @@
 #ifdef INCLUDED_BY_FACTORY
 
 #include <algorithm>
+#include <cstdlib>
 
 #include "Simulator.h"
 
@@ -29,6 +30,9 @@
 #include "../TensorNetworks/ForestContractor.h"
 
 #include "../Utils/Alias.h"
+#include "../Utils/PauliKernels.h"
+#include "../Utils/MPSSampler.h"
+#include "../Utils/StabilizerSampler.h"
 
 
 namespace Simulators {
@@ -36,6 +40,31 @@ namespace Simulators {
 	// but during development this should be good enough
 	namespace Private {
 
+		/**
+		 * @class QCSimStabilizerSimulator
+		 * @brief The qcsim clifford simulator, with read access to its stabilizer generators.
+		 *
+		 * The generators are needed for sampling many shots from the tableau without measuring it for each shot.
+		 * @sa Utils::StabilizerSampler
+		 */
+		class QCSimStabilizerSimulator : public QC::Clifford::StabilizerSimulator
+		{
+		public:
+			using QC::Clifford::StabilizerSimulator::StabilizerSimulator;
+
+			QCSimStabilizerSimulator(const QCSimStabilizerSimulator& other) = default;
+
+			/**
+			 * @brief Get the stabilizer generators.
+			 *
+			 * @return The stabilizer generators, one for each qubit.
+			 */
+			const auto& GetStabilizerGenerators() const
+			{
+				return stabilizerGenerators;
+			}
+		};
+
 		/**
 		 * @class QCSimState
 		 * @brief Class for the qcsim simulator state.
@@ -73,12 +102,13 @@ namespace Simulators {
 							mpsSimulator->setLimitBondDimension(chi);
 					}
 					else if (simulationType == SimulationType::kStabilizer)
-						cliffordSimulator = std::make_unique<QC::Clifford::StabilizerSimulator>(nrQubits);
+						cliffordSimulator = std::make_unique<QCSimStabilizerSimulator>(nrQubits);
 					else if (simulationType == SimulationType::kTensorNetwork)
 					{
 						tensorNetwork = std::make_unique<TensorNetworks::TensorNetwork>(nrQubits);
 						// for now the only used contractor is the forest one, but we'll use more in the future
 						const auto tensorContractor = std::make_shared<TensorNetworks::ForestContractor>();
+						tensorContractor->SetMaxIntermediateSize(maxIntermediateSize);
 						tensorNetwork->SetContractor(tensorContractor);
 					}
 					else
@@ -235,6 +265,17 @@ namespace Simulators {
 				}
 				else if (std::string("mps_sample_measure_algorithm") == key)
 					useMPSMeasureNoCollapse = std::string("mps_probabilities") == value;
+				else if (std::string("tensor_network_max_intermediate_size") == key)
+				{
+					// a value that is not a number is ignored, this is reachable from the C interface
+					char* end = nullptr;
+					const unsigned long long int val = std::strtoull(value, &end, 10);
+					if (end == value || *end != 0) return;
+
+					maxIntermediateSize = static_cast<size_t>(val);
+					if (tensorNetwork && tensorNetwork->GetContractor())
+						tensorNetwork->GetContractor()->SetMaxIntermediateSize(maxIntermediateSize);
+				}
 			}
 
 
@@ -276,6 +317,11 @@ namespace Simulators {
 				{
 					return useMPSMeasureNoCollapse ? "mps_probabilities" : "mps_apply_measure";
 				}
+				else if (std::string("tensor_network_max_intermediate_size") == key)
+				{
+					if (maxIntermediateSize > 0)
+						return std::to_string(maxIntermediateSize);
+				}
 
 				return "";
 			}
@@ -449,7 +495,7 @@ namespace Simulators {
 				else if (simulationType == SimulationType::kStabilizer)
 					return cliffordSimulator->getBasisStateProbability(static_cast<unsigned int>(outcome));
 				else if (simulationType == SimulationType::kTensorNetwork)
-					return tensorNetwork->getBasisStateProbability(outcome);
+					return std::norm(tensorNetwork->Amplitude(outcome)); // the single layer network, half the contraction work of the doubled one
 
 				return state->getBasisStateProbability(static_cast<unsigned int>(outcome));
 			}
@@ -471,7 +517,7 @@ namespace Simulators {
 				else if (simulationType == SimulationType::kStabilizer)
 					throw std::runtime_error("QCSimState::Amplitude: Invalid simulation type for obtaining the amplitude of the specified outcome.");
 				else if (simulationType == SimulationType::kTensorNetwork)
-					throw std::runtime_error("QCSimState::Amplitude: Not supported for the tensor network simulator.");
+					return tensorNetwork->Amplitude(outcome);
 
 				return state->getBasisStateAmplitude(static_cast<unsigned int>(outcome));
 			}
@@ -595,36 +641,36 @@ namespace Simulators {
 
 					if (normal)
 					{
-						auto savedState = mpsSimulator->getState();
-						for (size_t shot = 0; shot < shots; ++shot)
-						{
-							const size_t meas = Measure(qubits);
-							++result[meas];
-							mpsSimulator->setState(savedState);
-						}
+						// sweeps over the measured sites with cached environments, no copies of the state for each shot
+						const MPSStateView mpsState(mpsSimulator->getState());
+						const Utils::MPSSampler sampler(GetMPSSiteTensors(mpsState));
+
+						std::vector<size_t> sites(qubits.size());
+						for (size_t i = 0; i < qubits.size(); ++i)
+							sites[i] = static_cast<size_t>(mpsState.qubitsMap[qubits[i]]);
+
+						sampler.SampleCounts(sites, shots, rng(), [&result](size_t meas, size_t cnt)
+							{
+								result[meas] += cnt;
+							}, enableMultithreading ? QC::QubitRegister<>::GetNumberOfThreads() : 1);
 					}
 				}
 				else if (simulationType == SimulationType::kStabilizer)
 				{
-					cliffordSimulator->SaveState();
-					for (size_t shot = 0; shot < shots; ++shot)
-					{
-						const size_t meas = Measure(qubits);
-						++result[meas];
-						cliffordSimulator->RestoreState();
-					}
-					cliffordSimulator->ClearSavedState();
+					// a single elimination of the tableau, then the shots are random combinations of the outcomes subspace
+					const Utils::StabilizerSampler sampler = GetStabilizerSampler();
+
+					const std::vector<size_t> measured(qubits.begin(), qubits.end());
+					sampler.SampleCounts(measured, shots, rng(), [&result](size_t meas, size_t cnt)
+						{
+							result[meas] += cnt;
+						}, enableMultithreading ? QC::QubitRegister<>::GetNumberOfThreads() : 1);
 				}
 				else if (simulationType == SimulationType::kTensorNetwork)
 				{
-					tensorNetwork->SaveState();
-					for (size_t shot = 0; shot < shots; ++shot)
-					{
-						const size_t meas = Measure(qubits);
+					// sampled from the single layer network amplitudes, except for the qubits in large qubits groups
+					for (const auto meas : tensorNetwork->Sample(qubits, shots))
 						++result[meas];
-						tensorNetwork->RestoreState();
-					}
-					tensorNetwork->ClearSavedState();
 				}
 				else
 				{
@@ -632,25 +678,21 @@ namespace Simulators {
 					{
 						const auto& statev = state->getRegisterStorage();
 
-						const Utils::Alias alias(statev);
-
-						for (size_t shot = 0; shot < shots; ++shot)
-						{
-							const double prob = 1. - uniformZeroOne(rng);
-							const size_t measRaw = alias.Sample(prob);
-
-							size_t meas = 0;
-							size_t mask = 1ULL;
-							for (auto q : qubits)
+						// alias, binary search or a sweep with sorted uniforms, depending on the number of shots and the statevector size
+						Utils::SampleStatesCounts(statev, shots, rng, [&](size_t measRaw, size_t cnt)
 							{
-								const size_t qubitMask = 1ULL << q;
-								if ((measRaw & qubitMask) != 0)
-									meas |= mask;
-								mask <<= 1ULL;
-							}
+								size_t meas = 0;
+								size_t mask = 1ULL;
+								for (auto q : qubits)
+								{
+									const size_t qubitMask = 1ULL << q;
+									if ((measRaw & qubitMask) != 0)
+										meas |= mask;
+									mask <<= 1ULL;
+								}
 
-							++result[meas];
-						}
+								result[meas] += cnt;
+							}, enableMultithreading ? QC::QubitRegister<>::GetNumberOfThreads() : 1);
 					}
 					else
 					{
@@ -690,70 +732,68 @@ namespace Simulators {
 			 * @param pauliString The Pauli string to obtain the expected value for.
 			 * @return The expected value of the specified Pauli string.
 			 */
-			double ExpectationValue(const std::string& pauliStringOrig) override
+			double ExpectationValue(const std::string& pauliString) override
 			{
-				if (pauliStringOrig.empty()) return 1.0;
+				if (pauliString.empty()) return 1.0;
 
-				std::string pauliString = pauliStringOrig;
-				if (pauliString.size() > GetNumberOfQubits())
-				{
-					for (size_t i = GetNumberOfQubits(); i < pauliString.size(); ++i)
-					{
-						const auto pauliOp = toupper(pauliString[i]);
-						if (pauliOp != 'I' && pauliOp != 'Z')
-							return 0.0;
-					}
+				return ExpectationValue(Utils::PauliString(pauliString));
+			}
 
-					pauliString.resize(GetNumberOfQubits());
-				}
+			using ISimulator::ExpectationValues;
 
-				if (simulationType == SimulationType::kStabilizer)
-					return cliffordSimulator->ExpectationValue(pauliString);
-				else if (simulationType == SimulationType::kTensorNetwork)
-					return tensorNetwork->ExpectationValue(pauliString);
+			/**
+			 * @brief Returns the expected values of a batch of Pauli strings.
+			 *
+			 * For the statevector the strings are computed together, directly on the amplitudes, with the bit masks of the strings,
+			 * sharing the work between the strings with the same X and Y positions.
+			 * For the other simulation types they are computed one by one.
+			 *
+			 * @param paulis The Pauli strings to obtain the expected values for.
+			 * @return The expected values of the specified Pauli strings, in the same order.
+			 * @sa Utils::PauliExpectationValues
+			 */
+			std::vector<double> ExpectationValues(const std::vector<Utils::PauliString>& paulis) override
+			{
+				std::vector<double> result(paulis.size(), 0.);
 
-				// statevector or mps
-				static const QC::Gates::PauliXGate<> xgate;
-				static const QC::Gates::PauliYGate<> ygate;
-				static const QC::Gates::PauliZGate<> zgate;
+				if (simulationType != SimulationType::kStatevector)
+				{
+					for (size_t i = 0; i < paulis.size(); ++i)
+						result[i] = ExpectationValue(paulis[i]);
 
-				std::vector<QC::Gates::AppliedGate<Eigen::MatrixXcd>> pauliStringVec;
-				pauliStringVec.reserve(pauliString.size());
+					return result;
+				}
 
-				for (size_t q = 0; q < pauliString.size(); ++q)
+				// the strings that are not trivial
+				std::vector<size_t> indices;
+				std::vector<Utils::PauliString> trimmed;
+				indices.reserve(paulis.size());
+				trimmed.reserve(paulis.size());
+
+				for (size_t i = 0; i < paulis.size(); ++i)
 				{
-					switch (toupper(pauliString[q])) {
-					case 'X':
-					{
-						QC::Gates::AppliedGate<Eigen::MatrixXcd> ag(xgate.getRawOperatorMatrix(), static_cast<Types::qubit_t>(q));
-						pauliStringVec.emplace_back(std::move(ag));
-					}
-						break;
-					case 'Y':
-					{
-						QC::Gates::AppliedGate<Eigen::MatrixXcd> ag(ygate.getRawOperatorMatrix(), static_cast<Types::qubit_t>(q));
-						pauliStringVec.emplace_back(std::move(ag));
-					}
-						break;
-					case 'Z':
+					Utils::PauliString pauli = paulis[i];
+					if (!pauli.Trim(GetNumberOfQubits())) continue;
+					else if (pauli.IsIdentity())
 					{
-						QC::Gates::AppliedGate<Eigen::MatrixXcd> ag(zgate.getRawOperatorMatrix(), static_cast<Types::qubit_t>(q));
-						pauliStringVec.emplace_back(std::move(ag));
-					}
-						break;
-					case 'I':
-						[[fallthrough]];
-					default:
-						break;
+						result[i] = 1.0;
+						continue;
 					}
+
+					indices.push_back(i);
+					trimmed.emplace_back(std::move(pauli));
 				}
 
-				if (pauliStringVec.empty()) return 1.0;
+				if (indices.empty()) return result;
 
-				if (simulationType == SimulationType::kMatrixProductState)
-					return mpsSimulator->ExpectationValue(pauliStringVec).real();
+				const auto& amplitudes = state->getRegisterStorage();
+				const int nrThreads = enableMultithreading ? QC::QubitRegister<>::GetNumberOfThreads() : 1;
 
-				return state->ExpectationValue(pauliStringVec).real();
+				const auto values = Utils::PauliExpectationValues(amplitudes.data(), GetNumberOfQubits(), trimmed, nrThreads);
+				for (size_t i = 0; i < indices.size(); ++i)
+					result[indices[i]] = values[i];
+
+				return result;
 			}
 
 			/**
@@ -940,11 +980,117 @@ namespace Simulators {
 			}
 
 		protected:
+			/**
+			 * @brief A view of the mps state that gives access to its tensors.
+			 *
+			 * The state holds the tensors in the Vidal form and the map from the qubits to the sites.
+			 */
+			struct MPSStateView : public QC::TensorNetworks::MPSSimulatorState
+			{
+				explicit MPSStateView(const QC::TensorNetworks::MPSSimulatorState& state)
+					: QC::TensorNetworks::MPSSimulatorState(state)
+				{
+				}
+
+				using QC::TensorNetworks::MPSSimulatorState::gammas;
+				using QC::TensorNetworks::MPSSimulatorState::lambdas;
+				using QC::TensorNetworks::MPSSimulatorState::qubitsMap;
+			};
+
+			/**
+			 * @brief Converts the mps state to site tensors for sampling.
+			 *
+			 * Each gamma tensor is multiplied with the lambda values of its right bond, so the sites are in the right canonical form.
+			 *
+			 * @param mpsState The mps state.
+			 * @return The site tensors, in the order of the sites.
+			 */
+			static std::vector<Utils::MPSSampler::SiteTensor> GetMPSSiteTensors(const MPSStateView& mpsState)
+			{
+				std::vector<Utils::MPSSampler::SiteTensor> sites(mpsState.gammas.size());
+
+				for (size_t site = 0; site < sites.size(); ++site)
+				{
+					const auto& gamma = mpsState.gammas[site];
+					const Eigen::Index leftDim = gamma.dimension(0);
+					const Eigen::Index rightDim = gamma.dimension(2);
+
+					for (Eigen::Index s = 0; s < 2; ++s)
+					{
+						auto& mat = sites[site][s];
+						mat.resize(leftDim, rightDim);
+
+						for (Eigen::Index r = 0; r < rightDim; ++r)
+						{
+							const double lambda = site < mpsState.lambdas.size() ? mpsState.lambdas[site](r) : 1.;
+							for (Eigen::Index l = 0; l < leftDim; ++l)
+								mat(l, r) = gamma(l, s, r) * lambda;
+						}
+					}
+				}
+
+				return sites;
+			}
+
+			/**
+			 * @brief Returns the expected value of a Pauli string.
+			 *
+			 * The operators on the qubits that are not allocated act on the |0> state.
+			 *
+			 * @param pauliOrig The Pauli string.
+			 * @return The expected value of the Pauli string.
+			 */
+			double ExpectationValue(const Utils::PauliString& pauliOrig)
+			{
+				Utils::PauliString pauli = pauliOrig;
+				if (!pauli.Trim(GetNumberOfQubits())) return 0.0;
+				else if (pauli.IsIdentity()) return 1.0;
+
+				if (simulationType == SimulationType::kStabilizer)
+					return cliffordSimulator->ExpectationValue(pauli.ToString());
+				else if (simulationType == SimulationType::kTensorNetwork)
+					return tensorNetwork->ExpectationValue(pauli);
+				else if (simulationType == SimulationType::kStatevector)
+				{
+					const int nrThreads = enableMultithreading ? QC::QubitRegister<>::GetNumberOfThreads() : 1;
+					return Utils::PauliExpectationValues(state->getRegisterStorage().data(), GetNumberOfQubits(), { pauli }, nrThreads)[0];
+				}
+
+				// mps
+				static const QC::Gates::PauliXGate<> xgate;
+				static const QC::Gates::PauliYGate<> ygate;
+				static const QC::Gates::PauliZGate<> zgate;
+
+				std::vector<QC::Gates::AppliedGate<Eigen::MatrixXcd>> pauliStringVec;
+
+				pauli.ForEachOperator([&pauliStringVec](size_t q, char op)
+					{
+						const auto& gate = op == 'X' ? xgate.getRawOperatorMatrix() : (op == 'Y' ? ygate.getRawOperatorMatrix() : zgate.getRawOperatorMatrix());
+						pauliStringVec.emplace_back(gate, static_cast<Types::qubit_t>(q));
+					});
+
+				return mpsSimulator->ExpectationValue(pauliStringVec).real();
+			}
+
+			/**
+			 * @brief Creates a sampler from the stabilizer generators of the clifford simulator.
+			 *
+			 * @return The sampler.
+			 */
+			Utils::StabilizerSampler GetStabilizerSampler() const
+			{
+				Utils::StabilizerSampler sampler(GetNumberOfQubits());
+				for (const auto& generator : cliffordSimulator->GetStabilizerGenerators())
+					sampler.AddStabilizer(generator.X, generator.Z, generator.PhaseSign);
+
+				return sampler;
+			}
+
 			SimulationType simulationType = SimulationType::kStatevector; /**< The simulation type. */
 
 			std::unique_ptr<QC::QubitRegister<>> state; /**< The qcsim state. */
 			std::unique_ptr<QC::TensorNetworks::MPSSimulator> mpsSimulator; /**< The qcsim mps simulator. */
-			std::unique_ptr<QC::Clifford::StabilizerSimulator> cliffordSimulator; /**< The qcsim clifford simulator. */
+			std::unique_ptr<QCSimStabilizerSimulator> cliffordSimulator; /**< The qcsim clifford simulator. */
 			std::unique_ptr<TensorNetworks::TensorNetwork> tensorNetwork; /**< The qcsim tensor network. */
 
 			size_t nrQubits = 0;                        /**< The number of allocated qubits. */
@@ -954,6 +1100,7 @@ namespace Simulators {
 			double singularValueThreshold = 0.; // if limitEntanglement is true
 			bool enableMultithreading = true; /**< The multithreading flag. */
 			bool useMPSMeasureNoCollapse = true; /**< The flag to use the mps measure no collapse algorithm. */
+			size_t maxIntermediateSize = 0; /**< The maximum size in bytes of an intermediate tensor in the tensor network contraction, zero for no limit. */
 
 			std::mt19937_64 rng;
 			std::uniform_real_distribution<double> uniformZeroOne;
@@ -304,6 +304,17 @@ namespace Simulators {
 		 */
 		virtual void ApplyCU(Types::qubit_t ctrl_qubit, Types::qubit_t tgt_qubit, double theta, double phi, double lambda, double gamma) = 0;
 
+		/**
+		 * @brief Applies a gate given by a dense matrix to the qubits
+		 *
+		 * Applies a gate given by its (unitary) matrix to the specified qubits.
+		 * The matrix is 2^n x 2^n, in row major order, with qubits[0] corresponding to the least significant bit of the row and column indices.
+		 * Typically used for fused gates, supported only by statevector simulators.
+		 * @param qubits The qubits the gate is applied to
+		 * @param matrix The matrix of the gate
+		 */
+		virtual void ApplyMatrix(const Types::qubits_vector& qubits, const std::vector<std::complex<double>>& matrix) = 0;
+
 		/**
          * @brief Applies a nop
          *
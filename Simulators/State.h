@@ -29,6 +29,7 @@
 #endif
 
 #include "SimulatorObserver.h"
+#include "../Utils/PauliString.h"
 
 namespace Simulators {
 
@@ -80,7 +81,8 @@ namespace Simulators {
 		kMatrixProductState, /**< matrix product state simulation type */
 		kStabilizer, /**< Clifford gates simulation type */
 		kTensorNetwork, /**< Tensor network simulation type */
-		kOther /**< other simulation type, could occur for the aer simulator, which also has density matrix, stabilizer, extended stabilizer, unitary, superop */
+		kOther, /**< other simulation type, could occur for the aer simulator, which also has density matrix, stabilizer, extended stabilizer, unitary, superop */
+		kPauliFrame /**< Pauli frames propagated relative to a reference stabilizer execution, for many shots of Clifford circuits with mid-circuit measurements */
 	};
 
 	/**
@@ -290,6 +292,44 @@ namespace Simulators {
 		 */
 		virtual double ExpectationValue(const std::string& pauliString) = 0;
 
+		/**
+		 * @brief Returns the expected values of a batch of Pauli strings.
+		 *
+		 * Use it to obtain the expected values of many Pauli strings for the same state.
+		 * The simulators that can share work between the strings override it, the default computes them one by one.
+		 * 
+		 * The strings are parsed once, then the expected values are computed by the overload for parsed Pauli strings.
+		 * 
+		 * @param pauliStrings The Pauli strings to obtain the expected values for.
+		 * @return The expected values of the specified Pauli strings, in the same order.
+		 * @sa IState::ExpectationValue
+		 */
+		virtual std::vector<double> ExpectationValues(const std::vector<std::string>& pauliStrings)
+		{
+			return ExpectationValues(Utils::PauliString::Parse(pauliStrings));
+		}
+
+		/**
+		 * @brief Returns the expected values of a batch of parsed Pauli strings.
+		 *
+		 * Use it to obtain the expected values of many Pauli strings for the same state, without parsing the text again.
+		 * The simulators that can work with the bit masks of the strings override it, the default computes them one by one.
+		 * 
+		 * @param paulis The Pauli strings to obtain the expected values for.
+		 * @return The expected values of the specified Pauli strings, in the same order.
+		 * @sa Utils::PauliString
+		 */
+		virtual std::vector<double> ExpectationValues(const std::vector<Utils::PauliString>& paulis)
+		{
+			std::vector<double> result;
+			result.reserve(paulis.size());
+
+			for (const auto& pauli : paulis)
+				result.push_back(ExpectationValue(pauli.ToString()));
+
+			return result;
+		}
+
 		/**
 		 * @brief Registers an observer.
 		 *
@@ -15,8 +15,15 @@
 #define __BASE_CONTRACTOR_H_ 1
 
 #include "TensorContractor.h"
+#include "SliceJob.h"
 
 #include <random>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <boost/container_hash/hash.hpp>
 
 namespace TensorNetworks {
 
@@ -28,8 +35,506 @@ namespace TensorNetworks {
 	class BaseContractor : public ITensorContractor {
 	public:
 		using TensorsMap = ITensorContractor::TensorsMap;
+		using TopologyKey = std::vector<Eigen::Index>;
+		using PlansMap = std::unordered_map<TopologyKey, std::shared_ptr<const ContractionPlan>, boost::hash<TopologyKey>>;
 
-		TensorsMap InitializeTensors(const TensorNetwork& network, Types::qubit_t qubit, std::vector<Eigen::Index>& keys, std::unordered_map<Eigen::Index, Eigen::Index>& keysKeys, bool fillKeys = true, bool contract = true) override
+		constexpr static size_t MaxCachedPlans = 256; /**< When there are more cached plans than this, the cache is cleared */
+		constexpr static size_t MaxSlicedIndices = 24; /**< The maximum number of sliced indices, even if the intermediate tensors are still above the limit */
+
+		/**
+		 * @brief Contract the tensor network.
+		 *
+		 * The contraction order is searched only the first time a network topology is encountered,
+		 * afterwards the cached plan is replayed, even if the values of the tensors changed.
+		 * If the size of the intermediate tensors is limited, the order is searched without contracting the tensors,
+		 * then indices are sliced until the intermediate tensors fit in the limit.
+		 *
+		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group (the connected subnetwork) to contract.
+		 * @return The result of the contraction.
+		 */
+		double Contract(const TensorNetwork& network, Types::qubit_t qubit) override
+		{
+			if (maxIntermediateSize != 0)
+				return ExecutePlan(network, qubit, *Plan(network, qubit));
+
+			auto plan = std::make_shared<ContractionPlan>();
+
+			if (!cachePlans)
+			{
+				const double result = ContractAndPlan(network, qubit, *plan);
+				plan->SetMaxTensorRank(maxTensorRank);
+				EstimateCost(network, qubit, *plan);
+				lastPlan = std::move(plan);
+
+				return result;
+			}
+
+			TopologyKey key = GetTopologyKey(network, qubit);
+
+			const auto it = plans.find(key);
+			if (it != plans.end())
+			{
+				lastPlan = it->second;
+				return ExecutePlan(network, qubit, *lastPlan);
+			}
+
+			const double result = ContractAndPlan(network, qubit, *plan);
+			plan->SetMaxTensorRank(maxTensorRank);
+			EstimateCost(network, qubit, *plan);
+			lastPlan = plan;
+
+			if (plans.size() >= MaxCachedPlans) plans.clear();
+			plans.emplace(std::move(key), std::move(plan));
+
+			return result;
+		}
+
+		/**
+		 * @brief Get the contraction plan for a network, without contracting it.
+		 *
+		 * The order is searched using only the shapes of the tensors, so the intermediate tensors are not allocated.
+		 * If the size of the intermediate tensors is limited, while the largest one is above the limit,
+		 * an index is sliced and the order is searched again for the network without it.
+		 * The plan is cached, if caching is enabled.
+		 * The network must be prepared for the contraction as for Contract (with the projector or the measured qubit closed).
+		 *
+		 * @param network The tensor network.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @return The contraction plan, with its predicted cost.
+		 */
+		std::shared_ptr<const ContractionPlan> Plan(const TensorNetwork& network, Types::qubit_t qubit) override
+		{
+			TopologyKey key;
+			if (cachePlans)
+			{
+				key = GetTopologyKey(network, qubit);
+
+				const auto it = plans.find(key);
+				if (it != plans.end())
+				{
+					lastPlan = it->second;
+					return lastPlan;
+				}
+			}
+
+			auto plan = std::make_shared<ContractionPlan>();
+
+			const size_t maxRank = GetMaxIntermediateRank();
+			std::vector<ContractionPlan::SlicedIndex> slicedIndices;
+
+			do
+			{
+				plan->clear();
+				PlanWithoutContracting(network, qubit, *plan, slicedIndices);
+			} while (maxRank != 0 && plan->GetMaxTensorRank() > maxRank && slicedIndices.size() < MaxSlicedIndices && ChooseSlicedIndex(network, qubit, *plan, slicedIndices));
+
+			for (const auto& slicedIndex : slicedIndices)
+				plan->AddSlicedIndex(slicedIndex);
+
+			EstimateCost(network, qubit, *plan);
+			lastPlan = plan;
+
+			if (cachePlans)
+			{
+				if (plans.size() >= MaxCachedPlans) plans.clear();
+				plans.emplace(std::move(key), plan);
+			}
+
+			return plan;
+		}
+
+		/**
+		 * @brief Get the predicted number of operations of the last contraction.
+		 *
+		 * Counted as complex multiply-add operations, for all the slices, obtained from the plan used for the last contraction (or returned by Plan).
+		 *
+		 * @return The predicted number of operations, zero if nothing was contracted yet.
+		 */
+		double GetPredictedFlops() const
+		{
+			return lastPlan ? lastPlan->GetFlops() : 0.;
+		}
+
+		/**
+		 * @brief Get the predicted peak memory of the last contraction.
+		 *
+		 * The largest memory needed by a contraction step (the two contracted tensors and the result), for a slice.
+		 *
+		 * @return The predicted peak memory in bytes, zero if nothing was contracted yet.
+		 */
+		double GetPredictedPeakMemory() const
+		{
+			return lastPlan ? lastPlan->GetPeakMemory() : 0.;
+		}
+
+		/**
+		 * @brief Contract the tensor network, searching for the contraction order.
+		 *
+		 * Implemented by the contractors, each with its own method of picking the tensors to contract.
+		 * Each contraction done must be added to the plan.
+		 *
+		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
+		 * @return The result of the contraction.
+		 */
+		virtual double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) = 0;
+
+		/**
+		 * @brief Contract the tensor network following a plan.
+		 *
+		 * @param network The tensor network to contract, it must have the topology the plan was made for.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The contraction plan.
+		 * @return The result of the contraction.
+		 */
+		double ExecutePlan(const TensorNetwork& network, Types::qubit_t qubit, const ContractionPlan& plan)
+		{
+			if (!plan.GetSlicedIndices().empty())
+				return ExecuteSlicedPlan(network, qubit, plan);
+
+			std::vector<Eigen::Index> keys;
+			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
+
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, false);
+
+			for (const auto& step : plan.GetSteps())
+			{
+				ContractNodes(qubit, tensors, step.tensor1Id, step.tensor2Id, step.resultRank);
+
+				if (step.checkResult && step.resultRank == 0)
+				{
+					const auto& tensor = tensors[step.tensor1Id];
+					if (tensors.size() == 1 || tensor->contractsTheNeededQubit)
+						return std::real(tensor->tensor->atOffset(0));
+
+					tensors.erase(step.tensor1Id);
+				}
+			}
+
+			return std::real(tensors.begin()->second->tensor->atOffset(0));
+		}
+
+		/**
+		 * @brief Contract the tensor network following a plan with sliced indices.
+		 *
+		 * The slices are independent, if multithreading is enabled they are contracted in parallel on the threads pool,
+		 * each slice being contracted on a single thread.
+		 *
+		 * @param network The tensor network to contract, it must have the topology the plan was made for.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The contraction plan.
+		 * @return The result of the contraction, the sum of the results of the slices.
+		 */
+		double ExecuteSlicedPlan(const TensorNetwork& network, Types::qubit_t qubit, const ContractionPlan& plan)
+		{
+			const size_t nrSlices = plan.GetNumberOfSlices();
+			const size_t nrJobs = enableMultithreading ? std::min<size_t>(nrSlices, QC::QubitRegisterCalculator<>::GetNumberOfThreads()) : 1;
+
+			std::complex<double> result = 0.;
+
+			if (nrJobs <= 1)
+			{
+				for (size_t slice = 0; slice < nrSlices; ++slice)
+					result += ContractSlice(network, qubit, plan, slice);
+			}
+			else
+			{
+				// one job per thread, each with its own contractor, taking slices until there are none left
+				auto& threadsPool = SliceJobsPool::GetSharedPool(nrJobs);
+				const auto batch = std::make_shared<Utils::JobsBatch>(nrJobs);
+
+				std::atomic<size_t> nextSlice{ 0 };
+				std::vector<std::complex<double>> results(nrJobs, 0.);
+
+				for (size_t job = 0; job < nrJobs; ++job)
+				{
+					const auto worker = std::static_pointer_cast<BaseContractor>(Clone());
+					worker->SetCachePlans(false);
+					worker->SetMultithreading(false);
+
+					threadsPool.AddRunJob(std::make_shared<SliceJob>([&network, &plan, &nextSlice, &results, worker, job, qubit, nrSlices]()
+						{
+							for (size_t slice = nextSlice++; slice < nrSlices; slice = nextSlice++)
+								results[job] += worker->ContractSlice(network, qubit, plan, slice);
+						}), batch);
+				}
+
+				batch->WaitForFinish();
+
+				for (const auto& sliceResult : results)
+					result += sliceResult;
+			}
+
+			maxTensorRank = plan.GetMaxTensorRank();
+
+			return std::real(result);
+		}
+
+		/**
+		 * @brief Contract a slice of the tensor network.
+		 *
+		 * The sliced indices are fixed to the values given by the bits of the slice number,
+		 * by contracting basis vectors into both ends of each sliced bond, then the plan is replayed.
+		 *
+		 * @param network The tensor network to contract, it must have the topology the plan was made for.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The contraction plan, with sliced indices.
+		 * @param slice The slice number.
+		 * @return The result of the contraction of the slice.
+		 */
+		std::complex<double> ContractSlice(const TensorNetwork& network, Types::qubit_t qubit, const ContractionPlan& plan, size_t slice)
+		{
+			std::vector<Eigen::Index> keys;
+			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
+
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, false);
+			SliceTensors(qubit, tensors, plan.GetSlicedIndices(), slice);
+
+			const auto& steps = plan.GetSteps();
+			for (size_t i = 0; i < steps.size(); ++i)
+			{
+				const auto& step = steps[i];
+				ContractNodes(qubit, tensors, step.tensor1Id, step.tensor2Id, step.resultRank);
+
+				// as in the contraction without slicing, a scalar before the end is the result of a disconnected part, which is discarded
+				if (step.checkResult && step.resultRank == 0 && i + 1 < steps.size())
+					tensors.erase(step.tensor1Id);
+			}
+
+			if (steps.empty())
+				return tensors.begin()->second->tensor->atOffset(0);
+
+			return tensors[steps.back().tensor1Id]->tensor->atOffset(0);
+		}
+
+		/**
+		 * @brief Contract a connected network that might have open indices.
+		 *
+		 * The indices that are not connected are the indices of the result.
+		 * The pair of tensors with the lowest result rank is contracted first, the contraction plan is cached by topology, as for the closed networks.
+		 *
+		 * @param tensors The tensors of the network, they are changed by the contraction.
+		 * @return The result node, its qubits give the qubit of each index of the result tensor.
+		 */
+		std::shared_ptr<TensorNode> ContractOpen(TensorsMap& tensors) override
+		{
+			if (tensors.empty()) return nullptr;
+
+			TopologyKey key;
+			if (cachePlans)
+			{
+				key = GetTopologyKey(tensors);
+
+				const auto it = plans.find(key);
+				if (it != plans.end())
+				{
+					for (const auto& step : it->second->GetSteps())
+						ContractNodes(0, tensors, step.tensor1Id, step.tensor2Id, step.resultRank);
+
+					return tensors.begin()->second;
+				}
+			}
+
+			auto plan = std::make_shared<ContractionPlan>();
+
+			while (tensors.size() > 1)
+			{
+				bool found = false;
+				Eigen::Index tensor1Id = 0;
+				Eigen::Index tensor2Id = 0;
+				Eigen::Index resultRank = 0;
+				Eigen::Index bestCost = 0;
+
+				for (const auto& [tensorId, tensor] : tensors)
+				{
+					for (const auto nextTensorId : tensor->connections)
+					{
+						if (nextTensorId == TensorNode::NotConnected || nextTensorId < tensorId) continue;
+
+						const auto& nextTensor = tensors.at(nextTensorId);
+						const Eigen::Index newRank = GetResultRank(tensor, nextTensor);
+						const Eigen::Index cost = newRank - (tensor->GetRank() + nextTensor->GetRank()) / 2;
+
+						if (!found || newRank < resultRank || (newRank == resultRank && cost < bestCost))
+						{
+							tensor1Id = tensorId;
+							tensor2Id = nextTensorId;
+							resultRank = newRank;
+							bestCost = cost;
+							found = true;
+						}
+					}
+				}
+
+				if (!found)
+				{
+					// not connected, the outer product is needed
+					auto it = tensors.begin();
+					tensor1Id = it->first;
+					tensor2Id = (++it)->first;
+					resultRank = GetResultRank(tensors[tensor1Id], tensors[tensor2Id]);
+				}
+
+				ContractNodes(0, tensors, tensor1Id, tensor2Id, resultRank);
+				plan->AddStep(tensor1Id, tensor2Id, resultRank, false);
+			}
+
+			if (cachePlans)
+			{
+				plan->SetMaxTensorRank(maxTensorRank);
+
+				if (plans.size() >= MaxCachedPlans) plans.clear();
+				plans.emplace(std::move(key), std::move(plan));
+			}
+
+			return tensors.begin()->second;
+		}
+
+		/**
+		 * @brief Get the key identifying the topology of a network given by its tensors.
+		 *
+		 * @param tensors The tensors of the network.
+		 * @return The key.
+		 */
+		static TopologyKey GetTopologyKey(const TensorsMap& tensors)
+		{
+			std::vector<Eigen::Index> ids;
+			ids.reserve(tensors.size());
+			for (const auto& [tensorId, tensor] : tensors)
+				ids.push_back(tensorId);
+			std::sort(ids.begin(), ids.end());
+
+			// the first element is negative, so it can't be confused with the keys of the closed networks, which start with a qubit
+			TopologyKey key{ TensorNode::NotConnected };
+
+			for (const auto tensorId : ids)
+			{
+				const auto& tensor = tensors.at(tensorId);
+
+				key.push_back(tensorId);
+				key.push_back(static_cast<Eigen::Index>(tensor->qubits.size()));
+				key.insert(key.end(), tensor->connections.begin(), tensor->connections.end());
+				key.insert(key.end(), tensor->connectionsIndices.begin(), tensor->connectionsIndices.end());
+			}
+
+			return key;
+		}
+
+		/**
+		 * @brief Get the key identifying the topology of the subnetwork to be contracted.
+		 *
+		 * Contains the ids, connections and connections indices of the tensors in the qubits group, the tensors values are not part of it.
+		 *
+		 * @param network The tensor network.
+		 * @param qubit The qubit that identifies the qubits group.
+		 * @return The key.
+		 */
+		static TopologyKey GetTopologyKey(const TensorNetwork& network, Types::qubit_t qubit)
+		{
+			TopologyKey key;
+			key.push_back(static_cast<Eigen::Index>(qubit));
+
+			const auto& qubitGroup = network.GetQubitGroup(qubit);
+
+			for (const auto& tensor : network.GetTensors())
+			{
+				if (!tensor || qubitGroup.find(tensor->qubits[0]) == qubitGroup.end())
+					continue;
+
+				key.push_back(tensor->GetId());
+				key.push_back(static_cast<Eigen::Index>(tensor->qubits.size()));
+				key.insert(key.end(), tensor->connections.begin(), tensor->connections.end());
+				key.insert(key.end(), tensor->connectionsIndices.begin(), tensor->connectionsIndices.end());
+			}
+
+			return key;
+		}
+
+		/**
+		 * @brief Enable/disable caching the contraction plans.
+		 *
+		 * Enabled by default.
+		 *
+		 * @param cache A flag to indicate if the contraction plans should be cached.
+		 */
+		void SetCachePlans(bool cache = true)
+		{
+			cachePlans = cache;
+			if (!cache) plans.clear();
+		}
+
+		/**
+		 * @brief Get the contraction plans caching flag.
+		 *
+		 * @return True if the contraction plans are cached, false otherwise.
+		 */
+		bool GetCachePlans() const
+		{
+			return cachePlans;
+		}
+
+		/**
+		 * @brief Get the number of cached contraction plans.
+		 *
+		 * @return The number of cached plans.
+		 */
+		size_t GetNumberOfCachedPlans() const
+		{
+			return plans.size();
+		}
+
+		/**
+		 * @brief Clear the cached contraction plans.
+		 */
+		void ClearPlans()
+		{
+			plans.clear();
+		}
+
+		/**
+		 * @brief Set the maximum size of an intermediate tensor.
+		 *
+		 * The cached plans are cleared, since the sliced indices depend on the limit.
+		 *
+		 * @param bytes The maximum size in bytes of an intermediate tensor, zero for no limit.
+		 */
+		void SetMaxIntermediateSize(size_t bytes = 0) override
+		{
+			if (bytes != maxIntermediateSize) plans.clear();
+			maxIntermediateSize = bytes;
+		}
+
+		/**
+		 * @brief Get the maximum size of an intermediate tensor.
+		 *
+		 * @return The maximum size in bytes of an intermediate tensor, zero if there is no limit.
+		 */
+		size_t GetMaxIntermediateSize() const override
+		{
+			return maxIntermediateSize;
+		}
+
+		/**
+		 * @brief Get the maximum rank of an intermediate tensor.
+		 *
+		 * Obtained from the maximum size of an intermediate tensor, all the dimensions being 2.
+		 *
+		 * @return The maximum rank, zero if there is no limit.
+		 */
+		size_t GetMaxIntermediateRank() const
+		{
+			if (maxIntermediateSize == 0) return 0;
+
+			size_t rank = 1;
+			while ((sizeof(std::complex<double>) << (rank + 1)) <= maxIntermediateSize)
+				++rank;
+
+			return rank;
+		}
+
+		TensorsMap InitializeTensors(const TensorNetwork& network, Types::qubit_t qubit, std::vector<Eigen::Index>& keys, std::unordered_map<Eigen::Index, Eigen::Index>& keysKeys, bool fillKeys = true, bool contract = true, ContractionPlan* plan = nullptr) override
 		{
 			maxTensorRank = 0;
 
@@ -50,9 +555,13 @@ namespace TensorNetworks {
 						continue;
 
 					const auto tensorId = tensor->GetId();
-					tensors[tensorId] = tensor->CloneWithoutTensorCopy();
+					tensors[tensorId] = dryRun ? tensor->CloneWithADummyTensor() : tensor->CloneWithoutTensorCopy();
 				}
 
+				// when searching for the contraction order of a sliced network, the sliced indices are removed before anything else
+				if (dryRun && !planningSlicedIndices.empty())
+					SliceTensors(qubit, tensors, planningSlicedIndices, 0);
+
 				for (const auto& [tensor1Id, tensor1] : tensors)
 				{
 					// check the tensor, see if it can be contracted, contract it if possible
@@ -65,6 +574,7 @@ namespace TensorNetworks {
 
 						const auto resultRank = GetResultRank(tensor1, tensor2);
 						ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+						if (plan) plan->AddStep(tensor1Id, tensor2Id, resultRank, false);
 
 						tensors.erase(tensor2Id);
 					}
@@ -80,6 +590,7 @@ namespace TensorNetworks {
 
 							const auto resultRank = GetResultRank(tensor1, tensor2);
 							ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+							if (plan) plan->AddStep(tensor1Id, tensor2Id, resultRank, false);
 
 							tensors.erase(tensor2Id);
 						}
@@ -109,7 +620,7 @@ namespace TensorNetworks {
 						continue;
 
 					const auto tensorId = tensor->GetId();
-					tensors[tensorId] = tensor->CloneWithoutTensorCopy();
+					tensors[tensorId] = dryRun ? tensor->CloneWithADummyTensor() : tensor->CloneWithoutTensorCopy();
 					
 					if (fillKeys)
 					{
@@ -119,6 +630,9 @@ namespace TensorNetworks {
 
 					maxTensorRank = std::max(maxTensorRank, tensor->GetRank());
 				}
+
+				if (dryRun && !planningSlicedIndices.empty())
+					SliceTensors(qubit, tensors, planningSlicedIndices, 0);
 			}
 
 			return tensors;
@@ -139,7 +653,24 @@ namespace TensorNetworks {
 			maxTensorRank = std::max<size_t>(maxTensorRank, resultRank);
 
 			const auto resultNode = std::make_shared<TensorNode>();
-			resultNode->tensor = std::make_shared<Utils::Tensor<>>(std::move(tensor1->tensor->Contract(*(tensor2->tensor), indices, enableMultithreading)));
+			if (dryRun || tensor1->tensor->IsDummy() || tensor2->tensor->IsDummy())
+			{
+				// only the shapes are needed while searching for the contraction order
+				std::vector<size_t> dims;
+				for (size_t i = 0; i < tensor1->connections.size(); ++i)
+					if (tensor1->connections[i] != tensor2Id)
+						dims.push_back(tensor1->tensor->GetDim(i));
+
+				for (size_t i = 0; i < tensor2->connections.size(); ++i)
+					if (tensor2->connections[i] != tensor1Id)
+						dims.push_back(tensor2->tensor->GetDim(i));
+
+				// the scalars get a value, the contractors read the final result
+				if (dims.empty()) dims.push_back(1);
+				resultNode->tensor = std::make_shared<Utils::Tensor<>>(dims, dims.size() > 1 || dims[0] > 1);
+			}
+			else
+				resultNode->tensor = std::make_shared<Utils::Tensor<>>(std::move(tensor1->tensor->Contract(*(tensor2->tensor), indices, enableMultithreading)));
 			resultNode->SetId(tensor1Id);
 
 			const auto newRank = resultNode->GetRank();
@@ -174,7 +705,8 @@ namespace TensorNetworks {
 
 					// also need to update the 'other' tensor that is connected to the first tensor
 					//tensors[connectedTensorId]->connections[otherTensorIndex] = tensor1Id; // no need to update this, the new tensor inherits the id from tensor1
-					tensors[connectedTensorId]->connectionsIndices[otherTensorIndex] = pos;
+					if (connectedTensorId != TensorNode::NotConnected) // open index
+						tensors[connectedTensorId]->connectionsIndices[otherTensorIndex] = pos;
 
 					++pos;
 				}
@@ -195,8 +727,11 @@ namespace TensorNetworks {
 					resultNode->qubits[pos] = tensor2->qubits[i];
 
 					// also need to update the 'other' tensor that is connected to the second tensor
-					tensors[connectedTensorId]->connections[otherTensorIndex] = tensor1Id;
-					tensors[connectedTensorId]->connectionsIndices[otherTensorIndex] = pos;
+					if (connectedTensorId != TensorNode::NotConnected) // open index
+					{
+						tensors[connectedTensorId]->connections[otherTensorIndex] = tensor1Id;
+						tensors[connectedTensorId]->connectionsIndices[otherTensorIndex] = pos;
+					}
 
 					++pos;
 				}
@@ -262,8 +797,328 @@ namespace TensorNetworks {
 		}
 
 		protected:
+			/**
+			 * @brief Search for the contraction order without computing the tensors.
+			 *
+			 * @param network The tensor network.
+			 * @param qubit The qubit that identifies the qubits group to contract.
+			 * @param plan The plan where the contractions are recorded.
+			 * @param slicedIndices The indices removed from the network before searching for the order.
+			 */
+			void PlanWithoutContracting(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan, const std::vector<ContractionPlan::SlicedIndex>& slicedIndices)
+			{
+				dryRun = true;
+				planningSlicedIndices = slicedIndices;
+
+				try
+				{
+					ContractAndPlan(network, qubit, plan);
+				}
+				catch (...)
+				{
+					dryRun = false;
+					planningSlicedIndices.clear();
+					throw;
+				}
+
+				dryRun = false;
+				planningSlicedIndices.clear();
+
+				plan.SetMaxTensorRank(maxTensorRank);
+			}
+
+			using BondsSet = std::vector<size_t>; /**< A sorted set of bonds */
+
+			/**
+			 * @brief Get the bonds of the network, before any contraction.
+			 *
+			 * @param network The tensor network.
+			 * @param qubit The qubit that identifies the qubits group to contract.
+			 * @param slicedIndices The sliced indices, they are not in the bonds of the tensors.
+			 * @param bonds The bonds, each given by its two ends.
+			 * @param sliced For each bond, true if it's sliced.
+			 * @param tensorsBonds The bonds of each tensor.
+			 */
+			static void GetBonds(const TensorNetwork& network, Types::qubit_t qubit, const std::vector<ContractionPlan::SlicedIndex>& slicedIndices, std::vector<ContractionPlan::SlicedIndex>& bonds, std::vector<bool>& sliced, std::unordered_map<Eigen::Index, BondsSet>& tensorsBonds)
+			{
+				const auto& qubitGroup = network.GetQubitGroup(qubit);
+				for (const auto& tensor : network.GetTensors())
+				{
+					if (!tensor || qubitGroup.find(tensor->qubits[0]) == qubitGroup.end())
+						continue;
+
+					const auto tensorId = tensor->GetId();
+					tensorsBonds[tensorId];
+
+					for (size_t i = 0; i < tensor->connections.size(); ++i)
+					{
+						const auto otherTensorId = tensor->connections[i];
+						if (otherTensorId == TensorNode::NotConnected || otherTensorId <= tensorId) continue;
+
+						const bool isSliced = std::any_of(slicedIndices.begin(), slicedIndices.end(), [tensorId, i](const auto& slicedIndex) { return slicedIndex.tensor1Id == tensorId && slicedIndex.index1 == static_cast<Eigen::Index>(i); });
+						if (!isSliced)
+						{
+							tensorsBonds[tensorId].push_back(bonds.size());
+							tensorsBonds[otherTensorId].push_back(bonds.size());
+						}
+
+						bonds.push_back({ tensorId, static_cast<Eigen::Index>(i), otherTensorId, tensor->connectionsIndices[i] });
+						sliced.push_back(isSliced);
+					}
+				}
+
+				for (auto& [tensorId, tensorBonds] : tensorsBonds)
+					std::sort(tensorBonds.begin(), tensorBonds.end());
+			}
+
+			/**
+			 * @brief Compute the predicted cost of a plan.
+			 *
+			 * Simulates the plan on the sets of bonds of the tensors, the bonds of the result of a contraction being the symmetric difference of the bonds of the contracted tensors.
+			 * A contraction needs a multiply-add for each combination of values of the indices of the two tensors, the contracted ones counted once.
+			 *
+			 * @param network The tensor network.
+			 * @param qubit The qubit that identifies the qubits group to contract.
+			 * @param plan The contraction plan, its cost is set.
+			 */
+			static void EstimateCost(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan)
+			{
+				std::vector<ContractionPlan::SlicedIndex> bonds;
+				std::vector<bool> sliced;
+				std::unordered_map<Eigen::Index, BondsSet> tensorsBonds;
+				GetBonds(network, qubit, plan.GetSlicedIndices(), bonds, sliced, tensorsBonds);
+
+				double flops = 0;
+				double peakMemory = 0;
+
+				const auto& steps = plan.GetSteps();
+				for (size_t i = 0; i < steps.size(); ++i)
+				{
+					const auto& step = steps[i];
+
+					BondsSet result;
+					const auto& bonds1 = tensorsBonds[step.tensor1Id];
+					const auto& bonds2 = tensorsBonds[step.tensor2Id];
+					std::set_symmetric_difference(bonds1.begin(), bonds1.end(), bonds2.begin(), bonds2.end(), std::back_inserter(result));
+
+					flops += std::ldexp(1., static_cast<int>((bonds1.size() + bonds2.size() + result.size()) / 2));
+
+					const double size = std::ldexp(1., static_cast<int>(bonds1.size())) + std::ldexp(1., static_cast<int>(bonds2.size())) + std::ldexp(1., static_cast<int>(result.size()));
+					peakMemory = std::max(peakMemory, size * sizeof(std::complex<double>));
+
+					tensorsBonds.erase(step.tensor2Id);
+
+					if (step.checkResult && step.resultRank == 0 && i + 1 < steps.size())
+						tensorsBonds.erase(step.tensor1Id);
+					else
+						tensorsBonds[step.tensor1Id].swap(result);
+				}
+
+				plan.SetCost(flops * static_cast<double>(plan.GetNumberOfSlices()), peakMemory);
+			}
+
+			/**
+			 * @brief Choose an index to slice.
+			 *
+			 * Simulates the plan on the sets of bonds of the tensors, the bonds of the result of a contraction being the symmetric difference of the bonds of the contracted tensors.
+			 * The bond that is in most of the largest intermediate tensors is chosen.
+			 * The bonds of the disconnected parts that are discarded are not sliced, neither are the ones that would split the network.
+			 *
+			 * @param network The tensor network.
+			 * @param qubit The qubit that identifies the qubits group to contract.
+			 * @param plan The contraction plan for the network with the already sliced indices removed.
+			 * @param slicedIndices The already sliced indices, the chosen one is added to them.
+			 * @return True if an index was chosen, false otherwise.
+			 */
+			bool ChooseSlicedIndex(const TensorNetwork& network, Types::qubit_t qubit, const ContractionPlan& plan, std::vector<ContractionPlan::SlicedIndex>& slicedIndices) const
+			{
+				const size_t maxRank = GetMaxIntermediateRank();
+
+				std::vector<ContractionPlan::SlicedIndex> bonds;
+				std::vector<bool> sliced;
+				std::unordered_map<Eigen::Index, BondsSet> tensorsBonds;
+				GetBonds(network, qubit, slicedIndices, bonds, sliced, tensorsBonds);
+
+				auto history = tensorsBonds; // all the bonds that went in a tensor
+
+				std::vector<BondsSet> intermediates; // the bonds of the results of the contractions
+				std::vector<bool> eligible(bonds.size(), true);
+
+				const auto& steps = plan.GetSteps();
+				for (size_t i = 0; i < steps.size(); ++i)
+				{
+					const auto& step = steps[i];
+
+					BondsSet result;
+					const auto& bonds1 = tensorsBonds[step.tensor1Id];
+					const auto& bonds2 = tensorsBonds[step.tensor2Id];
+					std::set_symmetric_difference(bonds1.begin(), bonds1.end(), bonds2.begin(), bonds2.end(), std::back_inserter(result));
+
+					BondsSet resultHistory;
+					const auto& history1 = history[step.tensor1Id];
+					const auto& history2 = history[step.tensor2Id];
+					std::set_union(history1.begin(), history1.end(), history2.begin(), history2.end(), std::back_inserter(resultHistory));
+
+					tensorsBonds.erase(step.tensor2Id);
+					history.erase(step.tensor2Id);
+
+					if (result.size() > maxRank) intermediates.push_back(result);
+
+					if (step.checkResult && step.resultRank == 0 && i + 1 < steps.size())
+					{
+						// a disconnected part, its result is discarded, slicing it would change the result
+						for (const auto bond : resultHistory)
+							eligible[bond] = false;
+
+						tensorsBonds.erase(step.tensor1Id);
+						history.erase(step.tensor1Id);
+					}
+					else
+					{
+						tensorsBonds[step.tensor1Id].swap(result);
+						history[step.tensor1Id].swap(resultHistory);
+					}
+				}
+
+				size_t maxFound = 0;
+				for (const auto& intermediateBonds : intermediates)
+					maxFound = std::max(maxFound, intermediateBonds.size());
+
+				std::vector<size_t> maxCount(bonds.size(), 0);
+				std::vector<size_t> overCount(bonds.size(), 0);
+				for (const auto& intermediateBonds : intermediates)
+					for (const auto bond : intermediateBonds)
+					{
+						++overCount[bond];
+						if (intermediateBonds.size() == maxFound) ++maxCount[bond];
+					}
+
+				std::vector<size_t> candidates;
+				for (size_t bond = 0; bond < bonds.size(); ++bond)
+					if (!sliced[bond] && eligible[bond] && maxCount[bond] > 0)
+						candidates.push_back(bond);
+
+				std::sort(candidates.begin(), candidates.end(), [&maxCount, &overCount](size_t bond1, size_t bond2)
+					{
+						return maxCount[bond1] > maxCount[bond2] || (maxCount[bond1] == maxCount[bond2] && overCount[bond1] > overCount[bond2]);
+					});
+
+				// the network must stay connected, otherwise the contractors would discard parts of it
+				std::unordered_map<Eigen::Index, size_t> positions;
+				for (const auto& bond : bonds)
+				{
+					positions.emplace(bond.tensor1Id, positions.size());
+					positions.emplace(bond.tensor2Id, positions.size());
+				}
+
+				for (const auto candidate : candidates)
+				{
+					std::vector<size_t> parents(positions.size());
+					for (size_t i = 0; i < parents.size(); ++i)
+						parents[i] = i;
+
+					const auto findRoot = [&parents](size_t i)
+						{
+							while (parents[i] != i)
+								i = parents[i] = parents[parents[i]];
+							return i;
+						};
+
+					size_t components = parents.size();
+					for (size_t bond = 0; bond < bonds.size(); ++bond)
+					{
+						if (sliced[bond] || bond == candidate) continue;
+
+						const size_t root1 = findRoot(positions[bonds[bond].tensor1Id]);
+						const size_t root2 = findRoot(positions[bonds[bond].tensor2Id]);
+						if (root1 != root2)
+						{
+							parents[root1] = root2;
+							--components;
+						}
+					}
+
+					if (components == 1)
+					{
+						slicedIndices.push_back(bonds[candidate]);
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			/**
+			 * @brief Remove the sliced indices from the network.
+			 *
+			 * The sliced indices are fixed to the values given by the bits of the slice number,
+			 * by contracting basis vectors into both ends of each sliced bond. The tensors keep their ids.
+			 *
+			 * @param qubit The qubit that identifies the qubits group to contract.
+			 * @param tensors The tensors of the network, before any contraction.
+			 * @param slicedIndices The sliced indices.
+			 * @param slice The slice number.
+			 */
+			void SliceTensors(Types::qubit_t qubit, TensorsMap& tensors, const std::vector<ContractionPlan::SlicedIndex>& slicedIndices, size_t slice)
+			{
+				Eigen::Index basisId = 0;
+				for (const auto& [tensorId, tensor] : tensors)
+					basisId = std::max(basisId, tensorId + 1);
+
+				// first connect all the basis vectors, then contract them, this way the bonds indices are still valid while connecting them
+				std::vector<std::pair<Eigen::Index, Eigen::Index>> basisTensors;
+
+				for (size_t i = 0; i < slicedIndices.size(); ++i)
+				{
+					const bool zero = ((slice >> i) & 1) == 0;
+					const auto& slicedIndex = slicedIndices[i];
+
+					for (const auto& [tensorId, index] : { std::make_pair(slicedIndex.tensor1Id, slicedIndex.index1), std::make_pair(slicedIndex.tensor2Id, slicedIndex.index2) })
+					{
+						const auto& tensor = tensors[tensorId];
+
+						auto basisNode = std::make_shared<TensorNode>();
+						basisNode->SetQubit(tensor->qubits[index], zero);
+						basisNode->SetId(basisId);
+						basisNode->connections[0] = tensorId;
+						basisNode->connectionsIndices[0] = index;
+
+						tensor->connections[index] = basisId;
+						tensor->connectionsIndices[index] = 0;
+
+						tensors[basisId] = basisNode;
+						basisTensors.emplace_back(tensorId, basisId);
+
+						++basisId;
+					}
+				}
+
+				for (const auto& [tensorId, basisTensorId] : basisTensors)
+					ContractNodes(qubit, tensors, tensorId, basisTensorId, tensors[tensorId]->GetRank() - 1);
+			}
+
+			/**
+			 * @brief Copy the base contractor settings and the cached plans to a clone.
+			 *
+			 * @param cloned The cloned contractor.
+			 */
+			void CloneBase(BaseContractor& cloned) const
+			{
+				cloned.maxTensorRank = maxTensorRank;
+				cloned.enableMultithreading = enableMultithreading;
+				cloned.cachePlans = cachePlans;
+				cloned.maxIntermediateSize = maxIntermediateSize;
+				cloned.plans = plans; // the plans are immutable, they can be shared
+			}
+
 			size_t maxTensorRank = 0; /**< The maximum rank of the tensors in the network. */
 			bool enableMultithreading = true; /**< A flag to indicate if multithreading should be enabled. */
+			bool cachePlans = true; /**< A flag to indicate if the contraction plans should be cached. */
+			size_t maxIntermediateSize = 0; /**< The maximum size in bytes of an intermediate tensor, zero for no limit. */
+			std::shared_ptr<const ContractionPlan> lastPlan; /**< The plan of the last contraction, for the predicted cost. */
+			bool dryRun = false; /**< Set while searching for the contraction order without computing the tensors. */
+			std::vector<ContractionPlan::SlicedIndex> planningSlicedIndices; /**< The indices removed from the network while searching for the contraction order. */
+			PlansMap plans; /**< The cached contraction plans, by network topology. */
 	};
 
 } // namespace TensorNetworks
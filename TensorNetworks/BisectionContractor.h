@@ -0,0 +1,452 @@
+/**
+ * @file BisectionContractor.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The Bisection Tensor Contractor.
+ * The contraction order is given by recursively splitting the network graph in two parts with a small number of bonds between them,
+ * using a Kernighan-Lin (Fiduccia-Mattheyses) partitioner. Each part is contracted on its own, then the results are contracted together,
+ * so the largest tensors are the ones obtained by cutting the network along the few bonds found by the partitioner.
+ * The small parts (the leaves of the recursion) are contracted greedily.
+ *
+ * Tensor contractions using the Bisection contraction method.
+ */
+
+#pragma once
+
+#ifndef  __BISECTION_CONTRACTOR_H_
+#define __BISECTION_CONTRACTOR_H_ 1
+
+#include "BaseContractor.h"
+
+#include <map>
+#include <queue>
+#include <set>
+#include <unordered_set>
+
+namespace TensorNetworks {
+
+	/**
+	 * @brief The Bisection Tensor Contractor.
+	 *
+	 * Tensor contractions using the Bisection contraction method.
+	 * The predicted number of operations and peak memory of the contraction are available with GetPredictedFlops and GetPredictedPeakMemory.
+	 */
+	class BisectionContractor : public BaseContractor {
+	public:
+		constexpr static size_t MaxPasses = 8; /**< The maximum number of refinement passes of a bisection */
+		constexpr static size_t NrAttempts = 4; /**< The number of initial splits refined for a bisection */
+
+		/**
+		 * @brief Contract the tensor network, searching for the contraction order.
+		 *
+		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
+		 * @return The result of the contraction.
+		 */
+		double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) override
+		{
+			std::vector<Eigen::Index> keys;
+			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
+
+			// no contractions at initialization, the order is given by the partitioning
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, false, &plan);
+
+			std::vector<Eigen::Index> ids;
+			ids.reserve(tensors.size());
+			for (const auto& [tensorId, tensor] : tensors)
+				ids.push_back(tensorId);
+			std::sort(ids.begin(), ids.end());
+
+			Eigen::Index finalId = 0;
+			if (ContractPart(qubit, tensors, ids, plan, finalId))
+				return std::real(tensors[finalId]->tensor->atOffset(0));
+
+			// what is left is not connected, the outer product is needed
+			while (tensors.size() > 1)
+			{
+				auto it = tensors.begin();
+				const Eigen::Index tensor1Id = it->first;
+				const Eigen::Index tensor2Id = (++it)->first;
+
+				const auto resultRank = GetResultRank(tensors[tensor1Id], tensors[tensor2Id]);
+				ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+				plan.AddStep(tensor1Id, tensor2Id, resultRank);
+			}
+
+			return std::real(tensors.begin()->second->tensor->atOffset(0));
+		}
+
+		size_t GetLeafSize() const
+		{
+			return leafSize;
+		}
+
+		/**
+		 * @brief Set the size of the parts that are not split anymore.
+		 *
+		 * The parts with at most this number of tensors are contracted greedily.
+		 *
+		 * @param size The number of tensors.
+		 */
+		void SetLeafSize(size_t size)
+		{
+			leafSize = std::max<size_t>(size, 2);
+		}
+
+		double GetImbalance() const
+		{
+			return imbalance;
+		}
+
+		/**
+		 * @brief Set the allowed imbalance of a bisection.
+		 *
+		 * A part can have at most (1 + imbalance) / 2 of the tensors.
+		 * A larger imbalance allows cuts with fewer bonds, but makes the recursion deeper.
+		 *
+		 * @param val The imbalance, between 0 and 1.
+		 */
+		void SetImbalance(double val)
+		{
+			imbalance = std::clamp(val, 0., 1.);
+		}
+
+		/**
+		 * @brief Clone the tensor contractor.
+		 *
+		 * @return A shared pointer to the cloned tensor contractor.
+		 */
+		std::shared_ptr<ITensorContractor> Clone() const override
+		{
+			auto cloned = std::make_shared<BisectionContractor>();
+			CloneBase(*cloned);
+			cloned->leafSize = leafSize;
+			cloned->imbalance = imbalance;
+
+			return cloned;
+		}
+
+	private:
+		using Adjacency = std::vector<std::vector<std::pair<size_t, long long int>>>; /**< The graph of a part, the neighbours of each tensor with the number of bonds to them */
+
+		/**
+		 * @brief Contract a part of the network.
+		 *
+		 * Splits the part in two, contracts each of them, then contracts the results together.
+		 *
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param tensors The tensors of the network.
+		 * @param ids The ids of the tensors in the part, replaced with the ids of the tensors left after contraction (more than one if the part is not connected).
+		 * @param plan The plan where the contractions are recorded.
+		 * @param finalId Set to the id of the final result, if the contraction is finished.
+		 * @return True if the contraction is finished, false otherwise.
+		 */
+		bool ContractPart(Types::qubit_t qubit, TensorsMap& tensors, std::vector<Eigen::Index>& ids, ContractionPlan& plan, Eigen::Index& finalId)
+		{
+			if (ids.size() > leafSize)
+			{
+				std::vector<Eigen::Index> part1;
+				std::vector<Eigen::Index> part2;
+				Bisect(tensors, ids, part1, part2);
+
+				if (!part1.empty() && !part2.empty())
+				{
+					if (ContractPart(qubit, tensors, part1, plan, finalId) || ContractPart(qubit, tensors, part2, plan, finalId))
+						return true;
+
+					ids.swap(part1);
+					ids.insert(ids.end(), part2.begin(), part2.end());
+				}
+			}
+
+			return Merge(qubit, tensors, ids, plan, finalId);
+		}
+
+		/**
+		 * @brief Contract greedily the connected tensors of a part.
+		 *
+		 * The pair with the lowest result rank is contracted first, the number of operations decides between pairs with the same rank.
+		 *
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param tensors The tensors of the network.
+		 * @param ids The ids of the tensors in the part, replaced with the ids of the tensors left after contraction.
+		 * @param plan The plan where the contractions are recorded.
+		 * @param finalId Set to the id of the final result, if the contraction is finished.
+		 * @return True if the contraction is finished, false otherwise.
+		 */
+		bool Merge(Types::qubit_t qubit, TensorsMap& tensors, std::vector<Eigen::Index>& ids, ContractionPlan& plan, Eigen::Index& finalId)
+		{
+			std::unordered_set<Eigen::Index> idsSet(ids.begin(), ids.end());
+
+			for (;;)
+			{
+				bool found = false;
+				Eigen::Index tensor1Id = 0;
+				Eigen::Index tensor2Id = 0;
+				size_t resultRank = 0;
+				size_t bestCost = 0;
+
+				for (const auto tensorId : ids)
+				{
+					const auto& tensor = tensors[tensorId];
+
+					for (const auto nextTensorId : tensor->connections)
+					{
+						if (nextTensorId == TensorNode::NotConnected || nextTensorId < tensorId || idsSet.find(nextTensorId) == idsSet.end()) continue;
+
+						const auto& nextTensor = tensors[nextTensorId];
+						const size_t newRank = GetResultRank(tensor, nextTensor);
+						const size_t cost = tensor->GetRank() + nextTensor->GetRank() + newRank; // twice the log2 of the number of operations
+
+						if (!found || newRank < resultRank || (newRank == resultRank && cost < bestCost))
+						{
+							tensor1Id = tensorId;
+							tensor2Id = nextTensorId;
+							resultRank = newRank;
+							bestCost = cost;
+							found = true;
+						}
+					}
+				}
+
+				if (!found) return false;
+
+				ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+				plan.AddStep(tensor1Id, tensor2Id, resultRank);
+
+				idsSet.erase(tensor2Id);
+				ids.erase(std::find(ids.begin(), ids.end(), tensor2Id));
+
+				if (resultRank == 0)
+				{
+					if (tensors.size() == 1 || tensors[tensor1Id]->contractsTheNeededQubit)
+					{
+						finalId = tensor1Id;
+						return true;
+					}
+
+					tensors.erase(tensor1Id);
+					idsSet.erase(tensor1Id);
+					ids.erase(std::find(ids.begin(), ids.end(), tensor1Id));
+				}
+			}
+		}
+
+		/**
+		 * @brief Split a part of the network in two.
+		 *
+		 * Several initial splits, given by breadth first traversals from different tensors, are refined with Fiduccia-Mattheyses passes.
+		 * The split with the fewest cut bonds is kept.
+		 *
+		 * @param tensors The tensors of the network.
+		 * @param ids The ids of the tensors in the part.
+		 * @param part1 The ids of the tensors in the first part.
+		 * @param part2 The ids of the tensors in the second part.
+		 */
+		void Bisect(const TensorsMap& tensors, const std::vector<Eigen::Index>& ids, std::vector<Eigen::Index>& part1, std::vector<Eigen::Index>& part2) const
+		{
+			const size_t nrTensors = ids.size();
+
+			std::unordered_map<Eigen::Index, size_t> positions;
+			for (size_t i = 0; i < nrTensors; ++i)
+				positions[ids[i]] = i;
+
+			// the graph of the part, the weight of an edge is the number of bonds between the tensors
+			Adjacency adjacency(nrTensors);
+			for (size_t i = 0; i < nrTensors; ++i)
+			{
+				std::map<size_t, long long int> weights;
+				for (const auto nextTensorId : tensors.at(ids[i])->connections)
+				{
+					const auto it = positions.find(nextTensorId);
+					if (it != positions.end()) ++weights[it->second];
+				}
+
+				adjacency[i].assign(weights.begin(), weights.end());
+			}
+
+			// several initial splits are refined, the one with the fewest cut bonds is kept
+			std::vector<int> side;
+			long long int bestCut = 0;
+			for (size_t attempt = 0; attempt < NrAttempts && attempt < nrTensors; ++attempt)
+			{
+				std::vector<int> attemptSide = Split(adjacency, attempt * nrTensors / NrAttempts);
+				const long long int cut = Refine(adjacency, attemptSide);
+
+				if (side.empty() || cut < bestCut)
+				{
+					bestCut = cut;
+					side.swap(attemptSide);
+				}
+			}
+
+			for (size_t i = 0; i < nrTensors; ++i)
+				(side[i] == 0 ? part1 : part2).push_back(ids[i]);
+		}
+
+		/**
+		 * @brief The initial split of a part in two.
+		 *
+		 * Traverses the graph breadth first, twice, the second time from the last tensor reached the first time, which is far from the others.
+		 * The first half of the visited tensors go in the first part.
+		 *
+		 * @param adjacency The graph of the part.
+		 * @param start The tensor where the first traversal starts.
+		 * @return The part of each tensor, 0 or 1.
+		 */
+		static std::vector<int> Split(const Adjacency& adjacency, size_t start)
+		{
+			const size_t nrTensors = adjacency.size();
+
+			std::vector<size_t> order;
+			for (size_t traversal = 0; traversal < 2; ++traversal)
+			{
+				if (!order.empty()) start = order.back();
+				order.clear();
+
+				std::vector<bool> visited(nrTensors, false);
+				for (size_t root = start, rootsChecked = 0; rootsChecked < nrTensors; root = (root + 1) % nrTensors, ++rootsChecked)
+				{
+					if (visited[root]) continue;
+
+					// the part might not be connected, each connected component is traversed in turn
+					std::queue<size_t> queue;
+					queue.push(root);
+					visited[root] = true;
+
+					while (!queue.empty())
+					{
+						const size_t cur = queue.front();
+						queue.pop();
+						order.push_back(cur);
+
+						for (const auto& [next, weight] : adjacency[cur])
+							if (!visited[next])
+							{
+								visited[next] = true;
+								queue.push(next);
+							}
+					}
+				}
+			}
+
+			std::vector<int> side(nrTensors, 1);
+			for (size_t i = 0; i < nrTensors / 2; ++i)
+				side[order[i]] = 0;
+
+			return side;
+		}
+
+		/**
+		 * @brief Refine a split with Fiduccia-Mattheyses passes.
+		 *
+		 * Moves tensors between the parts, one at a time, the one with the largest decrease of the number of cut bonds first,
+		 * keeping the moves up to the best cut found in the pass.
+		 *
+		 * @param adjacency The graph of the part.
+		 * @param side The part of each tensor, changed by the refinement.
+		 * @return The number of cut bonds.
+		 */
+		long long int Refine(const Adjacency& adjacency, std::vector<int>& side) const
+		{
+			const size_t nrTensors = adjacency.size();
+
+			size_t sizes[2] = { 0, 0 };
+			for (size_t i = 0; i < nrTensors; ++i)
+				++sizes[side[i]];
+
+			const size_t maxPartSize = std::max<size_t>((nrTensors + 1) / 2, static_cast<size_t>(nrTensors * (1. + imbalance) / 2.));
+
+			long long int cut = 0;
+			for (size_t i = 0; i < nrTensors; ++i)
+				for (const auto& [next, weight] : adjacency[i])
+					if (side[next] != side[i]) cut += weight;
+			cut /= 2;
+
+			for (size_t pass = 0; pass < MaxPasses; ++pass)
+			{
+				// the gain of moving a tensor in the other part: the bonds that are not cut anymore minus the ones that become cut
+				std::vector<long long int> gains(nrTensors, 0);
+				for (size_t i = 0; i < nrTensors; ++i)
+					for (const auto& [next, weight] : adjacency[i])
+						gains[i] += side[next] != side[i] ? weight : -weight;
+
+				// the unlocked tensors of each part, ordered by gain
+				std::set<std::pair<long long int, size_t>, std::greater<std::pair<long long int, size_t>>> movable[2];
+				for (size_t i = 0; i < nrTensors; ++i)
+					movable[side[i]].emplace(gains[i], i);
+
+				std::vector<size_t> moves;
+
+				long long int gain = 0;
+				long long int bestGain = 0;
+				size_t bestMoves = 0;
+
+				for (;;)
+				{
+					int from = -1;
+					for (int s = 0; s < 2; ++s)
+						if (!movable[s].empty() && sizes[1 - s] < maxPartSize && (from < 0 || movable[s].begin()->first > movable[from].begin()->first))
+							from = s;
+
+					if (from < 0) break;
+
+					const size_t chosen = movable[from].begin()->second;
+					movable[from].erase(movable[from].begin());
+
+					side[chosen] = 1 - from;
+					--sizes[from];
+					++sizes[1 - from];
+
+					gain += gains[chosen];
+
+					for (const auto& [next, weight] : adjacency[chosen])
+					{
+						auto& nextMovable = movable[side[next]];
+						const auto it = nextMovable.find({ gains[next], next });
+						gains[next] += side[next] == from ? 2 * weight : -2 * weight;
+
+						// locked tensors are not in the sets anymore
+						if (it != nextMovable.end())
+						{
+							nextMovable.erase(it);
+							nextMovable.emplace(gains[next], next);
+						}
+					}
+
+					moves.push_back(chosen);
+
+					if (gain > bestGain)
+					{
+						bestGain = gain;
+						bestMoves = moves.size();
+					}
+				}
+
+				// undo the moves done after the best cut
+				for (size_t i = moves.size(); i > bestMoves; --i)
+				{
+					const size_t moved = moves[i - 1];
+					--sizes[side[moved]];
+					side[moved] = 1 - side[moved];
+					++sizes[side[moved]];
+				}
+
+				cut -= bestGain;
+
+				if (bestGain <= 0) break;
+			}
+
+			return cut;
+		}
+
+		size_t leafSize = 8;
+		double imbalance = 0.2;
+	};
+
+}
+
+#endif // __BISECTION_CONTRACTOR_H_
@@ -0,0 +1,196 @@
+/**
+ * @file ContractionPlan.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Contraction Plan class.
+ *
+ * The ordered list of tensor pairs contracted by a contractor, along with the ranks of the intermediate results.
+ * The plan depends only on the topology of the network (the connections between the tensors), not on the tensors values,
+ * so it can be replayed for networks that differ only in the content of the tensors (for example the projectors).
+ * It can also contain a set of sliced indices, fixed to each of their values in turn to bound the size of the intermediate tensors.
+ */
+
+#pragma once
+
+#ifndef __CONTRACTION_PLAN_H_
+#define __CONTRACTION_PLAN_H_ 1
+
+#include <Eigen/Eigen>
+#include <vector>
+
+namespace TensorNetworks {
+
+	/**
+	 * @brief Contraction Plan.
+	 *
+	 * The ordered list of contractions, as pairs of tensor ids, the result of a contraction keeping the id of the first tensor.
+	 * The intermediate tensors shapes are given by their ranks, all the dimensions being 2.
+	 */
+	class ContractionPlan {
+	public:
+		using Index = Eigen::Index;
+
+		/**
+		 * @brief A contraction step.
+		 */
+		struct Step {
+			Index tensor1Id; /**< The id of the first tensor, the result gets this id */
+			Index tensor2Id; /**< The id of the second tensor */
+			Index resultRank; /**< The rank of the result */
+			bool checkResult; /**< If true and the result rank is zero, the result might be the final one */
+		};
+
+		/**
+		 * @brief An index (bond) fixed to a value in each slice.
+		 *
+		 * Given by the two ends of the bond, in the network before any contraction.
+		 */
+		struct SlicedIndex {
+			Index tensor1Id; /**< The id of the first tensor */
+			Index index1; /**< The index of the bond in the first tensor */
+			Index tensor2Id; /**< The id of the second tensor */
+			Index index2; /**< The index of the bond in the second tensor */
+		};
+
+		/**
+		 * @brief Add a contraction step at the end of the plan.
+		 *
+		 * @param tensor1Id The id of the first tensor, the result gets this id.
+		 * @param tensor2Id The id of the second tensor.
+		 * @param resultRank The rank of the result.
+		 * @param checkResult False for contractions that don't end the contraction even if the result is a scalar (the ones done at initialization).
+		 */
+		void AddStep(Index tensor1Id, Index tensor2Id, Index resultRank, bool checkResult = true)
+		{
+			steps.push_back({ tensor1Id, tensor2Id, resultRank, checkResult });
+		}
+
+		/**
+		 * @brief Get the contraction steps.
+		 *
+		 * @return The steps, in the contraction order.
+		 */
+		const std::vector<Step>& GetSteps() const
+		{
+			return steps;
+		}
+
+		/**
+		 * @brief Set the maximum rank of the tensors encountered during contraction.
+		 *
+		 * @param rank The maximum rank.
+		 */
+		void SetMaxTensorRank(size_t rank)
+		{
+			maxTensorRank = rank;
+		}
+
+		/**
+		 * @brief Get the maximum rank of the tensors encountered during contraction.
+		 *
+		 * @return The maximum rank.
+		 */
+		size_t GetMaxTensorRank() const
+		{
+			return maxTensorRank;
+		}
+
+		/**
+		 * @brief Get the predicted size of the largest tensor.
+		 *
+		 * @return The number of elements of the largest tensor.
+		 */
+		size_t GetMaxTensorSize() const
+		{
+			return 1ULL << maxTensorRank;
+		}
+
+		/**
+		 * @brief Add a sliced index.
+		 *
+		 * @param slicedIndex The bond to slice.
+		 */
+		void AddSlicedIndex(const SlicedIndex& slicedIndex)
+		{
+			slicedIndices.push_back(slicedIndex);
+		}
+
+		/**
+		 * @brief Get the sliced indices.
+		 *
+		 * @return The sliced bonds, empty if the plan is contracted without slicing.
+		 */
+		const std::vector<SlicedIndex>& GetSlicedIndices() const
+		{
+			return slicedIndices;
+		}
+
+		/**
+		 * @brief Get the number of slices.
+		 *
+		 * @return The number of independent contractions that are summed to get the result.
+		 */
+		size_t GetNumberOfSlices() const
+		{
+			return 1ULL << slicedIndices.size();
+		}
+
+		/**
+		 * @brief Set the predicted cost of the contraction.
+		 *
+		 * @param nrFlops The number of complex multiply-add operations, for all the slices.
+		 * @param peakBytes The largest memory needed by a contraction step, in bytes.
+		 */
+		void SetCost(double nrFlops, double peakBytes)
+		{
+			flops = nrFlops;
+			peakMemory = peakBytes;
+		}
+
+		/**
+		 * @brief Get the predicted number of operations.
+		 *
+		 * @return The number of complex multiply-add operations, for all the slices.
+		 */
+		double GetFlops() const
+		{
+			return flops;
+		}
+
+		/**
+		 * @brief Get the predicted peak memory.
+		 *
+		 * @return The largest memory needed by a contraction step (the two contracted tensors and the result), in bytes.
+		 */
+		double GetPeakMemory() const
+		{
+			return peakMemory;
+		}
+
+		bool empty() const
+		{
+			return steps.empty();
+		}
+
+		void clear()
+		{
+			steps.clear();
+			slicedIndices.clear();
+			maxTensorRank = 0;
+			flops = 0;
+			peakMemory = 0;
+		}
+
+	private:
+		std::vector<Step> steps; /**< The contraction steps */
+		std::vector<SlicedIndex> slicedIndices; /**< The sliced bonds */
+		size_t maxTensorRank = 0; /**< The maximum rank of the tensors encountered during contraction */
+		double flops = 0; /**< The predicted number of operations */
+		double peakMemory = 0; /**< The predicted peak memory, in bytes */
+	};
+
+}
+
+#endif // __CONTRACTION_PLAN_H_
@@ -34,17 +34,19 @@ namespace TensorNetworks {
 	class DumbContractor : public BaseContractor {
 	public:
 		/**
-		 * @brief Contract the tensor network.
+		 * @brief Contract the tensor network, searching for the contraction order.
 		 *
 		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
 		 * @return The result of the contraction.
 		 */
-		double Contract(const TensorNetwork& network, Types::qubit_t qubit) override
+		double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) override
 		{
 			std::vector<Eigen::Index> keys;
 			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
 
-			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false);
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, true, &plan);
 
 			Eigen::Index minId = std::numeric_limits<Eigen::Index>::max();
 
@@ -115,6 +117,7 @@ namespace TensorNetworks {
 				//	it = tensors.begin();
 
 				ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+				plan.AddStep(tensor1Id, tensor2Id, resultRank);
 
 				if (resultRank == 0) 
 				{
@@ -156,9 +159,7 @@ namespace TensorNetworks {
 		std::shared_ptr<ITensorContractor> Clone() const override
 		{
 			auto cloned = std::make_shared<DumbContractor>();
-
-			cloned->maxTensorRank = maxTensorRank;
-			cloned->enableMultithreading = enableMultithreading;
+			CloneBase(*cloned);
 			cloned->contractTheLowestTensorId = contractTheLowestTensorId;
 
 			return cloned;
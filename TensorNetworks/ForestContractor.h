@@ -32,17 +32,19 @@ namespace TensorNetworks {
 	class ForestContractor : public BaseContractor {
 	public:
 		/**
-		 * @brief Contract the tensor network.
+		 * @brief Contract the tensor network, searching for the contraction order.
 		 *
 		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
 		 * @return The result of the contraction.
 		 */
-		double Contract(const TensorNetwork& network, Types::qubit_t qubit) override
+		double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) override
 		{
 			std::vector<Eigen::Index> keys;
 			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
 
-			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false);
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, true, &plan);
 			std::map<Eigen::Index, std::shared_ptr<TensorNode>> tensorsMap(tensors.begin(), tensors.end());
 			
 			using TensorPair = std::pair<Eigen::Index, Eigen::Index>;
@@ -129,6 +131,7 @@ namespace TensorNetworks {
 				}
 
 				ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+				plan.AddStep(tensor1Id, tensor2Id, resultRank);
 				tensorsMap[tensor1Id] = tensors[tensor1Id];
 				tensorsMap.erase(tensor2Id);
 
@@ -155,9 +158,7 @@ namespace TensorNetworks {
 		std::shared_ptr<ITensorContractor> Clone() const override
 		{
 			auto cloned = std::make_shared<ForestContractor>();
-
-			cloned->maxTensorRank = maxTensorRank;
-			cloned->enableMultithreading = enableMultithreading;
+			CloneBase(*cloned);
 
 			return cloned;
 		}
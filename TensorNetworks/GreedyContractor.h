@@ -0,0 +1,222 @@
+/**
+ * @file GreedyContractor.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The Greedy Tensor Contractor.
+ * At each step it contracts the connected pair of tensors with the best score given by a cost model:
+ * the size of the result minus the (weighted) sizes of the contracted tensors, plus the (weighted) number of operations needed.
+ * The candidate pairs are kept in a priority queue and only the pairs of the result are added after a contraction,
+ * so the search scales to networks with thousands of tensors.
+ *
+ * Tensor contractions using the Greedy contraction method.
+ */
+
+#pragma once
+
+#ifndef  __GREEDY_CONTRACTOR_H_
+#define __GREEDY_CONTRACTOR_H_ 1
+
+#include "BaseContractor.h"
+
+#include <queue>
+#include <tuple>
+
+namespace TensorNetworks {
+
+	/**
+	 * @brief The Greedy Tensor Contractor.
+	 *
+	 * Tensor contractions using the Greedy contraction method.
+	 * The predicted number of operations and peak memory of the contraction are available with GetPredictedFlops and GetPredictedPeakMemory.
+	 */
+	class GreedyContractor : public BaseContractor {
+	public:
+		/**
+		 * @brief Contract the tensor network, searching for the contraction order.
+		 *
+		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
+		 * @return The result of the contraction.
+		 */
+		double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) override
+		{
+			std::vector<Eigen::Index> keys;
+			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
+
+			// no contractions at initialization, all of them are chosen by the cost model
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, false, &plan);
+
+			CandidatesQueue candidates;
+			std::unordered_map<Eigen::Index, size_t> versions;
+
+			for (const auto& [tensorId, tensor] : tensors)
+				versions[tensorId] = 0;
+
+			for (const auto& [tensorId, tensor] : tensors)
+				AddCandidates(tensors, tensorId, versions, candidates, true);
+
+			while (tensors.size() > 1)
+			{
+				Eigen::Index tensor1Id;
+				Eigen::Index tensor2Id;
+
+				if (candidates.empty())
+				{
+					// not connected, the outer product is needed
+					auto it = tensors.begin();
+					tensor1Id = it->first;
+					tensor2Id = (++it)->first;
+				}
+				else
+				{
+					const Candidate candidate = candidates.top();
+					candidates.pop();
+
+					// one of the tensors was contracted since the candidate was added
+					const auto it1 = versions.find(candidate.tensor1Id);
+					const auto it2 = versions.find(candidate.tensor2Id);
+					if (it1 == versions.end() || it2 == versions.end() || it1->second != candidate.version1 || it2->second != candidate.version2)
+						continue;
+
+					tensor1Id = candidate.tensor1Id;
+					tensor2Id = candidate.tensor2Id;
+				}
+
+				const auto resultRank = GetResultRank(tensors[tensor1Id], tensors[tensor2Id]);
+				ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+				plan.AddStep(tensor1Id, tensor2Id, resultRank);
+
+				++versions[tensor1Id];
+				versions.erase(tensor2Id);
+
+				if (resultRank == 0)
+				{
+					const auto& tensor = tensors[tensor1Id];
+					if (tensors.size() == 1 || tensor->contractsTheNeededQubit)
+						return std::real(tensor->tensor->atOffset(0));
+
+					tensors.erase(tensor1Id);
+					versions.erase(tensor1Id);
+
+					continue;
+				}
+
+				AddCandidates(tensors, tensor1Id, versions, candidates, false);
+			}
+
+			return std::real(tensors.begin()->second->tensor->atOffset(0));
+		}
+
+		double GetSizeWeight() const
+		{
+			return sizeWeight;
+		}
+
+		/**
+		 * @brief Set the weight of the sizes of the contracted tensors in the score.
+		 *
+		 * With 1 (the default) the score is the change in memory, with 0 it's the size of the result.
+		 *
+		 * @param weight The weight.
+		 */
+		void SetSizeWeight(double weight)
+		{
+			sizeWeight = weight;
+		}
+
+		double GetFlopsWeight() const
+		{
+			return flopsWeight;
+		}
+
+		/**
+		 * @brief Set the weight of the number of operations in the score.
+		 *
+		 * With 0 (the default) the number of operations is used only to choose between pairs with the same score.
+		 *
+		 * @param weight The weight.
+		 */
+		void SetFlopsWeight(double weight)
+		{
+			flopsWeight = weight;
+		}
+
+		/**
+		 * @brief Clone the tensor contractor.
+		 *
+		 * @return A shared pointer to the cloned tensor contractor.
+		 */
+		std::shared_ptr<ITensorContractor> Clone() const override
+		{
+			auto cloned = std::make_shared<GreedyContractor>();
+			CloneBase(*cloned);
+			cloned->sizeWeight = sizeWeight;
+			cloned->flopsWeight = flopsWeight;
+
+			return cloned;
+		}
+
+	private:
+		/**
+		 * @brief A pair of connected tensors that can be contracted.
+		 */
+		struct Candidate {
+			double score; /**< The score, lower is better */
+			double flops; /**< The number of operations */
+			Eigen::Index tensor1Id; /**< The id of the first tensor */
+			Eigen::Index tensor2Id; /**< The id of the second tensor */
+			size_t version1; /**< The version of the first tensor when the candidate was added */
+			size_t version2; /**< The version of the second tensor when the candidate was added */
+
+			bool operator>(const Candidate& other) const
+			{
+				return std::tie(score, flops, tensor1Id, tensor2Id) > std::tie(other.score, other.flops, other.tensor1Id, other.tensor2Id);
+			}
+		};
+
+		using CandidatesQueue = std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>>;
+
+		/**
+		 * @brief Add the pairs of a tensor with the tensors connected to it.
+		 *
+		 * @param tensors The tensors.
+		 * @param tensorId The id of the tensor.
+		 * @param versions The versions of the tensors, incremented each time a tensor is the result of a contraction.
+		 * @param candidates The candidates queue.
+		 * @param onlyFollowing If true, only the pairs with tensors with a greater id are added (used at initialization, to add each pair once).
+		 */
+		void AddCandidates(const TensorsMap& tensors, Eigen::Index tensorId, const std::unordered_map<Eigen::Index, size_t>& versions, CandidatesQueue& candidates, bool onlyFollowing) const
+		{
+			const auto& tensor = tensors.at(tensorId);
+			const size_t version = versions.at(tensorId);
+
+			Eigen::Index lastTensorId = TensorNode::NotConnected;
+			for (const auto nextTensorId : tensor->connections)
+			{
+				// several indices can be connected to the same tensor, add the pair only once for consecutive ones
+				if (nextTensorId == TensorNode::NotConnected || nextTensorId == lastTensorId || (onlyFollowing && nextTensorId < tensorId)) continue;
+				lastTensorId = nextTensorId;
+
+				const auto& nextTensor = tensors.at(nextTensorId);
+
+				const int rank1 = static_cast<int>(tensor->GetRank());
+				const int rank2 = static_cast<int>(nextTensor->GetRank());
+				const int resultRank = static_cast<int>(GetResultRank(tensor, nextTensor));
+
+				const double flops = std::ldexp(1., (rank1 + rank2 + resultRank) / 2);
+				const double score = std::ldexp(1., resultRank) - sizeWeight * (std::ldexp(1., rank1) + std::ldexp(1., rank2)) + flopsWeight * flops;
+
+				candidates.push({ score, flops, tensorId, nextTensorId, version, versions.at(nextTensorId) });
+			}
+		}
+
+		double sizeWeight = 1.;
+		double flopsWeight = 0.;
+	};
+
+}
+
+#endif // __GREEDY_CONTRACTOR_H_
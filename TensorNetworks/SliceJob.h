@@ -0,0 +1,62 @@
+/**
+ * @file SliceJob.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A job contracting slices of a sliced tensor network.
+ *
+ * The slices are independent contractions, so they are executed on a threads pool, each job taking slices until there are none left.
+ */
+
+#pragma once
+
+#ifndef __SLICE_JOB_H_
+#define __SLICE_JOB_H_ 1
+
+#include <functional>
+
+#include "../Utils/ThreadsPool.h"
+#include "../Utils/WorkStealingThreadsPool.h"
+
+namespace TensorNetworks {
+
+	/**
+	 * @brief A job contracting slices.
+	 *
+	 * Wraps the work to be done by a thread of the pool, which contracts slices and accumulates their results.
+	 */
+	class SliceJob
+	{
+	public:
+		SliceJob() = delete;
+
+		explicit SliceJob(std::function<void()> w)
+			: work(std::move(w))
+		{
+		}
+
+		void DoWork()
+		{
+			if (work) work();
+		}
+
+		size_t GetJobCount() const
+		{
+			return 1;
+		}
+
+	private:
+		std::function<void()> work;
+	};
+
+	// the pool used for contracting the slices
+#ifdef USE_SINGLE_QUEUE_THREADS_POOL
+	using SliceJobsPool = Utils::ThreadsPool<SliceJob>;
+#else
+	using SliceJobsPool = Utils::WorkStealingThreadsPool<SliceJob>;
+#endif
+
+}
+
+#endif // __SLICE_JOB_H_
@@ -41,12 +41,14 @@ namespace TensorNetworks {
 		}
 
 		/**
-		 * @brief Contract the tensor network.
+		 * @brief Contract the tensor network, searching for the contraction order.
 		 *
 		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
 		 * @return The result of the contraction.
 		 */
-		double Contract(const TensorNetwork& network, Types::qubit_t qubit) override
+		double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) override
 		{
 			// algorithm very similar with the 'Algorithm 2' from arXiv:1709.03636v2 [quant-ph] 22 Dec 2018
 			// qTorch: The quantum tensor contraction handler
@@ -58,7 +60,7 @@ namespace TensorNetworks {
 			std::vector<Eigen::Index> keys;
 			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
 		
-			auto tensors = InitializeTensors(network, qubit, keys, keysKeys);
+			auto tensors = InitializeTensors(network, qubit, keys, keysKeys, true, true, &plan);
 
 			using TensorPair = std::pair<Eigen::Index, Eigen::Index>;
 			std::unordered_set<TensorPair, boost::hash<TensorPair>> visitedPairs;
@@ -111,6 +113,7 @@ namespace TensorNetworks {
 					CostThreshold = -1;
 
 					ContractNodes(qubit, tensors, tensor1Id, tensor2Id, resultRank);
+					plan.AddStep(tensor1Id, tensor2Id, resultRank);
 
 					visitedPairs.clear();
 
@@ -171,9 +174,7 @@ namespace TensorNetworks {
 		std::shared_ptr<ITensorContractor> Clone() const override
 		{
 			auto cloned = std::make_shared<StochasticContractor>();
-
-			cloned->maxTensorRank = maxTensorRank;
-			cloned->enableMultithreading = enableMultithreading;
+			CloneBase(*cloned);
 			cloned->MaxRejections = MaxRejections;
 
 			return cloned;
@@ -19,6 +19,7 @@
 
 #include "../Utils/Tensor.h"
 #include "TensorNetwork.h"
+#include "ContractionPlan.h"
 
 namespace TensorNetworks {
 
@@ -34,7 +35,7 @@ namespace TensorNetworks {
 	public:
 		using TensorsMap = std::unordered_map<Eigen::Index, std::shared_ptr<TensorNode>>;
 
-		virtual TensorsMap InitializeTensors(const TensorNetwork& network, Types::qubit_t qubit, std::vector<Eigen::Index>& keys, std::unordered_map<Eigen::Index, Eigen::Index>& keysKeys, bool fillKeys = true, bool contract = true) = 0;
+		virtual TensorsMap InitializeTensors(const TensorNetwork& network, Types::qubit_t qubit, std::vector<Eigen::Index>& keys, std::unordered_map<Eigen::Index, Eigen::Index>& keysKeys, bool fillKeys = true, bool contract = true, ContractionPlan* plan = nullptr) = 0;
 		
 		/**
 		 * @brief Contract the tensor network.
@@ -44,8 +45,42 @@ namespace TensorNetworks {
 		 */
 		virtual double Contract(const TensorNetwork& network, Types::qubit_t qubit) = 0;
 
+		/**
+		 * @brief Get the contraction plan for the tensor network, without contracting it.
+		 *
+		 * @param network The tensor network.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @return The contraction plan, with its predicted cost.
+		 */
+		virtual std::shared_ptr<const ContractionPlan> Plan(const TensorNetwork& network, Types::qubit_t qubit) = 0;
+
+		/**
+		 * @brief Contract a connected network that might have open indices.
+		 *
+		 * @param tensors The tensors of the network, they are changed by the contraction.
+		 * @return The result node, its qubits give the qubit of each index of the result tensor.
+		 */
+		virtual std::shared_ptr<TensorNode> ContractOpen(TensorsMap& tensors) = 0;
+
 		virtual size_t GetMaxTensorRank() const = 0;
 
+		/**
+		 * @brief Set the maximum size of an intermediate tensor.
+		 *
+		 * If the contraction would need larger intermediate tensors, some indices are sliced:
+		 * they are fixed to each of their values in turn, the slices are contracted independently and their results are summed.
+		 *
+		 * @param bytes The maximum size in bytes of an intermediate tensor, zero for no limit.
+		 */
+		virtual void SetMaxIntermediateSize(size_t bytes = 0) = 0;
+
+		/**
+		 * @brief Get the maximum size of an intermediate tensor.
+		 *
+		 * @return The maximum size in bytes of an intermediate tensor, zero if there is no limit.
+		 */
+		virtual size_t GetMaxIntermediateSize() const = 0;
+
 		/**
 		 * @brief Enable/disable multithreading.
 		 *
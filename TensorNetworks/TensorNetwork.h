@@ -16,17 +16,29 @@
 
 #include <Eigen/Eigen>
 #include <vector>
+#include <complex>
+#include <random>
+#include <algorithm>
+#include <set>
 #include <unordered_set>
+#include <limits>
 
 #include "TensorNode.h"
 #include "TensorContractor.h"
 
+#include "../Utils/Alias.h"
+#include "../Utils/BitScatter.h"
+#include "../Utils/PauliString.h"
+
 namespace TensorNetworks {
 
 	class TensorNetwork {
 	public:
 		using Index = Eigen::Index;
 
+		constexpr static size_t MaxSingleLayerSamplingQubits = 20; /**< Qubits groups larger than this are sampled by measuring on the doubled network */
+		constexpr static size_t OutcomeBits = std::numeric_limits<size_t>::digits; /**< The number of qubits that fit in an outcome, basis states and samples are truncated to these */
+
 		TensorNetwork() = delete;
 
 		/**
@@ -103,6 +115,37 @@ namespace TensorNetworks {
 			return result;
 		}
 
+		/**
+		 * @brief Get the plan of the contraction for the probability of a qubit, without contracting the network.
+		 *
+		 * The order of the contraction is searched using only the shapes of the tensors, so it's a lot faster than computing the probability.
+		 * It gives the predicted number of operations and peak memory of the contraction.
+		 *
+		 * @param qubit The qubit.
+		 * @return The contraction plan, nullptr if there is no contractor set.
+		 */
+		std::shared_ptr<const ContractionPlan> PlanProbability(Types::qubit_t qubit)
+		{
+			if (!contractor) return nullptr;
+
+			const auto lastTensorIdOnQubit = lastTensors[qubit];
+			const auto lastTensorIndexOnQubit = lastTensorIndices[qubit];
+
+			AddProjector(qubit, true);
+
+			Connect();
+
+			const auto plan = contractor->Plan(*this, qubit);
+
+			// restore back the network to the previous state, as for Probability
+			lastTensors[qubit] = lastTensorIdOnQubit;
+			lastTensorIndices[qubit] = lastTensorIndexOnQubit;
+
+			tensors.resize(tensors.size() - 1);
+
+			return plan;
+		}
+
 		/**
 		 * @brief Returns the expected value of a Pauli string.
 		 *
@@ -116,7 +159,22 @@ namespace TensorNetworks {
 		double ExpectationValue(const std::string& pauliString)
 		{
 			if (pauliString.empty()) return 1.;
-			else if (!contractor) return 0.;
+
+			return ExpectationValue(Utils::PauliString(pauliString));
+		}
+
+		/**
+		 * @brief Returns the expected value of a parsed Pauli string.
+		 *
+		 * Only the qubits with an operator are visited, the identities are skipped.
+		 *
+		 * @param pauli The Pauli string to obtain the expected value for.
+		 * @return The expected value of the specified Pauli string.
+		 */
+		double ExpectationValue(const Utils::PauliString& pauli)
+		{
+			if (!contractor) return 0.;
+			else if (pauli.IsIdentity()) return 1.;
 
 			auto savedTensorsNrLocal = tensors.size();
 			auto saveLastTensorsLocal = lastTensors;
@@ -129,29 +187,18 @@ namespace TensorNetworks {
 
 			std::unordered_set<Types::qubit_t> usedQubits;
 
-			for (Types::qubit_t q = 0; q < pauliString.size(); ++q)
-			{
-				const char op = toupper(pauliString[q]);
-				switch (op)
+			pauli.ForEachOperator([&](size_t q, char op)
 				{
-				case 'X':
-					AddOneQubitExpectationValueOp(XGate, q);
-					usedQubits.insert(q);
-					break;
-				case 'Y':
-					AddOneQubitExpectationValueOp(YGate, q);
-					usedQubits.insert(q);
-					break;
-				case 'Z':
-					AddOneQubitExpectationValueOp(ZGate, q);
-					usedQubits.insert(q);
-					break;
-				case 'I':
-					[[fallthrough]];
-				default:
-					break;
-				}
-			}
+					const Types::qubit_t qubit = static_cast<Types::qubit_t>(q);
+					if (op == 'X')
+						AddOneQubitExpectationValueOp(XGate, qubit);
+					else if (op == 'Y')
+						AddOneQubitExpectationValueOp(YGate, qubit);
+					else
+						AddOneQubitExpectationValueOp(ZGate, qubit);
+
+					usedQubits.insert(qubit);
+				});
 
 			if (usedQubits.empty()) return 1.;
 
@@ -189,6 +236,135 @@ namespace TensorNetworks {
 			return prob;
 		}
 
+		/**
+		 * @brief Returns the amplitude of a basis state.
+		 *
+		 * Contracts only the single layer (ket) network, with the outputs set to the basis state, once for each qubits group.
+		 * The contraction plan is the same for all the basis states, so after the first call it's cached.
+		 *
+		 * @param outcome The basis state, the qubits above the width of the outcome are taken to be 0.
+		 * @return The amplitude of the basis state.
+		 */
+		std::complex<double> Amplitude(size_t outcome)
+		{
+			if (!contractor) return 0.;
+			contractor->SetMultithreading(enableMultithreading);
+
+			std::complex<double> result = 1.;
+
+			for (const auto& group : qubitsGroups)
+			{
+				auto groupTensors = GetSingleLayerTensors(group.second, &outcome);
+				result *= contractor->ContractOpen(groupTensors)->tensor->atOffset(0);
+
+				if (result == 0.) break;
+			}
+
+			return result;
+		}
+
+		/**
+		 * @brief Returns the amplitudes of a batch of basis states.
+		 *
+		 * @param outcomes The basis states.
+		 * @return The amplitudes of the basis states, in the same order.
+		 * @sa TensorNetwork::Amplitude
+		 */
+		std::vector<std::complex<double>> Amplitudes(const std::vector<size_t>& outcomes)
+		{
+			std::vector<std::complex<double>> result;
+			result.reserve(outcomes.size());
+
+			for (const auto outcome : outcomes)
+				result.push_back(Amplitude(outcome));
+
+			return result;
+		}
+
+		/**
+		 * @brief Samples the measurement of the specified qubits, without collapsing the state.
+		 *
+		 * The qubits groups are not entangled with each other, so they are sampled independently.
+		 * A group with at most MaxSingleLayerSamplingQubits qubits is sampled from its amplitudes, obtained with a single contraction
+		 * of its single layer network, with the outputs left open, for all the shots.
+		 * The measured qubits from larger groups are measured one by one on the doubled network, restoring the network after each shot.
+		 *
+		 * @param qubits The qubits to measure, the bit i of an outcome is the result for qubits[i].
+		 * @param shots The number of shots.
+		 * @return The outcomes, one for each shot.
+		 */
+		std::vector<size_t> Sample(const Types::qubits_vector& qubits, size_t shots)
+		{
+			std::vector<size_t> outcomes(shots, 0);
+			if (shots == 0 || qubits.empty() || !contractor) return outcomes;
+			contractor->SetMultithreading(enableMultithreading);
+
+			// the measured qubits and their bit positions in the outcome, for each group
+			std::unordered_map<size_t, std::vector<std::pair<Types::qubit_t, size_t>>> measuredInGroups;
+			for (size_t i = 0; i < qubits.size(); ++i)
+				measuredInGroups[qubitsMap[qubits[i]]].emplace_back(qubits[i], i);
+
+			std::vector<std::pair<Types::qubit_t, size_t>> measuredInLargeGroups;
+			std::vector<size_t> groupOutcomes;
+			bool first = true;
+
+			for (const auto& [groupId, measured] : measuredInGroups)
+			{
+				const auto& group = qubitsGroups.at(groupId);
+				if (group.size() > MaxSingleLayerSamplingQubits)
+				{
+					measuredInLargeGroups.insert(measuredInLargeGroups.end(), measured.begin(), measured.end());
+					continue;
+				}
+
+				auto groupTensors = GetSingleLayerTensors(group);
+				const auto node = contractor->ContractOpen(groupTensors);
+
+				// the tensor has the fortran layout, so the bit j of the offset is the index j, which is on the qubit node->qubits[j]
+				std::vector<std::pair<size_t, size_t>> bitsMap;
+				for (const auto& [q, pos] : measured)
+				{
+					const auto it = std::find(node->qubits.begin(), node->qubits.end(), q);
+					bitsMap.emplace_back(it - node->qubits.begin(), pos);
+				}
+				const Utils::BitScatter scatter(bitsMap);
+
+				const auto& values = node->tensor->GetValues();
+				const Eigen::Map<const Eigen::VectorXcd> amplitudes(&values[0], values.size());
+
+				groupOutcomes.clear();
+				groupOutcomes.reserve(shots);
+				Utils::SampleStatesCounts(amplitudes, shots, rng, [&](size_t state, size_t cnt)
+					{
+						groupOutcomes.insert(groupOutcomes.end(), cnt, scatter.Scatter(state));
+					}, enableMultithreading ? QC::QubitRegisterCalculator<>::GetNumberOfThreads() : 1);
+
+				// the samplers might report the states in order, the groups would be correlated if combined like that
+				if (!first || measuredInGroups.size() > 1)
+					std::shuffle(groupOutcomes.begin(), groupOutcomes.end(), rng);
+				first = false;
+
+				for (size_t shot = 0; shot < shots; ++shot)
+					outcomes[shot] |= groupOutcomes[shot];
+			}
+
+			if (!measuredInLargeGroups.empty())
+			{
+				SaveState();
+				for (size_t shot = 0; shot < shots; ++shot)
+				{
+					for (const auto& [q, pos] : measuredInLargeGroups)
+						if (Measure(q) && pos < OutcomeBits)
+							outcomes[shot] |= 1ULL << pos;
+
+					RestoreState();
+				}
+				ClearSavedState();
+			}
+
+			return outcomes;
+		}
+
 		bool Measure(Types::qubit_t qubit)
 		{
 			const double p0 = Probability(qubit, false);
@@ -468,6 +644,90 @@ namespace TensorNetworks {
 		}
 
 	private:
+		/**
+		 * @brief Gets the single layer network of a qubits group.
+		 *
+		 * The ket tensors of the group, cloned so that their connections can be changed, without the super tensors.
+		 * The output indices are either left open or connected to basis state tensors.
+		 *
+		 * @param group The qubits group.
+		 * @param outcome If not null, the basis state the outputs are connected to, otherwise the outputs are left open.
+		 * @return The tensors of the single layer network.
+		 */
+		ITensorContractor::TensorsMap GetSingleLayerTensors(const std::unordered_set<Types::qubit_t>& group, const size_t* outcome = nullptr) const
+		{
+			ITensorContractor::TensorsMap result;
+
+			// the output indices of the last tensors, they might be connected to the super tensors
+			std::set<std::pair<Index, Index>> outputs;
+			std::vector<Index> toVisit;
+
+			for (const auto q : group)
+			{
+				const auto lastTensorId = lastTensors[q];
+				outputs.emplace(lastTensorId, lastTensorIndices[q]);
+
+				if (result.find(lastTensorId) == result.end())
+				{
+					result[lastTensorId] = tensors[lastTensorId]->CloneWithoutTensorCopy();
+					toVisit.push_back(lastTensorId);
+				}
+			}
+
+			// going backwards from the last tensors reaches all the ket tensors of the group, and only them
+			while (!toVisit.empty())
+			{
+				const auto tensorId = toVisit.back();
+				toVisit.pop_back();
+
+				const auto& tensor = result[tensorId];
+				for (Index i = 0; i < static_cast<Index>(tensor->connections.size()); ++i)
+				{
+					const auto connectedTensorId = tensor->connections[i];
+					if (connectedTensorId == TensorNode::NotConnected || outputs.find(std::make_pair(tensorId, i)) != outputs.end())
+						continue;
+
+					if (result.find(connectedTensorId) == result.end())
+					{
+						result[connectedTensorId] = tensors[connectedTensorId]->CloneWithoutTensorCopy();
+						toVisit.push_back(connectedTensorId);
+					}
+				}
+			}
+
+			for (const auto q : group)
+			{
+				const auto lastTensorId = lastTensors[q];
+				const auto lastTensorIndex = lastTensorIndices[q];
+				const auto& lastTensor = result[lastTensorId];
+
+				if (outcome)
+				{
+					auto basisNode = std::make_shared<TensorNode>();
+					// the qubits above the outcome width are taken as 0
+					const bool one = q < OutcomeBits && ((*outcome >> q) & 1);
+					basisNode->SetQubit(q, !one);
+
+					const auto basisNodeId = static_cast<Index>(tensors.size() + q);
+					basisNode->SetId(basisNodeId);
+					basisNode->connections[0] = lastTensorId;
+					basisNode->connectionsIndices[0] = lastTensorIndex;
+
+					lastTensor->connections[lastTensorIndex] = basisNodeId;
+					lastTensor->connectionsIndices[lastTensorIndex] = 0;
+
+					result[basisNodeId] = std::move(basisNode);
+				}
+				else
+				{
+					lastTensor->connections[lastTensorIndex] = TensorNode::NotConnected;
+					lastTensor->connectionsIndices[lastTensorIndex] = TensorNode::NotConnected;
+				}
+			}
+
+			return result;
+		}
+
 		void AddOneQubitExpectationValueOp(const QC::Gates::QuantumGateWithOp<TensorNode::MatrixClass>& gate, Types::qubit_t q)
 		{
 			auto tensorNode = std::make_shared<TensorNode>();
@@ -31,17 +31,19 @@ namespace  TensorNetworks {
 	class VerticalContractor : public BaseContractor {
 	public:
 		/**
-		 * @brief Contract the tensor network.
+		 * @brief Contract the tensor network, searching for the contraction order.
 		 *
 		 * @param network The tensor network to contract.
+		 * @param qubit The qubit that identifies the qubits group to contract.
+		 * @param plan The plan where the contractions are recorded.
 		 * @return The result of the contraction.
 		 */
-		double Contract(const TensorNetwork& network, Types::qubit_t qubit) override
+		double ContractAndPlan(const TensorNetwork& network, Types::qubit_t qubit, ContractionPlan& plan) override
 		{
 			std::vector<Eigen::Index> keys;
 			std::unordered_map<Eigen::Index, Eigen::Index> keysKeys;
 
-			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false);
+			TensorsMap tensors = InitializeTensors(network, qubit, keys, keysKeys, false, true, &plan);
 
 			const auto& qubitGroup = network.GetQubitGroup(qubit);
 			const std::set<Types::qubit_t> qubitGroupSet(qubitGroup.begin(), qubitGroup.end());
@@ -114,6 +116,7 @@ namespace  TensorNetworks {
 				}
 
 				ContractNodes(qubit, tensors, tensor1IdBest, tensor2IdBest, resultRankBest);
+				plan.AddStep(tensor1IdBest, tensor2IdBest, resultRankBest);
 
 				if (resultRankBest == 0)
 				{
@@ -135,8 +138,7 @@ namespace  TensorNetworks {
 		std::shared_ptr<ITensorContractor> Clone() const override
 		{
 			auto cloned = std::make_shared<VerticalContractor>();
-			cloned->maxTensorRank = maxTensorRank;
-			cloned->enableMultithreading = enableMultithreading;
+			CloneBase(*cloned);
 			return cloned;
 		}
 	};
@@ -5,6 +5,8 @@
  * @section DESCRIPTION
  *
  * Alias sampling for O(1) sampling with a O(N) preprocessing step.
+ *
+ * Also cumulative sum with binary search sampling and sorted uniforms sweep sampling, along with a cost based choice between them.
  */
 
 #pragma once
@@ -14,75 +16,121 @@
 
 #include <complex>
 #include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
 
 #include <Eigen/Eigen>
 
 namespace Utils {
 
+	namespace Private {
+		constexpr static size_t ProbabilitiesOmpLimit = 1ULL << 16; /**< Below this size the probabilities are computed on a single thread */
+
+		/**
+		 * @brief Computes the probabilities of the basis states.
+		 *
+		 * The trailing zero probabilities are dropped, they can't be sampled.
+		 *
+		 * @param statevector The statevector, must have contiguous storage (data()).
+		 * @param probabilities The probabilities, resized as needed.
+		 * @param nrThreads The number of threads to use.
+		 */
+		template<class T> void ComputeProbabilities(const T& statevector, std::vector<double>& probabilities, int nrThreads)
+		{
+			const long long int sz = static_cast<long long int>(statevector.size());
+			probabilities.resize(sz);
+
+			// the norm computed on the real and imaginary parts gets vectorized, std::norm might not
+			const double* amplitudes = reinterpret_cast<const double*>(statevector.data());
+			double* probs = probabilities.data();
+
+			if (nrThreads < 2 || sz < static_cast<long long int>(ProbabilitiesOmpLimit)) nrThreads = 1;
+
+#pragma omp parallel for simd num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+			for (long long int i = 0; i < sz; ++i)
+				probs[i] = amplitudes[2 * i] * amplitudes[2 * i] + amplitudes[2 * i + 1] * amplitudes[2 * i + 1];
+
+			size_t last = probabilities.size();
+			while (last > 1 && probabilities[last - 1] == 0.)
+				--last;
+
+			probabilities.resize(last);
+		}
+	}
+
+	/**
+	 * @class Alias
+	 * @brief Alias table sampling.
+	 *
+	 * O(1) sampling, but the table construction is the most expensive of the samplers.
+	 * The table entries have a float threshold and a 32 bit alias, so the table uses half the memory of a double/64 bit one.
+	 * The threshold precision is good enough for sampling, the error on an outcome probability is about 1e-7 of its bucket.
+	 */
 	class Alias {
 	public:
 		Alias() = delete;
 
-		template<class T = Eigen::VectorXcd> Alias(const T& statevector)
+		/**
+		 * @brief Construct the alias table.
+		 *
+		 * @param statevector The statevector to sample from.
+		 * @param nrThreads The number of threads to use for computing the probabilities.
+		 */
+		template<class T = Eigen::VectorXcd> Alias(const T& statevector, int nrThreads = 1)
 		{
-			std::vector<double> probabilities(statevector.size());
-			double accum = 0.;
-			for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(statevector.size()); ++i)
-			{
-				probabilities[i] = std::norm(statevector[i]);
-				accum += probabilities[i];
-				if (accum > 1. - std::numeric_limits<double>::epsilon())
-				{
-					probabilities.resize(i + 1);
-					break;
-				}
-			}
+			std::vector<double> probabilities;
+			Private::ComputeProbabilities(statevector, probabilities, nrThreads);
+
+			const size_t sz = probabilities.size();
+			if (sz > static_cast<size_t>(std::numeric_limits<uint32_t>::max()))
+				throw std::runtime_error("Alias: too many states for the alias table.");
 
-			aliasTable.resize(probabilities.size());
+			double total = 0.;
+			for (const double p : probabilities)
+				total += p;
+			const double scale = total > 0. ? sz / total : 1.;
 
-			std::vector<AliasEntry> under;
-			std::vector<AliasEntry> over;
+			aliasTable.resize(sz);
 
-			// this uses four times the memory of the sampling with the binary search 
-			under.reserve(probabilities.size());
-			over.reserve(probabilities.size());
+			// the under and over worklists share the same indices vector, under grows from the front, over from the back
+			std::vector<uint32_t> indices(sz);
+			size_t nrUnder = 0;
+			size_t overStart = sz;
 
-			for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(probabilities.size()); ++i)
+			for (size_t i = 0; i < sz; ++i)
 			{
-				const double prob = probabilities[i] * probabilities.size();
-				if (prob < 1.)
-					under.emplace_back(prob, i);
+				probabilities[i] *= scale;
+				if (probabilities[i] < 1.)
+					indices[nrUnder++] = static_cast<uint32_t>(i);
 				else
-					over.emplace_back(prob, i);
+					indices[--overStart] = static_cast<uint32_t>(i);
 			}
 
-			while (!under.empty() && !over.empty())
+			while (nrUnder > 0 && overStart < sz)
 			{
-				const AliasEntry& u = under.back();
-				const AliasEntry& o = over.back();
-
-				const size_t index = o.alias;
-
-				aliasTable[u.alias] = AliasEntry(u.probability, index);
+				const uint32_t u = indices[--nrUnder];
+				const uint32_t o = indices[overStart];
 
-				const double rem = o.probability + u.probability - 1.;
+				aliasTable[u] = AliasEntry(static_cast<float>(probabilities[u]), o);
 
-				under.pop_back();
-				over.pop_back();
-
-				if (rem < 1.)
-					under.emplace_back(rem, index);
-				else
-					over.emplace_back(rem, index);
+				probabilities[o] += probabilities[u] - 1.;
+				if (probabilities[o] < 1.)
+				{
+					// move it from over to under, there is room since one under was removed
+					++overStart;
+					indices[nrUnder++] = o;
+				}
 			}
 
-			const AliasEntry one(1., -1);
-
-			for (; !under.empty(); under.pop_back())
-				aliasTable[under.back().alias] = one;
+			for (size_t i = 0; i < nrUnder; ++i)
+				aliasTable[indices[i]] = AliasEntry(1.f, indices[i]);
 
-			for (; !over.empty(); over.pop_back())
-				aliasTable[over.back().alias] = one;
+			for (size_t i = overStart; i < sz; ++i)
+				aliasTable[indices[i]] = AliasEntry(1.f, indices[i]);
 		}
 
 		size_t Sample(double v) const
@@ -99,16 +147,168 @@ namespace Utils {
 	private:
 		class AliasEntry {
 		public:
-			AliasEntry() : probability(1.), alias(-1) {}
-			AliasEntry(double prob, long long int ali) : probability(prob), alias(ali) {}
+			AliasEntry() : probability(1.f), alias(0) {}
+			AliasEntry(float prob, uint32_t ali) : probability(prob), alias(ali) {}
 
-			double probability;
-			long long int alias;
+			float probability;
+			uint32_t alias;
 		};
 
 		std::vector<AliasEntry> aliasTable;
 	};
 
+	/**
+	 * @class CumulativeSampler
+	 * @brief Cumulative sum with binary search sampling.
+	 *
+	 * Cheap to construct, one pass over the probabilities, but O(log N) sampling.
+	 */
+	class CumulativeSampler {
+	public:
+		CumulativeSampler() = delete;
+
+		/**
+		 * @brief Construct the cumulative sum.
+		 *
+		 * @param statevector The statevector to sample from.
+		 * @param nrThreads The number of threads to use for computing the probabilities.
+		 */
+		template<class T = Eigen::VectorXcd> CumulativeSampler(const T& statevector, int nrThreads = 1)
+		{
+			Private::ComputeProbabilities(statevector, cumulative, nrThreads);
+
+			double accum = 0.;
+			for (double& p : cumulative)
+			{
+				accum += p;
+				p = accum;
+			}
+		}
+
+		size_t Sample(double v) const
+		{
+			const auto it = std::upper_bound(cumulative.begin(), cumulative.end(), v * cumulative.back());
+
+			return std::min<size_t>(it - cumulative.begin(), cumulative.size() - 1);
+		}
+
+	private:
+		std::vector<double> cumulative;
+	};
+
+	/**
+	 * @enum SamplingMethod
+	 * @brief The method for sampling many shots from a statevector.
+	 */
+	enum class SamplingMethod {
+		kAlias,        /**< alias table, expensive to build, cheapest per shot */
+		kBinarySearch, /**< cumulative sum and binary search, cheap to build, O(log N) per shot */
+		kSortedSweep   /**< sorted uniforms and a single sweep over the statevector, no table, cheapest if there are few shots */
+	};
+
+	/**
+	 * @brief Chooses the sampling method with the lowest estimated cost.
+	 *
+	 * The costs are rough estimates, in nanoseconds, of building the sampler (per state) and of drawing a shot.
+	 *
+	 * @param nrStates The number of basis states.
+	 * @param shots The number of shots.
+	 * @return The sampling method to use.
+	 */
+	inline SamplingMethod ChooseSamplingMethod(size_t nrStates, size_t shots)
+	{
+		const double n = static_cast<double>(nrStates);
+		const double s = static_cast<double>(shots);
+		const double logn = std::max(std::log2(n), 1.);
+
+		const double sweepCost = 1. * n + 20. * s; // a streaming pass, a pow per shot
+		const double binaryCost = 2. * n + 2. * logn * s; // probabilities and prefix sum, then mostly cached searches
+		const double aliasCost = 8. * n + 4. * s; // probabilities, worklists and the table, then one random access per shot
+
+		if (nrStates > static_cast<size_t>(std::numeric_limits<uint32_t>::max()))
+			return sweepCost <= binaryCost ? SamplingMethod::kSortedSweep : SamplingMethod::kBinarySearch;
+
+		if (sweepCost <= binaryCost && sweepCost <= aliasCost)
+			return SamplingMethod::kSortedSweep;
+
+		return binaryCost <= aliasCost ? SamplingMethod::kBinarySearch : SamplingMethod::kAlias;
+	}
+
+	/**
+	 * @brief Samples basis states from a statevector, many shots.
+	 *
+	 * Chooses the sampler based on the number of shots and the size of the statevector, then reports the sampled states.
+	 * The same state might be reported more than once.
+	 *
+	 * @param statevector The statevector to sample from, must have contiguous storage (data()).
+	 * @param shots The number of shots.
+	 * @param rng The random numbers generator.
+	 * @param addCount Called with the sampled basis state and the number of times it was sampled.
+	 * @param nrThreads The number of threads to use for computing the probabilities.
+	 */
+	template<class T, class Rng, class F> void SampleStatesCounts(const T& statevector, size_t shots, Rng& rng, F&& addCount, int nrThreads = 1)
+	{
+		if (shots == 0 || statevector.size() == 0) return;
+
+		std::uniform_real_distribution<double> uniformZeroOne(0., 1.);
+
+		switch (ChooseSamplingMethod(statevector.size(), shots))
+		{
+		case SamplingMethod::kAlias:
+		{
+			const Alias alias(statevector, nrThreads);
+			for (size_t shot = 0; shot < shots; ++shot)
+				addCount(alias.Sample(1. - uniformZeroOne(rng)), 1); // this excludes 0 as probability
+		}
+		break;
+
+		case SamplingMethod::kBinarySearch:
+		{
+			const CumulativeSampler sampler(statevector, nrThreads);
+			for (size_t shot = 0; shot < shots; ++shot)
+				addCount(sampler.Sample(1. - uniformZeroOne(rng)), 1);
+		}
+		break;
+
+		case SamplingMethod::kSortedSweep:
+		{
+			// the uniforms are generated in increasing order, as order statistics: u' = 1 - (1 - u) * v^(1 / remaining)
+			size_t remaining = shots;
+			double u = 1. - std::pow(1. - uniformZeroOne(rng), 1. / remaining);
+
+			const size_t sz = statevector.size();
+			const double* amplitudes = reinterpret_cast<const double*>(statevector.data());
+
+			double accum = 0.;
+			size_t lastNonZero = 0;
+			for (size_t i = 0; i < sz && remaining > 0; ++i)
+			{
+				const double p = amplitudes[2 * i] * amplitudes[2 * i] + amplitudes[2 * i + 1] * amplitudes[2 * i + 1];
+				if (p == 0.) continue;
+
+				lastNonZero = i;
+				accum += p;
+
+				size_t cnt = 0;
+				while (remaining > 0 && u < accum)
+				{
+					++cnt;
+					--remaining;
+					if (remaining > 0)
+						u = 1. - (1. - u) * std::pow(1. - uniformZeroOne(rng), 1. / remaining);
+				}
+
+				if (cnt) addCount(i, cnt);
+			}
+
+			// the statevector norm might be a little less than 1 because of rounding
+			if (remaining > 0)
+				addCount(lastNonZero, remaining);
+		}
+		break;
+		}
+	}
+
 } // namespace Utils
 
 #endif // _ALIAS_H_
@@ -0,0 +1,305 @@
+/**
+ * @file AmplitudeKernels.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Kernels working directly on statevector amplitude buffers.
+ *
+ * Used by the composite simulator for splitting a qubit out of a statevector (after measurement or reset)
+ * and for joining two statevectors with a tensor product.
+ * Also applying a gate given by a dense matrix on a few qubits, for fused gates.
+ * They use AVX2 if available and OpenMP if more than one thread is requested.
+ */
+
+#pragma once
+
+#ifndef _AMPLITUDE_KERNELS_H_
+#define _AMPLITUDE_KERNELS_H_
+
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace Utils {
+
+	namespace Private {
+		constexpr static size_t AmplitudesChunk = 4096; /**< The number of amplitudes processed in one go by a thread */
+
+		/**
+		 * @brief Multiplies the amplitudes with a scalar, writing the result into another buffer.
+		 *
+		 * @param src The source amplitudes.
+		 * @param scalar The scalar to multiply with.
+		 * @param dst The destination amplitudes.
+		 * @param count The number of amplitudes.
+		 */
+		inline void ScaleAmplitudes(const std::complex<double>* src, std::complex<double> scalar, std::complex<double>* dst, size_t count)
+		{
+			const double br = scalar.real();
+			const double bi = scalar.imag();
+
+			size_t i = 0;
+#ifdef __AVX2__
+			const __m256d vbr = _mm256_set1_pd(br);
+			const __m256d vbi = _mm256_set1_pd(bi);
+
+			// two complex numbers at once: (ar * br - ai * bi, ai * br + ar * bi)
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m256d a = _mm256_loadu_pd(reinterpret_cast<const double*>(src + i));
+				const __m256d aswapped = _mm256_permute_pd(a, 0x5);
+				const __m256d res = _mm256_addsub_pd(_mm256_mul_pd(a, vbr), _mm256_mul_pd(aswapped, vbi));
+				_mm256_storeu_pd(reinterpret_cast<double*>(dst + i), res);
+			}
+#endif
+			// std::complex multiplication checks for nans/infinities, avoid it
+			for (; i < count; ++i)
+			{
+				const double ar = src[i].real();
+				const double ai = src[i].imag();
+				dst[i] = std::complex<double>(ar * br - ai * bi, ai * br + ar * bi);
+			}
+		}
+
+		/**
+		 * @brief Copies every other amplitude.
+		 *
+		 * @param src The source amplitudes, 2 * count of them are read.
+		 * @param dst The destination amplitudes.
+		 * @param count The number of amplitudes to copy.
+		 * @param odd If true, the odd amplitudes are copied, otherwise the even ones.
+		 */
+		inline void CopyInterleavedAmplitudes(const std::complex<double>* src, std::complex<double>* dst, size_t count, bool odd)
+		{
+			size_t i = 0;
+#ifdef __AVX2__
+			if (odd)
+			{
+				for (; i + 2 <= count; i += 2)
+				{
+					const __m256d a = _mm256_loadu_pd(reinterpret_cast<const double*>(src + 2 * i));
+					const __m256d b = _mm256_loadu_pd(reinterpret_cast<const double*>(src + 2 * i + 2));
+					_mm256_storeu_pd(reinterpret_cast<double*>(dst + i), _mm256_permute2f128_pd(a, b, 0x31));
+				}
+			}
+			else
+			{
+				for (; i + 2 <= count; i += 2)
+				{
+					const __m256d a = _mm256_loadu_pd(reinterpret_cast<const double*>(src + 2 * i));
+					const __m256d b = _mm256_loadu_pd(reinterpret_cast<const double*>(src + 2 * i + 2));
+					_mm256_storeu_pd(reinterpret_cast<double*>(dst + i), _mm256_permute2f128_pd(a, b, 0x20));
+				}
+			}
+#endif
+			const size_t offset = odd ? 1 : 0;
+			for (; i < count; ++i)
+				dst[i] = src[2 * i + offset];
+		}
+
+		/**
+		 * @brief Applies a dense matrix on K qubits of a statevector.
+		 *
+		 * For each group of 2^K amplitudes that differ only in the gate qubits, the amplitudes are gathered, multiplied with the matrix and scattered to the destination.
+		 * The source and the destination can be the same.
+		 * @tparam K The number of qubits the matrix acts on.
+		 * @param src The amplitudes of the statevector.
+		 * @param dst The destination amplitudes.
+		 * @param nrQubits The number of qubits of the statevector.
+		 * @param qubits The qubits the matrix acts on, qubits[0] corresponds to the least significant bit of the matrix indices.
+		 * @param matrix The matrix, 2^K x 2^K, row major.
+		 * @param nrThreads The number of threads to use.
+		 */
+		template<size_t K> void ApplyMatrixOnQubits(const std::complex<double>* src, std::complex<double>* dst, size_t nrQubits, const size_t* qubits, const std::complex<double>* matrix, int nrThreads)
+		{
+			constexpr size_t dim = 1ULL << K;
+
+			size_t sorted[K];
+			std::copy(qubits, qubits + K, sorted);
+			std::sort(sorted, sorted + K);
+
+			size_t offsets[dim];
+			for (size_t j = 0; j < dim; ++j)
+			{
+				offsets[j] = 0;
+				for (size_t b = 0; b < K; ++b)
+					if ((j >> b) & 1ULL)
+						offsets[j] |= 1ULL << qubits[b];
+			}
+
+			// split in real and imaginary parts, to avoid the std::complex multiplication
+			double mr[dim * dim];
+			double mi[dim * dim];
+			for (size_t j = 0; j < dim * dim; ++j)
+			{
+				mr[j] = matrix[j].real();
+				mi[j] = matrix[j].imag();
+			}
+
+			const long long int nrGroups = static_cast<long long int>(1ULL << (nrQubits - K));
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+			for (long long int g = 0; g < nrGroups; ++g)
+			{
+				// insert zeros at the positions of the gate qubits
+				size_t base = static_cast<size_t>(g);
+				for (size_t b = 0; b < K; ++b)
+					base = ((base >> sorted[b]) << (sorted[b] + 1)) | (base & ((1ULL << sorted[b]) - 1ULL));
+
+				double vr[dim];
+				double vi[dim];
+				for (size_t j = 0; j < dim; ++j)
+				{
+					vr[j] = src[base + offsets[j]].real();
+					vi[j] = src[base + offsets[j]].imag();
+				}
+
+				for (size_t r = 0; r < dim; ++r)
+				{
+					const double* rowr = mr + r * dim;
+					const double* rowi = mi + r * dim;
+
+					double sr = 0.;
+					double si = 0.;
+					for (size_t c = 0; c < dim; ++c)
+					{
+						sr += rowr[c] * vr[c] - rowi[c] * vi[c];
+						si += rowr[c] * vi[c] + rowi[c] * vr[c];
+					}
+
+					dst[base + offsets[r]] = std::complex<double>(sr, si);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Removes a qubit from a statevector, keeping the amplitudes for the specified outcome.
+	 *
+	 * The destination amplitudes are not normalized, for a measurement or reset the state is expected to be already collapsed.
+	 *
+	 * @param src The source amplitudes, 2 * nrBasisStates of them.
+	 * @param dst The destination amplitudes, nrBasisStates of them.
+	 * @param nrBasisStates The number of basis states after removing the qubit.
+	 * @param localQubit The qubit to remove.
+	 * @param qubitOutcome The value of the removed qubit for which the amplitudes are kept.
+	 * @param nrThreads The number of threads to use.
+	 */
+	inline void SplitAmplitudes(const std::complex<double>* src, std::complex<double>* dst, size_t nrBasisStates, size_t localQubit, bool qubitOutcome, int nrThreads = 1)
+	{
+		if (localQubit == 0)
+		{
+			const size_t chunk = std::min(nrBasisStates, Private::AmplitudesChunk);
+			const long long int nrChunks = static_cast<long long int>(nrBasisStates / chunk);
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+			for (long long int c = 0; c < nrChunks; ++c)
+			{
+				const size_t start = static_cast<size_t>(c) * chunk;
+				Private::CopyInterleavedAmplitudes(src + 2 * start, dst + start, chunk, qubitOutcome);
+			}
+
+			return;
+		}
+
+		// the amplitudes to keep are in contiguous blocks of 2^localQubit, so copy them block by block (or chunk by chunk, if the blocks are large)
+		const size_t blockSize = 1ULL << localQubit;
+		const size_t blockMask = blockSize - 1ULL;
+		const size_t qubitMask = qubitOutcome ? blockSize : 0ULL;
+		const size_t chunk = std::min({ nrBasisStates, blockSize, Private::AmplitudesChunk });
+		const long long int nrChunks = static_cast<long long int>(nrBasisStates / chunk);
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+		for (long long int c = 0; c < nrChunks; ++c)
+		{
+			const size_t start = static_cast<size_t>(c) * chunk;
+			const size_t srcStart = ((start & ~blockMask) << 1ULL) | qubitMask | (start & blockMask);
+
+			std::copy(src + srcStart, src + srcStart + chunk, dst + start);
+		}
+	}
+
+	/**
+	 * @brief Joins two statevectors with a tensor product.
+	 *
+	 * The qubits of the first statevector are the low ones in the result, the qubits of the second one are shifted by nrQubits1.
+	 *
+	 * @param src1 The amplitudes of the first statevector.
+	 * @param nrQubits1 The number of qubits of the first statevector.
+	 * @param src2 The amplitudes of the second statevector.
+	 * @param nrBasisStates2 The number of basis states of the second statevector.
+	 * @param dst The destination amplitudes, 2^nrQubits1 * nrBasisStates2 of them.
+	 * @param nrThreads The number of threads to use.
+	 */
+	inline void JoinAmplitudes(const std::complex<double>* src1, size_t nrQubits1, const std::complex<double>* src2, size_t nrBasisStates2, std::complex<double>* dst, int nrThreads = 1)
+	{
+		const size_t nrBasisStates1 = 1ULL << nrQubits1;
+		const size_t nrBasisStates = nrBasisStates1 * nrBasisStates2;
+		const size_t state1Mask = nrBasisStates1 - 1ULL;
+
+		// a chunk never crosses the end of a copy of the first statevector, so it's multiplied with a single amplitude of the second one
+		const size_t chunk = std::min(nrBasisStates1, Private::AmplitudesChunk);
+		const long long int nrChunks = static_cast<long long int>(nrBasisStates / chunk);
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+		for (long long int c = 0; c < nrChunks; ++c)
+		{
+			const size_t start = static_cast<size_t>(c) * chunk;
+			Private::ScaleAmplitudes(src1 + (start & state1Mask), src2[start >> nrQubits1], dst + start, chunk);
+		}
+	}
+
+
+	/**
+	 * @brief Applies a gate given by a dense matrix to a statevector.
+	 *
+	 * The result is written in the destination, which can be the source for applying it in place.
+	 *
+	 * @param src The amplitudes of the statevector, 2^nrQubits of them.
+	 * @param dst The destination amplitudes, 2^nrQubits of them.
+	 * @param nrQubits The number of qubits of the statevector.
+	 * @param qubits The qubits the gate is applied to, at most 5 of them, qubits[0] corresponds to the least significant bit of the matrix indices.
+	 * @param matrix The matrix, 2^n x 2^n in row major order, n being the number of gate qubits.
+	 * @param nrThreads The number of threads to use.
+	 */
+	template<class Q> void ApplyMatrixToAmplitudes(const std::complex<double>* src, std::complex<double>* dst, size_t nrQubits, const Q& qubits, const std::complex<double>* matrix, int nrThreads = 1)
+	{
+		constexpr size_t MaxMatrixQubits = 5;
+
+		size_t q[MaxMatrixQubits];
+		const size_t k = qubits.size();
+		if (k == 0) return;
+		else if (k > MaxMatrixQubits || k > nrQubits)
+			throw std::invalid_argument("ApplyMatrixToAmplitudes: too many qubits for the gate.");
+
+		for (size_t i = 0; i < k; ++i)
+			q[i] = static_cast<size_t>(qubits[i]);
+
+		switch (k)
+		{
+		case 1:
+			Private::ApplyMatrixOnQubits<1>(src, dst, nrQubits, q, matrix, nrThreads);
+			break;
+		case 2:
+			Private::ApplyMatrixOnQubits<2>(src, dst, nrQubits, q, matrix, nrThreads);
+			break;
+		case 3:
+			Private::ApplyMatrixOnQubits<3>(src, dst, nrQubits, q, matrix, nrThreads);
+			break;
+		case 4:
+			Private::ApplyMatrixOnQubits<4>(src, dst, nrQubits, q, matrix, nrThreads);
+			break;
+		default:
+			Private::ApplyMatrixOnQubits<5>(src, dst, nrQubits, q, matrix, nrThreads);
+			break;
+		}
+	}
+
+}
+
+#endif // _AMPLITUDE_KERNELS_H_
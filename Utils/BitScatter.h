@@ -0,0 +1,104 @@
+/**
+ * @file BitScatter.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Moves bits from some positions to others in a 64 bit word, using precomputed masks and lookup tables.
+ *
+ * Used to convert sampled outcomes (with bits in the order of the simulator qubits) to results (with bits in the order of the measured qubits).
+ */
+
+#pragma once
+
+#ifndef _BIT_SCATTER_H_
+#define _BIT_SCATTER_H_
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace Utils {
+
+	/**
+	 * @class BitScatter
+	 * @brief Precomputed bits scatter.
+	 *
+	 * For each byte of the source that contains mapped bits, a table with 256 entries gives the bits set in the destination.
+	 * If the order of the bits is preserved, each source bit has a single destination and BMI2 is available, a pext/pdep pair is used instead.
+	 */
+	class BitScatter
+	{
+	public:
+		/**
+		 * @brief Construct a new Bit Scatter object.
+		 *
+		 * @param bitsMap Pairs of source and destination bit positions, all less than 64.
+		 */
+		explicit BitScatter(const std::vector<std::pair<size_t, size_t>>& bitsMap)
+		{
+			auto sorted = bitsMap;
+			std::sort(sorted.begin(), sorted.end());
+
+			for (size_t i = 0; i < sorted.size(); ++i)
+			{
+				srcMask |= 1ULL << sorted[i].first;
+				dstMask |= 1ULL << sorted[i].second;
+
+				// a source bit copied to several destinations (a qubit measured more than once) cannot be done with pext/pdep either
+				if (i > 0 && (sorted[i].second <= sorted[i - 1].second || sorted[i].first == sorted[i - 1].first))
+					orderPreserved = false;
+			}
+
+			for (size_t byte = 0; byte < 8; ++byte)
+			{
+				const uint64_t byteMask = 0xFFULL << (8 * byte);
+				if ((srcMask & byteMask) == 0) continue;
+
+				shifts.push_back(8 * byte);
+				tables.resize(tables.size() + 256, 0);
+				uint64_t* table = tables.data() + tables.size() - 256;
+
+				for (uint64_t v = 0; v < 256; ++v)
+					for (const auto& [src, dst] : sorted)
+						if ((src >> 3) == byte && ((v << (8 * byte)) & (1ULL << src)))
+							table[v] |= 1ULL << dst;
+			}
+		}
+
+		/**
+		 * @brief Scatter the bits.
+		 *
+		 * @param v The source word.
+		 * @return The destination word, with the mapped bits set as in the source and all the others zero.
+		 */
+		uint64_t Scatter(uint64_t v) const
+		{
+#ifdef __BMI2__
+			if (orderPreserved)
+				return _pdep_u64(_pext_u64(v, srcMask), dstMask);
+#endif
+			uint64_t res = 0;
+			for (size_t i = 0; i < shifts.size(); ++i)
+				res |= tables[256 * i + ((v >> shifts[i]) & 0xFF)];
+
+			return res;
+		}
+
+	private:
+		uint64_t srcMask = 0; /**< The mapped source bits */
+		uint64_t dstMask = 0; /**< The destination bits */
+		bool orderPreserved = true; /**< True if the destination bits are in the same order as the source ones */
+
+		std::vector<size_t> shifts; /**< The shifts of the source bytes that have mapped bits */
+		std::vector<uint64_t> tables; /**< The lookup tables, 256 entries for each byte in shifts */
+	};
+
+}
+
+#endif // _BIT_SCATTER_H_
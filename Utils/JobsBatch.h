@@ -0,0 +1,112 @@
+/**
+ * @file JobsBatch.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A batch of jobs submitted to a threads pool.
+ *
+ * Tracks the completion of a group of jobs added by a caller, independently of other jobs executed by the same threads pool.
+ */
+
+#pragma once
+
+#ifndef __JOBS_BATCH_H_
+#define __JOBS_BATCH_H_
+
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+
+
+namespace Utils {
+
+	/**
+	 * @class JobsBatch
+	 * @brief Completion counter for a group of jobs.
+	 *
+	 * A caller creates a batch, adds its jobs to the threads pool together with the batch, then waits on the batch.
+	 * The worker threads add the job count of each finished job to the batch it was submitted with.
+	 * This allows several callers to share the same threads pool, each one waiting only for its own jobs.
+	 * @sa ThreadsPool
+	 */
+	class JobsBatch
+	{
+	public:
+		/**
+		 * @brief Construct a new Jobs Batch object.
+		 *
+		 * Constructs a new batch that is finished when the job counts of the finished jobs reach the limit.
+		 * @param limit The finish limit. Default is std::numeric_limits<size_t>::max().
+		 */
+		explicit JobsBatch(size_t limit = std::numeric_limits<size_t>::max())
+			: FinishLimit(limit)
+		{
+		}
+
+		/**
+		 * @brief Set the finish limit.
+		 *
+		 * Sets the finish limit for the batch and resets the finished count.
+		 * @param limit The finish limit.
+		 */
+		void SetFinishLimit(size_t limit)
+		{
+			std::lock_guard lock(FinishMutex);
+			FinishLimit = limit;
+			FinishCount = 0;
+		}
+
+		/**
+		 * @brief Add finished work to the batch.
+		 *
+		 * Called by the worker threads after a job of the batch was executed.
+		 * Notifies the waiting threads if the finish limit was reached.
+		 * @param count The job count of the finished job.
+		 */
+		void AddFinished(size_t count)
+		{
+			bool finished;
+			{
+				std::lock_guard lock(FinishMutex);
+				FinishCount += count;
+				finished = FinishCount >= FinishLimit;
+			}
+
+			if (finished) ConditionFinish.notify_all();
+		}
+
+		/**
+		 * @brief Check if the batch is finished.
+		 *
+		 * Checks if the job counts of the finished jobs reached the finish limit.
+		 * @return true if the batch is finished, false otherwise.
+		 */
+		bool IsFinished() const
+		{
+			std::lock_guard lock(FinishMutex);
+			return FinishCount >= FinishLimit;
+		}
+
+		/**
+		 * @brief Wait for the batch to finish.
+		 *
+		 * Blocks until the job counts of the finished jobs reach the finish limit.
+		 */
+		void WaitForFinish()
+		{
+			std::unique_lock lock(FinishMutex);
+			ConditionFinish.wait(lock, [this] { return FinishCount >= FinishLimit; });
+		}
+
+	private:
+		mutable std::mutex FinishMutex; /**< Mutex to be used to check the finish condition */
+		std::condition_variable ConditionFinish; /**< Condition variable to notify threads waiting for finish */
+
+		size_t FinishCount = 0; /**< The sum of the job counts of the finished jobs */
+		size_t FinishLimit; /**< The limit of the finished jobs to reach before notifying finish */
+	};
+
+}
+
+#endif // __JOBS_BATCH_H_
@@ -0,0 +1,236 @@
+/**
+ * @file MPSSampler.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Sampling measurement outcomes of a subset of qubits from a matrix product state, many shots.
+ *
+ * The environments of the sites are computed once, then each shot is a sweep over the measured sites,
+ * drawing each outcome from the probabilities conditioned on the previous ones.
+ * The state is not changed, so there is no need to save and restore it for each shot.
+ */
+
+#pragma once
+
+#ifndef _MPS_SAMPLER_H_
+#define _MPS_SAMPLER_H_
+
+#include <array>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
+#include <Eigen/Eigen>
+
+namespace Utils {
+
+	/**
+	 * @class MPSSampler
+	 * @brief Samples the outcomes of measuring some of the sites of a matrix product state.
+	 *
+	 * The right environments (the reduced density matrices of the sites to the right, in the bond basis) are computed in the constructor,
+	 * so the sites after the last measured one are never visited when sampling.
+	 * The sites before the first measured one are contracted once into a left environment, shared by all the shots.
+	 * While the measured sites are contiguous the shot is a pure state, a row vector on the bond, so a site costs O(chi^2).
+	 * The unmeasured sites between the measured ones are traced out, the left environment becomes a matrix and a site costs O(chi^3).
+	 * The shots are split between threads, each thread with its own random numbers stream.
+	 */
+	class MPSSampler
+	{
+	public:
+		using MatrixClass = Eigen::MatrixXcd;
+		using SiteTensor = std::array<MatrixClass, 2>; /**< The matrices of a site for the outcomes 0 and 1, left bond x right bond */
+
+		/**
+		 * @brief Construct the sampler.
+		 *
+		 * The matrix product state does not need to be normalized or in a canonical form,
+		 * the probabilities are normalized at each site.
+		 *
+		 * @param siteTensors The tensors of the sites, in order. The first has a left bond of dimension 1, the last a right bond of dimension 1.
+		 */
+		explicit MPSSampler(std::vector<SiteTensor> siteTensors)
+			: sites(std::move(siteTensors))
+		{
+			ComputeRightEnvironments();
+		}
+
+		size_t GetNrSites() const
+		{
+			return sites.size();
+		}
+
+		/**
+		 * @brief Sample the outcomes of measuring the specified sites.
+		 *
+		 * @param measuredSites The sites to measure, the outcome of measuredSites[i] is the bit i of the reported outcome.
+		 * @param shots The number of shots.
+		 * @param seed The seed for the random number streams, each thread uses the seed and its index.
+		 * @param addCount Called with the sampled outcome and the number of times it was sampled, from the calling thread.
+		 * @param nrThreads The number of threads to use.
+		 */
+		template<class F> void SampleCounts(const std::vector<size_t>& measuredSites, size_t shots, uint64_t seed, F&& addCount, int nrThreads = 1) const
+		{
+			if (shots == 0 || measuredSites.empty()) return;
+
+			// the measured sites in the order of the sweep, with the bit of the outcome
+			std::vector<std::pair<size_t, size_t>> sweep(measuredSites.size());
+			for (size_t i = 0; i < measuredSites.size(); ++i)
+				sweep[i] = { measuredSites[i], i };
+			std::sort(sweep.begin(), sweep.end());
+
+			// the sites before the first measured one are traced out once
+			const size_t firstSite = sweep.front().first;
+			MatrixClass prefix = MatrixClass::Ones(1, 1);
+			for (size_t site = 0; site < firstSite; ++site)
+				prefix = TraceOut(prefix, site);
+
+			// not too many threads for a few shots
+			constexpr size_t MinShotsPerThread = 64;
+			const size_t nrSlices = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::max(nrThreads, 1)), shots / MinShotsPerThread));
+
+			std::vector<std::unordered_map<size_t, size_t>> counts(nrSlices);
+
+			const long long int slices = static_cast<long long int>(nrSlices);
+
+#pragma omp parallel for num_threads(static_cast<int>(nrSlices)) schedule(static, 1) if (nrSlices > 1)
+			for (long long int slice = 0; slice < slices; ++slice)
+			{
+				std::seed_seq seq{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(slice) };
+				std::mt19937_64 rng(seq);
+				std::uniform_real_distribution<double> uniformZeroOne(0., 1.);
+
+				const size_t sliceShots = shots / nrSlices + (static_cast<size_t>(slice) < shots % nrSlices ? 1 : 0);
+				auto& sliceCounts = counts[slice];
+
+				for (size_t shot = 0; shot < sliceShots; ++shot)
+					++sliceCounts[SampleShot(sweep, firstSite, prefix, rng, uniformZeroOne)];
+			}
+
+			for (size_t slice = 1; slice < nrSlices; ++slice)
+				for (const auto& [outcome, cnt] : counts[slice])
+					counts[0][outcome] += cnt;
+
+			for (const auto& [outcome, cnt] : counts[0])
+				addCount(outcome, cnt);
+		}
+
+	private:
+		/**
+		 * @brief Compute the right environments of all the sites.
+		 *
+		 * The environment at index i is the contraction of the sites from i to the end with their conjugates, over the physical indices.
+		 */
+		void ComputeRightEnvironments()
+		{
+			rightEnvironments.resize(sites.size() + 1);
+			rightEnvironments.back() = MatrixClass::Ones(1, 1);
+
+			for (size_t site = sites.size(); site > 0; --site)
+			{
+				const auto& tensor = sites[site - 1];
+				const auto& next = rightEnvironments[site];
+
+				rightEnvironments[site - 1] = tensor[0] * next * tensor[0].adjoint() + tensor[1] * next * tensor[1].adjoint();
+			}
+		}
+
+		/**
+		 * @brief Trace out a site from a left environment.
+		 *
+		 * @param left The left environment, on the left bond of the site.
+		 * @param site The site.
+		 * @return The left environment on the right bond of the site.
+		 */
+		MatrixClass TraceOut(const MatrixClass& left, size_t site) const
+		{
+			const auto& tensor = sites[site];
+
+			return tensor[0].adjoint() * left * tensor[0] + tensor[1].adjoint() * left * tensor[1];
+		}
+
+		/**
+		 * @brief Sample a shot.
+		 *
+		 * @param sweep The measured sites in increasing order, with the bits of their outcomes.
+		 * @param firstSite The first measured site.
+		 * @param prefix The left environment of the first measured site.
+		 * @param rng The random numbers generator.
+		 * @param uniformZeroOne The uniform distribution.
+		 * @return The outcome.
+		 */
+		template<class Rng> size_t SampleShot(const std::vector<std::pair<size_t, size_t>>& sweep, size_t firstSite, const MatrixClass& prefix, Rng& rng, std::uniform_real_distribution<double>& uniformZeroOne) const
+		{
+			size_t outcome = 0;
+
+			// pure while no site was traced out
+			bool pure = firstSite == 0;
+			MatrixClass left = prefix; // a row vector if pure, a matrix otherwise
+
+			size_t nextSite = firstSite;
+
+			for (const auto& [site, bit] : sweep)
+			{
+				for (; nextSite < site; ++nextSite)
+				{
+					if (pure)
+					{
+						left = left.adjoint() * left;
+						pure = false;
+					}
+
+					left = TraceOut(left, nextSite);
+				}
+
+				const auto& tensor = sites[site];
+				const auto& right = rightEnvironments[site + 1];
+
+				std::array<MatrixClass, 2> candidates;
+				std::array<double, 2> probabilities;
+
+				for (size_t s = 0; s < 2; ++s)
+				{
+					if (pure)
+					{
+						candidates[s] = left * tensor[s];
+						probabilities[s] = std::max(0., (candidates[s] * right * candidates[s].adjoint())(0, 0).real());
+					}
+					else
+					{
+						candidates[s] = tensor[s].adjoint() * left * tensor[s];
+						probabilities[s] = std::max(0., candidates[s].cwiseProduct(right.transpose()).sum().real());
+					}
+				}
+
+				const double total = probabilities[0] + probabilities[1];
+				const size_t s = (total <= 0. || uniformZeroOne(rng) * total < probabilities[0]) ? 0 : 1;
+
+				if (s) outcome |= 1ULL << bit;
+
+				// normalize, so the values do not get too small for many measured sites
+				if (probabilities[s] > 0.)
+				{
+					if (pure)
+						left = candidates[s] / std::sqrt(probabilities[s]);
+					else
+						left = candidates[s] / probabilities[s];
+				}
+				else
+					left = std::move(candidates[s]);
+
+				nextSite = site + 1;
+			}
+
+			return outcome;
+		}
+
+		std::vector<SiteTensor> sites; /**< The site tensors */
+		std::vector<MatrixClass> rightEnvironments; /**< The right environments, the one at index i includes the sites from i on */
+	};
+
+}
+
+#endif // _MPS_SAMPLER_H_
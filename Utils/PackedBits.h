@@ -0,0 +1,184 @@
+/**
+ * @file PackedBits.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Classical bits packed in 64 bit words, to be used as keys in hash maps.
+ *
+ * Up to 128 bits are stored inline, without allocating memory.
+ */
+
+#pragma once
+
+#ifndef _PACKED_BITS_H_
+#define _PACKED_BITS_H_
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace Utils {
+
+	/**
+	 * @class PackedBits
+	 * @brief Packed classical bits.
+	 *
+	 * A cheaper to build, compare and hash replacement for std::vector<bool> keys.
+	 * The bits are stored inline if they fit in InlineWords words, otherwise they are stored in a vector.
+	 * @sa PackedBitsHash
+	 */
+	class PackedBits
+	{
+	public:
+		constexpr static size_t InlineWords = 2; /**< The number of words stored inline */
+		constexpr static size_t BitsPerWord = 64; /**< The number of bits in a word */
+
+		/**
+		 * @brief Construct a new Packed Bits object.
+		 *
+		 * Packs the first nrBits bits, the missing ones are set to false.
+		 * @param bits The bits to pack.
+		 * @param nrBits The number of bits to pack.
+		 */
+		PackedBits(const std::vector<bool>& bits, size_t nrBits)
+			: NrBits(nrBits)
+		{
+			const size_t nrWords = GetNrWords();
+			if (nrWords > InlineWords)
+				OutWords.resize(nrWords, 0);
+
+			uint64_t* words = GetWords();
+			const size_t sz = std::min(bits.size(), nrBits);
+			for (size_t i = 0; i < sz; ++i)
+				if (bits[i])
+					words[i / BitsPerWord] |= 1ULL << (i % BitsPerWord);
+		}
+
+		/**
+		 * @brief Construct a new Packed Bits object.
+		 *
+		 * Packs all the bits.
+		 * @param bits The bits to pack.
+		 */
+		explicit PackedBits(const std::vector<bool>& bits)
+			: PackedBits(bits, bits.size())
+		{
+		}
+
+		/**
+		 * @brief Unpack the bits.
+		 *
+		 * @return The bits, as a vector of bools.
+		 */
+		std::vector<bool> ToVector() const
+		{
+			std::vector<bool> bits(NrBits, false);
+
+			const uint64_t* words = GetWords();
+			for (size_t i = 0; i < NrBits; ++i)
+				bits[i] = (words[i / BitsPerWord] >> (i % BitsPerWord)) & 1;
+
+			return bits;
+		}
+
+		/**
+		 * @brief Get the number of bits.
+		 *
+		 * @return The number of bits.
+		 */
+		size_t GetNrBits() const
+		{
+			return NrBits;
+		}
+
+		/**
+		 * @brief Get the number of words used to store the bits.
+		 *
+		 * @return The number of words.
+		 */
+		size_t GetNrWords() const
+		{
+			return (NrBits + BitsPerWord - 1) / BitsPerWord;
+		}
+
+		/**
+		 * @brief Get the words storing the bits.
+		 *
+		 * The bits not used in the last word are zero.
+		 * @return A pointer to the words.
+		 */
+		const uint64_t* GetWords() const
+		{
+			return OutWords.empty() ? InWords : OutWords.data();
+		}
+
+		bool operator==(const PackedBits& other) const
+		{
+			return NrBits == other.NrBits && std::equal(GetWords(), GetWords() + GetNrWords(), other.GetWords());
+		}
+
+		bool operator!=(const PackedBits& other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		uint64_t* GetWords()
+		{
+			return OutWords.empty() ? InWords : OutWords.data();
+		}
+
+		size_t NrBits; /**< The number of bits */
+		uint64_t InWords[InlineWords] = {}; /**< The inline storage, used if the bits fit in it */
+		std::vector<uint64_t> OutWords; /**< The storage for bits that don't fit inline, empty otherwise */
+	};
+
+	/**
+	 * @class PackedBitsHash
+	 * @brief Hash for PackedBits.
+	 *
+	 * Mixes the words with a multiply-xorshift, good enough for hash maps keyed by measurement results.
+	 */
+	class PackedBitsHash
+	{
+	public:
+		size_t operator()(const PackedBits& bits) const
+		{
+			uint64_t h = bits.GetNrBits() * 0x9E3779B97F4A7C15ULL;
+
+			const uint64_t* words = bits.GetWords();
+			for (size_t i = 0; i < bits.GetNrWords(); ++i)
+			{
+				h ^= words[i];
+				h *= 0xBF58476D1CE4E5B9ULL;
+				h ^= h >> 31;
+			}
+
+			return static_cast<size_t>(h);
+		}
+	};
+
+	/**
+	 * @brief Counts keyed by packed bits.
+	 */
+	using PackedBitsCounts = std::unordered_map<PackedBits, size_t, PackedBitsHash>;
+
+	/**
+	 * @brief Merge partial counts.
+	 *
+	 * Adds the counts from the source to the destination.
+	 * @param dest The counts to add to.
+	 * @param src The counts to add.
+	 */
+	inline void MergeCounts(PackedBitsCounts& dest, const PackedBitsCounts& src)
+	{
+		for (const auto& [bits, cnt] : src)
+			dest[bits] += cnt;
+	}
+
+}
+
+#endif // _PACKED_BITS_H_
@@ -0,0 +1,252 @@
+/**
+ * @file PauliKernels.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Kernels computing expectation values of Pauli strings directly on statevector amplitude buffers.
+ *
+ * A Pauli string is given by the mask of the qubits with an X or Y and the mask of the qubits with a Z or Y.
+ * Up to its phase, it flips the bits of the X mask and changes the sign for an odd number of set bits in the Z mask,
+ * so no gate matrices are needed.
+ */
+
+#pragma once
+
+#ifndef _PAULI_KERNELS_H_
+#define _PAULI_KERNELS_H_
+
+#include <complex>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+
+#include "PauliString.h"
+
+namespace Utils {
+
+	namespace Private {
+		constexpr static size_t MaxTransformQubits = 20; /**< Above this number of qubits the expectation values are not computed with a transform, as it needs a buffer the size of the state (16 MB at this limit) */
+
+		inline bool Parity(uint64_t v)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_parityll(v);
+#else
+			return std::bitset<64>(v).count() & 1;
+#endif
+		}
+
+		/**
+		 * @brief The real part of i^phase * sum.
+		 */
+		inline double ApplyPhase(std::complex<double> sum, int phase)
+		{
+			switch (phase % 4)
+			{
+			case 1:
+				return -sum.imag();
+			case 2:
+				return -sum.real();
+			case 3:
+				return sum.imag();
+			default:
+				return sum.real();
+			}
+		}
+
+		/**
+		 * @brief The expectation value of a Pauli string, with a pass over the amplitudes.
+		 *
+		 * For a string with X or Y the amplitudes are visited in pairs (k, k ^ xMask), only the pairs with the highest bit of the mask not set.
+		 *
+		 * @param amplitudes The amplitudes.
+		 * @param nrBasisStates The number of amplitudes.
+		 * @param xMask The mask of the qubits with X or Y.
+		 * @param zMask The mask of the qubits with Z or Y.
+		 * @param phase The power of i in front of the string.
+		 * @param nrThreads The number of threads to use.
+		 * @return The expectation value.
+		 */
+		inline double PauliExpectationPass(const std::complex<double>* amplitudes, size_t nrBasisStates, uint64_t xMask, uint64_t zMask, int phase, int nrThreads)
+		{
+			const long long int count = static_cast<long long int>(nrBasisStates);
+
+			if (xMask == 0)
+			{
+				// without X or Y there is no Y either, so no phase
+				double sum = 0;
+#pragma omp parallel for num_threads(nrThreads) schedule(static) reduction(+:sum) if (nrThreads > 1)
+				for (long long int k = 0; k < count; ++k)
+				{
+					const double p = std::norm(amplitudes[k]);
+					sum += Parity(static_cast<uint64_t>(k) & zMask) ? -p : p;
+				}
+
+				return sum;
+			}
+
+			size_t highBit = 0;
+			while ((xMask >> highBit) > 1) ++highBit;
+			const uint64_t lowMask = (1ULL << highBit) - 1ULL;
+
+			const bool oddY = std::bitset<64>(xMask & zMask).count() & 1;
+
+			// the term of k ^ xMask is the conjugate of the term of k, with the sign changed for each Y
+			// so the pair gives 2 * re(w) for an even number of Y and 2i * im(w) for an odd one
+			double sum = 0;
+#pragma omp parallel for num_threads(nrThreads) schedule(static) reduction(+:sum) if (nrThreads > 1)
+			for (long long int j = 0; j < count / 2; ++j)
+			{
+				const uint64_t k = ((static_cast<uint64_t>(j) & ~lowMask) << 1ULL) | (static_cast<uint64_t>(j) & lowMask);
+				const std::complex<double> a = amplitudes[k];
+				const std::complex<double> b = amplitudes[k ^ xMask];
+
+				// w = conj(b) * a
+				const double w = oddY ? b.real() * a.imag() - b.imag() * a.real() : b.real() * a.real() + b.imag() * a.imag();
+				sum += Parity(k & zMask) ? -w : w;
+			}
+
+			return ApplyPhase(oddY ? std::complex<double>(0, 2. * sum) : std::complex<double>(2. * sum, 0), phase);
+		}
+
+		/**
+		 * @brief The Walsh-Hadamard transform, in place.
+		 *
+		 * After the transform, the value at z is the sum of the values at k with the sign changed for an odd number of set bits in k & z.
+		 *
+		 * @param values The values, 2^nrQubits of them.
+		 * @param nrQubits The number of qubits.
+		 * @param nrThreads The number of threads to use.
+		 */
+		template<typename T> void WalshHadamardTransform(T* values, size_t nrQubits, int nrThreads)
+		{
+			const long long int half = static_cast<long long int>(1ULL << nrQubits) / 2;
+
+			for (size_t q = 0; q < nrQubits; ++q)
+			{
+				const uint64_t lowMask = (1ULL << q) - 1ULL;
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+				for (long long int j = 0; j < half; ++j)
+				{
+					const uint64_t k = ((static_cast<uint64_t>(j) & ~lowMask) << 1ULL) | (static_cast<uint64_t>(j) & lowMask);
+					const uint64_t l = k | (1ULL << q);
+
+					const T v1 = values[k];
+					const T v2 = values[l];
+					values[k] = v1 + v2;
+					values[l] = v1 - v2;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Computes the expectation values of a batch of Pauli strings on a statevector.
+	 *
+	 * The strings are grouped by their X masks. The strings in a group visit the same pairs of amplitudes, only the signs differ.
+	 * If a group has more strings than qubits, the products of the amplitude pairs (the probabilities for the diagonal strings)
+	 * are computed once and a Walsh-Hadamard transform gives the sums for all the Z masks, so each string is then a lookup.
+	 * Otherwise each string is a pass over the amplitudes, the passes for a small state being done in parallel, one string per thread.
+	 * The transform needs a buffer of 2^nrQubits values (complex for the non diagonal strings), reused between the groups, so it is done only up to Private::MaxTransformQubits qubits.
+	 *
+	 * @param amplitudes The amplitudes of the statevector, 2^nrQubits of them.
+	 * @param nrQubits The number of qubits of the statevector, at most 64.
+	 * @param paulis The Pauli strings, with at most nrQubits qubits.
+	 * @param nrThreads The number of threads to use.
+	 * @return The expectation values, in the order of the strings.
+	 */
+	inline std::vector<double> PauliExpectationValues(const std::complex<double>* amplitudes, size_t nrQubits, const std::vector<PauliString>& paulis, int nrThreads = 1)
+	{
+		const size_t nrStrings = paulis.size();
+		const size_t nrBasisStates = 1ULL << nrQubits;
+
+		std::vector<double> results(nrStrings, 0.);
+
+		std::vector<size_t> order(nrStrings);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&paulis](size_t i, size_t j) { return paulis[i].GetXWord() < paulis[j].GetXWord(); });
+
+		std::vector<size_t> passes;
+		std::vector<double> probabilities;
+		std::vector<std::complex<double>> products;
+
+		for (size_t groupStart = 0; groupStart < nrStrings;)
+		{
+			const uint64_t xMask = paulis[order[groupStart]].GetXWord();
+
+			size_t groupEnd = groupStart + 1;
+			while (groupEnd < nrStrings && paulis[order[groupEnd]].GetXWord() == xMask) ++groupEnd;
+
+			if (groupEnd - groupStart > nrQubits && nrQubits <= Private::MaxTransformQubits)
+			{
+				const long long int count = static_cast<long long int>(nrBasisStates);
+
+				if (xMask == 0)
+				{
+					probabilities.resize(nrBasisStates);
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+					for (long long int k = 0; k < count; ++k)
+						probabilities[k] = std::norm(amplitudes[k]);
+
+					Private::WalshHadamardTransform(probabilities.data(), nrQubits, nrThreads);
+
+					for (size_t i = groupStart; i < groupEnd; ++i)
+						results[order[i]] = probabilities[paulis[order[i]].GetZWord()];
+				}
+				else
+				{
+					products.resize(nrBasisStates);
+
+#pragma omp parallel for num_threads(nrThreads) schedule(static) if (nrThreads > 1)
+					for (long long int k = 0; k < count; ++k)
+						products[k] = std::conj(amplitudes[static_cast<uint64_t>(k) ^ xMask]) * amplitudes[k];
+
+					Private::WalshHadamardTransform(products.data(), nrQubits, nrThreads);
+
+					for (size_t i = groupStart; i < groupEnd; ++i)
+					{
+						const auto& pauli = paulis[order[i]];
+						results[order[i]] = Private::ApplyPhase(products[pauli.GetZWord()], pauli.GetPhase());
+					}
+				}
+			}
+			else
+			{
+				for (size_t i = groupStart; i < groupEnd; ++i)
+					passes.push_back(order[i]);
+			}
+
+			groupStart = groupEnd;
+		}
+
+		// for a large state the threads work on the same pass, for a small one each thread does its own passes
+		constexpr size_t MinParallelPassQubits = 14;
+
+		if (nrQubits >= MinParallelPassQubits || passes.size() < 2)
+		{
+			for (const auto i : passes)
+				results[i] = Private::PauliExpectationPass(amplitudes, nrBasisStates, paulis[i].GetXWord(), paulis[i].GetZWord(), paulis[i].GetPhase(), nrThreads);
+		}
+		else
+		{
+			const long long int nrPasses = static_cast<long long int>(passes.size());
+
+#pragma omp parallel for num_threads(nrThreads) schedule(dynamic) if (nrThreads > 1)
+			for (long long int p = 0; p < nrPasses; ++p)
+			{
+				const size_t i = passes[p];
+				results[i] = Private::PauliExpectationPass(amplitudes, nrBasisStates, paulis[i].GetXWord(), paulis[i].GetZWord(), paulis[i].GetPhase(), 1);
+			}
+		}
+
+		return results;
+	}
+
+}
+
+#endif // _PAULI_KERNELS_H_
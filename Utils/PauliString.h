@@ -0,0 +1,317 @@
+/**
+ * @file PauliString.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A Pauli string packed in X and Z bit masks.
+ *
+ * The strings given as text (like "XIZY") are parsed once, then the simulators work with the masks,
+ * without scanning the characters again.
+ */
+
+#pragma once
+
+#ifndef _PAULI_STRING_H_
+#define _PAULI_STRING_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <bitset>
+#include <algorithm>
+
+namespace Utils {
+
+	/**
+	 * @class PauliString
+	 * @brief A Pauli string in the symplectic representation.
+	 *
+	 * The string is i^phase * X^x * Z^z, the bit q of the x mask is set for an X or Y on qubit q, the bit q of the z mask for a Z or Y.
+	 * A Y is i * X * Z, so the phase counts the Y operators, modulo 4.
+	 * The masks are packed in 64 bit words, so there is no limit for the number of qubits.
+	 */
+	class PauliString
+	{
+	public:
+		constexpr static size_t BitsPerWord = 64; /**< The number of bits in a word */
+
+		PauliString() = default;
+
+		/**
+		 * @brief Construct an identity Pauli string.
+		 *
+		 * @param nrQubits The number of qubits.
+		 */
+		explicit PauliString(size_t nrQubits)
+			: nrQubits(nrQubits), xWords((nrQubits + BitsPerWord - 1) / BitsPerWord, 0), zWords(xWords.size(), 0)
+		{
+		}
+
+		/**
+		 * @brief Construct a Pauli string from text.
+		 *
+		 * The characters are the operators for the qubits, in order, case insensitive.
+		 * The characters other than X, Y and Z are identities.
+		 *
+		 * @param str The text, like "XIZY".
+		 */
+		explicit PauliString(const std::string& str)
+			: PauliString(str.size())
+		{
+			for (size_t q = 0; q < str.size(); ++q)
+				Set(q, str[q]);
+		}
+
+		/**
+		 * @brief Get the number of qubits.
+		 *
+		 * The qubits past the end are identities.
+		 *
+		 * @return The number of qubits.
+		 */
+		size_t GetNrQubits() const
+		{
+			return nrQubits;
+		}
+
+		/**
+		 * @brief Get the operator on a qubit.
+		 *
+		 * @param q The qubit.
+		 * @return The operator, one of 'I', 'X', 'Y' and 'Z'.
+		 */
+		char Get(size_t q) const
+		{
+			if (q >= nrQubits) return 'I';
+
+			const bool x = (xWords[q / BitsPerWord] >> (q % BitsPerWord)) & 1;
+			const bool z = (zWords[q / BitsPerWord] >> (q % BitsPerWord)) & 1;
+
+			return OperatorChar(x, z);
+		}
+
+		/**
+		 * @brief Set the operator on a qubit.
+		 *
+		 * The string is extended with identities if the qubit is past the end.
+		 *
+		 * @param q The qubit.
+		 * @param op The operator, case insensitive, anything other than X, Y and Z is an identity.
+		 */
+		void Set(size_t q, char op)
+		{
+			if (q >= nrQubits) Resize(q + 1);
+
+			const size_t word = q / BitsPerWord;
+			const uint64_t bit = 1ULL << (q % BitsPerWord);
+
+			if (xWords[word] & zWords[word] & bit) phase = (phase + 3) % 4;
+			xWords[word] &= ~bit;
+			zWords[word] &= ~bit;
+
+			switch (op)
+			{
+			case 'x':
+			case 'X':
+				xWords[word] |= bit;
+				break;
+			case 'y':
+			case 'Y':
+				xWords[word] |= bit;
+				zWords[word] |= bit;
+				phase = (phase + 1) % 4;
+				break;
+			case 'z':
+			case 'Z':
+				zWords[word] |= bit;
+				break;
+			default:
+				break;
+			}
+		}
+
+		/**
+		 * @brief Change the number of qubits.
+		 *
+		 * The added qubits are identities, the removed ones are dropped.
+		 *
+		 * @param nrQubitsNew The new number of qubits.
+		 */
+		void Resize(size_t nrQubitsNew)
+		{
+			if (nrQubitsNew < nrQubits)
+				for (size_t q = nrQubitsNew; q < nrQubits; ++q)
+					Set(q, 'I');
+
+			nrQubits = nrQubitsNew;
+			xWords.resize((nrQubits + BitsPerWord - 1) / BitsPerWord, 0);
+			zWords.resize(xWords.size(), 0);
+		}
+
+		/**
+		 * @brief Drop the qubits past the specified number of qubits.
+		 *
+		 * The operators on the dropped qubits act on the |0> state, so the Z operators do not change the expected value.
+		 *
+		 * @param nrQubitsNew The number of qubits to keep.
+		 * @return False if the expected value is zero because of an X or Y on a dropped qubit, true otherwise.
+		 */
+		bool Trim(size_t nrQubitsNew)
+		{
+			if (nrQubitsNew >= nrQubits) return true;
+
+			for (size_t q = nrQubitsNew; q < nrQubits; ++q)
+				if ((xWords[q / BitsPerWord] >> (q % BitsPerWord)) & 1)
+					return false;
+
+			Resize(nrQubitsNew);
+
+			return true;
+		}
+
+		/**
+		 * @brief Check if the string is the identity.
+		 *
+		 * @return True if there is no X, Y or Z in the string.
+		 */
+		bool IsIdentity() const
+		{
+			return std::all_of(xWords.begin(), xWords.end(), [](uint64_t w) { return w == 0; }) &&
+				std::all_of(zWords.begin(), zWords.end(), [](uint64_t w) { return w == 0; });
+		}
+
+		/**
+		 * @brief Check if the string is diagonal in the computational basis.
+		 *
+		 * @return True if there is no X or Y in the string.
+		 */
+		bool IsDiagonal() const
+		{
+			return std::all_of(xWords.begin(), xWords.end(), [](uint64_t w) { return w == 0; });
+		}
+
+		size_t GetNrWords() const
+		{
+			return xWords.size();
+		}
+
+		/**
+		 * @brief Get a word of the X mask.
+		 *
+		 * @param word The word index, the word 0 has the qubits 0 to 63.
+		 * @return The word, 0 if past the end.
+		 */
+		uint64_t GetXWord(size_t word = 0) const
+		{
+			return word < xWords.size() ? xWords[word] : 0;
+		}
+
+		/**
+		 * @brief Get a word of the Z mask.
+		 *
+		 * @param word The word index, the word 0 has the qubits 0 to 63.
+		 * @return The word, 0 if past the end.
+		 */
+		uint64_t GetZWord(size_t word = 0) const
+		{
+			return word < zWords.size() ? zWords[word] : 0;
+		}
+
+		/**
+		 * @brief Get the phase.
+		 *
+		 * @return The power of i in front of X^x * Z^z, from 0 to 3.
+		 */
+		int GetPhase() const
+		{
+			return phase;
+		}
+
+		/**
+		 * @brief Call a function for each qubit that is not an identity, in increasing order.
+		 *
+		 * @param f The function, called with the qubit and the operator character.
+		 */
+		template<class F> void ForEachOperator(F&& f) const
+		{
+			for (size_t word = 0; word < xWords.size(); ++word)
+			{
+				uint64_t bits = xWords[word] | zWords[word];
+				while (bits)
+				{
+					const size_t bit = LowestBit(bits);
+					bits &= bits - 1;
+
+					const bool x = (xWords[word] >> bit) & 1;
+					const bool z = (zWords[word] >> bit) & 1;
+
+					f(word * BitsPerWord + bit, OperatorChar(x, z));
+				}
+			}
+		}
+
+		/**
+		 * @brief Convert the string back to text.
+		 *
+		 * @return The text, with a character for each qubit.
+		 */
+		std::string ToString() const
+		{
+			std::string str(nrQubits, 'I');
+			ForEachOperator([&str](size_t q, char op) { str[q] = op; });
+
+			return str;
+		}
+
+		bool operator==(const PauliString& other) const
+		{
+			return nrQubits == other.nrQubits && xWords == other.xWords && zWords == other.zWords;
+		}
+
+		bool operator!=(const PauliString& other) const
+		{
+			return !(*this == other);
+		}
+
+		/**
+		 * @brief Parse a batch of Pauli strings.
+		 *
+		 * @param strs The strings as text.
+		 * @return The parsed strings, in the same order.
+		 */
+		static std::vector<PauliString> Parse(const std::vector<std::string>& strs)
+		{
+			std::vector<PauliString> result;
+			result.reserve(strs.size());
+
+			for (const auto& str : strs)
+				result.emplace_back(str);
+
+			return result;
+		}
+
+	private:
+		static char OperatorChar(bool x, bool z)
+		{
+			return x ? (z ? 'Y' : 'X') : (z ? 'Z' : 'I');
+		}
+
+		static size_t LowestBit(uint64_t v)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<size_t>(__builtin_ctzll(v));
+#else
+			return std::bitset<BitsPerWord>((v & (~v + 1)) - 1).count();
+#endif
+		}
+
+		size_t nrQubits = 0; /**< The number of qubits */
+		std::vector<uint64_t> xWords; /**< The X mask, packed */
+		std::vector<uint64_t> zWords; /**< The Z mask, packed */
+		int phase = 0; /**< The power of i in front of X^x * Z^z, the number of Y operators modulo 4 */
+	};
+
+}
+
+#endif // _PAULI_STRING_H_
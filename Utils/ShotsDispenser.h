@@ -0,0 +1,192 @@
+/**
+ * @file ShotsDispenser.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Dynamic partitioning of shots between the threads executing them.
+ *
+ * Instead of splitting the shots in equal slices upfront, the workers grab batches of shots from a shared atomic counter,
+ * with the size of the batches tuned from the measured time per shot.
+ */
+
+#pragma once
+
+#ifndef __SHOTS_DISPENSER_H_
+#define __SHOTS_DISPENSER_H_
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+
+namespace Utils {
+
+	/**
+	 * @class ShotsDispenser
+	 * @brief Hands out batches of shots to the workers.
+	 *
+	 * Shared by the workers executing the shots of a circuit.
+	 * A batch never exceeds a fraction of the remaining shots divided by the number of workers (guided scheduling),
+	 * so the batches get smaller towards the end and the workers finish at about the same time.
+	 * @sa ShotsBatchTuner
+	 */
+	class ShotsDispenser
+	{
+	public:
+		/**
+		 * @brief Construct a new Shots Dispenser object.
+		 *
+		 * @param shots The total number of shots to hand out.
+		 * @param workers The number of workers sharing the shots.
+		 */
+		ShotsDispenser(size_t shots, size_t workers)
+			: Remaining(shots), NrWorkers(std::max<size_t>(workers, 1ULL)), FairShare((shots + NrWorkers - 1) / NrWorkers)
+		{
+		}
+
+		/**
+		 * @brief Take a batch of shots.
+		 *
+		 * Takes at most 'wanted' shots, but no more than half of the remaining shots divided by the number of workers (and at least one).
+		 * @param wanted The number of shots the worker would like to execute.
+		 * @return The number of shots taken, zero if there are no shots left.
+		 */
+		size_t Take(size_t wanted)
+		{
+			size_t remaining = Remaining.load(std::memory_order_relaxed);
+
+			size_t cnt;
+			do
+			{
+				if (remaining == 0) return 0;
+
+				const size_t cap = std::max<size_t>(remaining / (2 * NrWorkers), 1ULL);
+				cnt = std::min(std::max<size_t>(wanted, 1ULL), cap);
+			} while (!Remaining.compare_exchange_weak(remaining, remaining - cnt, std::memory_order_relaxed));
+
+			return cnt;
+		}
+
+		/**
+		 * @brief Take a fair share of the shots.
+		 *
+		 * To be used when the cost does not depend on the shot, for example if all the shots are sampled at once.
+		 * Takes at most the total number of shots divided by the number of workers (rounded up).
+		 * @return The number of shots taken, zero if there are no shots left.
+		 */
+		size_t TakeShare()
+		{
+			size_t remaining = Remaining.load(std::memory_order_relaxed);
+
+			size_t cnt;
+			do
+			{
+				if (remaining == 0) return 0;
+
+				cnt = std::min(FairShare, remaining);
+			} while (!Remaining.compare_exchange_weak(remaining, remaining - cnt, std::memory_order_relaxed));
+
+			return cnt;
+		}
+
+		/**
+		 * @brief Take all the remaining shots.
+		 *
+		 * @return The number of shots taken.
+		 */
+		size_t TakeAll()
+		{
+			return Remaining.exchange(0, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Get the number of shots not handed out yet.
+		 *
+		 * @return The number of remaining shots.
+		 */
+		size_t GetRemaining() const
+		{
+			return Remaining.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Get the number of workers sharing the shots.
+		 *
+		 * @return The number of workers.
+		 */
+		size_t GetNrWorkers() const
+		{
+			return NrWorkers;
+		}
+
+	private:
+		std::atomic<size_t> Remaining; /**< The shots not handed out yet */
+		const size_t NrWorkers; /**< The number of workers sharing the shots */
+		const size_t FairShare; /**< The total shots divided by the number of workers, rounded up */
+	};
+
+	/**
+	 * @class ShotsBatchTuner
+	 * @brief Tunes the batch size of a worker from the measured time per shot.
+	 *
+	 * Each worker has its own tuner. It starts with a single shot, then asks for as many shots as fit in the target batch duration,
+	 * using the average time per shot measured so far.
+	 * The batches should be long enough to make the overhead of taking them negligible, but short enough to balance the tail.
+	 * @sa ShotsDispenser
+	 */
+	class ShotsBatchTuner
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * @brief Construct a new Shots Batch Tuner object.
+		 *
+		 * @param target The target duration of a batch, in seconds.
+		 */
+		explicit ShotsBatchTuner(double target = 0.002)
+			: TargetDuration(target)
+		{
+		}
+
+		/**
+		 * @brief Get the number of shots to ask for in the next batch.
+		 *
+		 * @return The batch size.
+		 */
+		size_t GetBatchSize() const
+		{
+			if (TotalShots == 0) return 1;
+			else if (TotalDuration <= 0.) return 2 * LastBatchSize;
+
+			const double perShot = TotalDuration / static_cast<double>(TotalShots);
+			const double size = TargetDuration / perShot;
+
+			// don't grow too fast, the first measurements can be far off
+			return static_cast<size_t>(std::clamp(size, 1., 2. * static_cast<double>(LastBatchSize) + 1.));
+		}
+
+		/**
+		 * @brief Record the execution of a batch.
+		 *
+		 * @param shots The number of shots executed.
+		 * @param start The time the execution of the batch started.
+		 */
+		void Update(size_t shots, Clock::time_point start)
+		{
+			TotalDuration += std::chrono::duration<double>(Clock::now() - start).count();
+			TotalShots += shots;
+			LastBatchSize = std::max<size_t>(shots, 1ULL);
+		}
+
+	private:
+		const double TargetDuration; /**< The target duration of a batch, in seconds */
+		double TotalDuration = 0.; /**< The time spent executing the shots so far, in seconds */
+		size_t TotalShots = 0; /**< The number of shots executed so far */
+		size_t LastBatchSize = 1; /**< The size of the last batch */
+	};
+
+}
+
+#endif // __SHOTS_DISPENSER_H_
@@ -0,0 +1,334 @@
+/**
+ * @file StabilizerSampler.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Sampling measurement outcomes of a stabilizer state, many shots at once.
+ *
+ * The outcomes of measuring a stabilizer state in the computational basis are uniformly distributed over an affine subspace of GF(2)^n.
+ * The subspace is found once, with a Gaussian elimination of the stabilizer generators,
+ * then the shots are random linear combinations of its basis, 64 shots in a word.
+ */
+
+#pragma once
+
+#ifndef _STABILIZER_SAMPLER_H_
+#define _STABILIZER_SAMPLER_H_
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <bitset>
+#include <cstdint>
+
+namespace Utils {
+
+	/**
+	 * @class StabilizerSampler
+	 * @brief Samples the outcomes of measuring some of the qubits of a stabilizer state.
+	 *
+	 * The stabilizer generators are brought to a row echelon form for their X parts.
+	 * The X parts of the generators with X operators are a basis for the directions of the subspace,
+	 * the generators without X operators constrain the outcomes and give a particular outcome.
+	 * Only the measured qubits are kept from them, so a shot costs O(rank) word operations for 64 shots,
+	 * no matter the number of qubits of the state.
+	 */
+	class StabilizerSampler
+	{
+	public:
+		constexpr static size_t BitsPerWord = 64; /**< The number of bits in a word */
+
+		/**
+		 * @brief Construct the sampler.
+		 *
+		 * @param nrQubits The number of qubits of the stabilizer state.
+		 */
+		explicit StabilizerSampler(size_t nrQubits)
+			: nrQubits(nrQubits), nrWords((nrQubits + BitsPerWord - 1) / BitsPerWord)
+		{
+		}
+
+		size_t GetNrQubits() const
+		{
+			return nrQubits;
+		}
+
+		/**
+		 * @brief Add a stabilizer generator.
+		 *
+		 * The generator is +/- a product of Pauli operators, a Y is given by both the X and Z bits set.
+		 * The state should have as many independent generators as qubits.
+		 *
+		 * @param x The X bits, one for each qubit.
+		 * @param z The Z bits, one for each qubit.
+		 * @param negative True if the sign of the generator is -1.
+		 */
+		void AddStabilizer(const std::vector<bool>& x, const std::vector<bool>& z, bool negative)
+		{
+			Row row;
+			row.x.assign(nrWords, 0);
+			row.z.assign(nrWords, 0);
+			row.negative = negative;
+
+			for (size_t q = 0; q < nrQubits; ++q)
+			{
+				if (q < x.size() && x[q]) row.x[q / BitsPerWord] |= 1ULL << (q % BitsPerWord);
+				if (q < z.size() && z[q]) row.z[q / BitsPerWord] |= 1ULL << (q % BitsPerWord);
+			}
+
+			generators.emplace_back(std::move(row));
+		}
+
+		/**
+		 * @brief Sample the outcomes of measuring the specified qubits.
+		 *
+		 * @param measuredQubits The qubits to measure, the outcome of measuredQubits[i] is the bit i of the reported outcome.
+		 * @param shots The number of shots.
+		 * @param seed The seed for the random number streams, each thread uses the seed and its index.
+		 * @param addCount Called with the sampled outcome and the number of times it was sampled, from the calling thread.
+		 * @param nrThreads The number of threads to use.
+		 */
+		template<class F> void SampleCounts(const std::vector<size_t>& measuredQubits, size_t shots, uint64_t seed, F&& addCount, int nrThreads = 1) const
+		{
+			if (shots == 0 || measuredQubits.empty()) return;
+
+			const size_t nrMeasured = measuredQubits.size();
+			const size_t nrMeasuredWords = (nrMeasured + BitsPerWord - 1) / BitsPerWord;
+
+			std::vector<uint64_t> offset;
+			std::vector<std::vector<uint64_t>> basis;
+			Reduce(measuredQubits, offset, basis);
+
+			// a single outcome, no need for random numbers
+			if (basis.empty())
+			{
+				addCount(static_cast<size_t>(offset[0]), shots);
+				return;
+			}
+
+			const size_t nrBlocks = (shots + BitsPerWord - 1) / BitsPerWord;
+			const size_t nrSlices = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::max(nrThreads, 1)), nrBlocks));
+
+			std::vector<std::unordered_map<size_t, size_t>> counts(nrSlices);
+
+			const long long int slices = static_cast<long long int>(nrSlices);
+
+#pragma omp parallel for num_threads(static_cast<int>(nrSlices)) schedule(static, 1) if (nrSlices > 1)
+			for (long long int slice = 0; slice < slices; ++slice)
+			{
+				std::seed_seq seq{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(slice) };
+				std::mt19937_64 rng(seq);
+
+				auto& sliceCounts = counts[slice];
+
+				// the outcomes of the measured qubits for 64 shots, a word for each measured qubit
+				std::vector<uint64_t> outcomes(nrMeasured);
+
+				for (size_t block = static_cast<size_t>(slice); block < nrBlocks; block += nrSlices)
+				{
+					for (size_t i = 0; i < nrMeasured; ++i)
+						outcomes[i] = (offset[i / BitsPerWord] >> (i % BitsPerWord)) & 1 ? ~0ULL : 0ULL;
+
+					for (const auto& direction : basis)
+					{
+						const uint64_t coefficients = rng();
+
+						for (size_t w = 0; w < nrMeasuredWords; ++w)
+						{
+							uint64_t bits = direction[w];
+							while (bits)
+							{
+								outcomes[w * BitsPerWord + LowestBit(bits)] ^= coefficients;
+								bits &= bits - 1;
+							}
+						}
+					}
+
+					const size_t blockShots = std::min(BitsPerWord, shots - block * BitsPerWord);
+					for (size_t shot = 0; shot < blockShots; ++shot)
+					{
+						size_t outcome = 0;
+						for (size_t i = 0; i < nrMeasured; ++i)
+							outcome |= static_cast<size_t>((outcomes[i] >> shot) & 1) << i;
+
+						++sliceCounts[outcome];
+					}
+				}
+			}
+
+			for (size_t slice = 1; slice < nrSlices; ++slice)
+				for (const auto& [outcome, cnt] : counts[slice])
+					counts[0][outcome] += cnt;
+
+			for (const auto& [outcome, cnt] : counts[0])
+				addCount(outcome, cnt);
+		}
+
+	private:
+		/**
+		 * @brief A stabilizer generator, packed.
+		 */
+		struct Row {
+			std::vector<uint64_t> x; /**< The X bits */
+			std::vector<uint64_t> z; /**< The Z bits */
+			bool negative = false; /**< The sign */
+		};
+
+		static size_t LowestBit(uint64_t v)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<size_t>(__builtin_ctzll(v));
+#else
+			return std::bitset<BitsPerWord>((v & (~v + 1)) - 1).count();
+#endif
+		}
+
+		static size_t PopCount(uint64_t v)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<size_t>(__builtin_popcountll(v));
+#else
+			return std::bitset<BitsPerWord>(v).count();
+#endif
+		}
+
+		static bool GetBit(const std::vector<uint64_t>& words, size_t q)
+		{
+			return (words[q / BitsPerWord] >> (q % BitsPerWord)) & 1;
+		}
+
+		/**
+		 * @brief Multiply a generator into another one, with the sign of the product.
+		 *
+		 * The generators commute, so the product is +/- a Pauli string. The power of i from each qubit is counted as in the Aaronson-Gottesman rowsum.
+		 *
+		 * @param target The generator that is replaced with the product.
+		 * @param source The generator it's multiplied with.
+		 */
+		static void MultiplyInto(Row& target, const Row& source)
+		{
+			long long int power = 0;
+
+			for (size_t w = 0; w < target.x.size(); ++w)
+			{
+				const uint64_t x1 = source.x[w];
+				const uint64_t z1 = source.z[w];
+				const uint64_t x2 = target.x[w];
+				const uint64_t z2 = target.z[w];
+
+				// Y * Z, X * Y and Z * X give +i, the reverse orders give -i
+				const uint64_t plus = (x1 & z1 & ~x2 & z2) | (x1 & ~z1 & x2 & z2) | (~x1 & z1 & x2 & ~z2);
+				const uint64_t minus = (x1 & z1 & x2 & ~z2) | (x1 & ~z1 & ~x2 & z2) | (~x1 & z1 & x2 & z2);
+
+				power += static_cast<long long int>(PopCount(plus)) - static_cast<long long int>(PopCount(minus));
+
+				target.x[w] ^= x1;
+				target.z[w] ^= z1;
+			}
+
+			// the power is 0 or 2 modulo 4 for commuting generators
+			const bool flip = ((power % 4) + 4) % 4 == 2;
+			target.negative = (target.negative != source.negative) != flip;
+		}
+
+		/**
+		 * @brief Find the affine subspace of the outcomes of the measured qubits.
+		 *
+		 * @param measuredQubits The measured qubits.
+		 * @param offset A particular outcome, packed, bit i for measuredQubits[i].
+		 * @param basis The directions of the subspace, packed, linearly independent.
+		 */
+		void Reduce(const std::vector<size_t>& measuredQubits, std::vector<uint64_t>& offset, std::vector<std::vector<uint64_t>>& basis) const
+		{
+			const size_t nrMeasuredWords = (measuredQubits.size() + BitsPerWord - 1) / BitsPerWord;
+
+			std::vector<Row> rows = generators;
+
+			// row echelon form for the X parts
+			size_t rank = 0;
+			for (size_t q = 0; q < nrQubits && rank < rows.size(); ++q)
+			{
+				size_t pivot = rank;
+				while (pivot < rows.size() && !GetBit(rows[pivot].x, q)) ++pivot;
+				if (pivot == rows.size()) continue;
+
+				std::swap(rows[rank], rows[pivot]);
+
+				for (size_t r = 0; r < rows.size(); ++r)
+					if (r != rank && GetBit(rows[r].x, q))
+						MultiplyInto(rows[r], rows[rank]);
+
+				++rank;
+			}
+
+			// the generators without X operators, reduced row echelon form for the Z parts
+			// a particular outcome has the pivot bits set to the signs and the others zero
+			std::vector<bool> outcome(nrQubits, false);
+
+			size_t zRank = rank;
+			for (size_t q = 0; q < nrQubits && zRank < rows.size(); ++q)
+			{
+				size_t pivot = zRank;
+				while (pivot < rows.size() && !GetBit(rows[pivot].z, q)) ++pivot;
+				if (pivot == rows.size()) continue;
+
+				std::swap(rows[zRank], rows[pivot]);
+
+				for (size_t r = rank; r < rows.size(); ++r)
+					if (r != zRank && GetBit(rows[r].z, q))
+					{
+						for (size_t w = 0; w < nrWords; ++w)
+							rows[r].z[w] ^= rows[zRank].z[w];
+						rows[r].negative = rows[r].negative != rows[zRank].negative;
+					}
+
+				++zRank;
+			}
+
+			for (size_t r = rank; r < zRank; ++r)
+			{
+				size_t w = 0;
+				while (rows[r].z[w] == 0) ++w;
+				outcome[w * BitsPerWord + LowestBit(rows[r].z[w])] = rows[r].negative;
+			}
+
+			offset.assign(nrMeasuredWords, 0);
+			for (size_t i = 0; i < measuredQubits.size(); ++i)
+				if (measuredQubits[i] < nrQubits && outcome[measuredQubits[i]])
+					offset[i / BitsPerWord] |= 1ULL << (i % BitsPerWord);
+
+			// the directions restricted to the measured qubits, the dependent ones are dropped
+			basis.clear();
+			std::vector<size_t> pivots;
+
+			for (size_t r = 0; r < rank; ++r)
+			{
+				std::vector<uint64_t> direction(nrMeasuredWords, 0);
+				for (size_t i = 0; i < measuredQubits.size(); ++i)
+					if (measuredQubits[i] < nrQubits && GetBit(rows[r].x, measuredQubits[i]))
+						direction[i / BitsPerWord] |= 1ULL << (i % BitsPerWord);
+
+				for (size_t b = 0; b < basis.size(); ++b)
+					if (GetBit(direction, pivots[b]))
+						for (size_t w = 0; w < nrMeasuredWords; ++w)
+							direction[w] ^= basis[b][w];
+
+				size_t w = 0;
+				while (w < nrMeasuredWords && direction[w] == 0) ++w;
+				if (w == nrMeasuredWords) continue;
+
+				pivots.push_back(w * BitsPerWord + LowestBit(direction[w]));
+				basis.emplace_back(std::move(direction));
+			}
+		}
+
+		size_t nrQubits; /**< The number of qubits */
+		size_t nrWords; /**< The number of words for the bits of a generator */
+		std::vector<Row> generators; /**< The stabilizer generators */
+	};
+
+}
+
+#endif // _STABILIZER_SAMPLER_H_
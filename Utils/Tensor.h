@@ -19,6 +19,13 @@
 #include <complex>
 #include <numeric>
 #include <unordered_set>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
@@ -43,11 +50,46 @@ namespace Utils {
 		constexpr static size_t OmpLimit = 1024;
 		constexpr static int divSchedule = 2;
 
+		// below this number of multiply-adds (result size times contracted size) the element-wise contraction is used,
+		// above it the operands are permuted into matrices and multiplied with the blocked gemm from Eigen
+		constexpr static size_t GemmLimit = 4096;
+		constexpr static size_t GemmColsPerThread = 16;
+
 		static int GetNumberOfThreads()
 		{
 			return QC::QubitRegisterCalculator<>::GetNumberOfThreads();
 		}
 
+		/**
+		 * @brief Limits the openmp threads started by the calling thread to one, for its lifetime.
+		 *
+		 * The number of threads is an internal control variable of the calling thread, so this does not affect other threads.
+		 */
+		class SingleThreadedScope
+		{
+		public:
+			SingleThreadedScope()
+			{
+#ifdef _OPENMP
+				maxThreads = omp_get_max_threads();
+				omp_set_num_threads(1);
+#endif
+			}
+
+			~SingleThreadedScope()
+			{
+#ifdef _OPENMP
+				omp_set_num_threads(maxThreads);
+#endif
+			}
+
+			SingleThreadedScope(const SingleThreadedScope&) = delete;
+			SingleThreadedScope& operator=(const SingleThreadedScope&) = delete;
+
+		private:
+			int maxThreads = 1;
+		};
+
 	public:
 		friend class boost::serialization::access;
 
@@ -609,7 +651,12 @@ namespace Utils {
 			{
 				const size_t sz = result.GetSize();
 
-				if (!allowMultithreading || sz < OmpLimit)
+				if (UseGemm(sz, dims[ind1]))
+				{
+					const std::vector<std::pair<size_t, size_t>> indices{ { ind1, ind2 } };
+					ContractGemm(other, indices, result, allowMultithreading);
+				}
+				else if (!allowMultithreading || sz < OmpLimit)
 				{
 					std::vector<size_t> indices1(dims.size());
 					std::vector<size_t> indices2(other.dims.size());
@@ -722,7 +769,9 @@ namespace Utils {
 				const Tensor<T, Storage> dummy(contractDims, true); // used for incrementing the index
 				const size_t sz = result.GetSize();
 
-				if (!allowMultithreading || sz < OmpLimit)
+				if (UseGemm(sz, dummy.GetSize()))
+					ContractGemm(other, indices, result, allowMultithreading);
+				else if (!allowMultithreading || sz < OmpLimit)
 				{
 					std::vector<size_t> dummyIndices(contractDims.size(), 0); // the dummy index to be incremented - use the values to complete the real indices
 					std::vector<size_t> indices1(dims.size());
@@ -1094,6 +1143,179 @@ namespace Utils {
 
 			return indices;
 		}
+
+		// gemm based contraction
+		// the element-wise contraction is dominated by the index computations and by the allocations for the indices vectors
+		// here the free indices of the first tensor become the rows, the contracted ones the columns, for the second tensor
+		// the contracted ones become the rows and the free ones the columns, so the result is obtained with a single matrix multiplication
+		// with the fortran layout, the result of the multiplication is already in the layout of the result tensor
+
+		static constexpr bool IsGemmType()
+		{
+			return std::is_same<T, std::complex<double>>::value || std::is_same<T, std::complex<float>>::value ||
+				std::is_same<T, double>::value || std::is_same<T, float>::value;
+		}
+
+		static bool UseGemm(size_t resultSize, size_t contractSize)
+		{
+			if constexpr (IsGemmType())
+				return resultSize * contractSize >= GemmLimit;
+			else
+				return false;
+		}
+
+		inline std::vector<size_t> GetStrides() const
+		{
+			std::vector<size_t> strides(dims.size());
+
+			size_t stride = 1;
+			for (size_t i = 0; i < dims.size(); ++i)
+			{
+				strides[i] = stride;
+				stride *= dims[i];
+			}
+
+			return strides;
+		}
+
+		// checks if the rows given by 'rowIndices' followed by the columns given by 'colIndices' are already
+		// the order in which the values are stored, in which case the values can be used as a matrix without permuting them
+		static bool IsMatrixOrder(const std::vector<size_t>& rowIndices, const std::vector<size_t>& colIndices)
+		{
+			size_t pos = 0;
+			for (const size_t index : rowIndices)
+				if (index != pos++) return false;
+
+			for (const size_t index : colIndices)
+				if (index != pos++) return false;
+
+			return true;
+		}
+
+		// copies the tensor values into a column-major matrix, the rows being given by the 'rowIndices' (the first is the fastest varying)
+		// and the columns by the 'colIndices'
+		// check with IsMatrixOrder first, there is no need to copy anything if the values are already in the needed order
+		void PermuteToMatrix(const std::vector<size_t>& rowIndices, const std::vector<size_t>& colIndices, T* dst) const
+		{
+			const std::vector<size_t> strides = GetStrides();
+
+			std::vector<size_t> order(rowIndices);
+			order.insert(order.end(), colIndices.cbegin(), colIndices.cend());
+
+			// odometer over the permuted indices, the offset into the source is updated incrementally
+			std::vector<size_t> counters(order.size(), 0);
+			const size_t size = GetSize();
+			size_t srcOffset = 0;
+
+			for (size_t dstOffset = 0; dstOffset < size; ++dstOffset)
+			{
+				dst[dstOffset] = values[srcOffset];
+
+				for (size_t i = 0; i < order.size(); ++i)
+				{
+					const size_t index = order[i];
+					if (++counters[i] < dims[index])
+					{
+						srcOffset += strides[index];
+						break;
+					}
+
+					srcOffset -= (dims[index] - 1) * strides[index];
+					counters[i] = 0;
+				}
+			}
+		}
+
+		void ContractGemm(const Tensor<T, Storage>& other, const std::vector<std::pair<size_t, size_t>>& indices, Tensor<T, Storage>& result, bool allowMultithreading) const
+		{
+			using Matrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+			using MatrixMap = Eigen::Map<Matrix>;
+			using ConstMatrixMap = Eigen::Map<const Matrix>;
+
+			std::vector<bool> contracted1(dims.size(), false);
+			std::vector<bool> contracted2(other.dims.size(), false);
+
+			std::vector<size_t> contractIndices1;
+			std::vector<size_t> contractIndices2;
+			contractIndices1.reserve(indices.size());
+			contractIndices2.reserve(indices.size());
+
+			size_t contractSize = 1;
+			for (const auto& index : indices)
+			{
+				contracted1[index.first] = true;
+				contracted2[index.second] = true;
+				contractIndices1.push_back(index.first);
+				contractIndices2.push_back(index.second);
+				contractSize *= dims[index.first];
+			}
+
+			std::vector<size_t> freeIndices1;
+			std::vector<size_t> freeIndices2;
+			size_t rows = 1;
+			size_t cols = 1;
+
+			for (size_t i = 0; i < dims.size(); ++i)
+				if (!contracted1[i])
+				{
+					freeIndices1.push_back(i);
+					rows *= dims[i];
+				}
+
+			for (size_t i = 0; i < other.dims.size(); ++i)
+				if (!contracted2[i])
+				{
+					freeIndices2.push_back(i);
+					cols *= other.dims[i];
+				}
+
+			std::vector<T> permuted1;
+			const T* data1 = &values[0];
+			if (!IsMatrixOrder(freeIndices1, contractIndices1))
+			{
+				permuted1.resize(GetSize());
+				PermuteToMatrix(freeIndices1, contractIndices1, permuted1.data());
+				data1 = permuted1.data();
+			}
+
+			std::vector<T> permuted2;
+			const T* data2 = &other.values[0];
+			if (!IsMatrixOrder(contractIndices2, freeIndices2))
+			{
+				permuted2.resize(other.GetSize());
+				other.PermuteToMatrix(contractIndices2, freeIndices2, permuted2.data());
+				data2 = permuted2.data();
+			}
+
+			const ConstMatrixMap mat1(data1, rows, contractSize);
+			const ConstMatrixMap mat2(data2, contractSize, cols);
+			MatrixMap res(&result.values[0], rows, cols);
+
+			const long long int nrBlocks = static_cast<long long int>(allowMultithreading && rows * cols >= OmpLimit ? std::min<size_t>(GetNumberOfThreads(), (cols + GemmColsPerThread - 1) / GemmColsPerThread) : 1);
+
+			if (nrBlocks <= 1)
+			{
+				// eigen would start its own openmp threads for the product, for example on the threads of a pool, where omp_in_parallel is false
+				const SingleThreadedScope singleThreaded;
+				res.noalias() = mat1 * mat2;
+			}
+			else
+			{
+				// split the columns of the result between threads, inside the parallel region eigen does not parallelize the product again
+				const auto processor_count = GetNumberOfThreads();
+				const size_t blockCols = (cols + nrBlocks - 1) / nrBlocks;
+
+#pragma omp parallel for num_threads(processor_count) schedule(static, 1)
+				for (long long int block = 0; block < nrBlocks; ++block)
+				{
+					const size_t startCol = block * blockCols;
+					if (startCol >= cols) continue;
+					const size_t nrCols = std::min(blockCols, cols - startCol);
+
+					res.middleCols(startCol, nrCols).noalias() = mat1 * mat2.middleCols(startCol, nrCols);
+				}
+			}
+		}
 	};
 
 
@@ -17,10 +17,12 @@
 #include <vector>
 #include <queue>
 #include <condition_variable>
+#include <memory>
 
 #include <fstream>
 
 #include "WorkerThread.h"
+#include "JobsBatch.h"
 
 namespace Utils {
 
@@ -37,7 +39,19 @@ namespace Utils {
 	{
 		using JobWorkerThread = WorkerThread<ThreadsPool<Job>, Job>;
 		friend class WorkerThread<ThreadsPool<Job>, Job>;
+
+		/**
+		 * @brief A job in the queue, along with the batch it was submitted with (if any).
+		 */
+		struct QueuedJob
+		{
+			std::shared_ptr<Job> job; /**< The job to be executed */
+			std::shared_ptr<JobsBatch> batch; /**< The batch to notify when the job is finished, nullptr if the pool finish counter is used */
+		};
+
 	public:
+		constexpr static bool WorkStealing = false; /**< The worker threads use the single queue loop */
+
 		/**
 		 * @brief Construct a new Thread pool object.
 		 *
@@ -64,6 +78,26 @@ namespace Utils {
 		}
 
 
+		/**
+		 * @brief Get the process-wide threads pool.
+		 *
+		 * Returns the threads pool shared by all the users of this job type.
+		 * The threads are created the first time they are needed and are kept alive between calls, avoiding the creation and join of threads for each execution.
+		 * Do not call Stop() or Resize() on it, use Reserve() to make sure there are enough threads and a JobsBatch to wait for the submitted jobs.
+		 * The pool is never destroyed, its threads are left to the process termination.
+		 * @param nrThreads The minimum number of threads in the pool. If zero, the pool is not grown.
+		 * @return The shared threads pool.
+		 */
+		static ThreadsPool<Job>& GetSharedPool(size_t nrThreads = 0)
+		{
+			// never freed on purpose: destroying it joins the threads, which at library unload would happen under the loader lock and deadlock
+			static auto* sharedPool = new ThreadsPool<Job>(1);
+
+			if (nrThreads) sharedPool->Reserve(nrThreads);
+
+			return *sharedPool;
+		}
+
 		/**
 		 * @brief Stop all the threads in the threads pool.
 		 *
@@ -72,6 +106,8 @@ namespace Utils {
 		 */
 		void Stop()
 		{
+			std::lock_guard lockThreads(ThreadsMutex);
+
 			{
 				std::lock_guard lock(Mutex);
 
@@ -94,6 +130,7 @@ namespace Utils {
 		 */
 		void Start()
 		{
+			std::lock_guard lockThreads(ThreadsMutex);
 			for (auto& worker : Threads)
 				worker->Start();
 		}
@@ -109,7 +146,7 @@ namespace Utils {
 		{
 			{
 				std::lock_guard lock(Mutex);
-				JobsQueue.push(job);
+				JobsQueue.push(QueuedJob{ job, nullptr });
 			}
 
 			NotifyOne();
@@ -126,7 +163,27 @@ namespace Utils {
 		{
 			{
 				std::lock_guard lock(Mutex);
-				JobsQueue.push(std::move(job));
+				JobsQueue.push(QueuedJob{ std::move(job), nullptr });
+			}
+
+			NotifyOne();
+		}
+
+		/**
+		 * @brief Add a job belonging to a batch to be executed by the threads pool.
+		 *
+		 * Adds a job to the queue of jobs to be executed by the threads pool.
+		 * When the job is finished, its job count is added to the batch instead of the pool finish counter.
+		 * Notifies one thread that there is a new job to execute.
+		 * @param job The job to be executed.
+		 * @param batch The batch the job belongs to.
+		 * @sa JobsBatch
+		 */
+		void AddRunJob(std::shared_ptr<Job> job, const std::shared_ptr<JobsBatch>& batch)
+		{
+			{
+				std::lock_guard lock(Mutex);
+				JobsQueue.push(QueuedJob{ std::move(job), batch });
 			}
 
 			NotifyOne();
@@ -166,6 +223,8 @@ namespace Utils {
 		{
 			if (nrThreads <= 0) nrThreads = 1;
 
+			std::lock_guard lockThreads(ThreadsMutex);
+
 			size_t oldSize = Threads.size();
 
 			if (oldSize == nrThreads) return;
@@ -182,18 +241,45 @@ namespace Utils {
 			{
 				{
 					std::lock_guard lock(Mutex);
-					for (size_t i = oldSize; i < nrThreads; ++i)
+					for (size_t i = nrThreads; i < oldSize; ++i)
 						Threads[i]->SetStopUnlocked();
 				}
 
 				NotifyAll();
 
-				for (size_t i = oldSize; i < nrThreads; ++i)
+				for (size_t i = nrThreads; i < oldSize; ++i)
 					Threads[i]->Join();
 				Threads.resize(nrThreads);
 			}
 		}
 
+		/**
+		 * @brief Make sure the pool has at least the given number of threads.
+		 *
+		 * Grows the threads pool if it has less threads than requested, never shrinks it.
+		 * Unlike Resize(), it is safe to call while other callers have jobs executing in the pool.
+		 * @param nrThreads The minimum number of threads in the pool.
+		 */
+		void Reserve(size_t nrThreads)
+		{
+			std::lock_guard lockThreads(ThreadsMutex);
+
+			for (size_t i = Threads.size(); i < nrThreads; ++i)
+				Threads.emplace_back(std::make_unique<JobWorkerThread>(this));
+		}
+
+		/**
+		 * @brief Get the number of threads.
+		 *
+		 * Returns the number of worker threads in the pool.
+		 * @return The number of threads.
+		 */
+		size_t GetNumberOfThreads() const
+		{
+			std::lock_guard lockThreads(ThreadsMutex);
+			return Threads.size();
+		}
+
 		/**
 		 * @brief Set the finish limit.
 		 *
@@ -260,8 +346,9 @@ namespace Utils {
 		size_t FinishCount = 0; /**< The number of finished jobs */
 		size_t FinishLimit = std::numeric_limits<size_t>::max(); /**< The limit of the finished jobs to reach before notifying finish */
 
-		std::queue<std::shared_ptr<Job>> JobsQueue; /**< The queue of the jobs to be executed */
+		std::queue<QueuedJob> JobsQueue; /**< The queue of the jobs to be executed */
 
+		mutable std::mutex ThreadsMutex; /**< Mutex to be used when the threads vector is changed */
 		std::vector<std::unique_ptr<JobWorkerThread>> Threads; /**< The vector with the worker threads */
 	};
 
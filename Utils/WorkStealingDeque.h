@@ -0,0 +1,201 @@
+/**
+ * @file WorkStealingDeque.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A lock-free work-stealing deque.
+ *
+ * The Chase-Lev deque, with the memory orderings from 'Correct and Efficient Work-Stealing for Weak Memory Models' (Le, Pop, Cohen, Zappa Nardelli).
+ * The owner thread pushes and pops at the bottom, other threads steal from the top.
+ */
+
+#pragma once
+
+#ifndef __WORK_STEALING_DEQUE_H_
+#define __WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <vector>
+#include <memory>
+
+
+namespace Utils {
+
+	/**
+	 * @class WorkStealingDeque
+	 * @brief Lock-free single owner, multiple thieves deque.
+	 *
+	 * Push and Pop can be called only by the owner thread, Steal can be called by any thread.
+	 * The storage grows when needed, the old buffers are kept until the deque is destroyed, since thieves might still read from them.
+	 * @tparam T The type of the stored elements. Must be a pointer type (or something trivially copyable that fits in an atomic), nullptr is returned when there is nothing to pop/steal.
+	 */
+	template<class T> class WorkStealingDeque
+	{
+	public:
+		/**
+		 * @brief Construct a new Work Stealing Deque object.
+		 *
+		 * @param logCapacity The logarithm in base two of the initial capacity.
+		 */
+		explicit WorkStealingDeque(size_t logCapacity = 8)
+			: Top(0), Bottom(0)
+		{
+			Buffers.emplace_back(std::make_unique<Buffer>(logCapacity));
+			Array.store(Buffers.back().get(), std::memory_order_relaxed);
+		}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		/**
+		 * @brief Push an element at the bottom.
+		 *
+		 * Called only by the owner thread.
+		 * @param value The element to push.
+		 */
+		void Push(T value)
+		{
+			const long long int b = Bottom.load(std::memory_order_relaxed);
+			const long long int t = Top.load(std::memory_order_acquire);
+			Buffer* a = Array.load(std::memory_order_relaxed);
+
+			if (b - t > static_cast<long long int>(a->Capacity()) - 1)
+				a = Grow(a, b, t);
+
+			a->Put(b, value);
+			std::atomic_thread_fence(std::memory_order_release);
+			Bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Pop an element from the bottom.
+		 *
+		 * Called only by the owner thread.
+		 * @return The element, or nullptr if the deque is empty.
+		 */
+		T Pop()
+		{
+			const long long int b = Bottom.load(std::memory_order_relaxed) - 1;
+			Buffer* a = Array.load(std::memory_order_relaxed);
+			Bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long long int t = Top.load(std::memory_order_relaxed);
+
+			T value = nullptr;
+
+			if (t <= b)
+			{
+				value = a->Get(b);
+				if (t == b)
+				{
+					// the last element, race against the thieves
+					if (!Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						value = nullptr;
+					Bottom.store(b + 1, std::memory_order_relaxed);
+				}
+			}
+			else
+				Bottom.store(b + 1, std::memory_order_relaxed);
+
+			return value;
+		}
+
+		/**
+		 * @brief Steal an element from the top.
+		 *
+		 * Can be called by any thread.
+		 * @return The element, or nullptr if the deque is empty or the steal lost a race.
+		 */
+		T Steal()
+		{
+			long long int t = Top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const long long int b = Bottom.load(std::memory_order_acquire);
+
+			if (t < b)
+			{
+				Buffer* a = Array.load(std::memory_order_acquire);
+				T value = a->Get(t);
+				if (!Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+
+				return value;
+			}
+
+			return nullptr;
+		}
+
+		/**
+		 * @brief Check if the deque is empty.
+		 *
+		 * The result is only a hint if other threads are using the deque.
+		 * @return true if the deque looks empty, false otherwise.
+		 */
+		bool Empty() const
+		{
+			const long long int b = Bottom.load(std::memory_order_relaxed);
+			const long long int t = Top.load(std::memory_order_relaxed);
+
+			return b <= t;
+		}
+
+	private:
+		/**
+		 * @brief Circular buffer with a power of two capacity.
+		 */
+		class Buffer
+		{
+		public:
+			explicit Buffer(size_t logCap)
+				: Mask((1ULL << logCap) - 1), LogCapacity(logCap), Values(1ULL << logCap)
+			{
+			}
+
+			inline size_t Capacity() const { return Mask + 1; }
+
+			inline T Get(long long int index) const
+			{
+				return Values[static_cast<size_t>(index) & Mask].load(std::memory_order_relaxed);
+			}
+
+			inline void Put(long long int index, T value)
+			{
+				Values[static_cast<size_t>(index) & Mask].store(value, std::memory_order_relaxed);
+			}
+
+			const size_t Mask; /**< The mask for the circular indexing */
+			const size_t LogCapacity; /**< The logarithm in base two of the capacity */
+
+		private:
+			std::vector<std::atomic<T>> Values; /**< The stored values */
+		};
+
+		/**
+		 * @brief Doubles the capacity of the buffer.
+		 *
+		 * Called only by the owner thread.
+		 */
+		Buffer* Grow(Buffer* a, long long int b, long long int t)
+		{
+			Buffers.emplace_back(std::make_unique<Buffer>(a->LogCapacity + 1));
+			Buffer* newArray = Buffers.back().get();
+
+			for (long long int i = t; i < b; ++i)
+				newArray->Put(i, a->Get(i));
+
+			Array.store(newArray, std::memory_order_release);
+
+			return newArray;
+		}
+
+		alignas(64) std::atomic<long long int> Top; /**< The index of the top, where the thieves steal from */
+		alignas(64) std::atomic<long long int> Bottom; /**< The index of the bottom, where the owner pushes and pops */
+		std::atomic<Buffer*> Array; /**< The current buffer */
+
+		std::vector<std::unique_ptr<Buffer>> Buffers; /**< All the allocated buffers, owned by the deque */
+	};
+
+}
+
+#endif // __WORK_STEALING_DEQUE_H_
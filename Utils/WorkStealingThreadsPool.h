@@ -0,0 +1,523 @@
+/**
+ * @file WorkStealingThreadsPool.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The work-stealing pool of threads, executing jobs.
+ *
+ * A drop-in alternative to ThreadsPool for many small jobs: instead of a single queue protected by a mutex,
+ * each worker has its own lock-free deque and idle workers steal jobs from random victims.
+ */
+
+#pragma once
+
+#ifndef __WORK_STEALING_THREADS_POOL_H_
+#define __WORK_STEALING_THREADS_POOL_H_
+
+#include <vector>
+#include <deque>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+
+#include "WorkerThread.h"
+#include "WorkStealingDeque.h"
+#include "JobsBatch.h"
+
+namespace Utils {
+
+	/**
+	 * @class WorkStealingThreadsPool
+	 * @brief Threads pool with per worker deques and work stealing.
+	 *
+	 * Has the same interface as ThreadsPool, so it can be used for the same jobs (anything having DoWork() and GetJobCount()).
+	 * Jobs added from outside the pool are distributed round-robin to the workers inboxes (each protected by its own mutex, so there is no global lock).
+	 * Jobs added from within a job running on a worker are pushed lock-free on the worker's own deque.
+	 * Workers first drain their inbox into their deque, pop from their deque and, when out of work, steal from random victims.
+	 * The mutex and condition variable are used only for putting idle workers to sleep and waking them up.
+	 * @tparam Job The job class/type.
+	 * @sa ThreadsPool
+	 * @sa WorkerThread
+	 */
+	template<class Job> class WorkStealingThreadsPool
+	{
+		using JobWorkerThread = WorkerThread<WorkStealingThreadsPool<Job>, Job>;
+		friend class WorkerThread<WorkStealingThreadsPool<Job>, Job>;
+
+		/**
+		 * @brief A job in the queues, along with the batch it was submitted with (if any).
+		 */
+		struct QueuedJob
+		{
+			std::shared_ptr<Job> job; /**< The job to be executed */
+			std::shared_ptr<JobsBatch> batch; /**< The batch to notify when the job is finished, nullptr if the pool finish counter is used */
+		};
+
+		/**
+		 * @brief The queues of a worker.
+		 */
+		struct WorkerQueues
+		{
+			WorkStealingDeque<QueuedJob*> Deque; /**< The lock-free deque, pushed and popped by the owner, stolen from by the others */
+			std::mutex InboxMutex; /**< Mutex for the inbox */
+			std::deque<QueuedJob*> Inbox; /**< The jobs added from outside the pool, waiting to be moved in the deque */
+		};
+
+		/**
+		 * @brief Identifies the pool and worker the current thread belongs to, if any.
+		 */
+		struct CurrentWorker
+		{
+			const WorkStealingThreadsPool<Job>* pool = nullptr; /**< The pool */
+			size_t index = 0; /**< The worker index */
+		};
+
+		constexpr static int StealRounds = 4; /**< How many times the victims are visited before going to sleep */
+
+	public:
+		constexpr static bool WorkStealing = true; /**< Tells the worker threads to use the work-stealing loop */
+
+		/**
+		 * @brief Construct a new Work Stealing Threads Pool object.
+		 *
+		 * Constructs a new threads pool object with the given number of threads.
+		 * @param nrThreads The number of threads to create in the pool. If less than or equal to zero, one thread will be created. Can be resized later.
+		 * @param maxThreads The maximum number of threads the pool can grow to. If zero, it is set to four times the hardware concurrency (but not less than nrThreads).
+		 */
+		explicit WorkStealingThreadsPool(int nrThreads = 0, size_t maxThreads = 0)
+		{
+			if (nrThreads <= 0) nrThreads = 1;
+			if (maxThreads == 0) maxThreads = std::max<size_t>(4 * std::thread::hardware_concurrency(), 64);
+			maxThreads = std::max<size_t>(maxThreads, nrThreads);
+
+			// the queues are allocated upfront, so the workers can look for victims without synchronizing with resizing
+			Queues.reserve(maxThreads);
+			for (size_t i = 0; i < maxThreads; ++i)
+				Queues.emplace_back(std::make_unique<WorkerQueues>());
+
+			NrVictims.store(nrThreads);
+
+			for (int i = 0; i < nrThreads; ++i)
+				Threads.emplace_back(std::make_unique<JobWorkerThread>(this, i));
+		}
+
+		/**
+		 * @brief Destructor.
+		 *
+		 * Destroy the threads pool object.
+		 * Before destroying, stops all threads and waits for their completion.
+		 * Jobs that were not executed are discarded.
+		 */
+		~WorkStealingThreadsPool()
+		{
+			Stop();
+
+			for (auto& queues : Queues)
+			{
+				for (QueuedJob* queued = queues->Deque.Pop(); queued; queued = queues->Deque.Pop())
+					delete queued;
+				for (QueuedJob* queued : queues->Inbox)
+					delete queued;
+			}
+		}
+
+		/**
+		 * @brief Get the process-wide threads pool.
+		 *
+		 * Returns the work-stealing threads pool shared by all the users of this job type.
+		 * Do not call Stop() or Resize() on it, use Reserve() to make sure there are enough threads and a JobsBatch to wait for the submitted jobs.
+		 * @param nrThreads The minimum number of threads in the pool. If zero, the pool is not grown.
+		 * @return The shared threads pool.
+		 * @sa ThreadsPool::GetSharedPool
+		 */
+		static WorkStealingThreadsPool<Job>& GetSharedPool(size_t nrThreads = 0)
+		{
+			// intentionally leaked, as for ThreadsPool::GetSharedPool
+			static auto* sharedPool = new WorkStealingThreadsPool<Job>(1);
+
+			if (nrThreads) sharedPool->Reserve(nrThreads);
+
+			return *sharedPool;
+		}
+
+		/**
+		 * @brief Stop all the threads in the threads pool.
+		 *
+		 * Stops all the threads and clears the threads pool.
+		 * Waits for all threads to complete before returning.
+		 */
+		void Stop()
+		{
+			std::lock_guard lockThreads(ThreadsMutex);
+
+			{
+				std::lock_guard lock(Mutex);
+
+				for (auto& worker : Threads)
+					worker->SetStopUnlocked();
+			}
+
+			NotifyAll();
+
+			for (auto& worker : Threads)
+				worker->Join();
+
+			Threads.clear();
+		}
+
+		/**
+		 * @brief Start all the threads in the threads pool.
+		 *
+		 * Starts all the threads in the threads pool.
+		 */
+		void Start()
+		{
+			std::lock_guard lockThreads(ThreadsMutex);
+			for (auto& worker : Threads)
+				worker->Start();
+		}
+
+		/**
+		 * @brief Add a job to be executed by the threads pool.
+		 *
+		 * If called from a job executing in this pool, the job is pushed on the current worker's deque, otherwise in the inbox of a worker.
+		 * Wakes up a sleeping thread, if any.
+		 * @param job The job to be executed.
+		 */
+		void AddRunJob(const std::shared_ptr<Job>& job)
+		{
+			Push(new QueuedJob{ job, nullptr });
+		}
+
+		/**
+		 * @brief Add a job to be executed by the threads pool.
+		 *
+		 * If called from a job executing in this pool, the job is pushed on the current worker's deque, otherwise in the inbox of a worker.
+		 * Wakes up a sleeping thread, if any.
+		 * @param job The job to be executed.
+		 */
+		void AddRunJob(std::shared_ptr<Job>&& job)
+		{
+			Push(new QueuedJob{ std::move(job), nullptr });
+		}
+
+		/**
+		 * @brief Add a job belonging to a batch to be executed by the threads pool.
+		 *
+		 * When the job is finished, its job count is added to the batch instead of the pool finish counter.
+		 * @param job The job to be executed.
+		 * @param batch The batch the job belongs to.
+		 * @sa JobsBatch
+		 */
+		void AddRunJob(std::shared_ptr<Job> job, const std::shared_ptr<JobsBatch>& batch)
+		{
+			Push(new QueuedJob{ std::move(job), batch });
+		}
+
+		/**
+		 * @brief Wait for all jobs to finish.
+		 *
+		 * Blocks until the number of finished jobs (added without a batch) reaches the finish limit set by SetFinishLimit().
+		 * If no finish limit is set, it will wait indefinitely.
+		 */
+		void WaitForFinish()
+		{
+			std::unique_lock lock(FinishMutex);
+			ConditionFinish.wait(lock, [this] { return FinishCount >= FinishLimit; });
+		}
+
+		/**
+		 * @brief Resize the threads pool.
+		 *
+		 * Resizes the threads pool to the given number of threads, limited by the maximum number of threads set in the constructor.
+		 * Jobs left in the queues of the stopped threads are stolen by the remaining ones.
+		 * @param nrThreads The new number of threads in the pool. If less than or equal to zero, one thread will be created or remain.
+		 */
+		void Resize(size_t nrThreads)
+		{
+			if (nrThreads <= 0) nrThreads = 1;
+			nrThreads = std::min(nrThreads, Queues.size());
+
+			std::lock_guard lockThreads(ThreadsMutex);
+
+			const size_t oldSize = Threads.size();
+
+			if (oldSize == nrThreads) return;
+
+			if (oldSize < nrThreads)
+			{
+				for (size_t i = oldSize; i < nrThreads; ++i)
+					Threads.emplace_back(std::make_unique<JobWorkerThread>(this, i));
+
+				UpdateVictims(nrThreads);
+			}
+			else
+			{
+				{
+					std::lock_guard lock(Mutex);
+					for (size_t i = nrThreads; i < oldSize; ++i)
+						Threads[i]->SetStopUnlocked();
+				}
+
+				NotifyAll();
+
+				for (size_t i = nrThreads; i < oldSize; ++i)
+					Threads[i]->Join();
+				Threads.resize(nrThreads);
+
+				// wake up the remaining ones, in case the stopped workers left jobs behind
+				if (PendingJobs.load() > 0) NotifyAll();
+			}
+		}
+
+		/**
+		 * @brief Make sure the pool has at least the given number of threads.
+		 *
+		 * Grows the threads pool if it has less threads than requested (up to the maximum set in the constructor), never shrinks it.
+		 * It is safe to call while other callers have jobs executing in the pool.
+		 * @param nrThreads The minimum number of threads in the pool.
+		 */
+		void Reserve(size_t nrThreads)
+		{
+			nrThreads = std::min(nrThreads, Queues.size());
+
+			std::lock_guard lockThreads(ThreadsMutex);
+
+			for (size_t i = Threads.size(); i < nrThreads; ++i)
+				Threads.emplace_back(std::make_unique<JobWorkerThread>(this, i));
+
+			UpdateVictims(Threads.size());
+		}
+
+		/**
+		 * @brief Get the number of threads.
+		 *
+		 * Returns the number of worker threads in the pool.
+		 * @return The number of threads.
+		 */
+		size_t GetNumberOfThreads() const
+		{
+			std::lock_guard lockThreads(ThreadsMutex);
+			return Threads.size();
+		}
+
+		/**
+		 * @brief Set the finish limit.
+		 *
+		 * Sets the finish limit for the jobs added without a batch and resets the finished count.
+		 * @param limit The finish limit.
+		 */
+		void SetFinishLimit(size_t limit)
+		{
+			std::lock_guard lock(FinishMutex);
+			FinishLimit = limit;
+			FinishCount = 0;
+		}
+
+	private:
+		/**
+		 * @brief Notify all threads that something new has occured.
+		 *
+		 * Notifies all threads that there are new jobs to execute or that they need to terminate.
+		 */
+		inline void NotifyAll()
+		{
+			Condition.notify_all();
+		}
+
+		/**
+		 * @brief Returns the per thread identification of the current worker.
+		 */
+		static CurrentWorker& GetCurrentWorker()
+		{
+			thread_local CurrentWorker current;
+			return current;
+		}
+
+		/**
+		 * @brief Make the newly started workers visible to the thieves.
+		 *
+		 * Called with the threads mutex locked.
+		 */
+		void UpdateVictims(size_t nrThreads)
+		{
+			if (nrThreads > NrVictims.load())
+				NrVictims.store(nrThreads);
+		}
+
+		/**
+		 * @brief Add a queued job to the pool.
+		 */
+		void Push(QueuedJob* queued)
+		{
+			const CurrentWorker& current = GetCurrentWorker();
+
+			++PendingJobs;
+
+			if (current.pool == this)
+				Queues[current.index]->Deque.Push(queued);
+			else
+			{
+				const size_t nrThreads = std::max<size_t>(NrVictims.load(), 1);
+				WorkerQueues& queues = *Queues[NextInbox.fetch_add(1, std::memory_order_relaxed) % nrThreads];
+
+				std::lock_guard lock(queues.InboxMutex);
+				queues.Inbox.push_back(queued);
+			}
+
+			// locking the mutex avoids missing the wake up of a thread that just checked the pending jobs and is about to wait
+			if (Sleepers.load() > 0)
+			{
+				{
+					std::lock_guard lock(Mutex);
+				}
+				Condition.notify_one();
+			}
+		}
+
+		/**
+		 * @brief Try to get a job for the specified worker.
+		 *
+		 * Called by the worker threads.
+		 * Moves the inbox in the deque, pops from the deque, then tries to steal from the others.
+		 * @param index The index of the worker.
+		 * @param seed The random state of the worker, used for choosing victims.
+		 * @return The job, or nullptr if none was found.
+		 */
+		QueuedJob* TakeJob(size_t index, unsigned long long int& seed)
+		{
+			WorkerQueues& own = *Queues[index];
+
+			{
+				std::unique_lock lock(own.InboxMutex, std::try_to_lock);
+				if (lock.owns_lock())
+				{
+					for (QueuedJob* queued : own.Inbox)
+						own.Deque.Push(queued);
+					own.Inbox.clear();
+				}
+			}
+
+			QueuedJob* queued = own.Deque.Pop();
+			if (queued) return queued;
+
+			const size_t nrVictims = NrVictims.load();
+			if (nrVictims == 0) return nullptr;
+
+			for (int round = 0; round < StealRounds && PendingJobs.load() > 0; ++round)
+			{
+				// xorshift, good enough for choosing victims
+				seed ^= seed << 13;
+				seed ^= seed >> 7;
+				seed ^= seed << 17;
+
+				const size_t start = seed % nrVictims;
+				for (size_t i = 0; i < nrVictims; ++i)
+				{
+					const size_t victim = (start + i) % nrVictims;
+					if (victim == index) continue;
+
+					WorkerQueues& queues = *Queues[victim];
+					queued = queues.Deque.Steal();
+					if (queued) return queued;
+
+					// the victim might be busy with a long job, don't let its inbox wait for it
+					std::unique_lock lock(queues.InboxMutex, std::try_to_lock);
+					if (lock.owns_lock() && !queues.Inbox.empty())
+					{
+						queued = queues.Inbox.front();
+						queues.Inbox.pop_front();
+						return queued;
+					}
+				}
+			}
+
+			return nullptr;
+		}
+
+		/**
+		 * @brief Executes a job and accounts for its completion.
+		 *
+		 * Called by the worker threads.
+		 */
+		void Execute(QueuedJob* queued)
+		{
+			--PendingJobs;
+
+			const std::unique_ptr<QueuedJob> holder(queued);
+			queued->job->DoWork();
+
+			if (queued->batch)
+				queued->batch->AddFinished(queued->job->GetJobCount());
+			else
+			{
+				{
+					std::lock_guard lockCount(FinishMutex);
+					FinishCount += queued->job->GetJobCount();
+				}
+				ConditionFinish.notify_all();
+			}
+		}
+
+		/**
+		 * @brief The loop of a worker thread.
+		 *
+		 * Called by the worker threads from their thread function.
+		 * @param index The index of the worker.
+		 * @param stopFlag The stop flag of the worker.
+		 */
+		void RunWorker(size_t index, const std::atomic<bool>& stopFlag)
+		{
+			CurrentWorker& current = GetCurrentWorker();
+			current.pool = this;
+			current.index = index;
+
+			unsigned long long int seed = 0x9E3779B97F4A7C15ULL * (index + 1);
+
+			for (;;)
+			{
+				while (!stopFlag)
+				{
+					QueuedJob* queued = TakeJob(index, seed);
+					if (!queued) break;
+
+					Execute(queued);
+				}
+
+				std::unique_lock lock(Mutex);
+				if (stopFlag) break;
+
+				++Sleepers;
+				Condition.wait(lock, [this, &stopFlag] { return PendingJobs.load() > 0 || stopFlag; });
+				--Sleepers;
+
+				if (stopFlag) break;
+			}
+
+			current.pool = nullptr;
+		}
+
+		std::mutex Mutex; /**< Mutex used only for sleeping and waking up the workers */
+		std::condition_variable Condition; /**< Condition variable to notify threads of new jobs */
+
+		std::atomic<size_t> PendingJobs{ 0 }; /**< The number of jobs added and not taken yet */
+		std::atomic<size_t> Sleepers{ 0 }; /**< The number of workers waiting for jobs */
+		std::atomic<size_t> NextInbox{ 0 }; /**< Round-robin counter for distributing the jobs added from outside */
+		std::atomic<size_t> NrVictims{ 0 }; /**< The number of queues that might contain jobs */
+
+		std::mutex FinishMutex; /**< Mutex to be used to check the finish condition */
+		std::condition_variable ConditionFinish; /**< Condition variable to notify threads waiting for finish */
+
+		size_t FinishCount = 0; /**< The number of finished jobs */
+		size_t FinishLimit = std::numeric_limits<size_t>::max(); /**< The limit of the finished jobs to reach before notifying finish */
+
+		std::vector<std::unique_ptr<WorkerQueues>> Queues; /**< The queues of the workers, allocated for the maximum number of threads */
+
+		mutable std::mutex ThreadsMutex; /**< Mutex to be used when the threads vector is changed */
+		std::vector<std::unique_ptr<JobWorkerThread>> Threads; /**< The vector with the worker threads */
+	};
+
+}
+
+#endif // __WORK_STEALING_THREADS_POOL_H_
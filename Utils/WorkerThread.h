@@ -26,8 +26,10 @@ namespace Utils {
 	 * @brief WorkerThread class for a thread in a threads pool.
 	 *
 	 * A thread that is used in a threads pool, executing jobs.
+	 * For pools that declare WorkStealing as true, the loop is delegated to the pool, which knows how to find work in its queues.
 	 * 
 	 * @tparam ThreadsPool The threads pool class.
+	 * @sa WorkStealingThreadsPool
 	 * @tparam Job The job class/type.
 	 * @sa ThreadsPool
 	 */
@@ -41,9 +43,10 @@ namespace Utils {
 		 * The thread is started immediately.
 		 * 
 		 * @param threadsPool The threads pool that this thread belongs to.
+		 * @param index The index of the thread in the pool, used by the work-stealing pools to identify the thread's own queue.
 		 */
-		explicit WorkerThread(ThreadsPool* threadsPool)
-			: threadsPool(threadsPool), StopFlag(false)
+		explicit WorkerThread(ThreadsPool* threadsPool, size_t index = 0)
+			: threadsPool(threadsPool), Index(index), StopFlag(false)
 		{
 			Thread = std::thread(&WorkerThread::Run, this);
 		}
@@ -134,6 +137,19 @@ namespace Utils {
 		 * If the stop flag is set, the thread exits the loop and terminates.
 		 */
 		void Run()
+		{
+			if constexpr (ThreadsPool::WorkStealing)
+				threadsPool->RunWorker(Index, StopFlag);
+			else
+				RunQueue();
+		}
+
+		/**
+		 * @brief The loop for the single queue threads pool.
+		 *
+		 * Waits on the pool condition variable for jobs, takes them from the pool queue and executes them.
+		 */
+		void RunQueue()
 		{
 			for (;;)
 			{
@@ -143,15 +159,18 @@ namespace Utils {
 
 				while (threadsPool->HasWork() && !StopFlag)
 				{
-					const std::shared_ptr<Job> job = std::move(threadsPool->JobsQueue.front());
+					const auto queued = std::move(threadsPool->JobsQueue.front());
 					threadsPool->JobsQueue.pop();
 					lock.unlock();
 
-					job->DoWork();
+					queued.job->DoWork();
 
+					if (queued.batch)
+						queued.batch->AddFinished(queued.job->GetJobCount());
+					else
 					{
 						std::lock_guard lockCount(threadsPool->FinishMutex);
-						threadsPool->FinishCount += job->GetJobCount();
+						threadsPool->FinishCount += queued.job->GetJobCount();
 					}
 					lock.lock();
 				}
@@ -164,7 +183,8 @@ namespace Utils {
 
 		ThreadsPool* threadsPool; /**< The threads pool that this thread belongs to. */
 		std::thread Thread; /**< The thread object. */
-		bool StopFlag; /**< The stop flag, indicating if the thread should terminate. */
+		size_t Index; /**< The index of the thread in the pool. */
+		std::atomic<bool> StopFlag; /**< The stop flag, indicating if the thread should terminate. */
 	};
 
 
@@ -0,0 +1,159 @@
+/**
+ * @file AsyncJob.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ * An execution submitted to be done asynchronously, by the jobs pool of the maestro object.
+ */
+
+#pragma once
+
+#ifndef _ASYNC_JOB_H_
+#define _ASYNC_JOB_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/**
+ * @class AsyncJob
+ * @brief An execution done on the maestro jobs pool, with its status and its result.
+ *
+ * The work (parsing, execution, encoding of the results) is done by the function passed when constructed.
+ * A cancelled job that did not start is skipped, one that is executing drops the shots not started yet.
+ */
+class AsyncJob
+{
+public:
+	/**
+	 * @brief The status of the job.
+	 */
+	enum class Status : int {
+		kUnknown = 0, /**< No such job */
+		kQueued, /**< Waiting for a thread of the pool */
+		kRunning, /**< Executing */
+		kDone, /**< Finished, the result is available */
+		kFailed, /**< Finished without a result */
+		kCancelled /**< Cancelled before finishing */
+	};
+
+	/**
+	 * @brief The work of the job.
+	 *
+	 * Gets the cancellation flag and returns the result (allocated with new[]) with its size, nullptr if it failed.
+	 */
+	using Work = std::function<char* (const std::shared_ptr<const std::atomic<bool>>& cancelled, unsigned long int& resultSize)>;
+
+	explicit AsyncJob(Work w)
+		: work(std::move(w)), cancelled(std::make_shared<std::atomic<bool>>(false))
+	{
+	}
+
+	~AsyncJob()
+	{
+		delete[] result;
+	}
+
+	void DoWork()
+	{
+		if (SkipIfCancelled()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(statusMutex);
+			status = Status::kRunning;
+		}
+
+		unsigned long int size = 0;
+		char* res = nullptr;
+		try
+		{
+			res = work(cancelled, size);
+		}
+		catch (...)
+		{
+			// an exception must not end the pool thread, the job just fails
+			res = nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(statusMutex);
+		if (cancelled->load())
+		{
+			delete[] res;
+			status = Status::kCancelled;
+		}
+		else
+		{
+			result = res;
+			resultSize = size;
+			status = res ? Status::kDone : Status::kFailed;
+		}
+
+		finished.notify_all();
+	}
+
+	size_t GetJobCount() const
+	{
+		return 1;
+	}
+
+	Status GetStatus() const
+	{
+		std::lock_guard<std::mutex> lock(statusMutex);
+		return status;
+	}
+
+	/**
+	 * @brief Wait for the job to finish and take its result.
+	 *
+	 * @param size Receives the size of the result, if not null.
+	 * @return The result, to be freed with delete[], nullptr if the job failed or was cancelled.
+	 */
+	char* Wait(unsigned long int* size)
+	{
+		std::unique_lock<std::mutex> lock(statusMutex);
+		finished.wait(lock, [this] { return status == Status::kDone || status == Status::kFailed || status == Status::kCancelled; });
+
+		if (size) *size = resultSize;
+
+		char* res = result;
+		result = nullptr;
+
+		return res;
+	}
+
+	/**
+	 * @brief Cancel the job.
+	 *
+	 * A queued job is not executed anymore, a running one stops before starting the next batch of shots.
+	 */
+	void Cancel()
+	{
+		cancelled->store(true);
+	}
+
+private:
+	bool SkipIfCancelled()
+	{
+		std::lock_guard<std::mutex> lock(statusMutex);
+		if (!cancelled->load()) return false;
+
+		status = Status::kCancelled;
+		finished.notify_all();
+
+		return true;
+	}
+
+	Work work;
+	std::shared_ptr<std::atomic<bool>> cancelled;
+
+	mutable std::mutex statusMutex;
+	std::condition_variable finished;
+	Status status = Status::kQueued;
+
+	char* result = nullptr;
+	unsigned long int resultSize = 0;
+};
+
+#endif // _ASYNC_JOB_H_
@@ -17,10 +17,12 @@
 #include "Maestro.h"
 
 #include "Json.h"
+#include "ResultsEncoder.h"
 
 #include <boost/json/src.hpp>
 
 #include <atomic>
+#include <cstring>
 #include <memory>
 
 #include "../Utils/LogFile.h"
@@ -97,39 +99,23 @@ extern "C" int AddOptimizationSimulator(unsigned long int simHandle, int simType
 	return maestroInstance->AddOptimizationSimulator(simHandle, static_cast<Simulators::SimulatorType>(simType), static_cast<Simulators::SimulationType>(simExecType));
 }
 
-extern "C" char* SimpleExecute(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig)
+/**
+ * @brief Check out a network instance of a simple simulator, configured from the json configuration of an execution.
+ *
+ * The simulator options found in the configuration apply only to the checked out network instance.
+ * The instance goes back to the pool with them, to be reused by the requests with the same options,
+ * so they are applied (and the simulator created) only on a new instance.
+ *
+ * @param simpleSim The handle of the simple simulator.
+ * @param jsonConfig The json configuration.
+ * @param nrShots Receives the number of shots from the configuration, 1 if not specified.
+ * @param format Receives the format of the results, if not null.
+ * @return The lease of the instance, empty if the simple simulator does not exist.
+ */
+static SimpleSimulatorPool::Lease CheckoutConfiguredSimulator(unsigned long int simpleSim, const char* jsonConfig, size_t& nrShots, ResultsEncoder::Format* format = nullptr)
 {
-	if (simpleSim == 0 || !jsonCircuit || !jsonConfig || !maestroInstance)
-		return nullptr;
-
-	auto network = maestroInstance->GetSimpleSimulator(simpleSim);
-
-	// step 1: Parse the JSON circuit and configuration strings
-	// convert the JSON circuit into a Circuit object
-
-	// I'm unsure here on how it deals with the classical registers, more precisely
-	// with stuff like "other_measure_name" and "meas" (see below)
-	// since in the example it seems to just use the cbit number
-
-	// This is the json format:
-	// {"instructions": 
-	// [{"name": "h", "qubits": [0], "params": []},
-	// {"name": "cx", "qubits": [0, 1], "params": []}, 
-	// {"name": "rx", "qubits": [0], "params": [0.39528385768119634]}, 
-	// {"name": "measure", "qubits": [0], "memory": [0]}], 
-	// 
-	// "num_qubits": 2, "num_clbits": 4, 
-	// "quantum_registers": {"q": [0, 1]}, 
-	// "classical_registers": {"c": [0, 1], "other_measure_name": [2], "meas": [3]}}
-
-	Json::JsonParserMaestro<> jsonParser;
-
-	auto circuit = jsonParser.ParseCircuit(jsonCircuit);
-	
-	// check if the circuit has measurements only at the end
-
 	// get the number of shots from the configuration
-	size_t nrShots = 1; // default value
+	nrShots = 1; // default value
 
 	const auto configJson = Json::JsonParserMaestro<>::ParseString(jsonConfig);
 
@@ -147,48 +133,61 @@ extern "C" char* SimpleExecute(unsigned long int simpleSim, const char* jsonCirc
 		}
 	}
 
-	bool configured = false;
+	// the default json results are expensive for many distinct outcomes, "hex" and "binary" are cheaper
+	if (format)
+		*format = ResultsEncoder::GetFormat(Json::JsonParserMaestro<>::GetConfigString("result_format", configJson));
 
-	const std::string maxBondDim = Json::JsonParserMaestro<>::GetConfigString("matrix_product_state_max_bond_dimension", configJson);
-	if (!maxBondDim.empty())
-	{
-		configured = true;
-		if (network->GetSimulator())
-			network->GetSimulator()->Clear();
-		network->Configure("matrix_product_state_max_bond_dimension", maxBondDim.c_str());
-	}
+	static const char* const simulatorOptions[] = { "matrix_product_state_max_bond_dimension", "matrix_product_state_truncation_threshold",
+		"mps_sample_measure_algorithm", "tensor_network_max_intermediate_size" };
 
-	const std::string singularValueThreshold = Json::JsonParserMaestro<>::GetConfigString("matrix_product_state_truncation_threshold", configJson);
-	if (!singularValueThreshold.empty())
+	// the options set, also identifying the instances configured with them
+	std::vector<std::pair<const char*, std::string>> options;
+	std::string configuration;
+	for (const char* option : simulatorOptions)
 	{
-		configured = true;
-		if (network->GetSimulator())
-			network->GetSimulator()->Clear();
-		network->Configure("matrix_product_state_truncation_threshold", singularValueThreshold.c_str());
+		std::string value = Json::JsonParserMaestro<>::GetConfigString(option, configJson);
+		if (value.empty()) continue;
+
+		configuration += option;
+		configuration += '=';
+		configuration += value;
+		configuration += ';';
+
+		options.emplace_back(option, std::move(value));
 	}
-	
-	const std::string mpsSample = Json::JsonParserMaestro<>::GetConfigString("mps_sample_measure_algorithm", configJson);
-	if (!mpsSample.empty())
+
+	auto lease = maestroInstance->CheckoutSimpleSimulator(simpleSim, configuration);
+	if (!lease)
+		return lease;
+
+	const auto& network = lease.GetNetwork();
+
+	if (lease.IsNew())
 	{
-		configured = true;
-		if (network->GetSimulator())
-			network->GetSimulator()->Clear();
-		network->Configure("mps_sample_measure_algorithm", mpsSample.c_str());
+		for (const auto& [option, value] : options)
+		{
+			if (network->GetSimulator())
+				network->GetSimulator()->Clear();
+			network->Configure(option, value.c_str());
+		}
 	}
 
-	if (configured || !network->GetSimulator())
+	if ((lease.IsNew() && !options.empty()) || !network->GetSimulator())
 		network->CreateSimulator();
 
 	// TODO: get from config the allowed simulators types and so on, if set
 
-	auto results = network->RepeatedExecuteOnHost(circuit, 0, nrShots);
-
-	// convert the results into a JSON string
-	// allocate memory for the result string and copy the JSON result into it
-	// return the result string
-
-	// TODO: Implement it!
+	return lease;
+}
 
+/**
+ * @brief Convert the results of an execution to the json response.
+ *
+ * @param results The results of the execution.
+ * @return The json response, to be freed with FreeResult.
+ */
+static boost::json::object CountsToJson(const Network::INetwork<>::ExecuteResults& results)
+{
 	boost::json::object response;
 	boost::json::object jsonResult;
 
@@ -201,6 +200,15 @@ extern "C" char* SimpleExecute(unsigned long int simpleSim, const char* jsonCirc
 		jsonResult[bits] = result.second;
 	}
 	response["counts"] = jsonResult;
+
+	return response;
+}
+
+static char* JsonToResult(const boost::json::value& response)
+{
+	// allocate memory for the result string and copy the JSON result into it
+	// return the result string
+
 	const std::string responseStr = boost::json::serialize(response);
 	const size_t responseSize = responseStr.length();
 	char* result = new char[responseSize + 1];
@@ -214,6 +222,316 @@ extern "C" char* SimpleExecute(unsigned long int simpleSim, const char* jsonCirc
 	return result;
 }
 
+static char* ResultsToJson(const Network::INetwork<>::ExecuteResults& results)
+{
+	// convert the results into a JSON string
+	return JsonToResult(CountsToJson(results));
+}
+
+static char* EncodeResults(const Network::INetwork<>::ExecuteResults& results, ResultsEncoder::Format format, unsigned long int* resultSize)
+{
+	if (format == ResultsEncoder::Format::kJson)
+	{
+		char* result = ResultsToJson(results);
+		if (resultSize) *resultSize = static_cast<unsigned long int>(std::strlen(result));
+
+		return result;
+	}
+
+	size_t size = 0;
+	char* result = ResultsEncoder::Encode(results, format, size);
+	if (resultSize) *resultSize = static_cast<unsigned long int>(size);
+
+	return result;
+}
+
+static bool ExecuteSimple(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig, Network::INetwork<>::ExecuteResults& results, ResultsEncoder::Format& format,
+	const std::shared_ptr<const std::atomic<bool>>& cancelled = nullptr)
+{
+	if (!jsonCircuit || !jsonConfig)
+		return false;
+
+	// step 1: Parse the JSON circuit and configuration strings
+	// convert the JSON circuit into a Circuit object
+
+	// I'm unsure here on how it deals with the classical registers, more precisely
+	// with stuff like "other_measure_name" and "meas" (see below)
+	// since in the example it seems to just use the cbit number
+
+	// This is the json format:
+	// {"instructions": 
+	// [{"name": "h", "qubits": [0], "params": []},
+	// {"name": "cx", "qubits": [0, 1], "params": []}, 
+	// {"name": "rx", "qubits": [0], "params": [0.39528385768119634]}, 
+	// {"name": "measure", "qubits": [0], "memory": [0]}], 
+	// 
+	// "num_qubits": 2, "num_clbits": 4, 
+	// "quantum_registers": {"q": [0, 1]}, 
+	// "classical_registers": {"c": [0, 1], "other_measure_name": [2], "meas": [3]}}
+
+	Json::JsonParserMaestro<> jsonParser;
+
+	auto circuit = jsonParser.ParseCircuit(jsonCircuit);
+	
+	// check if the circuit has measurements only at the end
+
+	// the calls using the same simple simulator execute concurrently, each on its own network instance
+	size_t nrShots;
+	const auto lease = CheckoutConfiguredSimulator(simpleSim, jsonConfig, nrShots, &format);
+	if (!lease)
+		return false;
+
+	const auto& network = lease.GetNetwork();
+
+	// the flag is cleared when the instance is returned to the pool
+	if (cancelled)
+		network->SetCancellationFlag(cancelled);
+
+	results = network->RepeatedExecuteOnHost(circuit, 0, nrShots);
+
+	return true;
+}
+
+extern "C" char* SimpleExecute(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig)
+{
+	if (simpleSim == 0 || !maestroInstance)
+		return nullptr;
+
+	Network::INetwork<>::ExecuteResults results;
+	ResultsEncoder::Format format;
+	if (!ExecuteSimple(simpleSim, jsonCircuit, jsonConfig, results, format))
+		return nullptr;
+
+	// the binary encoding needs its size returned, see SimpleExecuteEncoded
+	if (format == ResultsEncoder::Format::kBinary)
+		format = ResultsEncoder::Format::kJson;
+
+	return EncodeResults(results, format, nullptr);
+}
+
+extern "C" char* SimpleExecuteEncoded(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig, unsigned long int* resultSize)
+{
+	if (resultSize) *resultSize = 0;
+
+	if (simpleSim == 0 || !maestroInstance)
+		return nullptr;
+
+	Network::INetwork<>::ExecuteResults results;
+	ResultsEncoder::Format format;
+	if (!ExecuteSimple(simpleSim, jsonCircuit, jsonConfig, results, format))
+		return nullptr;
+
+	return EncodeResults(results, format, resultSize);
+}
+
+extern "C" unsigned long int SubmitExecute(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig)
+{
+	if (simpleSim == 0 || !jsonCircuit || !jsonConfig || !maestroInstance)
+		return 0;
+
+	// copied, the caller can free the strings right after submitting
+	const std::string circuitStr(jsonCircuit);
+	const std::string configStr(jsonConfig);
+
+	return maestroInstance->SubmitJob(simpleSim, [simpleSim, circuitStr, configStr](const std::shared_ptr<const std::atomic<bool>>& cancelled, unsigned long int& resultSize) -> char*
+		{
+			Network::INetwork<>::ExecuteResults results;
+			ResultsEncoder::Format format;
+
+			const bool executed = ExecuteSimple(simpleSim, circuitStr.c_str(), configStr.c_str(), results, format, cancelled);
+
+			// the results of a cancelled execution are partial, they are not encoded
+			if (!executed || cancelled->load())
+				return nullptr;
+
+			return EncodeResults(results, format, &resultSize);
+		});
+}
+
+extern "C" int PollJob(unsigned long int jobHandle)
+{
+	if (jobHandle == 0 || !maestroInstance)
+		return static_cast<int>(AsyncJob::Status::kUnknown);
+
+	const auto job = maestroInstance->GetJob(jobHandle);
+	if (!job)
+		return static_cast<int>(AsyncJob::Status::kUnknown);
+
+	return static_cast<int>(job->GetStatus());
+}
+
+extern "C" char* WaitJob(unsigned long int jobHandle, unsigned long int* resultSize)
+{
+	if (resultSize) *resultSize = 0;
+
+	if (jobHandle == 0 || !maestroInstance)
+		return nullptr;
+
+	const auto job = maestroInstance->GetJob(jobHandle);
+	if (!job)
+		return nullptr;
+
+	char* result = job->Wait(resultSize);
+
+	// the result is taken, the job is not needed anymore
+	maestroInstance->RemoveJob(jobHandle);
+
+	return result;
+}
+
+extern "C" int CancelJob(unsigned long int jobHandle)
+{
+	if (jobHandle == 0 || !maestroInstance)
+		return 0;
+
+	const auto job = maestroInstance->GetJob(jobHandle);
+	if (!job)
+		return 0;
+
+	// the pool keeps the job until it finishes, the handle is released now
+	job->Cancel();
+	maestroInstance->RemoveJob(jobHandle);
+
+	return 1;
+}
+
+extern "C" unsigned long int CreateCircuit(const char* jsonCircuit)
+{
+	if (!jsonCircuit || !maestroInstance)
+		return 0;
+
+	// the gate parameters can be names, the values are specified at each execution
+	Json::JsonParserMaestro<> jsonParser;
+	std::vector<Json::SymbolicParameter> symbols;
+
+	std::shared_ptr<Circuits::Circuit<>> circuit;
+	try
+	{
+		circuit = jsonParser.ParseCircuit(jsonCircuit, &symbols);
+	}
+	catch (const std::exception&)
+	{
+		return 0;
+	}
+
+	if (!circuit)
+		return 0;
+
+	return maestroInstance->CreateCircuit(std::make_shared<PreparedCircuit>(circuit, symbols));
+}
+
+extern "C" void DestroyCircuit(unsigned long int circuitHandle)
+{
+	if (!maestroInstance || circuitHandle == 0)
+		return;
+
+	maestroInstance->DestroyCircuit(circuitHandle);
+}
+
+extern "C" unsigned long int GetCircuitNumberOfParameters(unsigned long int circuitHandle)
+{
+	if (!maestroInstance || circuitHandle == 0)
+		return 0;
+
+	const auto circuit = maestroInstance->GetCircuit(circuitHandle);
+	if (!circuit)
+		return 0;
+
+	return static_cast<unsigned long int>(circuit->GetNumParameters());
+}
+
+extern "C" char* GetCircuitParameterName(unsigned long int circuitHandle, unsigned long int index)
+{
+	if (!maestroInstance || circuitHandle == 0)
+		return nullptr;
+
+	const auto circuit = maestroInstance->GetCircuit(circuitHandle);
+	if (!circuit || index >= circuit->GetNumParameters())
+		return nullptr;
+
+	const std::string& name = circuit->GetParameterName(index);
+
+	char* result = new char[name.length() + 1];
+	std::copy(name.c_str(), name.c_str() + name.length(), result);
+	result[name.length()] = 0; // ensure null-termination
+
+	return result;
+}
+
+extern "C" char* SimpleExecuteCircuit(unsigned long int simpleSim, unsigned long int circuitHandle, const double* params, unsigned long int nrParams, const char* jsonConfig)
+{
+	if (simpleSim == 0 || circuitHandle == 0 || !jsonConfig || !maestroInstance)
+		return nullptr;
+
+	const auto circuit = maestroInstance->GetCircuit(circuitHandle);
+	if (!circuit || nrParams < circuit->GetNumParameters())
+		return nullptr;
+
+	size_t nrShots;
+	ResultsEncoder::Format format;
+	const auto lease = CheckoutConfiguredSimulator(simpleSim, jsonConfig, nrShots, &format);
+	if (!lease)
+		return nullptr;
+
+	const auto& network = lease.GetNetwork();
+
+	// the circuit is mapped on the host only at the first execution on this network instance, then only the parameters are changed
+	auto results = circuit->Execute(simpleSim, network, params, nrParams, nrShots);
+
+	return EncodeResults(results, format == ResultsEncoder::Format::kHexJson ? format : ResultsEncoder::Format::kJson, nullptr);
+}
+
+extern "C" char* SimpleExecuteCircuitSweep(unsigned long int simpleSim, unsigned long int circuitHandle, const double* params, unsigned long int nrPoints, unsigned long int nrParams, const char* jsonConfig)
+{
+	if (simpleSim == 0 || circuitHandle == 0 || !jsonConfig || !maestroInstance)
+		return nullptr;
+
+	const auto circuit = maestroInstance->GetCircuit(circuitHandle);
+	if (!circuit || nrParams < circuit->GetNumParameters())
+		return nullptr;
+
+	size_t nrShots;
+	ResultsEncoder::Format format;
+	const auto lease = CheckoutConfiguredSimulator(simpleSim, jsonConfig, nrShots, &format);
+	if (!lease)
+		return nullptr;
+
+	const auto& network = lease.GetNetwork();
+
+	// the points are spread over the execution threads, the results are in the order of the points
+	const auto results = circuit->ExecuteSweep(network, params, nrPoints, nrParams, nrShots);
+	if (results.size() != nrPoints)
+		return nullptr;
+
+	if (format == ResultsEncoder::Format::kHexJson)
+	{
+		// the brackets and the commas between the points
+		size_t size = nrPoints ? nrPoints + 1 : 2;
+		for (const auto& pointResults : results)
+			size += ResultsEncoder::GetHexJsonSize(pointResults);
+
+		char* result = new char[size + 1];
+		char* out = result;
+
+		*out++ = '[';
+		for (size_t i = 0; i < nrPoints; ++i)
+		{
+			if (i) *out++ = ',';
+			out = ResultsEncoder::WriteHexJson(results[i], out);
+		}
+		*out++ = ']';
+		*out = 0;
+
+		return result;
+	}
+
+	boost::json::array response;
+	for (const auto& pointResults : results)
+		response.emplace_back(CountsToJson(pointResults));
+
+	return JsonToResult(response);
+}
+
 extern "C" void FreeResult(char* result)
 {
 	if (result)
@@ -23,8 +23,23 @@ extern "C" {
 	int AddOptimizationSimulator(unsigned long int simHandle, int simType, int simExecType);
 
 	char* SimpleExecute(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig);
+	char* SimpleExecuteEncoded(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig, unsigned long int* resultSize);
+
+	// asynchronous execution, the result of WaitJob is encoded as for SimpleExecuteEncoded and freed with FreeResult
+	// PollJob returns 0 for an unknown job, 1 queued, 2 running, 3 done, 4 failed, 5 cancelled
+	unsigned long int SubmitExecute(unsigned long int simpleSim, const char* jsonCircuit, const char* jsonConfig);
+	int PollJob(unsigned long int jobHandle);
+	char* WaitJob(unsigned long int jobHandle, unsigned long int* resultSize);
+	int CancelJob(unsigned long int jobHandle);
 	void FreeResult(char* result);
 
+	unsigned long int CreateCircuit(const char* jsonCircuit);
+	void DestroyCircuit(unsigned long int circuitHandle);
+	unsigned long int GetCircuitNumberOfParameters(unsigned long int circuitHandle);
+	char* GetCircuitParameterName(unsigned long int circuitHandle, unsigned long int index);
+	char* SimpleExecuteCircuit(unsigned long int simpleSim, unsigned long int circuitHandle, const double* params, unsigned long int nrParams, const char* jsonConfig);
+	char* SimpleExecuteCircuitSweep(unsigned long int simpleSim, unsigned long int circuitHandle, const double* params, unsigned long int nrPoints, unsigned long int nrParams, const char* jsonConfig);
+
 	unsigned long int CreateSimulator(int simType, int simExecType);
 	void* GetSimulator(unsigned long int simHandle);
 	void DestroySimulator(unsigned long int simHandle);
@@ -23,6 +23,16 @@
 
 namespace Json {
 
+	/**
+	 * @struct SymbolicParameter
+	 * @brief A gate parameter given by name in the json circuit, to be bound to a value before each execution.
+	 */
+	struct SymbolicParameter {
+		size_t operationIndex = 0; /**< The index of the operation in the parsed circuit */
+		size_t paramIndex = 0; /**< The position of the parameter in the gate parameters */
+		std::string name; /**< The name of the parameter */
+	};
+
 	template<typename Time = Types::time_type> class JsonParserMaestro {
 	public:
 		/**
@@ -42,7 +52,18 @@ namespace Json {
 		}
 
 
-		std::shared_ptr<Circuits::Circuit<Time>> ParseCircuit(const char* str) const
+		/**
+		 * @brief Parses a circuit.
+		 *
+		 * The gate parameters must be numbers, unless the symbolic parameters are requested.
+		 * In that case a parameter can also be a string, the name of a parameter whose value is set later,
+		 * the gate is created with a zero value for it.
+		 *
+		 * @param str The string containing the json circuit.
+		 * @param symbols If not null, receives the symbolic parameters of the gates.
+		 * @return A shared pointer to the parsed circuit, null if the json is not an array.
+		 */
+		std::shared_ptr<Circuits::Circuit<Time>> ParseCircuit(const char* str, std::vector<SymbolicParameter>* symbols = nullptr) const
 		{
 			const boost::json::value circuitJson = ParseString(str);
 
@@ -52,7 +73,7 @@ namespace Json {
 			std::shared_ptr<Circuits::Circuit<Time>> circuit;
 
 			const auto circuitArray = circuitJson.as_array();
-			circuit = ParseCircuitArray(circuitArray);
+			circuit = ParseCircuitArray(circuitArray, symbols);
 
 			return circuit;
 		}
@@ -95,10 +116,11 @@ namespace Json {
 		 * Parses a circuit json array.
 		 *
 		 * @param circuitArray The json array to parse.
+		 * @param symbols If not null, receives the symbolic parameters of the gates.
 		 * @return A shared pointer to the parsed circuit.
 		 * @sa Circuits::Circuit
 		 */
-		std::shared_ptr<Circuits::Circuit<Time>> ParseCircuitArray(const boost::json::array& circuitArray) const
+		std::shared_ptr<Circuits::Circuit<Time>> ParseCircuitArray(const boost::json::array& circuitArray, std::vector<SymbolicParameter>* symbols) const
 		{
 			const auto circuit = std::make_shared<Circuits::Circuit<Time>>();
 
@@ -116,7 +138,14 @@ namespace Json {
 				const boost::json::string type = operationObject.at(nameString).as_string();
 
 				if (type != "id")
-					circuit->AddOperation(ParseOperation(type, operationObject));
+				{
+					const size_t firstSymbol = symbols ? symbols->size() : 0;
+					circuit->AddOperation(ParseOperation(type, operationObject, symbols));
+
+					if (symbols)
+						for (size_t i = firstSymbol; i < symbols->size(); ++i)
+							(*symbols)[i].operationIndex = circuit->GetOperations().size() - 1;
+				}
 			}
 
 			return circuit;
@@ -129,17 +158,18 @@ namespace Json {
 		 *
 		 * @param type The type of operation to parse.
 		 * @param obj The json object to parse.
+		 * @param symbols If not null, receives the symbolic parameters of the gate.
 		 * @return A shared pointer to the parsed operation.
 		 * @sa Circuits::IOperation
 		 */
-		std::shared_ptr<Circuits::IOperation<Time>> ParseOperation(const boost::json::string& type, boost::json::object& obj) const
+		std::shared_ptr<Circuits::IOperation<Time>> ParseOperation(const boost::json::string& type, boost::json::object& obj, std::vector<SymbolicParameter>* symbols) const
 		{
 			std::shared_ptr<Circuits::IOperation<Time>> operation;
 
 			if (type == measurementString)
 				operation = ParseMeasurement(obj); 
 			else
-				operation = ParseGate(type, obj);
+				operation = ParseGate(type, obj, symbols);
 
 			return operation;
 		}
@@ -178,10 +208,11 @@ namespace Json {
 		 * Parses a gate operation.
 		 *
 		 * @param obj The json object to parse.
+		 * @param symbols If not null, receives the symbolic parameters of the gate.
 		 * @return A shared pointer to the parsed gate.
 		 * @sa Circuits::IGateOperation
 		 */
-		std::shared_ptr<Circuits::IOperation<Time>> ParseGate(const boost::json::string& type, boost::json::object& obj) const
+		std::shared_ptr<Circuits::IOperation<Time>> ParseGate(const boost::json::string& type, boost::json::object& obj, std::vector<SymbolicParameter>* symbols) const
 		{
 			const std::string gateName = type.c_str();
 			
@@ -199,7 +230,7 @@ namespace Json {
 			gateType = gatesMap.at(gateName);
 
 			// parse gate parameters
-			const auto parameters = ParseParameters(obj);
+			const auto parameters = ParseParameters(obj, symbols);
 
 			const auto operation = Circuits::CircuitFactory<Time>::CreateGate(gateType, qubits[0], qubits.size() > 1 ? qubits[1] : 0, qubits.size() > 2 ? qubits[2] : 0,
 				parameters.size() > 0 ? parameters[0] : 0., parameters.size() > 1 ? parameters[1] : 0., parameters.size() > 2 ? parameters[2] : 0., parameters.size() > 3 ? parameters[3] : 0.);
@@ -248,9 +279,10 @@ namespace Json {
 		 * Parses quantum gate parameters from a json object.
 		 *
 		 * @param obj The json object to parse.
+		 * @param symbols If not null, receives the parameters given by name, their values are set to zero.
 		 * @return A vector containing the parsed parameters.
 		 */
-		std::vector<double> ParseParameters(boost::json::object& obj) const
+		std::vector<double> ParseParameters(boost::json::object& obj, std::vector<SymbolicParameter>* symbols) const
 		{
 			std::vector<double> parameters;
 
@@ -260,7 +292,16 @@ namespace Json {
 			auto paramsJson = (obj.contains(paramsString) ? obj.at(paramsString).as_array() : boost::json::array());
 			for (auto param : paramsJson)
 			{
-				if (!param.is_number())
+				if (symbols && param.is_string())
+				{
+					SymbolicParameter symbol;
+					symbol.paramIndex = parameters.size();
+					symbol.name = param.as_string().c_str();
+					symbols->emplace_back(std::move(symbol));
+
+					parameters.push_back(0.);
+				}
+				else if (!param.is_number())
 					throw std::runtime_error("Parameter must be a number.");
 				else if (param.is_double())
 					parameters.push_back(param.as_double());
@@ -15,6 +15,13 @@
 #endif
 
 #include "../Simulators/Factory.h"
+#include "PreparedCircuit.h"
+#include "AsyncJob.h"
+#include "SimpleSimulatorPool.h"
+
+#include "../Utils/ThreadsPool.h"
+
+#include <thread>
 
 class Maestro
 {
@@ -48,46 +55,84 @@ public:
 		}
 		const unsigned long int handle = ++curHandle;
 		
-		simpleSimulators[handle] = network;
+		// the requests execute on instances checked out from the pool, so they can execute concurrently
+		simpleSimulators[handle] = std::make_shared<SimpleSimulatorPool>(network, std::max(std::thread::hardware_concurrency(), 1U));
 
 		return handle;
 	}
 
 	void DestroySimpleSimulator(unsigned long int simHandle)
 	{
-		std::lock_guard<std::mutex> lock(simpleSimulatorsMutex);
+		{
+			std::lock_guard<std::mutex> lock(simpleSimulatorsMutex);
 
-		simpleSimulators.erase(simHandle);
+			simpleSimulators.erase(simHandle);
+		}
+
+		// the circuits prepared for it are not needed anymore
+		std::lock_guard<std::mutex> lock(circuitsMutex);
+		for (auto& [handle, circuit] : circuits)
+			circuit->Forget(simHandle);
 	}
 
+	/**
+	 * @brief Get the network keeping the settings of the simple simulator.
+	 *
+	 * The requests do not execute on it, use CheckoutSimpleSimulator for executing.
+	 *
+	 * @param simHandle The handle of the simple simulator.
+	 * @return The network, nullptr if the simple simulator does not exist.
+	 */
 	std::shared_ptr<Network::INetwork<>> GetSimpleSimulator(unsigned long int simHandle)
 	{
-		std::lock_guard<std::mutex> lock(simpleSimulatorsMutex);
-		auto it = simpleSimulators.find(simHandle);
-		if (it != simpleSimulators.end())
-			return it->second;
+		const auto pool = GetSimpleSimulatorPool(simHandle);
+		if (pool)
+			return pool->GetPrototype();
 
 		return nullptr;
 	}
 
+	/**
+	 * @brief Check out a network instance of the simple simulator, for executing a request.
+	 *
+	 * @param simHandle The handle of the simple simulator.
+	 * @param configuration The configuration the request applies to the instance, empty if none.
+	 * @return The lease of the instance, empty if the simple simulator does not exist.
+	 * @sa SimpleSimulatorPool::Checkout
+	 */
+	SimpleSimulatorPool::Lease CheckoutSimpleSimulator(unsigned long int simHandle, const std::string& configuration = std::string())
+	{
+		const auto pool = GetSimpleSimulatorPool(simHandle);
+		if (pool)
+			return pool->Checkout(configuration);
+
+		return {};
+	}
+
 
 	int RemoveAllOptimizationSimulatorsAndAdd(unsigned long int simHandle, Simulators::SimulatorType simType, Simulators::SimulationType simExecType)
 	{
-		auto sim = GetSimpleSimulator(simHandle);
-		if (!sim)
+		auto pool = GetSimpleSimulatorPool(simHandle);
+		if (!pool)
 			return 0;
 
-		sim->RemoveAllOptimizationSimulatorsAndAdd(simType, simExecType);
+		pool->ChangeSettings([simType, simExecType](const std::shared_ptr<Network::INetwork<>>& sim)
+			{
+				sim->RemoveAllOptimizationSimulatorsAndAdd(simType, simExecType);
+			});
 
 		return 1;
 	}
 
 	int AddOptimizationSimulator(unsigned long int simHandle, Simulators::SimulatorType simType, Simulators::SimulationType simExecType)
 	{
-		auto sim = GetSimpleSimulator(simHandle);
-		if (!sim)
+		auto pool = GetSimpleSimulatorPool(simHandle);
+		if (!pool)
 			return 0;
-		sim->AddOptimizationSimulator(simType, simExecType);
+		pool->ChangeSettings([simType, simExecType](const std::shared_ptr<Network::INetwork<>>& sim)
+			{
+				sim->AddOptimizationSimulator(simType, simExecType);
+			});
 		return 1;
 	}
 
@@ -124,14 +169,115 @@ public:
 		simulators.erase(simHandle);
 	}
 
+	unsigned long int CreateCircuit(const std::shared_ptr<PreparedCircuit>& circuit)
+	{
+		std::lock_guard<std::mutex> lock(circuitsMutex);
+		if (curCircuitHandle == std::numeric_limits<unsigned long int>::max())
+		{
+			// Handle overflow, reset to 0
+			curCircuitHandle = 0;
+		}
+		const unsigned long int handle = ++curCircuitHandle;
+
+		circuits[handle] = circuit;
+
+		return handle;
+	}
+
+	std::shared_ptr<PreparedCircuit> GetCircuit(unsigned long int circuitHandle)
+	{
+		std::lock_guard<std::mutex> lock(circuitsMutex);
+		auto it = circuits.find(circuitHandle);
+		if (it != circuits.end())
+			return it->second;
+
+		return nullptr;
+	}
+
+	void DestroyCircuit(unsigned long int circuitHandle)
+	{
+		std::lock_guard<std::mutex> lock(circuitsMutex);
+		circuits.erase(circuitHandle);
+	}
+
+	/**
+	 * @brief Submit a job to be executed on the jobs pool.
+	 *
+	 * The jobs execute concurrently, each on its own instance of the simple simulator.
+	 *
+	 * @param simHandle The handle of the simple simulator the job executes on.
+	 * @param work The work of the job.
+	 * @return The handle of the job, 0 if the simple simulator does not exist.
+	 */
+	unsigned long int SubmitJob(unsigned long int simHandle, AsyncJob::Work work)
+	{
+		if (!GetSimpleSimulatorPool(simHandle))
+			return 0;
+
+		auto job = std::make_shared<AsyncJob>(std::move(work));
+
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		if (curJobHandle == std::numeric_limits<unsigned long int>::max())
+		{
+			// Handle overflow, reset to 0
+			curJobHandle = 0;
+		}
+		const unsigned long int handle = ++curJobHandle;
+
+		jobs[handle] = job;
+
+		// the threads are created at the first submission, in the process-wide pool, which is never destroyed
+		// (joining its threads at library unload would deadlock under the loader lock, and they could still be running jobs)
+		Utils::ThreadsPool<AsyncJob>::GetSharedPool(std::max(std::thread::hardware_concurrency(), 2U)).AddRunJob(job);
+
+		return handle;
+	}
+
+	std::shared_ptr<AsyncJob> GetJob(unsigned long int jobHandle)
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		auto it = jobs.find(jobHandle);
+		if (it != jobs.end())
+			return it->second;
+
+		return nullptr;
+	}
+
+	/**
+	 * @brief Remove the job, its result is freed when it finishes if not taken.
+	 *
+	 * @param jobHandle The handle of the job.
+	 */
+	void RemoveJob(unsigned long int jobHandle)
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		jobs.erase(jobHandle);
+	}
+
 private:
+	std::shared_ptr<SimpleSimulatorPool> GetSimpleSimulatorPool(unsigned long int simHandle)
+	{
+		std::lock_guard<std::mutex> lock(simpleSimulatorsMutex);
+		auto it = simpleSimulators.find(simHandle);
+		if (it != simpleSimulators.end())
+			return it->second;
+
+		return nullptr;
+	}
+
 	// allow multithreaded access
 	std::mutex simpleSimulatorsMutex;
 	std::mutex simulatorsMutex;
+	std::mutex circuitsMutex;
+	std::mutex jobsMutex;
 
-	std::unordered_map<unsigned long int, std::shared_ptr<Network::INetwork<>>> simpleSimulators; // map for network simulators
+	std::unordered_map<unsigned long int, std::shared_ptr<SimpleSimulatorPool>> simpleSimulators; // map for network simulators, with their instances
 	std::unordered_map<unsigned long int, std::shared_ptr<Simulators::ISimulator>> simulators; // map for simulators
+	std::unordered_map<unsigned long int, std::shared_ptr<PreparedCircuit>> circuits; // map for the parsed circuits
+	std::unordered_map<unsigned long int, std::shared_ptr<AsyncJob>> jobs; // map for the submitted jobs
 	
 	unsigned long int curHandle = 0;
 	unsigned long int curSimulatorHandle = 0; // current handle for simulators
+	unsigned long int curCircuitHandle = 0; // current handle for circuits
+	unsigned long int curJobHandle = 0; // current handle for jobs
 };
@@ -0,0 +1,188 @@
+/**
+ * @file PreparedCircuit.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ * A circuit parsed once, for executing it many times with different parameters values.
+ */
+
+#pragma once
+
+#ifndef _PREPARED_CIRCUIT_H_
+#define _PREPARED_CIRCUIT_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Json.h"
+#include "../Circuit/Parameters.h"
+
+/**
+ * @class PreparedCircuit
+ * @brief A circuit parsed once, with its gate parameters given by name bound to values before each execution.
+ *
+ * The parameters are numbered in the order of their first appearance in the json circuit.
+ * For each network instance the circuit is executed on, the circuit mapped on the host is kept,
+ * together with the gates that have parameters bound to values, so an execution only changes the gates parameters.
+ * Circuits with parameters are not optimized, as merging gates would lose the positions of the parameters.
+ * A network instance executes a single request at a time, so the executions on different instances of a simple simulator
+ * run concurrently, each changing the parameters of its own copy of the gates.
+ */
+class PreparedCircuit
+{
+public:
+	PreparedCircuit(const std::shared_ptr<Circuits::Circuit<>>& circ, const std::vector<Json::SymbolicParameter>& symbols)
+		: circuit(circ)
+	{
+		std::unordered_map<std::string, size_t> indices;
+
+		for (const auto& symbol : symbols)
+		{
+			auto it = indices.find(symbol.name);
+			if (it == indices.end())
+			{
+				it = indices.emplace(symbol.name, names.size()).first;
+				names.push_back(symbol.name);
+			}
+
+			bindings.push_back({ symbol.operationIndex, symbol.paramIndex, it->second });
+		}
+	}
+
+	size_t GetNumParameters() const
+	{
+		return names.size();
+	}
+
+	const std::string& GetParameterName(size_t index) const
+	{
+		return names[index];
+	}
+
+	/**
+	 * @brief Execute the circuit on a simple simulator, with the specified parameters values.
+	 *
+	 * The circuit is prepared for the network instance at the first execution on it.
+	 *
+	 * @param simHandle The handle of the simple simulator the network instance belongs to.
+	 * @param network The network instance of the simple simulator to execute on, checked out for this call only.
+	 * @param params The parameters values, at least GetNumParameters of them.
+	 * @param nrParams The number of values.
+	 * @param shots The number of shots.
+	 * @return The results of the execution, empty if not enough parameters values are specified.
+	 */
+	Network::INetwork<>::ExecuteResults Execute(unsigned long int simHandle, const std::shared_ptr<Network::INetwork<>>& network, const double* params, size_t nrParams, size_t shots)
+	{
+		if (nrParams < names.size() || (nrParams && !params)) return {};
+
+		std::shared_ptr<PreparedForNetwork> prepared;
+
+		{
+			std::lock_guard<std::mutex> lock(preparedMutex);
+
+			// drop the instances that are gone, the address of one of them might be reused by a new instance
+			for (auto it = preparedForNetworks.begin(); it != preparedForNetworks.end();)
+			{
+				if (it->second->network.expired())
+					it = preparedForNetworks.erase(it);
+				else
+					++it;
+			}
+
+			auto& entry = preparedForNetworks[network.get()];
+			if (!entry)
+			{
+				entry = std::make_shared<PreparedForNetwork>();
+				entry->network = network;
+				entry->simHandle = simHandle;
+			}
+
+			prepared = entry;
+		}
+
+		// the instance is checked out by this call, so nothing else uses its prepared circuit, the lock is not needed
+		if (!prepared->prepared)
+		{
+			auto preparedCircuit = network->PrepareCircuitOnHost(circuit, 0, bindings.empty());
+			if (!preparedCircuit->circuit)
+			{
+				std::lock_guard<std::mutex> lock(preparedMutex);
+				preparedForNetworks.erase(network.get());
+
+				return {};
+			}
+
+			// right after preparing, the operations are still in the same order as in the parsed circuit
+			prepared->binder = std::make_unique<Circuits::ParametersBinder<>>(preparedCircuit->circuit->GetOperations(), bindings);
+			prepared->prepared = std::move(preparedCircuit);
+		}
+
+		prepared->binder->Bind(params);
+
+		return network->RepeatedExecutePrepared(*prepared->prepared, shots);
+	}
+
+	/**
+	 * @brief Execute the circuit on a simple simulator, for each of the parameters points.
+	 *
+	 * The parsed circuit is only copied, not changed, so the prepared circuits are not needed.
+	 *
+	 * @param network The simple simulator.
+	 * @param params The parameters values, nrPoints rows of nrParams values each.
+	 * @param nrPoints The number of points.
+	 * @param nrParams The number of values for each point.
+	 * @param shots The number of shots for each point.
+	 * @return The results of the execution for each point, empty if not enough parameters values are specified.
+	 */
+	std::vector<Network::INetwork<>::ExecuteResults> ExecuteSweep(const std::shared_ptr<Network::INetwork<>>& network, const double* params, size_t nrPoints, size_t nrParams, size_t shots) const
+	{
+		if (nrParams < names.size() || (nrPoints && nrParams && !params)) return {};
+
+		std::vector<std::vector<double>> points(nrPoints);
+		for (size_t i = 0; i < nrPoints; ++i)
+			points[i].assign(params + i * nrParams, params + (i + 1) * nrParams);
+
+		return network->RepeatedExecuteSweepOnHost(circuit, bindings, points, 0, shots);
+	}
+
+	/**
+	 * @brief Forget the circuits prepared for the network instances of a simple simulator.
+	 *
+	 * @param simHandle The handle of the simple simulator.
+	 */
+	void Forget(unsigned long int simHandle)
+	{
+		std::lock_guard<std::mutex> lock(preparedMutex);
+
+		for (auto it = preparedForNetworks.begin(); it != preparedForNetworks.end();)
+		{
+			if (it->second->simHandle == simHandle)
+				it = preparedForNetworks.erase(it);
+			else
+				++it;
+		}
+	}
+
+private:
+	/**
+	 * @brief The circuit prepared for a network instance.
+	 */
+	struct PreparedForNetwork {
+		std::weak_ptr<Network::INetwork<>> network; /**< The network instance, for telling it apart from a later one at the same address */
+		unsigned long int simHandle = 0; /**< The simple simulator the network instance belongs to */
+		std::shared_ptr<Network::PreparedHostCircuit<>> prepared; /**< The prepared circuit */
+		std::unique_ptr<Circuits::ParametersBinder<>> binder; /**< Sets the parameters of the gates in the prepared circuit */
+	};
+
+	std::shared_ptr<Circuits::Circuit<>> circuit; /**< The parsed circuit */
+	std::vector<std::string> names; /**< The names of the parameters */
+	std::vector<Circuits::ParameterBinding> bindings; /**< The gate parameters bound to circuit parameters */
+
+	std::mutex preparedMutex;
+	std::unordered_map<const Network::INetwork<>*, std::shared_ptr<PreparedForNetwork>> preparedForNetworks; /**< The circuit prepared for each network instance it was executed on */
+};
+
+#endif // _PREPARED_CIRCUIT_H_
@@ -0,0 +1,255 @@
+/**
+ * @file ResultsEncoder.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ * Compact encodings of the execution results, written directly into the result buffer.
+ */
+
+#pragma once
+
+#ifndef _RESULTS_ENCODER_H_
+#define _RESULTS_ENCODER_H_
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../Network/Network.h"
+
+/**
+ * @class ResultsEncoder
+ * @brief Encodes the counts of the execution results, without building intermediate strings or json objects.
+ *
+ * The size of the encoding is computed first, so the buffer is allocated once, then the encoding is written directly into it.
+ *
+ * The hex json encoding is {"counts":{"0x...":count,...}}, where the classical bit 0 is the least significant bit of the key, as in qiskit.
+ *
+ * The binary encoding is made of 64 bit unsigned integers, in the native byte order:
+ * the number of classical bits, the number of words of an outcome, the number of outcomes,
+ * then for each outcome its words (bit i is the classical bit 64 * word + i) followed by its count.
+ */
+class ResultsEncoder
+{
+public:
+	using ExecuteResults = Network::INetwork<>::ExecuteResults;
+
+	/**
+	 * @brief The format of the results returned by the execution functions.
+	 */
+	enum class Format {
+		kJson, /**< The default json, with the keys being the classical bits as '0'/'1' characters, classical bit 0 first */
+		kHexJson, /**< Json with hex keys */
+		kBinary /**< Packed binary */
+	};
+
+	/**
+	 * @brief Get the format from its name in the configuration.
+	 *
+	 * @param name The name: "json", "hex" or "binary".
+	 * @return The format, the default json for an empty or unknown name.
+	 */
+	static Format GetFormat(const std::string& name)
+	{
+		if (name == "hex")
+			return Format::kHexJson;
+		else if (name == "binary")
+			return Format::kBinary;
+
+		return Format::kJson;
+	}
+
+	/**
+	 * @brief Get the size of the hex json encoding, without the null terminator.
+	 *
+	 * @param results The results.
+	 * @return The size in bytes.
+	 */
+	static size_t GetHexJsonSize(const ExecuteResults& results)
+	{
+		// {"counts":{}}
+		size_t size = 13;
+
+		for (const auto& [bits, cnt] : results)
+			size += GetHexDigits(bits) + GetDecimalDigits(cnt) + 6; // "0x":, and the comma (one too many for the last one)
+
+		if (!results.empty()) --size;
+
+		return size;
+	}
+
+	/**
+	 * @brief Write the hex json encoding.
+	 *
+	 * @param results The results.
+	 * @param out The buffer, at least GetHexJsonSize bytes.
+	 * @return The position after the written encoding.
+	 */
+	static char* WriteHexJson(const ExecuteResults& results, char* out)
+	{
+		out = Append(out, "{\"counts\":{");
+
+		bool first = true;
+		for (const auto& [bits, cnt] : results)
+		{
+			if (!first) *out++ = ',';
+			first = false;
+
+			out = Append(out, "\"0x");
+			for (size_t digit = GetHexDigits(bits); digit > 0; --digit)
+				*out++ = "0123456789abcdef"[GetNibble(bits, digit - 1)];
+			out = Append(out, "\":");
+
+			out = std::to_chars(out, out + 20, cnt).ptr;
+		}
+
+		return Append(out, "}}");
+	}
+
+	/**
+	 * @brief Get the size of the binary encoding.
+	 *
+	 * @param results The results.
+	 * @return The size in bytes.
+	 */
+	static size_t GetBinarySize(const ExecuteResults& results)
+	{
+		return sizeof(uint64_t) * (3 + results.size() * (GetNumWords(GetNumBits(results)) + 1));
+	}
+
+	/**
+	 * @brief Write the binary encoding.
+	 *
+	 * @param results The results.
+	 * @param out The buffer, at least GetBinarySize bytes.
+	 * @return The position after the written encoding.
+	 */
+	static char* WriteBinary(const ExecuteResults& results, char* out)
+	{
+		const size_t nrBits = GetNumBits(results);
+		const size_t nrWords = GetNumWords(nrBits);
+
+		out = AppendWord(out, nrBits);
+		out = AppendWord(out, nrWords);
+		out = AppendWord(out, results.size());
+
+		for (const auto& [bits, cnt] : results)
+		{
+			for (size_t w = 0; w < nrWords; ++w)
+			{
+				uint64_t word = 0;
+
+				const size_t start = w * 64;
+				const size_t end = std::min(start + 64, bits.size());
+				for (size_t b = start; b < end; ++b)
+					if (bits[b]) word |= 1ULL << (b - start);
+
+				out = AppendWord(out, word);
+			}
+
+			out = AppendWord(out, cnt);
+		}
+
+		return out;
+	}
+
+	/**
+	 * @brief Encode the results into a newly allocated buffer.
+	 *
+	 * The json encodings are null terminated, the terminator is not included in the size.
+	 *
+	 * @param results The results.
+	 * @param format The format, either hex json or binary.
+	 * @param size Receives the size of the encoding.
+	 * @return The buffer, to be freed with delete[].
+	 */
+	static char* Encode(const ExecuteResults& results, Format format, size_t& size)
+	{
+		char* buffer;
+
+		if (format == Format::kBinary)
+		{
+			size = GetBinarySize(results);
+			buffer = new char[size];
+			WriteBinary(results, buffer);
+		}
+		else
+		{
+			size = GetHexJsonSize(results);
+			buffer = new char[size + 1];
+			WriteHexJson(results, buffer)[0] = 0;
+		}
+
+		return buffer;
+	}
+
+private:
+	static size_t GetNumBits(const ExecuteResults& results)
+	{
+		size_t nrBits = 0;
+		for (const auto& result : results)
+			nrBits = std::max(nrBits, result.first.size());
+
+		return nrBits;
+	}
+
+	static size_t GetNumWords(size_t nrBits)
+	{
+		return (nrBits + 63) / 64;
+	}
+
+	static unsigned int GetNibble(const std::vector<bool>& bits, size_t nibble)
+	{
+		unsigned int value = 0;
+
+		const size_t start = nibble * 4;
+		const size_t end = std::min(start + 4, bits.size());
+		for (size_t b = start; b < end; ++b)
+			if (bits[b]) value |= 1U << (b - start);
+
+		return value;
+	}
+
+	/**
+	 * @brief Get the number of significant hex digits, at least one.
+	 */
+	static size_t GetHexDigits(const std::vector<bool>& bits)
+	{
+		size_t last = bits.size();
+		while (last > 0 && !bits[last - 1]) --last;
+
+		return last == 0 ? 1 : (last + 3) / 4;
+	}
+
+	static size_t GetDecimalDigits(size_t value)
+	{
+		size_t digits = 1;
+		while (value >= 10)
+		{
+			value /= 10;
+			++digits;
+		}
+
+		return digits;
+	}
+
+	static char* Append(char* out, const char* str)
+	{
+		const size_t len = std::strlen(str);
+		std::memcpy(out, str, len);
+
+		return out + len;
+	}
+
+	static char* AppendWord(char* out, uint64_t word)
+	{
+		std::memcpy(out, &word, sizeof(word));
+
+		return out + sizeof(word);
+	}
+};
+
+#endif // _RESULTS_ENCODER_H_
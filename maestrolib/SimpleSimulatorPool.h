@@ -0,0 +1,213 @@
+/**
+ * @file SimpleSimulatorPool.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ * The instances of a simple simulator, checked out by the requests executing on it.
+ */
+
+#pragma once
+
+#ifndef _SIMPLE_SIMULATOR_POOL_H_
+#define _SIMPLE_SIMULATOR_POOL_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Network/Network.h"
+
+/**
+ * @class SimpleSimulatorPool
+ * @brief The network instances of a simple simulator handle, one checked out for each request.
+ *
+ * A network keeps the state of the execution (the distributed circuit, the simulator, the configuration), so it cannot execute concurrent requests.
+ * Each request checks out its own instance, which is returned to the pool afterwards, keeping its simulator for the next request.
+ * The settings of the handle are kept by a prototype network that is never executed on, the instances are created from it.
+ * The requests can configure their instance further (the simulator options in the execution configuration), the idle instances
+ * are kept by that configuration, so a request gets an instance already configured as it needs, with its prepared circuits.
+ * Changing the settings drops the idle instances, the ones checked out are dropped when returned.
+ */
+class SimpleSimulatorPool : public std::enable_shared_from_this<SimpleSimulatorPool>
+{
+public:
+	/**
+	 * @class Lease
+	 * @brief A network instance checked out from the pool, returned when the lease is destroyed.
+	 */
+	class Lease
+	{
+	public:
+		Lease() = default;
+
+		Lease(const std::shared_ptr<SimpleSimulatorPool>& p, const std::shared_ptr<Network::INetwork<>>& n, const std::string& config, size_t gen, bool isNew)
+			: pool(p), network(n), configuration(config), generation(gen), created(isNew)
+		{
+		}
+
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+		Lease(Lease&& other) noexcept
+			: pool(std::move(other.pool)), network(std::move(other.network)), configuration(std::move(other.configuration)), generation(other.generation), created(other.created)
+		{
+		}
+
+		Lease& operator=(Lease&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Release();
+
+				pool = std::move(other.pool);
+				network = std::move(other.network);
+				configuration = std::move(other.configuration);
+				generation = other.generation;
+				created = other.created;
+			}
+
+			return *this;
+		}
+
+		~Lease()
+		{
+			Release();
+		}
+
+		const std::shared_ptr<Network::INetwork<>>& GetNetwork() const
+		{
+			return network;
+		}
+
+		explicit operator bool() const
+		{
+			return network != nullptr;
+		}
+
+		/**
+		 * @brief Check if the instance was created for this lease.
+		 *
+		 * A new instance has only the settings of the prototype, the request must apply its configuration to it.
+		 * A reused one was already configured by a previous request with the same configuration.
+		 *
+		 * @return True if the instance is new, false if it was reused.
+		 */
+		bool IsNew() const
+		{
+			return created;
+		}
+
+	private:
+		void Release()
+		{
+			if (pool && network)
+				pool->Return(network, configuration, generation);
+
+			pool.reset();
+			network.reset();
+		}
+
+		std::shared_ptr<SimpleSimulatorPool> pool;
+		std::shared_ptr<Network::INetwork<>> network;
+		std::string configuration;
+		size_t generation = 0;
+		bool created = false;
+	};
+
+	/**
+	 * @brief Construct the pool.
+	 *
+	 * @param proto The network keeping the settings, the instances are clones of it.
+	 * @param maxIdleInstances The maximum number of instances kept in the pool between requests, for all the configurations.
+	 */
+	SimpleSimulatorPool(const std::shared_ptr<Network::INetwork<>>& proto, size_t maxIdleInstances)
+		: prototype(proto), maxIdle(maxIdleInstances)
+	{
+	}
+
+	/**
+	 * @brief Check out a network instance for a request.
+	 *
+	 * An idle instance with the same configuration is reused if there is one, otherwise a new one is created.
+	 *
+	 * @param configuration The configuration the request applies to the instance, as a string identifying it, empty if none.
+	 * @return The lease of the instance.
+	 */
+	Lease Checkout(const std::string& configuration = std::string())
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		const auto it = idle.find(configuration);
+		if (it != idle.end() && !it->second.empty())
+		{
+			auto network = std::move(it->second.back());
+			it->second.pop_back();
+			--nrIdle;
+
+			return Lease(shared_from_this(), network, configuration, generation, false);
+		}
+
+		return Lease(shared_from_this(), CreateInstance(), configuration, generation, true);
+	}
+
+	/**
+	 * @brief Change the settings of the simple simulator.
+	 *
+	 * @param change The function changing the prototype network.
+	 */
+	template<class Change> void ChangeSettings(Change change)
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		change(prototype);
+
+		++generation;
+		idle.clear();
+		nrIdle = 0;
+	}
+
+	/**
+	 * @brief Get the prototype network, keeping the settings.
+	 *
+	 * @return The prototype network.
+	 */
+	const std::shared_ptr<Network::INetwork<>>& GetPrototype() const
+	{
+		return prototype;
+	}
+
+private:
+	std::shared_ptr<Network::INetwork<>> CreateInstance() const
+	{
+		auto network = prototype->Clone();
+
+		network->SetOptimizeSimulator(prototype->GetOptimizeSimulator());
+		for (const auto& [type, kind] : prototype->GetSimulatorsSet())
+			network->AddOptimizationSimulator(type, kind);
+
+		return network;
+	}
+
+	void Return(const std::shared_ptr<Network::INetwork<>>& network, const std::string& configuration, size_t gen)
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		// created with old settings or too many instances kept
+		if (gen != generation || nrIdle >= maxIdle) return;
+
+		network->SetCancellationFlag(nullptr);
+		idle[configuration].push_back(network);
+		++nrIdle;
+	}
+
+	std::mutex poolMutex;
+	std::shared_ptr<Network::INetwork<>> prototype; /**< Keeps the settings, never executed on */
+	std::unordered_map<std::string, std::vector<std::shared_ptr<Network::INetwork<>>>> idle; /**< The instances not checked out, by the configuration applied to them */
+	size_t nrIdle = 0; /**< The number of instances not checked out, for all the configurations */
+	const size_t maxIdle;
+	size_t generation = 0; /**< Incremented when the settings change */
+};
+
+#endif // _SIMPLE_SIMULATOR_POOL_H_
@@ -0,0 +1,149 @@
+/**
+ * @file AliasTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the statevector samplers against the probabilities of the basis states.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+
+#include "../Utils/Alias.h"
+
+namespace {
+
+	Eigen::VectorXcd StateWithProbabilities(const std::vector<double>& probabilities)
+	{
+		Eigen::VectorXcd state(probabilities.size());
+		for (size_t i = 0; i < probabilities.size(); ++i)
+			state[i] = std::polar(std::sqrt(probabilities[i]), 0.3 * i); // the phases must not matter
+
+		return state;
+	}
+
+	// the sampled frequencies over an even grid of uniforms, for a sampler this is the probability it gives to each outcome
+	template<class Sampler> std::vector<double> GridFrequencies(const Sampler& sampler, size_t nrStates, size_t gridSize)
+	{
+		std::vector<double> frequencies(nrStates, 0.);
+		for (size_t k = 0; k < gridSize; ++k)
+		{
+			const size_t state = sampler.Sample((k + 0.5) / gridSize);
+			BOOST_REQUIRE_LT(state, nrStates);
+			frequencies[state] += 1. / gridSize;
+		}
+
+		return frequencies;
+	}
+
+	void CheckFrequencies(const std::vector<double>& frequencies, const std::vector<double>& probabilities, double tolerance)
+	{
+		for (size_t i = 0; i < probabilities.size(); ++i)
+		{
+			BOOST_TEST_CONTEXT("state " << i)
+			{
+				if (probabilities[i] == 0.)
+					BOOST_CHECK_EQUAL(frequencies[i], 0.);
+				else
+					BOOST_CHECK_SMALL(frequencies[i] - probabilities[i], tolerance);
+			}
+		}
+	}
+
+	// samples with SampleStatesCounts, checking the method it chooses, then compares the frequencies with the probabilities (within 5 standard deviations)
+	void CheckSampleStatesCounts(const std::vector<double>& probabilities, size_t shots, Utils::SamplingMethod expectedMethod)
+	{
+		BOOST_REQUIRE(Utils::ChooseSamplingMethod(probabilities.size(), shots) == expectedMethod);
+
+		const auto state = StateWithProbabilities(probabilities);
+
+		std::mt19937_64 rng(11);
+		std::map<size_t, size_t> counts;
+		Utils::SampleStatesCounts(state, shots, rng, [&counts](size_t s, size_t cnt) { counts[s] += cnt; });
+
+		size_t total = 0;
+		for (const auto& [s, cnt] : counts)
+		{
+			BOOST_REQUIRE_LT(s, probabilities.size());
+			BOOST_CHECK_MESSAGE(probabilities[s] > 0., "state " << s << " has zero probability but was sampled");
+			total += cnt;
+		}
+		BOOST_CHECK_EQUAL(total, shots);
+
+		for (size_t i = 0; i < probabilities.size(); ++i)
+		{
+			const double p = probabilities[i];
+			if (p == 0.) continue;
+
+			const auto it = counts.find(i);
+			const double frequency = it == counts.end() ? 0. : static_cast<double>(it->second) / shots;
+			BOOST_CHECK_SMALL(frequency - p, 5. * std::sqrt(p * (1. - p) / shots) + 1E-9);
+		}
+	}
+
+	const std::vector<double> UnevenProbabilities = { 0.05, 0., 0.3, 0.15, 0., 0.25, 0.05, 0.2 };
+
+}
+
+BOOST_AUTO_TEST_SUITE(Samplers)
+
+BOOST_AUTO_TEST_CASE(AliasTableGivesTheProbabilities)
+{
+	const auto state = StateWithProbabilities(UnevenProbabilities);
+
+	for (const int nrThreads : { 1, 4 })
+	{
+		const Utils::Alias alias(state, nrThreads);
+
+		// the thresholds are floats, so the precision is about 1e-7 of a bucket
+		CheckFrequencies(GridFrequencies(alias, UnevenProbabilities.size(), 1 << 20), UnevenProbabilities, 1E-5);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CumulativeSamplerGivesTheProbabilities)
+{
+	const auto state = StateWithProbabilities(UnevenProbabilities);
+
+	const Utils::CumulativeSampler sampler(state);
+	CheckFrequencies(GridFrequencies(sampler, UnevenProbabilities.size(), 1 << 20), UnevenProbabilities, 1E-5);
+}
+
+BOOST_AUTO_TEST_CASE(SamplersSkipTrailingZeroProbabilities)
+{
+	const std::vector<double> probabilities = { 0.5, 0.5, 0., 0. };
+	const auto state = StateWithProbabilities(probabilities);
+
+	const Utils::Alias alias(state);
+	const Utils::CumulativeSampler sampler(state);
+
+	// the largest uniform must not go past the last state that can be sampled
+	BOOST_CHECK_LT(alias.Sample(1.), 2);
+	BOOST_CHECK_LT(sampler.Sample(1.), 2);
+	CheckFrequencies(GridFrequencies(alias, probabilities.size(), 1 << 16), probabilities, 1E-5);
+	CheckFrequencies(GridFrequencies(sampler, probabilities.size(), 1 << 16), probabilities, 1E-5);
+}
+
+BOOST_AUTO_TEST_CASE(SampleCountsWithAliasTable)
+{
+	CheckSampleStatesCounts(UnevenProbabilities, 200000, Utils::SamplingMethod::kAlias);
+}
+
+BOOST_AUTO_TEST_CASE(SampleCountsWithBinarySearch)
+{
+	CheckSampleStatesCounts({ 0.1, 0.6, 0., 0.3 }, 100000, Utils::SamplingMethod::kBinarySearch);
+}
+
+BOOST_AUTO_TEST_CASE(SampleCountsWithSortedSweep)
+{
+	std::vector<double> probabilities(1ULL << 16, 0.);
+	probabilities[3] = 0.1;
+	probabilities[1000] = 0.2;
+	probabilities[40000] = 0.3;
+	probabilities[65535] = 0.4;
+
+	CheckSampleStatesCounts(probabilities, 10000, Utils::SamplingMethod::kSortedSweep);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
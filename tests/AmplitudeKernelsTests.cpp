@@ -0,0 +1,187 @@
+/**
+ * @file AmplitudeKernelsTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the statevector kernels (AVX2 and OpenMP, if enabled) against straightforward scalar implementations.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <random>
+
+#include "../Utils/AmplitudeKernels.h"
+
+namespace {
+
+	using Amplitudes = std::vector<std::complex<double>>;
+
+	Amplitudes RandomAmplitudes(size_t count, std::mt19937_64& rng)
+	{
+		std::uniform_real_distribution<double> dist(-1., 1.);
+
+		Amplitudes amplitudes(count);
+		for (auto& a : amplitudes)
+			a = std::complex<double>(dist(rng), dist(rng));
+
+		return amplitudes;
+	}
+
+	void CheckEqual(const Amplitudes& result, const Amplitudes& expected)
+	{
+		BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+
+		for (size_t i = 0; i < result.size(); ++i)
+			BOOST_REQUIRE_MESSAGE(std::abs(result[i] - expected[i]) < 1E-12, "amplitude " << i << ": " << result[i] << " instead of " << expected[i]);
+	}
+
+	Amplitudes SplitReference(const Amplitudes& src, size_t nrBasisStates, size_t localQubit, bool qubitOutcome)
+	{
+		const size_t lowMask = (1ULL << localQubit) - 1ULL;
+
+		Amplitudes dst(nrBasisStates);
+		for (size_t i = 0; i < nrBasisStates; ++i)
+			dst[i] = src[((i & ~lowMask) << 1) | (qubitOutcome ? 1ULL << localQubit : 0ULL) | (i & lowMask)];
+
+		return dst;
+	}
+
+	Amplitudes JoinReference(const Amplitudes& src1, size_t nrQubits1, const Amplitudes& src2)
+	{
+		Amplitudes dst(src1.size() * src2.size());
+		for (size_t i = 0; i < dst.size(); ++i)
+			dst[i] = src1[i & ((1ULL << nrQubits1) - 1ULL)] * src2[i >> nrQubits1];
+
+		return dst;
+	}
+
+	Amplitudes ApplyMatrixReference(const Amplitudes& src, const std::vector<size_t>& qubits, const Amplitudes& matrix)
+	{
+		const size_t dim = 1ULL << qubits.size();
+
+		size_t gateMask = 0;
+		for (const auto q : qubits)
+			gateMask |= 1ULL << q;
+
+		Amplitudes dst(src.size());
+		for (size_t i = 0; i < src.size(); ++i)
+		{
+			size_t row = 0;
+			for (size_t b = 0; b < qubits.size(); ++b)
+				if ((i >> qubits[b]) & 1ULL)
+					row |= 1ULL << b;
+
+			std::complex<double> sum = 0.;
+			for (size_t col = 0; col < dim; ++col)
+			{
+				size_t j = i & ~gateMask;
+				for (size_t b = 0; b < qubits.size(); ++b)
+					if ((col >> b) & 1ULL)
+						j |= 1ULL << qubits[b];
+
+				sum += matrix[row * dim + col] * src[j];
+			}
+
+			dst[i] = sum;
+		}
+
+		return dst;
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(AmplitudeKernels)
+
+// qubit 0 goes through the odd/even interleaving (the AVX2 permutes), the others through the block copies
+BOOST_AUTO_TEST_CASE(SplitMatchesScalar)
+{
+	std::mt19937_64 rng(42);
+
+	for (const size_t nrQubits : { 1, 2, 3, 7, 14 })
+	{
+		const size_t nrBasisStates = 1ULL << (nrQubits - 1);
+		const auto src = RandomAmplitudes(2 * nrBasisStates, rng);
+
+		for (size_t localQubit = 0; localQubit < nrQubits; ++localQubit)
+			for (const bool outcome : { false, true })
+				for (const int nrThreads : { 1, 4 })
+				{
+					BOOST_TEST_CONTEXT("qubits " << nrQubits << ", removed qubit " << localQubit << ", outcome " << outcome << ", threads " << nrThreads)
+					{
+						Amplitudes dst(nrBasisStates);
+						Utils::SplitAmplitudes(src.data(), dst.data(), nrBasisStates, localQubit, outcome, nrThreads);
+
+						CheckEqual(dst, SplitReference(src, nrBasisStates, localQubit, outcome));
+					}
+				}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(JoinMatchesScalar)
+{
+	std::mt19937_64 rng(7);
+
+	for (const size_t nrQubits1 : { 0, 1, 2, 3, 13 })
+		for (const size_t nrQubits2 : { 0, 1, 3 })
+			for (const int nrThreads : { 1, 4 })
+			{
+				BOOST_TEST_CONTEXT("qubits " << nrQubits1 << " and " << nrQubits2 << ", threads " << nrThreads)
+				{
+					const auto src1 = RandomAmplitudes(1ULL << nrQubits1, rng);
+					const auto src2 = RandomAmplitudes(1ULL << nrQubits2, rng);
+
+					Amplitudes dst(src1.size() * src2.size());
+					Utils::JoinAmplitudes(src1.data(), nrQubits1, src2.data(), src2.size(), dst.data(), nrThreads);
+
+					CheckEqual(dst, JoinReference(src1, nrQubits1, src2));
+				}
+			}
+}
+
+BOOST_AUTO_TEST_CASE(ApplyMatrixMatchesScalar)
+{
+	std::mt19937_64 rng(1234);
+
+	const size_t nrQubits = 6;
+	const auto src = RandomAmplitudes(1ULL << nrQubits, rng);
+
+	// adjacent, spread and unsorted qubits, including the lowest and the highest one
+	const std::vector<std::vector<size_t>> gateQubits = {
+		{ 0 }, { 3 }, { 5 },
+		{ 0, 1 }, { 1, 0 }, { 2, 5 }, { 5, 0 },
+		{ 0, 1, 2 }, { 4, 1, 3 }, { 5, 0, 2 },
+		{ 0, 2, 3, 5, 1 }
+	};
+
+	for (const auto& qubits : gateQubits)
+		for (const int nrThreads : { 1, 4 })
+		{
+			BOOST_TEST_CONTEXT("gate on " << qubits.size() << " qubits, first " << qubits.front() << ", threads " << nrThreads)
+			{
+				const auto matrix = RandomAmplitudes(1ULL << (2 * qubits.size()), rng);
+				const auto expected = ApplyMatrixReference(src, qubits, matrix);
+
+				Amplitudes dst(src.size());
+				Utils::ApplyMatrixToAmplitudes(src.data(), dst.data(), nrQubits, qubits, matrix.data(), nrThreads);
+				CheckEqual(dst, expected);
+
+				// in place
+				Amplitudes inPlace = src;
+				Utils::ApplyMatrixToAmplitudes(inPlace.data(), inPlace.data(), nrQubits, qubits, matrix.data(), nrThreads);
+				CheckEqual(inPlace, expected);
+			}
+		}
+}
+
+BOOST_AUTO_TEST_CASE(ApplyMatrixRejectsTooManyQubits)
+{
+	Amplitudes amplitudes(4, 0.5);
+	const Amplitudes matrix(64, 1.);
+	const std::vector<size_t> qubits = { 0, 1, 2 };
+
+	BOOST_CHECK_THROW(Utils::ApplyMatrixToAmplitudes(amplitudes.data(), amplitudes.data(), 2, qubits, matrix.data()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
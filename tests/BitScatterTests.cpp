@@ -0,0 +1,82 @@
+/**
+ * @file BitScatterTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the precomputed bits scatter against copying the bits one by one.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+#include "../Utils/BitScatter.h"
+
+namespace {
+
+	uint64_t ScatterReference(uint64_t v, const std::vector<std::pair<size_t, size_t>>& bitsMap)
+	{
+		uint64_t res = 0;
+		for (const auto& [src, dst] : bitsMap)
+			if ((v >> src) & 1ULL)
+				res |= 1ULL << dst;
+
+		return res;
+	}
+
+	void CheckScatter(const std::vector<std::pair<size_t, size_t>>& bitsMap)
+	{
+		const Utils::BitScatter scatter(bitsMap);
+
+		std::mt19937_64 rng(3);
+		for (const uint64_t v : { 0ULL, ~0ULL, 1ULL, 1ULL << 63, 0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL })
+			BOOST_CHECK_EQUAL(scatter.Scatter(v), ScatterReference(v, bitsMap));
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			const uint64_t v = rng();
+			BOOST_REQUIRE_EQUAL(scatter.Scatter(v), ScatterReference(v, bitsMap));
+		}
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(BitScatter)
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+	const Utils::BitScatter scatter({});
+
+	BOOST_CHECK_EQUAL(scatter.Scatter(~0ULL), 0ULL);
+}
+
+BOOST_AUTO_TEST_CASE(OrderPreserved)
+{
+	CheckScatter({ { 0, 0 }, { 1, 1 }, { 2, 2 } });
+	CheckScatter({ { 3, 0 }, { 9, 1 }, { 17, 5 }, { 40, 6 }, { 63, 63 } });
+}
+
+BOOST_AUTO_TEST_CASE(OrderChanged)
+{
+	CheckScatter({ { 0, 2 }, { 1, 1 }, { 2, 0 } });
+	CheckScatter({ { 63, 0 }, { 0, 63 }, { 31, 32 }, { 32, 31 }, { 8, 7 }, { 7, 8 } });
+}
+
+// a qubit measured several times, its bit goes to several classical bits
+BOOST_AUTO_TEST_CASE(SourceBitToSeveralDestinations)
+{
+	CheckScatter({ { 1, 3 }, { 1, 7 } });
+	CheckScatter({ { 0, 0 }, { 5, 1 }, { 5, 2 }, { 12, 40 } });
+}
+
+BOOST_AUTO_TEST_CASE(AllBits)
+{
+	std::vector<std::pair<size_t, size_t>> bitsMap;
+	for (size_t i = 0; i < 64; ++i)
+		bitsMap.emplace_back(i, 63 - i);
+
+	CheckScatter(bitsMap);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
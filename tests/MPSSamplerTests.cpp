@@ -0,0 +1,160 @@
+/**
+ * @file MPSSamplerTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the matrix product state sampler against the marginal probabilities of the contracted state.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+
+#include "../Utils/MPSSampler.h"
+
+namespace {
+
+	// a random, not normalized, matrix product state
+	std::vector<Utils::MPSSampler::SiteTensor> RandomSites(size_t nrSites, Eigen::Index bondDim, std::mt19937_64& rng)
+	{
+		std::normal_distribution<double> dist;
+
+		std::vector<Utils::MPSSampler::SiteTensor> sites(nrSites);
+		for (size_t site = 0; site < nrSites; ++site)
+		{
+			const Eigen::Index rows = site == 0 ? 1 : bondDim;
+			const Eigen::Index cols = site == nrSites - 1 ? 1 : bondDim;
+
+			for (auto& m : sites[site])
+			{
+				m.resize(rows, cols);
+				for (Eigen::Index i = 0; i < rows; ++i)
+					for (Eigen::Index j = 0; j < cols; ++j)
+						m(i, j) = std::complex<double>(dist(rng), dist(rng));
+			}
+		}
+
+		return sites;
+	}
+
+	// contracts the whole state, then sums the probabilities of the basis states with the same outcome of the measured sites
+	std::vector<double> MarginalProbabilities(const std::vector<Utils::MPSSampler::SiteTensor>& sites, const std::vector<size_t>& measuredSites)
+	{
+		std::vector<double> probabilities(1ULL << measuredSites.size(), 0.);
+		double total = 0.;
+
+		for (size_t state = 0; state < (1ULL << sites.size()); ++state)
+		{
+			Eigen::MatrixXcd amplitude = Eigen::MatrixXcd::Ones(1, 1);
+			for (size_t site = 0; site < sites.size(); ++site)
+				amplitude = amplitude * sites[site][(state >> site) & 1];
+
+			size_t outcome = 0;
+			for (size_t i = 0; i < measuredSites.size(); ++i)
+				if ((state >> measuredSites[i]) & 1) outcome |= 1ULL << i;
+
+			const double p = std::norm(amplitude(0, 0));
+			probabilities[outcome] += p;
+			total += p;
+		}
+
+		for (auto& p : probabilities)
+			p /= total;
+
+		return probabilities;
+	}
+
+	std::map<size_t, size_t> SampleCounts(const Utils::MPSSampler& sampler, const std::vector<size_t>& measuredSites, size_t shots, uint64_t seed, int nrThreads)
+	{
+		std::map<size_t, size_t> counts;
+		sampler.SampleCounts(measuredSites, shots, seed, [&counts](size_t outcome, size_t cnt) { counts[outcome] += cnt; }, nrThreads);
+
+		return counts;
+	}
+
+	// the frequencies must be within 5 standard deviations of the probabilities
+	void CheckCounts(const std::map<size_t, size_t>& counts, const std::vector<double>& probabilities, size_t shots)
+	{
+		size_t total = 0;
+		for (const auto& [outcome, cnt] : counts)
+		{
+			BOOST_REQUIRE_LT(outcome, probabilities.size());
+			total += cnt;
+		}
+		BOOST_CHECK_EQUAL(total, shots);
+
+		for (size_t i = 0; i < probabilities.size(); ++i)
+		{
+			const double p = probabilities[i];
+			const auto it = counts.find(i);
+			const double frequency = it == counts.end() ? 0. : static_cast<double>(it->second) / shots;
+
+			BOOST_TEST_CONTEXT("outcome " << i)
+			{
+				BOOST_CHECK_SMALL(frequency - p, 5. * std::sqrt(p * (1. - p) / shots) + 1E-9);
+			}
+		}
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(MPSSampling)
+
+BOOST_AUTO_TEST_CASE(SamplesTheMarginals)
+{
+	std::mt19937_64 rng(17);
+
+	const auto sites = RandomSites(7, 3, rng);
+	const Utils::MPSSampler sampler(sites);
+	BOOST_CHECK_EQUAL(sampler.GetNrSites(), 7);
+
+	// contiguous from the first site (a pure left state), after traced out sites, with gaps, unsorted, a single site
+	const std::vector<std::vector<size_t>> measurements = { { 0, 1, 2 }, { 3, 4 }, { 5, 1, 3 }, { 6, 0 }, { 0, 1, 2, 3, 4, 5, 6 }, { 4 } };
+
+	const size_t shots = 100000;
+	for (const auto& measuredSites : measurements)
+	{
+		const auto probabilities = MarginalProbabilities(sites, measuredSites);
+
+		for (const int nrThreads : { 1, 4 })
+		{
+			BOOST_TEST_CONTEXT("measurement " << measuredSites.size() << " sites starting with " << measuredSites.front() << ", threads " << nrThreads)
+			{
+				CheckCounts(SampleCounts(sampler, measuredSites, shots, 42, nrThreads), probabilities, shots);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ProductState)
+{
+	// |1> on site 0, |0> on site 1, (|0> + |1>) / sqrt(2) on site 2
+	std::vector<Utils::MPSSampler::SiteTensor> sites(3);
+	for (auto& site : sites)
+		site = { Eigen::MatrixXcd::Zero(1, 1), Eigen::MatrixXcd::Zero(1, 1) };
+	sites[0][1](0, 0) = 1.;
+	sites[1][0](0, 0) = 1.;
+	sites[2][0](0, 0) = sites[2][1](0, 0) = 1. / std::sqrt(2.);
+
+	const Utils::MPSSampler sampler(sites);
+
+	const auto counts = SampleCounts(sampler, { 1, 0 }, 1000, 1, 1);
+	BOOST_REQUIRE_EQUAL(counts.size(), 1);
+	BOOST_CHECK_EQUAL(counts.begin()->first, 0b10);
+	BOOST_CHECK_EQUAL(counts.begin()->second, 1000);
+
+	CheckCounts(SampleCounts(sampler, { 2 }, 10000, 2, 1), { 0.5, 0.5 }, 10000);
+}
+
+BOOST_AUTO_TEST_CASE(SameSeedSameCounts)
+{
+	std::mt19937_64 rng(3);
+
+	const Utils::MPSSampler sampler(RandomSites(5, 2, rng));
+
+	BOOST_CHECK(SampleCounts(sampler, { 0, 2, 4 }, 5000, 7, 4) == SampleCounts(sampler, { 0, 2, 4 }, 5000, 7, 4));
+	BOOST_CHECK(SampleCounts(sampler, { 0, 2, 4 }, 5000, 7, 1) != SampleCounts(sampler, { 0, 2, 4 }, 5000, 8, 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
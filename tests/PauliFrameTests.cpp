@@ -0,0 +1,221 @@
+/**
+ * @file PauliFrameTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the Pauli frames execution against executing the circuits shot by shot on the qcsim statevector simulator.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+
+#include "../Simulators/Factory.h"
+#include "../Simulators/PauliFrameSimulator.h"
+
+namespace {
+
+	using Circuit = Circuits::Circuit<>;
+	using OperationPtr = Circuit::OperationPtr;
+
+	OperationPtr Measure(Types::qubit_t qubit, size_t bit)
+	{
+		return std::make_shared<Circuits::MeasurementOperation<>>(std::vector<std::pair<Types::qubit_t, size_t>>{ { qubit, bit } });
+	}
+
+	OperationPtr Conditional(const std::shared_ptr<Circuits::IGateOperation<>>& gate, const std::vector<size_t>& bits, const std::vector<bool>& values)
+	{
+		return std::make_shared<Circuits::ConditionalGate<>>(gate, std::make_shared<Circuits::EqualCondition>(bits, values));
+	}
+
+	// Clifford gates, mid-circuit measurements, resets and conditional Pauli gates, each measurement in a new classical bit
+	std::shared_ptr<Circuit> RandomCircuit(size_t nrQubits, size_t nrOps, std::mt19937_64& rng, size_t& nrCbits)
+	{
+		auto circuit = std::make_shared<Circuit>();
+
+		std::uniform_int_distribution<int> opDist(0, 13);
+		std::uniform_int_distribution<Types::qubit_t> qubitDist(0, static_cast<Types::qubit_t>(nrQubits - 1));
+
+		nrCbits = 0;
+		for (size_t i = 0; i < nrOps; ++i)
+		{
+			const Types::qubit_t q = qubitDist(rng);
+			Types::qubit_t t = qubitDist(rng);
+			if (t == q) t = static_cast<Types::qubit_t>((q + 1) % nrQubits);
+
+			switch (opDist(rng))
+			{
+			case 0: circuit->AddOperation(std::make_shared<Circuits::HadamardGate<>>(q)); break;
+			case 1: circuit->AddOperation(std::make_shared<Circuits::SGate<>>(q)); break;
+			case 2: circuit->AddOperation(std::make_shared<Circuits::SdgGate<>>(q)); break;
+			case 3: circuit->AddOperation(std::make_shared<Circuits::SxGate<>>(q)); break;
+			case 4: circuit->AddOperation(std::make_shared<Circuits::YGate<>>(q)); break;
+			case 5: circuit->AddOperation(std::make_shared<Circuits::CXGate<>>(q, t)); break;
+			case 6: circuit->AddOperation(std::make_shared<Circuits::CYGate<>>(q, t)); break;
+			case 7: circuit->AddOperation(std::make_shared<Circuits::CZGate<>>(q, t)); break;
+			case 8: circuit->AddOperation(std::make_shared<Circuits::SwapGate<>>(q, t)); break;
+			case 9:
+			case 10: circuit->AddOperation(Measure(q, nrCbits++)); break;
+			case 11: circuit->AddOperation(std::make_shared<Circuits::Reset<>>(Types::qubits_vector{ q })); break;
+			default:
+				if (nrCbits == 0) break;
+				{
+					std::uniform_int_distribution<size_t> bitDist(0, nrCbits - 1);
+					const std::vector<size_t> bits = { bitDist(rng) };
+					const std::vector<bool> values = { (rng() & 1) != 0 };
+
+					std::shared_ptr<Circuits::IGateOperation<>> gate;
+					switch (rng() % 3)
+					{
+					case 0: gate = std::make_shared<Circuits::XGate<>>(q); break;
+					case 1: gate = std::make_shared<Circuits::YGate<>>(q); break;
+					default: gate = std::make_shared<Circuits::ZGate<>>(q); break;
+					}
+					circuit->AddOperation(Conditional(gate, bits, values));
+				}
+				break;
+			}
+		}
+
+		for (Types::qubit_t q = 0; q < nrQubits; ++q)
+			circuit->AddOperation(Measure(q, nrCbits++));
+
+		return circuit;
+	}
+
+	std::map<std::vector<bool>, size_t> ExecuteWithFrames(const std::shared_ptr<Circuit>& circuit, size_t nrQubits, size_t nrCbits, size_t shots)
+	{
+		BOOST_REQUIRE(Simulators::PauliFrameSimulator<>::IsSupported(*circuit));
+
+		auto sim = Simulators::SimulatorsFactory::CreateSimulator(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStabilizer);
+		BOOST_REQUIRE(sim);
+		sim->AllocateQubits(nrQubits);
+		sim->Initialize();
+
+		Simulators::PauliFrameSimulator<> frames(circuit, nrQubits, nrCbits);
+		frames.Seed(7);
+		frames.ExecuteReference(sim);
+		BOOST_REQUIRE(frames.HasReference());
+
+		std::map<std::vector<bool>, size_t> counts;
+		size_t total = 0;
+		frames.ExecuteShots(shots, [&counts, &total](const std::vector<bool>& bits)
+			{
+				++counts[bits];
+				++total;
+			});
+		BOOST_CHECK_EQUAL(total, shots);
+
+		return counts;
+	}
+
+	std::map<std::vector<bool>, size_t> ExecuteShotByShot(const std::shared_ptr<Circuit>& circuit, size_t nrQubits, size_t nrCbits, size_t shots)
+	{
+		auto sim = Simulators::SimulatorsFactory::CreateSimulator(Simulators::SimulatorType::kQCSim, Simulators::SimulationType::kStatevector);
+		BOOST_REQUIRE(sim);
+		sim->AllocateQubits(nrQubits);
+		sim->Initialize();
+
+		std::map<std::vector<bool>, size_t> counts;
+		Circuits::OperationState state(nrCbits);
+		for (size_t shot = 0; shot < shots; ++shot)
+		{
+			sim->Reset();
+			circuit->Execute(sim, state);
+			++counts[state.GetAllBitsCopy()];
+		}
+
+		return counts;
+	}
+
+	// the two samples must come from the same distribution: the difference of the frequencies is within 5 standard deviations
+	void CheckSameDistribution(const std::map<std::vector<bool>, size_t>& counts, size_t shots, const std::map<std::vector<bool>, size_t>& reference, size_t referenceShots)
+	{
+		std::map<std::vector<bool>, std::pair<size_t, size_t>> both;
+		for (const auto& [bits, cnt] : counts)
+			both[bits].first = cnt;
+		for (const auto& [bits, cnt] : reference)
+			both[bits].second = cnt;
+
+		for (const auto& [bits, cnts] : both)
+		{
+			const double f1 = static_cast<double>(cnts.first) / shots;
+			const double f2 = static_cast<double>(cnts.second) / referenceShots;
+			const double p = static_cast<double>(cnts.first + cnts.second) / (shots + referenceShots);
+			const double sigma = std::sqrt(p * (1. - p) * (1. / shots + 1. / referenceShots));
+
+			BOOST_CHECK_MESSAGE(std::abs(f1 - f2) <= 5. * sigma + 1E-9, "frequency " << f1 << " instead of " << f2 << " for an outcome");
+		}
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(PauliFrames)
+
+BOOST_AUTO_TEST_CASE(MidCircuitMeasurementsAndCorrections)
+{
+	// a Bell pair, qubit 1 corrected by the measurement of qubit 0, so it's always 0
+	// qubit 2 is random, then reset and always 0
+	auto circuit = std::make_shared<Circuit>();
+	circuit->AddOperation(std::make_shared<Circuits::HadamardGate<>>(0));
+	circuit->AddOperation(std::make_shared<Circuits::CXGate<>>(0, 1));
+	circuit->AddOperation(Measure(0, 0));
+	circuit->AddOperation(Conditional(std::make_shared<Circuits::XGate<>>(1), { 0 }, { true }));
+	circuit->AddOperation(Measure(1, 1));
+	circuit->AddOperation(std::make_shared<Circuits::HadamardGate<>>(2));
+	circuit->AddOperation(Measure(2, 2));
+	circuit->AddOperation(std::make_shared<Circuits::Reset<>>(Types::qubits_vector{ 2 }));
+	circuit->AddOperation(Measure(2, 3));
+
+	const size_t shots = 10000;
+	const auto counts = ExecuteWithFrames(circuit, 3, 4, shots);
+
+	BOOST_CHECK_EQUAL(counts.size(), 4);
+	for (const auto& [bits, cnt] : counts)
+	{
+		BOOST_CHECK(!bits[1]);
+		BOOST_CHECK(!bits[3]);
+		BOOST_CHECK_SMALL(static_cast<double>(cnt) / shots - 0.25, 5. * std::sqrt(0.25 * 0.75 / shots));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(RandomCircuitsAgainstStatevector)
+{
+	std::mt19937_64 rng(41);
+
+	const size_t nrQubits = 4;
+	const size_t shots = 5000;
+
+	for (size_t trial = 0; trial < 10; ++trial)
+	{
+		size_t nrCbits = 0;
+		const auto circuit = RandomCircuit(nrQubits, 30, rng, nrCbits);
+
+		BOOST_TEST_CONTEXT("trial " << trial)
+		{
+			CheckSameDistribution(ExecuteWithFrames(circuit, nrQubits, nrCbits, shots), shots, ExecuteShotByShot(circuit, nrQubits, nrCbits, shots), shots);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(UnsupportedOperations)
+{
+	Circuit withT;
+	withT.AddOperation(std::make_shared<Circuits::TGate<>>(0));
+	BOOST_CHECK(!Simulators::PauliFrameSimulator<>::IsSupported(withT));
+
+	Circuit conditionalHadamard;
+	conditionalHadamard.AddOperation(Measure(0, 0));
+	conditionalHadamard.AddOperation(Conditional(std::make_shared<Circuits::HadamardGate<>>(1), { 0 }, { true }));
+	BOOST_CHECK(!Simulators::PauliFrameSimulator<>::IsSupported(conditionalHadamard));
+
+	Circuit clifford;
+	clifford.AddOperation(std::make_shared<Circuits::HadamardGate<>>(0));
+	clifford.AddOperation(std::make_shared<Circuits::CZGate<>>(0, 1));
+	clifford.AddOperation(Measure(1, 0));
+	clifford.AddOperation(Conditional(std::make_shared<Circuits::ZGate<>>(0), { 0 }, { true }));
+	BOOST_CHECK(Simulators::PauliFrameSimulator<>::IsSupported(clifford));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
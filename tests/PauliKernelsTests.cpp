@@ -0,0 +1,160 @@
+/**
+ * @file PauliKernelsTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the batched Pauli expectation values against applying the Pauli matrices on a copy of the state.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+#include "../Utils/PauliKernels.h"
+
+namespace {
+
+	using Amplitudes = std::vector<std::complex<double>>;
+
+	Amplitudes RandomState(size_t nrQubits, std::mt19937_64& rng)
+	{
+		std::normal_distribution<double> dist;
+
+		Amplitudes state(1ULL << nrQubits);
+		double norm = 0.;
+		for (auto& a : state)
+		{
+			a = std::complex<double>(dist(rng), dist(rng));
+			norm += std::norm(a);
+		}
+
+		for (auto& a : state)
+			a /= std::sqrt(norm);
+
+		return state;
+	}
+
+	// <psi|P|psi>, with P applied qubit by qubit with its 2x2 matrix
+	double ExpectationReference(const Amplitudes& state, const std::string& pauli)
+	{
+		const std::complex<double> i(0., 1.);
+
+		Amplitudes applied = state;
+		for (size_t q = 0; q < pauli.size(); ++q)
+		{
+			const char op = pauli[q];
+			if (op == 'I') continue;
+
+			const size_t bit = 1ULL << q;
+			for (size_t k = 0; k < applied.size(); ++k)
+			{
+				if (k & bit) continue;
+
+				const auto a0 = applied[k];
+				const auto a1 = applied[k | bit];
+				switch (op)
+				{
+				case 'X':
+					applied[k] = a1;
+					applied[k | bit] = a0;
+					break;
+				case 'Y':
+					applied[k] = -i * a1;
+					applied[k | bit] = i * a0;
+					break;
+				case 'Z':
+					applied[k | bit] = -a1;
+					break;
+				}
+			}
+		}
+
+		std::complex<double> res = 0.;
+		for (size_t k = 0; k < state.size(); ++k)
+			res += std::conj(state[k]) * applied[k];
+
+		BOOST_REQUIRE_SMALL(res.imag(), 1E-10); // a Pauli string is hermitian
+
+		return res.real();
+	}
+
+	std::vector<std::string> AllPauliStrings(size_t nrQubits)
+	{
+		std::vector<std::string> strs;
+
+		const size_t count = 1ULL << (2 * nrQubits);
+		for (size_t v = 0; v < count; ++v)
+		{
+			std::string str(nrQubits, 'I');
+			for (size_t q = 0; q < nrQubits; ++q)
+				str[q] = "IXYZ"[(v >> (2 * q)) & 3];
+
+			strs.push_back(str);
+		}
+
+		return strs;
+	}
+
+	void CheckExpectations(const Amplitudes& state, size_t nrQubits, const std::vector<std::string>& strs, int nrThreads)
+	{
+		const auto values = Utils::PauliExpectationValues(state.data(), nrQubits, Utils::PauliString::Parse(strs), nrThreads);
+		BOOST_REQUIRE_EQUAL(values.size(), strs.size());
+
+		for (size_t i = 0; i < strs.size(); ++i)
+			BOOST_CHECK_MESSAGE(std::abs(values[i] - ExpectationReference(state, strs[i])) < 1E-10,
+				strs[i] << ": " << values[i] << " instead of " << ExpectationReference(state, strs[i]));
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(PauliExpectations)
+
+// many strings for each X mask, the values come from the Walsh-Hadamard transforms
+BOOST_AUTO_TEST_CASE(AllStringsWithTransform)
+{
+	std::mt19937_64 rng(5);
+
+	const size_t nrQubits = 5;
+	const auto state = RandomState(nrQubits, rng);
+	const auto strs = AllPauliStrings(nrQubits);
+
+	for (const int nrThreads : { 1, 4 })
+		CheckExpectations(state, nrQubits, strs, nrThreads);
+}
+
+// few strings for each X mask, each string is a pass over the amplitudes, in parallel or one string per thread
+BOOST_AUTO_TEST_CASE(FewStringsWithPasses)
+{
+	std::mt19937_64 rng(6);
+
+	const std::vector<std::string> strs = { "ZIIZZ", "XIIII", "IYIIX", "XYZ", "YY", "IIIIZ", "ZXZXY", "IIIII", "Y" };
+
+	for (const size_t nrQubits : { 5, 15 })
+	{
+		const auto state = RandomState(nrQubits, rng);
+
+		for (const int nrThreads : { 1, 4 })
+		{
+			BOOST_TEST_CONTEXT("qubits " << nrQubits << ", threads " << nrThreads)
+			{
+				CheckExpectations(state, nrQubits, strs, nrThreads);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(KnownValues)
+{
+	// (|00> + |11>) / sqrt(2)
+	const double s = 1. / std::sqrt(2.);
+	const Amplitudes bell = { s, 0., 0., s };
+
+	const auto values = Utils::PauliExpectationValues(bell.data(), 2, Utils::PauliString::Parse({ "XX", "YY", "ZZ", "ZI", "XI", "II" }));
+
+	const std::vector<double> expected = { 1., -1., 1., 0., 0., 1. };
+	for (size_t i = 0; i < expected.size(); ++i)
+		BOOST_CHECK_SMALL(values[i] - expected[i], 1E-12);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
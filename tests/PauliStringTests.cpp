@@ -0,0 +1,101 @@
+/**
+ * @file PauliStringTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the packed X/Z masks representation of the Pauli strings.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "../Utils/PauliString.h"
+
+BOOST_AUTO_TEST_SUITE(PauliStrings)
+
+BOOST_AUTO_TEST_CASE(MasksAndPhase)
+{
+	const Utils::PauliString pauli("XyZIY");
+
+	BOOST_CHECK_EQUAL(pauli.GetNrQubits(), 5);
+	BOOST_CHECK_EQUAL(pauli.GetXWord(), 0b10011ULL);
+	BOOST_CHECK_EQUAL(pauli.GetZWord(), 0b10110ULL);
+	BOOST_CHECK_EQUAL(pauli.GetPhase(), 2); // two Y
+	BOOST_CHECK_EQUAL(pauli.ToString(), "XYZIY");
+	BOOST_CHECK(!pauli.IsDiagonal());
+	BOOST_CHECK(!pauli.IsIdentity());
+
+	BOOST_CHECK(Utils::PauliString("IZZ").IsDiagonal());
+	BOOST_CHECK(Utils::PauliString("I-I").IsIdentity());
+}
+
+BOOST_AUTO_TEST_CASE(SetKeepsThePhase)
+{
+	Utils::PauliString pauli(3);
+
+	pauli.Set(0, 'Y');
+	pauli.Set(2, 'Y');
+	BOOST_CHECK_EQUAL(pauli.GetPhase(), 2);
+
+	// replacing a Y removes its phase
+	pauli.Set(0, 'X');
+	BOOST_CHECK_EQUAL(pauli.GetPhase(), 1);
+	pauli.Set(2, 'I');
+	BOOST_CHECK_EQUAL(pauli.GetPhase(), 0);
+	BOOST_CHECK_EQUAL(pauli.ToString(), "XII");
+
+	// past the end it grows
+	pauli.Set(6, 'Z');
+	BOOST_CHECK_EQUAL(pauli.ToString(), "XIIIIIZ");
+	BOOST_CHECK_EQUAL(pauli.Get(100), 'I');
+}
+
+BOOST_AUTO_TEST_CASE(SeveralWords)
+{
+	std::string str(130, 'I');
+	str[0] = 'X';
+	str[64] = 'Z';
+	str[129] = 'Y';
+
+	const Utils::PauliString pauli(str);
+
+	BOOST_CHECK_EQUAL(pauli.GetNrWords(), 3);
+	BOOST_CHECK_EQUAL(pauli.GetXWord(0), 1ULL);
+	BOOST_CHECK_EQUAL(pauli.GetZWord(0), 0ULL);
+	BOOST_CHECK_EQUAL(pauli.GetXWord(1), 0ULL);
+	BOOST_CHECK_EQUAL(pauli.GetZWord(1), 1ULL);
+	BOOST_CHECK_EQUAL(pauli.GetXWord(2), 2ULL);
+	BOOST_CHECK_EQUAL(pauli.GetZWord(2), 2ULL);
+	BOOST_CHECK_EQUAL(pauli.GetXWord(3), 0ULL);
+	BOOST_CHECK_EQUAL(pauli.ToString(), str);
+
+	std::vector<std::pair<size_t, char>> ops;
+	pauli.ForEachOperator([&ops](size_t q, char op) { ops.emplace_back(q, op); });
+
+	const std::vector<std::pair<size_t, char>> expected = { { 0, 'X' }, { 64, 'Z' }, { 129, 'Y' } };
+	BOOST_CHECK(ops == expected);
+}
+
+BOOST_AUTO_TEST_CASE(TrimAndResize)
+{
+	Utils::PauliString diagonalPast("XZIZ");
+	BOOST_CHECK(diagonalPast.Trim(2));
+	BOOST_CHECK_EQUAL(diagonalPast.ToString(), "XZ");
+
+	// an X or Y on a dropped qubit (in the |0> state) makes the expectation value zero
+	Utils::PauliString flipPast("ZIY");
+	BOOST_CHECK(!flipPast.Trim(2));
+
+	Utils::PauliString pauli("YZ");
+	pauli.Resize(1);
+	BOOST_CHECK_EQUAL(pauli.ToString(), "Y");
+	BOOST_CHECK_EQUAL(pauli.GetPhase(), 1);
+	pauli.Resize(0);
+	BOOST_CHECK_EQUAL(pauli.GetPhase(), 0);
+	BOOST_CHECK(pauli.IsIdentity());
+
+	BOOST_CHECK(Utils::PauliString("XZ") == Utils::PauliString("xz"));
+	BOOST_CHECK(Utils::PauliString("XZ") != Utils::PauliString("XZI"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
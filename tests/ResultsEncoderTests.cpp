@@ -0,0 +1,189 @@
+/**
+ * @file ResultsEncoderTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the compact encodings of the results by decoding them back into counts.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <cctype>
+
+#include "../maestrolib/ResultsEncoder.h"
+
+namespace {
+
+	using ExecuteResults = ResultsEncoder::ExecuteResults;
+
+	// parses {"counts":{"0x...":count,...}}, the hex key is expanded to nrBits bits, the classical bit 0 being the least significant
+	ExecuteResults DecodeHexJson(const std::string& json, size_t nrBits)
+	{
+		const std::string prefix = "{\"counts\":{";
+		const std::string suffix = "}}";
+
+		BOOST_REQUIRE_GE(json.size(), prefix.size() + suffix.size());
+		BOOST_REQUIRE_EQUAL(json.substr(0, prefix.size()), prefix);
+		BOOST_REQUIRE_EQUAL(json.substr(json.size() - suffix.size()), suffix);
+
+		ExecuteResults results;
+
+		const std::string body = json.substr(prefix.size(), json.size() - prefix.size() - suffix.size());
+		size_t pos = 0;
+		while (pos < body.size())
+		{
+			size_t end = body.find(',', pos);
+			if (end == std::string::npos) end = body.size();
+
+			const std::string entry = body.substr(pos, end - pos);
+			const size_t colon = entry.find(':');
+			BOOST_REQUIRE_NE(colon, std::string::npos);
+			BOOST_REQUIRE_GT(colon, 4U);
+			BOOST_REQUIRE_EQUAL(entry.substr(0, 3), "\"0x");
+			BOOST_REQUIRE_EQUAL(entry[colon - 1], '"');
+
+			const std::string hex = entry.substr(3, colon - 4);
+			BOOST_CHECK_MESSAGE(hex.size() == 1 || hex[0] != '0', "leading zero in " << hex);
+
+			std::vector<bool> bits(nrBits, false);
+			for (size_t digit = 0; digit < hex.size(); ++digit)
+			{
+				const char c = hex[hex.size() - 1 - digit];
+				BOOST_REQUIRE(std::isxdigit(static_cast<unsigned char>(c)) && !std::isupper(static_cast<unsigned char>(c)));
+				const unsigned int value = std::stoul(std::string(1, c), nullptr, 16);
+
+				for (size_t b = 0; b < 4; ++b)
+					if ((value >> b) & 1)
+					{
+						BOOST_REQUIRE_LT(4 * digit + b, nrBits);
+						bits[4 * digit + b] = true;
+					}
+			}
+
+			const bool inserted = results.emplace(bits, std::stoull(entry.substr(colon + 1))).second;
+			BOOST_CHECK_MESSAGE(inserted, "duplicate key " << hex);
+
+			pos = end + 1;
+		}
+
+		return results;
+	}
+
+	ExecuteResults DecodeBinary(const char* buffer, size_t size, size_t nrBits)
+	{
+		BOOST_REQUIRE_EQUAL(size % sizeof(uint64_t), 0U);
+
+		std::vector<uint64_t> words(size / sizeof(uint64_t));
+		std::memcpy(words.data(), buffer, size);
+
+		BOOST_REQUIRE_GE(words.size(), 3U);
+		BOOST_CHECK_EQUAL(words[0], nrBits);
+		const size_t nrWords = words[1];
+		BOOST_CHECK_EQUAL(nrWords, (nrBits + 63) / 64);
+		BOOST_REQUIRE_EQUAL(words.size(), 3 + words[2] * (nrWords + 1));
+
+		ExecuteResults results;
+		for (size_t outcome = 0; outcome < words[2]; ++outcome)
+		{
+			const uint64_t* record = words.data() + 3 + outcome * (nrWords + 1);
+
+			std::vector<bool> bits(nrBits);
+			for (size_t b = 0; b < nrBits; ++b)
+				bits[b] = (record[b / 64] >> (b % 64)) & 1;
+
+			// no bits past the last classical bit
+			if (nrBits % 64)
+				BOOST_CHECK_EQUAL(record[nrWords - 1] >> (nrBits % 64), 0ULL);
+
+			results.emplace(bits, record[nrWords]);
+		}
+
+		return results;
+	}
+
+	ExecuteResults RandomResults(size_t nrBits, size_t nrOutcomes, std::mt19937_64& rng)
+	{
+		std::bernoulli_distribution bitDist(0.3);
+		std::uniform_int_distribution<size_t> countDist(1, 1000000);
+
+		ExecuteResults results;
+		while (results.size() < nrOutcomes)
+		{
+			std::vector<bool> bits(nrBits);
+			for (size_t b = 0; b < nrBits; ++b)
+				bits[b] = bitDist(rng);
+
+			results[bits] = countDist(rng);
+		}
+
+		return results;
+	}
+
+	void CheckRoundTrips(const ExecuteResults& results, size_t nrBits)
+	{
+		size_t size = 0;
+		char* hex = ResultsEncoder::Encode(results, ResultsEncoder::Format::kHexJson, size);
+		BOOST_CHECK_EQUAL(std::strlen(hex), size);
+		BOOST_CHECK(DecodeHexJson(std::string(hex, size), nrBits) == results);
+		delete[] hex;
+
+		char* binary = ResultsEncoder::Encode(results, ResultsEncoder::Format::kBinary, size);
+		BOOST_CHECK(DecodeBinary(binary, size, nrBits) == results);
+		delete[] binary;
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(ResultsEncoding)
+
+BOOST_AUTO_TEST_CASE(RoundTrips)
+{
+	std::mt19937_64 rng(31);
+
+	// a single bit, less than a nibble, a word, more than a word
+	for (const size_t nrBits : { 1, 6, 64, 70, 130 })
+	{
+		BOOST_TEST_CONTEXT(nrBits << " bits")
+		{
+			CheckRoundTrips(RandomResults(nrBits, nrBits == 1 ? 2 : 50, rng), nrBits);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(KnownEncodings)
+{
+	// classical bit 0 is the least significant
+	const ExecuteResults results = { { { true, false, false, false, true }, 12 } };
+
+	size_t size = 0;
+	char* hex = ResultsEncoder::Encode(results, ResultsEncoder::Format::kHexJson, size);
+	BOOST_CHECK_EQUAL(std::string(hex, size), "{\"counts\":{\"0x11\":12}}");
+	delete[] hex;
+
+	const ExecuteResults zero = { { std::vector<bool>(9, false), 1000 } };
+	hex = ResultsEncoder::Encode(zero, ResultsEncoder::Format::kHexJson, size);
+	BOOST_CHECK_EQUAL(std::string(hex, size), "{\"counts\":{\"0x0\":1000}}");
+	delete[] hex;
+
+	hex = ResultsEncoder::Encode(ExecuteResults(), ResultsEncoder::Format::kHexJson, size);
+	BOOST_CHECK_EQUAL(std::string(hex, size), "{\"counts\":{}}");
+	delete[] hex;
+
+	char* binary = ResultsEncoder::Encode(ExecuteResults(), ResultsEncoder::Format::kBinary, size);
+	BOOST_CHECK_EQUAL(size, 3 * sizeof(uint64_t));
+	BOOST_CHECK(DecodeBinary(binary, size, 0).empty());
+	delete[] binary;
+}
+
+BOOST_AUTO_TEST_CASE(FormatNames)
+{
+	BOOST_CHECK(ResultsEncoder::GetFormat("hex") == ResultsEncoder::Format::kHexJson);
+	BOOST_CHECK(ResultsEncoder::GetFormat("binary") == ResultsEncoder::Format::kBinary);
+	BOOST_CHECK(ResultsEncoder::GetFormat("json") == ResultsEncoder::Format::kJson);
+	BOOST_CHECK(ResultsEncoder::GetFormat("") == ResultsEncoder::Format::kJson);
+	BOOST_CHECK(ResultsEncoder::GetFormat("HEX") == ResultsEncoder::Format::kJson);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,264 @@
+/**
+ * @file StabilizerSamplerTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the stabilizer sampler against the probabilities of the state projected out by the stabilizer generators.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <complex>
+
+#include "../Utils/StabilizerSampler.h"
+
+namespace {
+
+	// a stabilizer generator, with the Aaronson-Gottesman convention: both bits set for a Y
+	struct Generator {
+		std::vector<bool> x;
+		std::vector<bool> z;
+		bool negative = false;
+	};
+
+	// the tableau of |0...0>, evolved with random H, S and CNOT gates
+	std::vector<Generator> RandomStabilizerState(size_t nrQubits, size_t nrGates, std::mt19937_64& rng)
+	{
+		std::vector<Generator> gens(nrQubits);
+		for (size_t q = 0; q < nrQubits; ++q)
+		{
+			gens[q].x.assign(nrQubits, false);
+			gens[q].z.assign(nrQubits, false);
+			gens[q].z[q] = true;
+		}
+
+		std::uniform_int_distribution<size_t> gateDist(0, 2);
+		std::uniform_int_distribution<size_t> qubitDist(0, nrQubits - 1);
+
+		for (size_t g = 0; g < nrGates; ++g)
+		{
+			const size_t gate = gateDist(rng);
+			const size_t q = qubitDist(rng);
+			size_t t = qubitDist(rng);
+			if (gate == 2 && t == q) t = (q + 1) % nrQubits;
+
+			for (auto& gen : gens)
+			{
+				if (gate == 0) // H
+				{
+					gen.negative = gen.negative != (gen.x[q] && gen.z[q]);
+					const bool x = gen.x[q];
+					gen.x[q] = gen.z[q];
+					gen.z[q] = x;
+				}
+				else if (gate == 1) // S
+				{
+					gen.negative = gen.negative != (gen.x[q] && gen.z[q]);
+					gen.z[q] = gen.z[q] != gen.x[q];
+				}
+				else // CNOT, control q, target t
+				{
+					gen.negative = gen.negative != (gen.x[q] && gen.z[t] && (gen.x[t] == gen.z[q]));
+					gen.x[t] = gen.x[t] != gen.x[q];
+					gen.z[q] = gen.z[q] != gen.z[t];
+				}
+			}
+		}
+
+		return gens;
+	}
+
+	// applies the generator to a statevector, qubit q is the bit q of the basis state
+	std::vector<std::complex<double>> Apply(const Generator& gen, std::vector<std::complex<double>> state)
+	{
+		const std::complex<double> i(0., 1.);
+
+		for (size_t q = 0; q < gen.x.size(); ++q)
+		{
+			const size_t bit = 1ULL << q;
+			for (size_t k = 0; k < state.size(); ++k)
+			{
+				if (k & bit) continue;
+
+				const auto a0 = state[k];
+				const auto a1 = state[k | bit];
+				if (gen.x[q] && gen.z[q]) // Y
+				{
+					state[k] = -i * a1;
+					state[k | bit] = i * a0;
+				}
+				else if (gen.x[q])
+				{
+					state[k] = a1;
+					state[k | bit] = a0;
+				}
+				else if (gen.z[q])
+					state[k | bit] = -a1;
+			}
+		}
+
+		if (gen.negative)
+			for (auto& a : state)
+				a = -a;
+
+		return state;
+	}
+
+	// projects a random vector on the stabilized state with the product of (I + g) / 2, then sums the probabilities for the outcomes
+	std::vector<double> MarginalProbabilities(const std::vector<Generator>& gens, size_t nrQubits, const std::vector<size_t>& measuredQubits)
+	{
+		std::mt19937_64 rng(99);
+		std::normal_distribution<double> dist;
+
+		std::vector<std::complex<double>> state(1ULL << nrQubits);
+		for (auto& a : state)
+			a = std::complex<double>(dist(rng), dist(rng));
+
+		for (const auto& gen : gens)
+		{
+			const auto applied = Apply(gen, state);
+			for (size_t k = 0; k < state.size(); ++k)
+				state[k] = 0.5 * (state[k] + applied[k]);
+		}
+
+		std::vector<double> probabilities(1ULL << measuredQubits.size(), 0.);
+		double total = 0.;
+		for (size_t k = 0; k < state.size(); ++k)
+		{
+			size_t outcome = 0;
+			for (size_t i = 0; i < measuredQubits.size(); ++i)
+				if ((k >> measuredQubits[i]) & 1) outcome |= 1ULL << i;
+
+			const double p = std::norm(state[k]);
+			probabilities[outcome] += p;
+			total += p;
+		}
+
+		BOOST_REQUIRE_GT(total, 1E-6);
+		for (auto& p : probabilities)
+		{
+			p /= total;
+			if (p < 1E-9) p = 0.;
+		}
+
+		return probabilities;
+	}
+
+	Utils::StabilizerSampler MakeSampler(const std::vector<Generator>& gens, size_t nrQubits)
+	{
+		Utils::StabilizerSampler sampler(nrQubits);
+		for (const auto& gen : gens)
+			sampler.AddStabilizer(gen.x, gen.z, gen.negative);
+
+		return sampler;
+	}
+
+	std::map<size_t, size_t> SampleCounts(const Utils::StabilizerSampler& sampler, const std::vector<size_t>& measuredQubits, size_t shots, uint64_t seed, int nrThreads)
+	{
+		std::map<size_t, size_t> counts;
+		sampler.SampleCounts(measuredQubits, shots, seed, [&counts](size_t outcome, size_t cnt) { counts[outcome] += cnt; }, nrThreads);
+
+		return counts;
+	}
+
+	// the outcomes with zero probability must not show up, the others within 5 standard deviations
+	void CheckCounts(const std::map<size_t, size_t>& counts, const std::vector<double>& probabilities, size_t shots)
+	{
+		size_t total = 0;
+		for (const auto& [outcome, cnt] : counts)
+		{
+			BOOST_REQUIRE_LT(outcome, probabilities.size());
+			BOOST_CHECK_MESSAGE(probabilities[outcome] > 0., "outcome " << outcome << " has zero probability but was sampled");
+			total += cnt;
+		}
+		BOOST_CHECK_EQUAL(total, shots);
+
+		for (size_t i = 0; i < probabilities.size(); ++i)
+		{
+			const double p = probabilities[i];
+			if (p == 0.) continue;
+
+			const auto it = counts.find(i);
+			const double frequency = it == counts.end() ? 0. : static_cast<double>(it->second) / shots;
+
+			BOOST_TEST_CONTEXT("outcome " << i)
+			{
+				BOOST_CHECK_SMALL(frequency - p, 5. * std::sqrt(p * (1. - p) / shots) + 1E-9);
+			}
+		}
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(StabilizerSampling)
+
+BOOST_AUTO_TEST_CASE(RandomCliffordStates)
+{
+	std::mt19937_64 rng(23);
+
+	const size_t nrQubits = 6;
+	const std::vector<std::vector<size_t>> measurements = { { 0, 1, 2, 3, 4, 5 }, { 5, 0 }, { 4, 2, 1 }, { 3 } };
+
+	const size_t shots = 20000; // not a multiple of 64, the last block is partial
+	for (size_t trial = 0; trial < 8; ++trial)
+	{
+		const auto gens = RandomStabilizerState(nrQubits, 40, rng);
+		const auto sampler = MakeSampler(gens, nrQubits);
+
+		for (const auto& measuredQubits : measurements)
+		{
+			const auto probabilities = MarginalProbabilities(gens, nrQubits, measuredQubits);
+
+			for (const int nrThreads : { 1, 3 })
+			{
+				BOOST_TEST_CONTEXT("trial " << trial << ", " << measuredQubits.size() << " qubits starting with " << measuredQubits.front() << ", threads " << nrThreads)
+				{
+					CheckCounts(SampleCounts(sampler, measuredQubits, shots, trial, nrThreads), probabilities, shots);
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(DeterministicOutcome)
+{
+	// -Z0, Z1, -Z2: always 101
+	std::vector<Generator> gens(3);
+	for (size_t q = 0; q < 3; ++q)
+	{
+		gens[q].x.assign(3, false);
+		gens[q].z.assign(3, false);
+		gens[q].z[q] = true;
+	}
+	gens[0].negative = gens[2].negative = true;
+
+	// mixing the generators must not change the state: Z0 Z1 instead of Z1
+	gens[1].z[0] = true;
+	gens[1].negative = true;
+
+	const auto counts = SampleCounts(MakeSampler(gens, 3), { 2, 1, 0 }, 1000, 5, 2);
+	BOOST_REQUIRE_EQUAL(counts.size(), 1);
+	BOOST_CHECK_EQUAL(counts.begin()->first, 0b101);
+	BOOST_CHECK_EQUAL(counts.begin()->second, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(GHZOverSeveralWords)
+{
+	// H on 0, then a chain of CNOTs: the generators are X...X and Z(q) Z(q + 1)
+	const size_t nrQubits = 130;
+
+	Utils::StabilizerSampler sampler(nrQubits);
+	sampler.AddStabilizer(std::vector<bool>(nrQubits, true), {}, false);
+	for (size_t q = 0; q + 1 < nrQubits; ++q)
+	{
+		std::vector<bool> z(nrQubits, false);
+		z[q] = z[q + 1] = true;
+		sampler.AddStabilizer({}, z, false);
+	}
+
+	CheckCounts(SampleCounts(sampler, { 0, 64, 129, 70 }, 10000, 3, 2), { 0.5, 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.5 }, 10000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,229 @@
+/**
+ * @file TensorNetworkTests.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Checks the tensor network contractions (cached plans, single layer amplitudes and sampling, sliced indices)
+ * against the qcsim statevector simulator.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <cmath>
+
+#include "../Simulators/Factory.h"
+#include "../TensorNetworks/TensorNetwork.h"
+#include "../TensorNetworks/ForestContractor.h"
+
+namespace {
+
+	constexpr size_t NrQubits = 6;
+
+	// qubits 0 to 4 are entangled by random gates, qubit 5 gets only one qubit gates, so there are two qubits groups
+	void ApplyRandomCircuit(const std::vector<std::shared_ptr<Simulators::ISimulator>>& sims, uint64_t seed)
+	{
+		std::mt19937_64 rng(seed);
+		std::uniform_int_distribution<Types::qubit_t> qubitDist(0, NrQubits - 2);
+		std::uniform_real_distribution<double> angleDist(0., 2. * M_PI);
+
+		for (const auto& sim : sims)
+			sim->ApplyH(NrQubits - 1);
+
+		for (size_t i = 0; i < 40; ++i)
+		{
+			const int gate = static_cast<int>(rng() % 7);
+			const Types::qubit_t q = qubitDist(rng);
+			Types::qubit_t t = qubitDist(rng);
+			if (t == q) t = (q + 1) % (NrQubits - 1);
+			const double angle = angleDist(rng);
+
+			for (const auto& sim : sims)
+			{
+				switch (gate)
+				{
+				case 0: sim->ApplyH(q); break;
+				case 1: sim->ApplyT(q); break;
+				case 2: sim->ApplyRx(q, angle); break;
+				case 3: sim->ApplyRy(q, angle); break;
+				case 4: sim->ApplyCX(q, t); break;
+				case 5: sim->ApplyCZ(q, t); break;
+				default: sim->ApplyCRz(q, t, angle); break;
+				}
+			}
+		}
+
+		for (const auto& sim : sims)
+			sim->ApplyRy(NrQubits - 1, 0.7);
+	}
+
+	std::shared_ptr<Simulators::ISimulator> CreateSimulator(Simulators::SimulationType method, size_t maxIntermediateSize = 0)
+	{
+		auto sim = Simulators::SimulatorsFactory::CreateSimulator(Simulators::SimulatorType::kQCSim, method);
+		BOOST_REQUIRE(sim);
+
+		if (maxIntermediateSize)
+			sim->Configure("tensor_network_max_intermediate_size", std::to_string(maxIntermediateSize).c_str());
+
+		sim->AllocateQubits(NrQubits);
+		sim->Initialize();
+
+		return sim;
+	}
+
+	// a network with a 5 qubits group, deep enough to have intermediate tensors larger than a few indices
+	void AddLayers(TensorNetworks::TensorNetwork& network)
+	{
+		QC::Gates::HadamardGate<> h;
+		QC::Gates::TGate<> t;
+		QC::Gates::CNOTGate<> cx;
+
+		for (Types::qubit_t q = 0; q < 5; ++q)
+			network.AddGate(h, q);
+
+		for (size_t layer = 0; layer < 6; ++layer)
+		{
+			for (Types::qubit_t q = layer % 2; q + 1 < 5; q += 2)
+				network.AddGate(cx, q, q + 1);
+			for (Types::qubit_t q = 0; q < 5; ++q)
+			{
+				if ((layer + q) % 2)
+					network.AddGate(t, q);
+				else
+					network.AddGate(h, q);
+			}
+		}
+	}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TensorNetworkContractions)
+
+BOOST_AUTO_TEST_CASE(CachedPlansGiveTheSameProbabilities)
+{
+	TensorNetworks::TensorNetwork network(5);
+	const auto contractor = std::make_shared<TensorNetworks::ForestContractor>();
+	network.SetContractor(contractor);
+	AddLayers(network);
+
+	TensorNetworks::TensorNetwork uncachedNetwork(5);
+	const auto uncachedContractor = std::make_shared<TensorNetworks::ForestContractor>();
+	uncachedContractor->SetCachePlans(false);
+	uncachedNetwork.SetContractor(uncachedContractor);
+	AddLayers(uncachedNetwork);
+
+	BOOST_CHECK_EQUAL(contractor->GetNumberOfCachedPlans(), 0);
+
+	for (Types::qubit_t q = 0; q < 5; ++q)
+	{
+		const double expected = uncachedNetwork.Probability(q);
+
+		// the first contraction searches the order and caches the plan, the second replays it
+		const size_t nrPlans = contractor->GetNumberOfCachedPlans();
+		BOOST_CHECK_SMALL(network.Probability(q) - expected, 1E-10);
+		BOOST_CHECK_EQUAL(contractor->GetNumberOfCachedPlans(), nrPlans + 1);
+		BOOST_CHECK_SMALL(network.Probability(q) - expected, 1E-10);
+		BOOST_CHECK_EQUAL(contractor->GetNumberOfCachedPlans(), nrPlans + 1);
+
+		// a projector with other values, the same topology
+		BOOST_CHECK_SMALL(network.Probability(q, false) - (1. - expected), 1E-10);
+	}
+
+	BOOST_CHECK_EQUAL(uncachedContractor->GetNumberOfCachedPlans(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SlicedContractionGivesTheSameProbabilities)
+{
+	TensorNetworks::TensorNetwork network(5);
+	network.SetContractor(std::make_shared<TensorNetworks::ForestContractor>());
+	AddLayers(network);
+
+	TensorNetworks::TensorNetwork slicedNetwork(5);
+	const auto slicedContractor = std::make_shared<TensorNetworks::ForestContractor>();
+	slicedContractor->SetMaxIntermediateSize(64); // at most 2 indices
+	slicedNetwork.SetContractor(slicedContractor);
+	AddLayers(slicedNetwork);
+
+	const auto plan = network.PlanProbability(2);
+	const auto slicedPlan = slicedNetwork.PlanProbability(2);
+	BOOST_REQUIRE(plan && slicedPlan);
+	BOOST_REQUIRE_GT(plan->GetMaxTensorRank(), slicedContractor->GetMaxIntermediateRank());
+
+	BOOST_CHECK(plan->GetSlicedIndices().empty());
+	BOOST_CHECK(!slicedPlan->GetSlicedIndices().empty());
+	BOOST_CHECK_EQUAL(slicedPlan->GetNumberOfSlices(), 1ULL << slicedPlan->GetSlicedIndices().size());
+	BOOST_CHECK_LT(slicedPlan->GetMaxTensorRank(), plan->GetMaxTensorRank());
+
+	for (const bool multithreading : { false, true })
+	{
+		slicedNetwork.SetMultithreading(multithreading);
+
+		for (Types::qubit_t q = 0; q < 5; ++q)
+			BOOST_CHECK_SMALL(slicedNetwork.Probability(q) - network.Probability(q), 1E-10);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AmplitudesAgainstStatevector)
+{
+	for (const size_t maxIntermediateSize : { 0, 64 })
+	{
+		std::vector<std::shared_ptr<Simulators::ISimulator>> sims = { CreateSimulator(Simulators::SimulationType::kStatevector), CreateSimulator(Simulators::SimulationType::kTensorNetwork, maxIntermediateSize) };
+		ApplyRandomCircuit(sims, 13);
+
+		BOOST_TEST_CONTEXT("max intermediate size " << maxIntermediateSize)
+		{
+			for (Types::qubit_t outcome = 0; outcome < (1ULL << NrQubits); ++outcome)
+			{
+				const auto expected = sims[0]->Amplitude(outcome);
+
+				BOOST_CHECK_SMALL(std::abs(sims[1]->Amplitude(outcome) - expected), 1E-10);
+				BOOST_CHECK_SMALL(sims[1]->Probability(outcome) - std::norm(expected), 1E-10);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SamplingAgainstStatevector)
+{
+	std::vector<std::shared_ptr<Simulators::ISimulator>> sims = { CreateSimulator(Simulators::SimulationType::kStatevector), CreateSimulator(Simulators::SimulationType::kTensorNetwork) };
+	ApplyRandomCircuit(sims, 29);
+
+	// measuring both groups, in an order that is not the qubits order
+	const Types::qubits_vector qubits = { 5, 1, 3, 0 };
+
+	std::vector<double> probabilities(1ULL << qubits.size(), 0.);
+	for (Types::qubit_t state = 0; state < (1ULL << NrQubits); ++state)
+	{
+		Types::qubit_t outcome = 0;
+		for (size_t i = 0; i < qubits.size(); ++i)
+			if ((state >> qubits[i]) & 1) outcome |= 1ULL << i;
+
+		probabilities[outcome] += sims[0]->Probability(state);
+	}
+
+	const size_t shots = 50000;
+	const auto counts = sims[1]->SampleCounts(qubits, shots);
+
+	size_t total = 0;
+	for (const auto& [outcome, cnt] : counts)
+	{
+		BOOST_REQUIRE_LT(outcome, probabilities.size());
+		total += cnt;
+	}
+	BOOST_CHECK_EQUAL(total, shots);
+
+	for (size_t outcome = 0; outcome < probabilities.size(); ++outcome)
+	{
+		const double p = probabilities[outcome];
+		const auto it = counts.find(outcome);
+		const double frequency = it == counts.end() ? 0. : static_cast<double>(it->second) / shots;
+
+		BOOST_TEST_CONTEXT("outcome " << outcome)
+		{
+			BOOST_CHECK_SMALL(frequency - p, 5. * std::sqrt(p * (1. - p) / shots) + 1E-9);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,12 @@
+/**
+ * @file TestsMain.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The unit tests module, the test cases are in the other files of the directory.
+ * Boost.Test is used header only, so it's included in this translation unit only.
+ */
+
+#define BOOST_TEST_MODULE MaestroTests
+#include <boost/test/included/unit_test.hpp>
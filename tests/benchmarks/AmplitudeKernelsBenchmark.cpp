@@ -0,0 +1,161 @@
+/**
+ * @file AmplitudeKernelsBenchmark.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Times the statevector kernels against plain scalar loops doing the same work.
+ *
+ * Usage: AmplitudeKernelsBenchmark [number of qubits] [number of threads]
+ * The defaults are 22 qubits and all the hardware threads.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <functional>
+
+#include "../../Utils/AmplitudeKernels.h"
+
+namespace {
+
+	using Amplitudes = std::vector<std::complex<double>>;
+
+	constexpr int Repetitions = 10;
+
+	double TimeMs(const std::function<void()>& work)
+	{
+		work(); // warm up, also touching the destination pages
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Repetitions; ++i)
+			work();
+		const auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::milli>(end - start).count() / Repetitions;
+	}
+
+	void Report(const std::string& name, double scalarMs, double kernelMs, double threadedMs, int nrThreads)
+	{
+		std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << scalarMs << std::setw(12) << kernelMs << std::setw(12) << threadedMs
+			<< std::setw(10) << std::setprecision(2) << scalarMs / kernelMs << "x"
+			<< std::setw(10) << scalarMs / threadedMs << "x (" << nrThreads << " threads)" << std::endl;
+	}
+
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t nrQubits = argc > 1 ? std::stoul(argv[1]) : 22;
+	const int nrThreads = argc > 2 ? std::stoi(argv[2]) : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+
+	if (nrQubits < 4 || nrQubits > 30)
+	{
+		std::cerr << "The number of qubits must be between 4 and 30" << std::endl;
+		return 1;
+	}
+
+	const size_t nrBasisStates = 1ULL << nrQubits;
+
+	std::mt19937_64 rng(42);
+	std::uniform_real_distribution<double> dist(-1., 1.);
+	Amplitudes src(nrBasisStates);
+	for (auto& a : src)
+		a = std::complex<double>(dist(rng), dist(rng));
+
+	Amplitudes dst(nrBasisStates);
+
+#ifdef __AVX2__
+	std::cout << "AVX2 enabled";
+#else
+	std::cout << "AVX2 not enabled";
+#endif
+	std::cout << ", " << nrQubits << " qubits, times in ms" << std::endl << std::endl;
+	std::cout << std::left << std::setw(28) << "kernel" << std::right << std::setw(12) << "scalar" << std::setw(12) << "1 thread" << std::setw(12) << "threads" << std::endl;
+
+	// splitting out qubit 0 uses the odd/even interleaving, a higher qubit the block copies
+	for (const size_t localQubit : { size_t{ 0 }, nrQubits / 2 })
+		for (const bool outcome : { false, true })
+		{
+			const size_t half = nrBasisStates / 2;
+			const size_t lowMask = (1ULL << localQubit) - 1ULL;
+			const size_t qubitMask = outcome ? 1ULL << localQubit : 0ULL;
+
+			const double scalarMs = TimeMs([&]() {
+				for (size_t i = 0; i < half; ++i)
+					dst[i] = src[((i & ~lowMask) << 1) | qubitMask | (i & lowMask)];
+				});
+			const double kernelMs = TimeMs([&]() { Utils::SplitAmplitudes(src.data(), dst.data(), half, localQubit, outcome, 1); });
+			const double threadedMs = TimeMs([&]() { Utils::SplitAmplitudes(src.data(), dst.data(), half, localQubit, outcome, nrThreads); });
+
+			Report("split q" + std::to_string(localQubit) + (outcome ? " |1>" : " |0>"), scalarMs, kernelMs, threadedMs, nrThreads);
+		}
+
+	{
+		const size_t nrQubits1 = nrQubits / 2;
+		const size_t nrBasisStates1 = 1ULL << nrQubits1;
+		const size_t nrBasisStates2 = nrBasisStates >> nrQubits1;
+		const std::complex<double>* src1 = src.data();
+		const std::complex<double>* src2 = src.data() + nrBasisStates1;
+
+		const double scalarMs = TimeMs([&]() {
+			for (size_t i = 0; i < nrBasisStates; ++i)
+				dst[i] = src1[i & (nrBasisStates1 - 1ULL)] * src2[i >> nrQubits1];
+			});
+		const double kernelMs = TimeMs([&]() { Utils::JoinAmplitudes(src1, nrQubits1, src2, nrBasisStates2, dst.data(), 1); });
+		const double threadedMs = TimeMs([&]() { Utils::JoinAmplitudes(src1, nrQubits1, src2, nrBasisStates2, dst.data(), nrThreads); });
+
+		Report("join", scalarMs, kernelMs, threadedMs, nrThreads);
+	}
+
+	for (size_t k = 1; k <= 3; ++k)
+	{
+		const size_t dim = 1ULL << k;
+
+		std::vector<size_t> qubits(k);
+		for (size_t i = 0; i < k; ++i)
+			qubits[i] = (i * nrQubits) / k + 1;
+
+		Amplitudes matrix(dim * dim);
+		for (auto& m : matrix)
+			m = std::complex<double>(dist(rng), dist(rng));
+
+		size_t gateMask = 0;
+		for (const auto q : qubits)
+			gateMask |= 1ULL << q;
+
+		const double scalarMs = TimeMs([&]() {
+			for (size_t i = 0; i < nrBasisStates; ++i)
+			{
+				size_t row = 0;
+				for (size_t b = 0; b < k; ++b)
+					if ((i >> qubits[b]) & 1ULL)
+						row |= 1ULL << b;
+
+				std::complex<double> sum = 0.;
+				for (size_t col = 0; col < dim; ++col)
+				{
+					size_t j = i & ~gateMask;
+					for (size_t b = 0; b < k; ++b)
+						if ((col >> b) & 1ULL)
+							j |= 1ULL << qubits[b];
+
+					sum += matrix[row * dim + col] * src[j];
+				}
+
+				dst[i] = sum;
+			}
+			});
+		const double kernelMs = TimeMs([&]() { Utils::ApplyMatrixToAmplitudes(src.data(), dst.data(), nrQubits, qubits, matrix.data(), 1); });
+		const double threadedMs = TimeMs([&]() { Utils::ApplyMatrixToAmplitudes(src.data(), dst.data(), nrQubits, qubits, matrix.data(), nrThreads); });
+
+		Report("apply matrix K=" + std::to_string(k), scalarMs, kernelMs, threadedMs, nrThreads);
+	}
+
+	return 0;
+}